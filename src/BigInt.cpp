@@ -0,0 +1,454 @@
+// File: src/BigInt.cpp
+// Purpose: Source file for BigInts, which are the integers of any size that
+//  Ints too large for 64 bits are stored as. See src/BigInt.hpp for more
+//  documentation.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BigInt.hpp"
+
+// Constructors
+BigInt::BigInt(bool negative, Limbs limbs): negative { negative },
+  limbs { std::move(limbs) } {
+  trim(this->limbs);
+  if (this->limbs.empty()) {
+    this->negative = false;
+  }
+}
+
+// The magnitude of the most negative number is found without overflowing.
+BigInt::BigInt(std::int64_t number): negative { number < 0 } {
+  const std::uint64_t magnitude = number < 0 ?
+    0 - static_cast<std::uint64_t>(number) : static_cast<std::uint64_t>(number);
+  if (magnitude != 0) {
+    limbs.push_back(static_cast<std::uint32_t>(magnitude));
+  }
+  if (magnitude >> 32 != 0) {
+    limbs.push_back(static_cast<std::uint32_t>(magnitude >> 32));
+  }
+}
+
+// trim(limbs) - Removes the leading zero limbs.
+void BigInt::trim(Limbs &limbs) {
+  while (!limbs.empty() && limbs.back() == 0) {
+    limbs.pop_back();
+  }
+}
+
+// compareMagnitudes(x, y) - Compares trimmed magnitudes, first by length.
+int BigInt::compareMagnitudes(const Limbs &x, const Limbs &y) {
+  if (x.size() != y.size()) {
+    return x.size() < y.size() ? -1 : 1;
+  }
+  for (std::size_t i = x.size(); i-- > 0; ) {
+    if (x[i] != y[i]) {
+      return x[i] < y[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+// addMagnitudes(x, y) - Adds limb by limb, carrying into the next limb.
+BigInt::Limbs BigInt::addMagnitudes(const Limbs &x, const Limbs &y) {
+  const Limbs &longer = x.size() < y.size() ? y : x;
+  const Limbs &shorter = x.size() < y.size() ? x : y;
+  Limbs sum(longer.size() + 1, 0);
+  std::uint64_t carry = 0;
+  for (std::size_t i = 0; i < longer.size(); i++) {
+    carry += static_cast<std::uint64_t>(longer[i]) +
+      (i < shorter.size() ? shorter[i] : 0);
+    sum[i] = static_cast<std::uint32_t>(carry);
+    carry >>= 32;
+  }
+  sum[longer.size()] = static_cast<std::uint32_t>(carry);
+  trim(sum);
+  return sum;
+}
+
+// subtractMagnitudes(x, y) - Subtracts limb by limb, borrowing from the next
+//  limb. x must be at least y.
+BigInt::Limbs BigInt::subtractMagnitudes(const Limbs &x, const Limbs &y) {
+  Limbs difference(x.size(), 0);
+  std::int64_t borrow = 0;
+  for (std::size_t i = 0; i < x.size(); i++) {
+    std::int64_t limb = static_cast<std::int64_t>(x[i]) - borrow -
+      (i < y.size() ? y[i] : 0);
+    borrow = limb < 0;
+    difference[i] = static_cast<std::uint32_t>(limb + (borrow << 32));
+  }
+  trim(difference);
+  return difference;
+}
+
+// addShifted(to, x, shift) - Adds x times 2^(32 * shift) to to, which must
+//  have enough limbs for the sum.
+void BigInt::addShifted(Limbs &to, const Limbs &x, std::size_t shift) {
+  std::uint64_t carry = 0;
+  std::size_t i = 0;
+  for (; i < x.size(); i++) {
+    carry += static_cast<std::uint64_t>(to[shift + i]) + x[i];
+    to[shift + i] = static_cast<std::uint32_t>(carry);
+    carry >>= 32;
+  }
+  for (; carry != 0; i++) {
+    carry += to[shift + i];
+    to[shift + i] = static_cast<std::uint32_t>(carry);
+    carry >>= 32;
+  }
+}
+
+// multiplySchoolbook(x, xSize, y, ySize) - Multiplies every pair of limbs.
+BigInt::Limbs BigInt::multiplySchoolbook(const std::uint32_t *x,
+  std::size_t xSize, const std::uint32_t *y, std::size_t ySize) {
+  Limbs product(xSize + ySize, 0);
+  for (std::size_t i = 0; i < xSize; i++) {
+    std::uint64_t carry = 0;
+    for (std::size_t j = 0; j < ySize; j++) {
+      carry += static_cast<std::uint64_t>(x[i]) * y[j] + product[i + j];
+      product[i + j] = static_cast<std::uint32_t>(carry);
+      carry >>= 32;
+    }
+    product[i + ySize] = static_cast<std::uint32_t>(carry);
+  }
+  trim(product);
+  return product;
+}
+
+// multiplyMagnitudes(x, xSize, y, ySize) - With x split into x1 and x0 at
+//  half of its limbs and y likewise, x * y is z2 shifted by twice half plus
+//  z1 shifted by half plus z0, where z2 = x1 * y1, z0 = x0 * y0 and
+//  z1 = (x1 + x0) * (y1 + y0) - z2 - z0. A factor less than half as long as
+//  the other is multiplied by slices of the other as long as it instead,
+//  since splitting it would leave nothing in its upper half.
+BigInt::Limbs BigInt::multiplyMagnitudes(const std::uint32_t *x,
+  std::size_t xSize, const std::uint32_t *y, std::size_t ySize) {
+  if (xSize < ySize) {
+    std::swap(x, y);
+    std::swap(xSize, ySize);
+  }
+  if (ySize < karatsubaLimbs) {
+    return multiplySchoolbook(x, xSize, y, ySize);
+  }
+  Limbs product(xSize + ySize + 1, 0);
+  if (ySize <= xSize / 2) {
+    for (std::size_t start = 0; start < xSize; start += ySize) {
+      addShifted(product, multiplyMagnitudes(x + start,
+        std::min(ySize, xSize - start), y, ySize), start);
+    }
+    trim(product);
+    return product;
+  }
+
+  const std::size_t half = xSize / 2;
+  Limbs x0 { x, x + half };
+  Limbs y0 { y, y + half };
+  trim(x0);
+  trim(y0);
+  const Limbs x1 { x + half, x + xSize };
+  const Limbs y1 { y + half, y + ySize };
+  const Limbs z0 = multiplyMagnitudes(x0.data(), x0.size(), y0.data(),
+    y0.size());
+  const Limbs z2 = multiplyMagnitudes(x1.data(), x1.size(), y1.data(),
+    y1.size());
+  const Limbs xSum = addMagnitudes(x0, x1);
+  const Limbs ySum = addMagnitudes(y0, y1);
+  const Limbs z1 = subtractMagnitudes(subtractMagnitudes(multiplyMagnitudes(
+    xSum.data(), xSum.size(), ySum.data(), ySum.size()), z0), z2);
+  addShifted(product, z0, 0);
+  addShifted(product, z1, half);
+  addShifted(product, z2, 2 * half);
+  trim(product);
+  return product;
+}
+
+// multiplyAddSmall(x, factor, addend) - Sets x to x * factor + addend.
+void BigInt::multiplyAddSmall(Limbs &x, std::uint32_t factor,
+  std::uint32_t addend) {
+  std::uint64_t carry = addend;
+  for (std::uint32_t &limb : x) {
+    carry += static_cast<std::uint64_t>(limb) * factor;
+    limb = static_cast<std::uint32_t>(carry);
+    carry >>= 32;
+  }
+  if (carry != 0) {
+    x.push_back(static_cast<std::uint32_t>(carry));
+  }
+}
+
+// divideSmall(x, divisor) - Sets x to x / divisor, from the top limb down,
+//  and returns the remainder.
+std::uint32_t BigInt::divideSmall(Limbs &x, std::uint32_t divisor) {
+  std::uint64_t remainder = 0;
+  for (std::size_t i = x.size(); i-- > 0; ) {
+    const std::uint64_t current = remainder << 32 | x[i];
+    x[i] = static_cast<std::uint32_t>(current / divisor);
+    remainder = current % divisor;
+  }
+  trim(x);
+  return static_cast<std::uint32_t>(remainder);
+}
+
+// divideMagnitudes(x, y, quotient, remainder) - Knuth's algorithm D: both
+//  numbers are shifted so that the top bit of y is set, which makes the
+//  estimate of each limb of the quotient from the top two limbs of the
+//  remainder at most 2 too large. The estimate is corrected with the next
+//  limb, which almost always makes it exact, and y is added back in the rare
+//  case that subtracting estimate * y still leaves a negative remainder.
+void BigInt::divideMagnitudes(const Limbs &x, const Limbs &y,
+  Limbs &quotient, Limbs &remainder) {
+  if (compareMagnitudes(x, y) < 0) {
+    quotient.clear();
+    remainder = x;
+    return;
+  }
+  if (y.size() == 1) {
+    quotient = x;
+    remainder = { divideSmall(quotient, y[0]) };
+    trim(remainder);
+    return;
+  }
+  const std::size_t n = y.size();
+  const std::size_t m = x.size();
+  const unsigned shift = __builtin_clz(y.back());
+  Limbs v(n);
+  Limbs u(m + 1);
+  for (std::size_t i = n; i-- > 1; ) {
+    v[i] = y[i] << shift |
+      (shift ? static_cast<std::uint32_t>(y[i - 1] >> (32 - shift)) : 0);
+  }
+  v[0] = y[0] << shift;
+  u[m] = shift ? static_cast<std::uint32_t>(x[m - 1] >> (32 - shift)) : 0;
+  for (std::size_t i = m; i-- > 1; ) {
+    u[i] = x[i] << shift |
+      (shift ? static_cast<std::uint32_t>(x[i - 1] >> (32 - shift)) : 0);
+  }
+  u[0] = x[0] << shift;
+
+  constexpr std::uint64_t base = std::uint64_t { 1 } << 32;
+  quotient.assign(m - n + 1, 0);
+  for (std::size_t j = m - n + 1; j-- > 0; ) {
+    const std::uint64_t top = static_cast<std::uint64_t>(u[j + n]) << 32 |
+      u[j + n - 1];
+    std::uint64_t estimate = top / v[n - 1];
+    std::uint64_t rest = top % v[n - 1];
+    while (estimate >= base ||
+      estimate * v[n - 2] > (rest << 32 | u[j + n - 2])) {
+      estimate--;
+      rest += v[n - 1];
+      if (rest >= base) {
+        break;
+      }
+    }
+    std::int64_t borrow = 0;
+    std::int64_t limb = 0;
+    for (std::size_t i = 0; i < n; i++) {
+      const std::uint64_t product = estimate * v[i];
+      limb = static_cast<std::int64_t>(u[i + j]) - borrow -
+        static_cast<std::int64_t>(product & 0xffffffff);
+      u[i + j] = static_cast<std::uint32_t>(limb);
+      borrow = static_cast<std::int64_t>(product >> 32) - (limb >> 32);
+    }
+    limb = static_cast<std::int64_t>(u[j + n]) - borrow;
+    u[j + n] = static_cast<std::uint32_t>(limb);
+    quotient[j] = static_cast<std::uint32_t>(estimate);
+    if (limb < 0) {
+      quotient[j]--;
+      std::uint64_t carry = 0;
+      for (std::size_t i = 0; i < n; i++) {
+        carry += static_cast<std::uint64_t>(u[i + j]) + v[i];
+        u[i + j] = static_cast<std::uint32_t>(carry);
+        carry >>= 32;
+      }
+      u[j + n] += static_cast<std::uint32_t>(carry);
+    }
+  }
+  remainder.assign(n, 0);
+  for (std::size_t i = 0; i < n; i++) {
+    remainder[i] = u[i] >> shift |
+      (shift ? static_cast<std::uint32_t>(u[i + 1] << (32 - shift)) : 0);
+  }
+  trim(quotient);
+  trim(remainder);
+}
+
+// toUnsigned(limbs) - Returns the magnitude if it fits in 64 bits.
+std::optional<std::uint64_t> BigInt::toUnsigned(const Limbs &limbs) {
+  if (limbs.size() > 2) {
+    return {};
+  }
+  std::uint64_t magnitude = 0;
+  for (std::size_t i = limbs.size(); i-- > 0; ) {
+    magnitude = magnitude << 32 | limbs[i];
+  }
+  return magnitude;
+}
+
+// parse(digits) - Adds up to 9 digits at a time, which fit in a limb.
+std::optional<BigInt> BigInt::parse(const std::string &digits) {
+  const bool negative = !digits.empty() && digits[0] == '-';
+  const std::size_t start = negative ? 1 : 0;
+  if (digits.size() == start) {
+    return {};
+  }
+  Limbs limbs;
+  for (std::size_t i = start; i < digits.size(); ) {
+    const std::size_t end = std::min(digits.size(), i + 9);
+    std::uint32_t chunk = 0;
+    std::uint32_t scale = 1;
+    for (; i < end; i++) {
+      if (digits[i] < '0' || digits[i] > '9') {
+        return {};
+      }
+      chunk = chunk * 10 + static_cast<std::uint32_t>(digits[i] - '0');
+      scale *= 10;
+    }
+    multiplyAddSmall(limbs, scale, chunk);
+  }
+  return BigInt { negative, std::move(limbs) };
+}
+
+// isNegative() - Zero is never negative.
+bool BigInt::isNegative() const {
+  return negative;
+}
+
+// toSmall() - The most negative 64-bit number has a magnitude of 2^63.
+std::optional<std::int64_t> BigInt::toSmall() const {
+  const std::optional<std::uint64_t> magnitude = toUnsigned(limbs);
+  constexpr std::uint64_t most = std::numeric_limits<std::int64_t>::max();
+  if (!magnitude || *magnitude > most + negative) {
+    return {};
+  }
+  return negative ? static_cast<std::int64_t>(0 - *magnitude) :
+    static_cast<std::int64_t>(*magnitude);
+}
+
+// toDouble() - The top three limbs hold more bits than a double does, so
+//  only they are converted.
+double BigInt::toDouble() const {
+  double magnitude = 0;
+  const std::size_t used = std::min<std::size_t>(limbs.size(), 3);
+  for (std::size_t i = limbs.size(); i-- > limbs.size() - used; ) {
+    magnitude = magnitude * 4294967296.0 + limbs[i];
+  }
+  magnitude = std::ldexp(magnitude,
+    static_cast<int>(32 * (limbs.size() - used)));
+  return negative ? -magnitude : magnitude;
+}
+
+// operator string() - Divides by 10^9 repeatedly, giving 9 digits at a time
+//  from the right.
+BigInt::operator std::string() const {
+  if (limbs.empty()) {
+    return "0";
+  }
+  Limbs rest = limbs;
+  std::string digits;
+  while (!rest.empty()) {
+    std::uint32_t chunk = divideSmall(rest, 1000000000);
+    for (int i = 0; i < 9 && (chunk != 0 || !rest.empty()); i++) {
+      digits += static_cast<char>('0' + chunk % 10);
+      chunk /= 10;
+    }
+  }
+  if (negative) {
+    digits += '-';
+  }
+  return { digits.rbegin(), digits.rend() };
+}
+
+// compare(x, y) - Numbers of different signs compare by sign.
+int BigInt::compare(const BigInt &x, const BigInt &y) {
+  if (x.negative != y.negative) {
+    return x.negative ? -1 : 1;
+  }
+  const int magnitudes = compareMagnitudes(x.limbs, y.limbs);
+  return x.negative ? -magnitudes : magnitudes;
+}
+
+// add(x, y) - Numbers of different signs are added by subtracting the
+//  smaller magnitude from the larger.
+BigInt BigInt::add(const BigInt &x, const BigInt &y) {
+  if (x.negative == y.negative) {
+    return BigInt { x.negative, addMagnitudes(x.limbs, y.limbs) };
+  }
+  if (compareMagnitudes(x.limbs, y.limbs) >= 0) {
+    return BigInt { x.negative, subtractMagnitudes(x.limbs, y.limbs) };
+  }
+  return BigInt { y.negative, subtractMagnitudes(y.limbs, x.limbs) };
+}
+
+// subtract(x, y) - Adds the negation of y.
+BigInt BigInt::subtract(const BigInt &x, const BigInt &y) {
+  return add(x, BigInt { !y.negative, y.limbs });
+}
+
+// multiply(x, y) - Multiplies the magnitudes.
+BigInt BigInt::multiply(const BigInt &x, const BigInt &y) {
+  return BigInt { x.negative != y.negative, multiplyMagnitudes(
+    x.limbs.data(), x.limbs.size(), y.limbs.data(), y.limbs.size()
+  ) };
+}
+
+// divide(x, y, quotient, remainder) - Divides the magnitudes.
+void BigInt::divide(const BigInt &x, const BigInt &y, BigInt &quotient,
+  BigInt &remainder) {
+  Limbs quotientLimbs;
+  Limbs remainderLimbs;
+  divideMagnitudes(x.limbs, y.limbs, quotientLimbs, remainderLimbs);
+  quotient = BigInt { x.negative != y.negative, std::move(quotientLimbs) };
+  remainder = BigInt { x.negative, std::move(remainderLimbs) };
+}
+
+// gcd(x, y) - Each step of Euclid's algorithm replaces the larger number by
+//  its remainder after dividing by the smaller, and std::gcd takes over once
+//  both fit in 64 bits.
+BigInt BigInt::gcd(const BigInt &x, const BigInt &y) {
+  Limbs larger = x.limbs;
+  Limbs smaller = y.limbs;
+  if (compareMagnitudes(larger, smaller) < 0) {
+    std::swap(larger, smaller);
+  }
+  while (!smaller.empty()) {
+    const std::optional<std::uint64_t> a = toUnsigned(larger);
+    const std::optional<std::uint64_t> b = toUnsigned(smaller);
+    if (a && b) {
+      const std::uint64_t divisor = std::gcd(*a, *b);
+      return BigInt { false, {
+        static_cast<std::uint32_t>(divisor),
+        static_cast<std::uint32_t>(divisor >> 32)
+      } };
+    }
+    Limbs quotient;
+    Limbs remainder;
+    divideMagnitudes(larger, smaller, quotient, remainder);
+    larger = std::move(smaller);
+    smaller = std::move(remainder);
+  }
+  return BigInt { false, std::move(larger) };
+}
+
+// power(base, exponent) - Squares base once per bit of exponent, and
+//  multiplies the result by it for each set bit.
+BigInt BigInt::power(const BigInt &base, std::uint64_t exponent) {
+  BigInt result { 1 };
+  BigInt square = base;
+  while (exponent != 0) {
+    if (exponent & 1) {
+      result = multiply(result, square);
+    }
+    exponent >>= 1;
+    if (exponent != 0) {
+      square = multiply(square, square);
+    }
+  }
+  return result;
+}
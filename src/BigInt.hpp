@@ -0,0 +1,100 @@
+// File: src/BigInt.hpp
+// Purpose: Header file for BigInts, which are the integers of any size that
+//  Ints too large for 64 bits are stored as. See src/BigInt.cpp for
+//  implementations.
+
+#ifndef BIGINT_HPP
+#define BIGINT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// BigInt - An immutable integer of any size, stored as its sign and the 32-bit
+//  limbs of its magnitude, least significant first, without leading zero
+//  limbs. Multiplying two numbers of at least karatsubaLimbs limbs splits each
+//  in halves and combines three half-size products instead of four
+//  (Karatsuba multiplication), which takes O(n^1.58) time rather than O(n^2).
+//  Division is long division a limb at a time (Knuth's algorithm D), and gcd
+//  runs Euclid's algorithm on BigInts only until the numbers fit in 64 bits.
+class BigInt {
+public:
+  // The fewest limbs of both factors for which Karatsuba multiplication is
+  //  faster than multiplying every pair of limbs.
+  static constexpr std::size_t karatsubaLimbs = 32;
+
+private:
+  typedef std::vector<std::uint32_t> Limbs;
+
+  bool negative;
+  Limbs limbs;
+
+  // Private methods are documented in src/BigInt.cpp.
+  BigInt(bool negative, Limbs limbs);
+  static void trim(Limbs &limbs);
+  static int compareMagnitudes(const Limbs &x, const Limbs &y);
+  static Limbs addMagnitudes(const Limbs &x, const Limbs &y);
+  static Limbs subtractMagnitudes(const Limbs &x, const Limbs &y);
+  static void addShifted(Limbs &to, const Limbs &x, std::size_t shift);
+  static Limbs multiplySchoolbook(const std::uint32_t *x, std::size_t xSize,
+    const std::uint32_t *y, std::size_t ySize);
+  static Limbs multiplyMagnitudes(const std::uint32_t *x, std::size_t xSize,
+    const std::uint32_t *y, std::size_t ySize);
+  static void multiplyAddSmall(Limbs &x, std::uint32_t factor,
+    std::uint32_t addend);
+  static std::uint32_t divideSmall(Limbs &x, std::uint32_t divisor);
+  static void divideMagnitudes(const Limbs &x, const Limbs &y,
+    Limbs &quotient, Limbs &remainder);
+  static std::optional<std::uint64_t> toUnsigned(const Limbs &limbs);
+
+public:
+  // Constructor(number) - Creates a BigInt equal to number.
+  BigInt(std::int64_t number);
+
+  // static parse(digits) - Returns the BigInt written in decimal in digits,
+  //  which may start with a minus sign, or nothing if digits is not such a
+  //  number.
+  static std::optional<BigInt> parse(const std::string &digits);
+
+  // isNegative() - Returns whether the number is less than 0.
+  bool isNegative() const;
+
+  // toSmall() - Returns the number if it fits in 64 bits, and nothing
+  //  otherwise.
+  std::optional<std::int64_t> toSmall() const;
+
+  // toDouble() - Returns the double nearest to the number (or, rarely, the
+  //  one next to that), which is infinite if the number is too large.
+  double toDouble() const;
+
+  // operator string() - Returns the number in decimal.
+  operator std::string() const;
+
+  // static compare(x, y) - Returns a negative number, 0 or a positive number
+  //  if x is less than, equal to or greater than y.
+  static int compare(const BigInt &x, const BigInt &y);
+
+  // static add(x, y), subtract(x, y), multiply(x, y) - Return x + y, x - y
+  //  and x * y.
+  static BigInt add(const BigInt &x, const BigInt &y);
+  static BigInt subtract(const BigInt &x, const BigInt &y);
+  static BigInt multiply(const BigInt &x, const BigInt &y);
+
+  // static divide(x, y, quotient, remainder) - Sets quotient to x / y rounded
+  //  toward 0 and remainder to x - quotient * y, which has the sign of x. y
+  //  must not be 0.
+  static void divide(const BigInt &x, const BigInt &y, BigInt &quotient,
+    BigInt &remainder);
+
+  // static gcd(x, y) - Returns the greatest common divisor of x and y, which
+  //  is never negative (and 0 only if both are 0).
+  static BigInt gcd(const BigInt &x, const BigInt &y);
+
+  // static power(base, exponent) - Returns base raised to exponent, by
+  //  squaring. Takes O(log exponent) multiplications.
+  static BigInt power(const BigInt &base, std::uint64_t exponent);
+};
+
+#endif
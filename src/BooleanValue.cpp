@@ -0,0 +1,64 @@
+// File: src/BooleanValue.cpp
+// Purpose: A BooleanValue is a Value that is either True or False, such as the
+//  result of a comparison. For more documentation see src/BooleanValue.hpp.
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include "BooleanValue.hpp"
+#include "Error.hpp"
+#include "Value.hpp"
+
+// Constructor
+BooleanValue::BooleanValue(bool rawBoolean): boolean(rawBoolean) {}
+
+// of(rawBoolean) - The two BooleanValues are created on first use and are
+//  never released.
+const std::shared_ptr<BooleanValue> &BooleanValue::of(bool rawBoolean) {
+  static const std::shared_ptr<BooleanValue> trueValue {
+    new BooleanValue { true }
+  };
+  static const std::shared_ptr<BooleanValue> falseValue {
+    new BooleanValue { false }
+  };
+  return rawBoolean ? trueValue : falseValue;
+}
+
+// call([unused] arg) - Returns an error, since BooleanValues cannot be called.
+Value::OrError BooleanValue::call([[maybe_unused]] Value::Pointer arg) const {
+  return {
+    Error { Error::Code::NotCallable, { &BooleanValue::getClassName } }
+  };
+}
+
+// operator string() - Returns the name of the BooleanValue in Fleet code.
+BooleanValue::operator std::string() const {
+  return boolean ? "True" : "False";
+}
+
+// getRawBoolean() - Returns the internal bool value in the object.
+bool BooleanValue::getRawBoolean() const {
+  return boolean;
+}
+
+std::optional<std::size_t> BooleanValue::hash() const {
+  return mixHash(boolean ? 1 : 2);
+}
+
+// equals(other) - Both BooleanValues are shared, but others can be created.
+bool BooleanValue::equals(const Value &other) const {
+  const auto otherBoolean = dynamic_cast<const BooleanValue *>(&other);
+  return otherBoolean && otherBoolean->boolean == boolean;
+}
+
+const std::string BooleanValue::name { "Boolean" };
+
+// getName() - Returns "Boolean", the name of the Boolean type.
+std::string BooleanValue::getName() const {
+  return BooleanValue::name;
+}
+
+std::string BooleanValue::getClassName() {
+  return BooleanValue::name;
+}
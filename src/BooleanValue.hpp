@@ -0,0 +1,47 @@
+// File: src/BooleanValue.hpp
+// Purpose: A BooleanValue is a Value that is either True or False, such as the
+//  result of a comparison. For implementations see src/BooleanValue.cpp.
+
+#ifndef BOOLEANVALUE_HPP
+#define BOOLEANVALUE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include "Value.hpp"
+
+class BooleanValue: public Value {
+private:
+  bool boolean;
+
+public:
+  // Constructor(rawBoolean) - Creates a BooleanValue with rawBoolean as its
+  //  internal C++ bool. Use of(rawBoolean) instead to share the two Values.
+  BooleanValue(bool rawBoolean);
+
+  // static of(rawBoolean) - Returns the shared BooleanValue for rawBoolean,
+  //  so that no BooleanValue is ever allocated while code is evaluated.
+  static const std::shared_ptr<BooleanValue> &of(bool rawBoolean);
+
+  // call(arg) - Returns an error, since BooleanValues cannot be called.
+  Value::OrError call([[maybe_unused]] Value::Pointer arg) const;
+
+  // operator string() - Returns "True" or "False".
+  operator std::string() const;
+
+  // getRawBoolean() - Returns the BooleanValue's internal C++ bool.
+  bool getRawBoolean() const;
+
+  // hash(), equals(other) - Booleans are equal if both are True or both are
+  //  False.
+  std::optional<std::size_t> hash() const;
+  bool equals(const Value &other) const;
+
+  // name/getName() - Returns "Boolean", the name of a BooleanValue-type value.
+  static const std::string name;
+  static std::string getClassName();
+  std::string getName() const;
+};
+
+#endif
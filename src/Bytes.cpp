@@ -0,0 +1,146 @@
+// File: src/Bytes.cpp
+// Purpose: Source file for Bytes, which are the immutable arrays of bytes that
+//  BytesValues hold. See src/Bytes.hpp for more documentation.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include "Bytes.hpp"
+
+// Files are mapped with the POSIX calls where there are any, and are read
+//  into memory elsewhere.
+#if defined(__unix__) || defined(__APPLE__)
+#define BYTES_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Constructors
+Bytes::Storage::Storage(): mapping { nullptr }, mappedSize { 0 } {}
+Bytes::Bytes(): storage { nullptr }, begin { nullptr }, count { 0 } {}
+Bytes::Bytes(const std::shared_ptr<const Storage> &storage,
+  const unsigned char *begin, std::size_t count): storage { storage },
+  begin { begin }, count { count } {}
+
+// Destructor - Unmaps the file, if the Storage is of one.
+Bytes::Storage::~Storage() {
+#ifdef BYTES_MMAP
+  if (mapping) {
+    munmap(mapping, mappedSize);
+  }
+#endif
+}
+
+// of(buffer) - The Bytes view the whole buffer.
+Bytes Bytes::of(std::string buffer) {
+  auto storage = std::make_shared<Storage>();
+  storage->buffer = std::move(buffer);
+  return Bytes {
+    storage, reinterpret_cast<const unsigned char *>(storage->buffer.data()),
+    storage->buffer.size()
+  };
+}
+
+// map(path) - Maps the file privately, so that the Bytes never change even if
+//  the process writes to it. An empty file cannot be mapped, and gives empty
+//  Bytes.
+std::optional<Bytes> Bytes::map(const std::string &path) {
+#ifdef BYTES_MMAP
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    return {};
+  }
+  struct stat status;
+  if (fstat(file, &status) != 0 || !S_ISREG(status.st_mode)) {
+    close(file);
+    return {};
+  }
+  auto storage = std::make_shared<Storage>();
+  const auto size = static_cast<std::size_t>(status.st_size);
+  if (size != 0) {
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (mapping == MAP_FAILED) {
+      close(file);
+      return {};
+    }
+    storage->mapping = mapping;
+    storage->mappedSize = size;
+  }
+  close(file);
+  return Bytes {
+    storage, static_cast<const unsigned char *>(storage->mapping), size
+  };
+#else
+  std::ifstream file { path, std::ios::binary };
+  if (!file) {
+    return {};
+  }
+  return of(std::string {
+    std::istreambuf_iterator<char> { file }, std::istreambuf_iterator<char> {}
+  });
+#endif
+}
+
+std::size_t Bytes::size() const {
+  return count;
+}
+
+const unsigned char *Bytes::data() const {
+  return begin;
+}
+
+unsigned char Bytes::at(std::size_t index) const {
+  return begin[index];
+}
+
+// slice(from, to) - Shares the Storage.
+Bytes Bytes::slice(std::size_t from, std::size_t to) const {
+  to = std::min(to, count);
+  from = std::min(from, to);
+  return Bytes { storage, begin + from, to - from };
+}
+
+// unsignedAt(offset, width) - Assembles the bytes from the lowest one up,
+//  which compilers turn into a single load on little-endian processors.
+std::uint64_t Bytes::unsignedAt(std::size_t offset, std::size_t width) const {
+  std::uint64_t number = 0;
+  for (std::size_t i = width; i-- > 0; ) {
+    number = number << 8 | begin[offset + i];
+  }
+  return number;
+}
+
+// integerAt(offset, width) - Extends the sign of narrower integers.
+std::int64_t Bytes::integerAt(std::size_t offset, std::size_t width) const {
+  const std::uint64_t number = unsignedAt(offset, width);
+  const std::size_t unused = 64 - 8 * width;
+  return static_cast<std::int64_t>(number << unused) >> unused;
+}
+
+// floatAt(offset, width) - Copies the bits of the number into a float or a
+//  double.
+double Bytes::floatAt(std::size_t offset, std::size_t width) const {
+  const std::uint64_t bits = unsignedAt(offset, width);
+  if (width == 4) {
+    const auto narrow = static_cast<std::uint32_t>(bits);
+    float number;
+    std::memcpy(&number, &narrow, sizeof number);
+    return number;
+  }
+  double number;
+  std::memcpy(&number, &bits, sizeof number);
+  return number;
+}
+
+std::string Bytes::toString() const {
+  return std::string { reinterpret_cast<const char *>(begin), count };
+}
@@ -0,0 +1,79 @@
+// File: src/Bytes.hpp
+// Purpose: Header file for Bytes, which are the immutable arrays of bytes that
+//  BytesValues hold. See src/Bytes.cpp for implementations.
+
+#ifndef BYTES_HPP
+#define BYTES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+// Bytes - A view of part of a buffer of bytes, which is either in memory or a
+//  file mapped read-only into memory. Slicing Bytes takes O(1) time and shares
+//  the buffer, which is reference-counted, so a file stays mapped as long as
+//  any slice of it is alive, and only the pages of it that are read are ever
+//  loaded.
+class Bytes {
+private:
+  // Storage - The buffer of some Bytes: either buffer, or the mappedSize bytes
+  //  of a file mapped at mapping, which are unmapped when it is destroyed.
+  struct Storage {
+    std::string buffer;
+    void *mapping;
+    std::size_t mappedSize;
+
+    Storage();
+    ~Storage();
+    Storage(const Storage &other) = delete;
+    Storage &operator=(const Storage &other) = delete;
+  };
+
+  std::shared_ptr<const Storage> storage;
+  const unsigned char *begin;
+  std::size_t count;
+
+  // Private methods are documented in src/Bytes.cpp.
+  Bytes(const std::shared_ptr<const Storage> &storage,
+    const unsigned char *begin, std::size_t count);
+  std::uint64_t unsignedAt(std::size_t offset, std::size_t width) const;
+
+public:
+  // Constructor() - Creates empty Bytes.
+  Bytes();
+
+  // static of(buffer) - Returns the Bytes of buffer, which they keep.
+  static Bytes of(std::string buffer);
+
+  // static map(path) - Returns the Bytes of the file at path, mapped into
+  //  memory rather than read, or nothing if it cannot be opened.
+  static std::optional<Bytes> map(const std::string &path);
+
+  // size() - Returns the number of bytes.
+  std::size_t size() const;
+
+  // data() - Returns the first byte, after which the others follow.
+  const unsigned char *data() const;
+
+  // at(index) - Returns the byte at index, which must be less than size().
+  unsigned char at(std::size_t index) const;
+
+  // slice(from, to) - Returns the bytes from position from up to position to,
+  //  which are clamped to size().
+  Bytes slice(std::size_t from, std::size_t to) const;
+
+  // integerAt(offset, width) - Returns the signed integer of width bytes (1,
+  //  2, 4 or 8) stored little-endian at offset.
+  std::int64_t integerAt(std::size_t offset, std::size_t width) const;
+
+  // floatAt(offset, width) - Returns the IEEE 754 number of width bytes (4 or
+  //  8) stored little-endian at offset.
+  double floatAt(std::size_t offset, std::size_t width) const;
+
+  // toString() - Returns a copy of the bytes.
+  std::string toString() const;
+};
+
+#endif
@@ -0,0 +1,148 @@
+// File: src/BytesValue.cpp
+// Purpose: Source file for BytesValues, which are the sequences of bytes that
+//  readBytes and bytesOf return. See src/BytesValue.hpp for more
+//  documentation.
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+#include "BytesValue.hpp"
+#include "Bytes.hpp"
+#include "Error.hpp"
+#include "Evacuation.hpp"
+#include "NumberValue.hpp"
+#include "Region.hpp"
+#include "SequenceValue.hpp"
+#include "TextKernel.hpp"
+#include "Value.hpp"
+
+// Constructor
+BytesValue::BytesValue(const Bytes &bytes): SequenceValue {
+  std::make_shared<const Source>(bytes), std::vector<Stage> {}
+} {}
+
+// elementOf(byte) - The Ints are created on first use and are never released.
+std::shared_ptr<NumberValue> BytesValue::elementOf(unsigned char byte) {
+  static const auto elements = [] {
+    std::array<std::shared_ptr<NumberValue>, 256> numbers;
+    for (std::size_t i = 0; i < numbers.size(); i++) {
+      numbers[i] = std::make_shared<NumberValue>(static_cast<std::int64_t>(i));
+    }
+    return numbers;
+  }();
+  return elements[byte];
+}
+
+// getBytes() - A BytesValue is always created with Bytes.
+const Bytes &BytesValue::getBytes() const {
+  return *std::get_if<Bytes>(source.get());
+}
+
+// then(stage) - Slices the Bytes for Take and Drop.
+std::shared_ptr<SequenceValue> BytesValue::then(const Stage &stage) const {
+  const Bytes &bytes = getBytes();
+  switch (stage.kind) {
+    case Stage::Kind::Take:
+      return Region::make<BytesValue>(bytes.slice(0, stage.count));
+    case Stage::Kind::Drop:
+      return Region::make<BytesValue>(bytes.slice(stage.count, bytes.size()));
+    default:
+      return SequenceValue::then(stage);
+  }
+}
+
+// length() - The number of bytes is known.
+Value::OrError BytesValue::length() const {
+  return { Value::Pointer {
+    Region::make<NumberValue>(static_cast<std::int64_t>(getBytes().size()))
+  } };
+}
+
+// first() - Returns the byte at 0.
+Value::OrError BytesValue::first() const {
+  if (getBytes().size() == 0) {
+    return { Error { Error::Code::EmptySequence } };
+  }
+  return { Value::Pointer { elementOf(getBytes().at(0)) } };
+}
+
+// last() - Returns the byte at the end.
+Value::OrError BytesValue::last() const {
+  const Bytes &bytes = getBytes();
+  if (bytes.size() == 0) {
+    return { Error { Error::Code::EmptySequence } };
+  }
+  return { Value::Pointer { elementOf(bytes.at(bytes.size() - 1)) } };
+}
+
+// at(index) - Reads the byte directly.
+Value::OrError BytesValue::at(const std::shared_ptr<NumberValue> &index)
+  const {
+  const double position = index->getRawNumber();
+  if (position < 0 || std::floor(position) != position ||
+    !(position < static_cast<double>(getBytes().size()))) {
+    return {
+      Error { Error::Code::IndexOutOfRange, { Error::Shown { index } } }
+    };
+  }
+  return { Value::Pointer {
+    elementOf(getBytes().at(static_cast<std::size_t>(position)))
+  } };
+}
+
+std::optional<std::size_t> BytesValue::hash() const {
+  if (!cachedHash) {
+    const Bytes &bytes = getBytes();
+    cachedHash = std::hash<std::string_view> {}(std::string_view {
+      reinterpret_cast<const char *>(bytes.data()), bytes.size()
+    });
+  }
+  return cachedHash;
+}
+
+std::optional<std::size_t> BytesValue::knownHash() const {
+  return cachedHash;
+}
+
+bool BytesValue::equals(const Value &other) const {
+  const auto otherBytes = dynamic_cast<const BytesValue *>(&other);
+  if (!otherBytes) {
+    return false;
+  }
+  const Bytes &x = getBytes();
+  const Bytes &y = otherBytes->getBytes();
+  return x.size() == y.size() && (x.data() == y.data() || TextKernel::equal(
+    reinterpret_cast<const char *>(x.data()),
+    reinterpret_cast<const char *>(y.data()), x.size()
+  ));
+}
+
+// evacuate([unused] evacuation) - The storage of Bytes is never in a Region.
+Value::Pointer BytesValue::evacuate([[maybe_unused]] Evacuation &evacuation)
+  const {
+  return Value::Pointer { std::make_shared<BytesValue>(*this) };
+}
+
+// operator string() - Shows only the number of bytes.
+BytesValue::operator std::string() const {
+  return "<Bytes of length " + std::to_string(getBytes().size()) + ">";
+}
+
+const std::string BytesValue::name { "Bytes" };
+
+// getName() - Returns "Bytes", the name of the Bytes type.
+std::string BytesValue::getName() const {
+  return BytesValue::name;
+}
+
+std::string BytesValue::getClassName() {
+  return BytesValue::name;
+}
@@ -0,0 +1,71 @@
+// File: src/BytesValue.hpp
+// Purpose: Header file for BytesValues, which are the sequences of bytes that
+//  readBytes and bytesOf return. See src/BytesValue.cpp for implementations.
+
+#ifndef BYTESVALUE_HPP
+#define BYTESVALUE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include "Bytes.hpp"
+#include "NumberValue.hpp"
+#include "SequenceValue.hpp"
+#include "Value.hpp"
+
+// BytesValue - A SequenceValue whose source is Bytes (see src/Bytes.hpp) and
+//  which has no stages. Its elements are its bytes, each given as an Int from
+//  0 to 255. Its length and the byte at any position are found directly, and
+//  taking or dropping bytes shares the buffer, so slicing a file read with
+//  readBytes never copies it.
+class BytesValue final: public SequenceValue {
+private:
+  // The hash of the bytes, once it has been computed.
+  mutable std::optional<std::size_t> cachedHash;
+
+public:
+  // Constructor(bytes) - Creates the sequence of bytes.
+  explicit BytesValue(const Bytes &bytes);
+
+  // static elementOf(byte) - Returns the Int of byte. The 256 Ints are
+  //  shared, so that going through the bytes does not allocate.
+  static std::shared_ptr<NumberValue> elementOf(unsigned char byte);
+
+  // getBytes() - Returns the bytes.
+  const Bytes &getBytes() const;
+
+  // then(stage) - Returns a slice of the bytes for stages that take or drop
+  //  bytes, and adds stage to the sequence like any other otherwise.
+  std::shared_ptr<SequenceValue> then(const Stage &stage) const;
+
+  // length(), first(), last(), at(index) - Look the result up directly.
+  Value::OrError length() const;
+  Value::OrError first() const;
+  Value::OrError last() const;
+  Value::OrError at(const std::shared_ptr<NumberValue> &index) const;
+
+  // hash(), knownHash() - Return the hash of the bytes, which is computed
+  //  once.
+  std::optional<std::size_t> hash() const;
+  std::optional<std::size_t> knownHash() const;
+
+  // equals(other) - Returns whether other is Bytes with the same bytes, which
+  //  are compared a block at a time (see TextKernel::equal).
+  bool equals(const Value &other) const;
+
+  // evacuate(evacuation) - Returns a copy of the Bytes, which shares its
+  //  bytes.
+  Value::Pointer evacuate(Evacuation &evacuation) const;
+
+  // operator string() - Returns "<Bytes of length n>", since the bytes may be
+  //  too many to show.
+  operator std::string() const;
+
+  // name/getName() - Returns "Bytes", the name of a BytesValue-type value.
+  static const std::string name;
+  static std::string getClassName();
+  std::string getName() const;
+};
+
+#endif
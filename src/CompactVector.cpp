@@ -0,0 +1,297 @@
+// File: src/CompactVector.cpp
+// Purpose: Source file for CompactVectors, which are immutable arrays of whole
+//  numbers stored in a few bits each. See src/CompactVector.hpp for more
+//  documentation.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "CompactVector.hpp"
+
+// Constructor
+CompactVector::Builder::Builder(): data { std::make_shared<Data>() } {
+  data->count = 0;
+}
+
+// add(numbers, size) - Works out how many bytes each encoding would take, and
+//  writes the block in the smallest. Since the numbers of a Packed block are
+//  found without decoding the others, the other encodings are only used if
+//  they take at most three quarters of the bytes that Packed takes.
+bool CompactVector::Builder::add(const double *numbers, std::size_t size) {
+  // Numbers below 2^53 in size are exact, and so are the differences of any
+  //  two of them.
+  std::int64_t values[blockSize];
+  for (std::size_t i = 0; i < size; i++) {
+    if (!(std::fabs(numbers[i]) < 9007199254740992.0) ||
+      std::floor(numbers[i]) != numbers[i]) {
+      return false;
+    }
+    values[i] = static_cast<std::int64_t>(numbers[i]);
+  }
+  const auto [least, most] = std::minmax_element(values, values + size);
+  const auto range = static_cast<std::uint64_t>(*most - *least);
+  unsigned bits = 0;
+  while (bits < 64 && range >> bits != 0) {
+    bits++;
+  }
+  const std::size_t packed = (size * bits + 7) / 8;
+  std::size_t delta = 0;
+  std::size_t runs = 0;
+  for (std::size_t i = 1; i < size; i++) {
+    delta += varintSize(zigzag(values[i] - values[i - 1]));
+  }
+  for (std::size_t i = 0, previous = 0; i < size; ) {
+    std::size_t end = i + 1;
+    while (end < size && values[end] == values[i]) {
+      end++;
+    }
+    runs += varintSize(end - i) +
+      varintSize(zigzag(values[i] - values[previous]));
+    previous = i;
+    i = end;
+  }
+
+  const Encoding encoding = std::min(delta, runs) * 4 > packed * 3 ?
+    Encoding::Packed : delta <= runs ? Encoding::Delta : Encoding::Runs;
+  if (data->bytes.size() + std::max({ packed, delta, runs }) >
+    std::numeric_limits<std::uint32_t>::max()) {
+    return false;
+  }
+  std::vector<unsigned char> &bytes = data->bytes;
+  data->blocks.push_back({
+    encoding == Encoding::Packed ? *least : values[0],
+    static_cast<std::uint32_t>(bytes.size()), encoding,
+    static_cast<std::uint8_t>(bits)
+  });
+  switch (encoding) {
+    case Encoding::Packed: {
+      // The numbers are written from the lowest bit up, a byte at a time.
+      std::uint64_t buffer = 0;
+      unsigned filled = 0;
+      for (std::size_t i = 0; i < size; i++) {
+        buffer |= static_cast<std::uint64_t>(values[i] - *least) << filled;
+        filled += bits;
+        while (filled >= 8) {
+          bytes.push_back(static_cast<unsigned char>(buffer & 0xff));
+          buffer >>= 8;
+          filled -= 8;
+        }
+      }
+      if (filled > 0) {
+        bytes.push_back(static_cast<unsigned char>(buffer));
+      }
+      break;
+    }
+    case Encoding::Delta:
+      for (std::size_t i = 1; i < size; i++) {
+        putVarint(zigzag(values[i] - values[i - 1]), bytes);
+      }
+      break;
+    case Encoding::Runs:
+      for (std::size_t i = 0, previous = 0; i < size; ) {
+        std::size_t end = i + 1;
+        while (end < size && values[end] == values[i]) {
+          end++;
+        }
+        putVarint(end - i, bytes);
+        putVarint(zigzag(values[i] - values[previous]), bytes);
+        previous = i;
+        i = end;
+      }
+      break;
+  }
+  data->count += size;
+  return true;
+}
+
+// build() - Adds the zero bytes that Packed blocks may read past the end.
+CompactVector CompactVector::Builder::build() {
+  data->bytes.insert(data->bytes.end(), 8, 0);
+  data->bytes.shrink_to_fit();
+  data->blocks.shrink_to_fit();
+  const std::size_t count = data->count;
+  return CompactVector { std::move(data), 0, count };
+}
+
+// Constructor
+CompactVector::CompactVector(std::shared_ptr<const Data> data,
+  std::size_t from, std::size_t count): data { std::move(data) },
+  from { from }, count { count } {}
+
+// zigzag(number), unzigzag(number) - Map numbers near 0, whether negative or
+//  not, to small unsigned numbers and back: 0, -1, 1, -2, 2... become 0, 1,
+//  2, 3, 4...
+std::uint64_t CompactVector::zigzag(std::int64_t number) {
+  return (static_cast<std::uint64_t>(number) << 1) ^
+    static_cast<std::uint64_t>(number < 0 ? -1 : 0);
+}
+
+std::int64_t CompactVector::unzigzag(std::uint64_t number) {
+  return static_cast<std::int64_t>(number >> 1) ^
+    -static_cast<std::int64_t>(number & 1);
+}
+
+// varintSize(number) - Returns the number of bytes of number as a varint.
+std::size_t CompactVector::varintSize(std::uint64_t number) {
+  std::size_t size = 1;
+  while (number >= 0x80) {
+    number >>= 7;
+    size++;
+  }
+  return size;
+}
+
+// putVarint(number, bytes) - Adds number to bytes 7 bits at a time, from the
+//  lowest up, with the top bit of each byte but the last set.
+void CompactVector::putVarint(std::uint64_t number,
+  std::vector<unsigned char> &bytes) {
+  while (number >= 0x80) {
+    bytes.push_back(static_cast<unsigned char>(number | 0x80));
+    number >>= 7;
+  }
+  bytes.push_back(static_cast<unsigned char>(number));
+}
+
+// getVarint(bytes) - Reads a varint and moves bytes past it.
+std::uint64_t CompactVector::getVarint(const unsigned char *&bytes) {
+  std::uint64_t number = 0;
+  unsigned shift = 0;
+  while (*bytes & 0x80) {
+    number |= static_cast<std::uint64_t>(*bytes++ & 0x7f) << shift;
+    shift += 7;
+  }
+  return number | static_cast<std::uint64_t>(*bytes++) << shift;
+}
+
+// field(bytes, index, bits) - Returns the number at index of a Packed block.
+//  Since no number is more than 54 bits wide, the 8 bytes from the one it
+//  starts in always hold all of it.
+std::uint64_t CompactVector::field(const unsigned char *bytes,
+  std::size_t index, unsigned bits) {
+  const std::size_t position = index * bits;
+  const unsigned char *start = bytes + position / 8;
+  std::uint64_t word = 0;
+  for (std::size_t i = 8; i-- > 0; ) {
+    word = word << 8 | start[i];
+  }
+  return word >> position % 8 & ((std::uint64_t { 1 } << bits) - 1);
+}
+
+// blockLength(block) - Every block but the last is full.
+std::size_t CompactVector::blockLength(std::size_t block) const {
+  return std::min(blockSize, data->count - block * blockSize);
+}
+
+// decode(block, numbers) - Writes every number of the block to numbers.
+void CompactVector::decode(std::size_t block, double *numbers) const {
+  const Block &header = data->blocks[block];
+  const std::size_t length = blockLength(block);
+  const unsigned char *bytes = data->bytes.data() + header.offset;
+  std::int64_t value = header.base;
+  switch (header.encoding) {
+    case Encoding::Packed:
+      for (std::size_t i = 0; i < length; i++) {
+        numbers[i] = static_cast<double>(header.base +
+          static_cast<std::int64_t>(field(bytes, i, header.bits)));
+      }
+      return;
+    case Encoding::Delta:
+      numbers[0] = static_cast<double>(value);
+      for (std::size_t i = 1; i < length; i++) {
+        value += unzigzag(getVarint(bytes));
+        numbers[i] = static_cast<double>(value);
+      }
+      return;
+    case Encoding::Runs:
+      for (std::size_t i = 0; i < length; ) {
+        const std::uint64_t run = getVarint(bytes);
+        value += unzigzag(getVarint(bytes));
+        std::fill_n(numbers + i, run, static_cast<double>(value));
+        i += run;
+      }
+      return;
+  }
+}
+
+// size() - Returns the number of numbers included.
+std::size_t CompactVector::size() const {
+  return count;
+}
+
+// at(index) - A number of a Packed block is read directly, and the blocks
+//  encoded otherwise are decoded up to it.
+double CompactVector::at(std::size_t index) const {
+  const std::size_t position = from + index;
+  const Block &header = data->blocks[position / blockSize];
+  const unsigned char *bytes = data->bytes.data() + header.offset;
+  std::size_t offset = position % blockSize;
+  std::int64_t value = header.base;
+  switch (header.encoding) {
+    case Encoding::Packed:
+      value += static_cast<std::int64_t>(field(bytes, offset, header.bits));
+      break;
+    case Encoding::Delta:
+      for (; offset > 0; offset--) {
+        value += unzigzag(getVarint(bytes));
+      }
+      break;
+    case Encoding::Runs:
+      while (true) {
+        const std::uint64_t run = getVarint(bytes);
+        value += unzigzag(getVarint(bytes));
+        if (offset < run) {
+          break;
+        }
+        offset -= run;
+      }
+      break;
+  }
+  return static_cast<double>(value);
+}
+
+// copyNumbers(start, count, numbers) - Whole blocks are decoded in place, and
+//  the blocks that are only partly copied are decoded on the side.
+void CompactVector::copyNumbers(std::size_t start, std::size_t count,
+  double *numbers) const {
+  std::size_t position = from + start;
+  const std::size_t end = position + count;
+  while (position < end) {
+    const std::size_t block = position / blockSize;
+    const std::size_t offset = position % blockSize;
+    const std::size_t length = blockLength(block);
+    const std::size_t taken = std::min(end - position, length - offset);
+    if (taken == length) {
+      decode(block, numbers);
+    }
+    else {
+      double decoded[blockSize];
+      decode(block, decoded);
+      std::copy_n(decoded + offset, taken, numbers);
+    }
+    numbers += taken;
+    position += taken;
+  }
+}
+
+// slice(from, to) - Shares the blocks.
+CompactVector CompactVector::slice(std::size_t from, std::size_t to) const {
+  return CompactVector { data, this->from + from, to - from };
+}
+
+// getBytes() - Counts the block index along with the encoded bytes.
+std::size_t CompactVector::getBytes() const {
+  return data->blocks.size() * sizeof(Block) + data->bytes.size();
+}
+
+// countBlocks(encoding) - Goes through the block index.
+std::size_t CompactVector::countBlocks(Encoding encoding) const {
+  return std::count_if(data->blocks.begin(), data->blocks.end(),
+    [encoding](const Block &block) {
+    return block.encoding == encoding;
+  });
+}
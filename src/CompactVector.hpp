@@ -0,0 +1,121 @@
+// File: src/CompactVector.hpp
+// Purpose: Header file for CompactVectors, which are immutable arrays of whole
+//  numbers stored in a few bits each. See src/CompactVector.cpp for
+//  implementations.
+
+#ifndef COMPACTVECTOR_HPP
+#define COMPACTVECTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// CompactVector - An immutable array of whole numbers, split into blocks of
+//  128 that are each encoded in whichever of three ways takes the fewest
+//  bytes (favoring Packed, whose numbers are read without decoding):
+//  - Packed: the distance of each number from the smallest one in the block,
+//    in as many bits as the largest distance needs (frame of reference bit
+//    packing). Counters and small numbers take a few bits each.
+//  - Delta: the difference of each number from the one before, as a varint
+//    (7 bits per byte). Sorted numbers such as IDs take a byte or two each.
+//  - Runs: the length of each run of equal numbers and its difference from
+//    the run before, as varints (run-length encoding).
+// The blocks are found through an index of where each one starts, so the
+//  number at any position is found by decoding at most one block, and a
+//  Packed block does not even need to be decoded. Slicing a CompactVector
+//  only changes which of its numbers it includes, and shares the blocks.
+class CompactVector {
+public:
+  // The number of numbers in each block (but the last).
+  static constexpr std::size_t blockSize = 128;
+
+  // The ways of encoding a block.
+  enum class Encoding : std::uint8_t { Packed, Delta, Runs };
+
+private:
+  // A Block is encoded in bytes from offset on, and its numbers are counted
+  //  from base: its smallest number for Packed blocks and its first number
+  //  otherwise. bits is the width of each number in a Packed block.
+  struct Block {
+    std::int64_t base;
+    std::uint32_t offset;
+    Encoding encoding;
+    std::uint8_t bits;
+  };
+
+  // The blocks, the bytes they are encoded in (followed by 8 zero bytes, so
+  //  that reading 8 bytes at once from any Packed number stays inside) and
+  //  the number of numbers in all of them.
+  struct Data {
+    std::vector<Block> blocks;
+    std::vector<unsigned char> bytes;
+    std::size_t count;
+  };
+
+public:
+  // Builder - Builds a CompactVector from numbers given a block at a time.
+  class Builder {
+  private:
+    std::shared_ptr<Data> data;
+
+  public:
+    // Constructor() - Creates a Builder with no numbers.
+    Builder();
+
+    // add(numbers, size) - Encodes the size numbers, which must be at most
+    //  blockSize, as the next block, and returns true. Returns false without
+    //  adding anything if some number is not whole or is too large to
+    //  always be exact. Only the last block added may have fewer than
+    //  blockSize numbers.
+    bool add(const double *numbers, std::size_t size);
+
+    // build() - Returns the CompactVector of every number added so far. The
+    //  Builder must not be used afterwards.
+    CompactVector build();
+  };
+
+private:
+  std::shared_ptr<const Data> data;
+  std::size_t from;
+  std::size_t count;
+
+  // Private methods are documented in src/CompactVector.cpp.
+  CompactVector(std::shared_ptr<const Data> data, std::size_t from,
+    std::size_t count);
+  static std::uint64_t zigzag(std::int64_t number);
+  static std::int64_t unzigzag(std::uint64_t number);
+  static std::size_t varintSize(std::uint64_t number);
+  static void putVarint(std::uint64_t number,
+    std::vector<unsigned char> &bytes);
+  static std::uint64_t getVarint(const unsigned char *&bytes);
+  static std::uint64_t field(const unsigned char *bytes, std::size_t index,
+    unsigned bits);
+  std::size_t blockLength(std::size_t block) const;
+  void decode(std::size_t block, double *numbers) const;
+
+public:
+  // size() - Returns the number of numbers.
+  std::size_t size() const;
+
+  // at(index) - Returns the number at index, which must be less than size().
+  double at(std::size_t index) const;
+
+  // copyNumbers(start, count, numbers) - Copies the count numbers from index
+  //  start on into numbers, decoding a block at a time.
+  void copyNumbers(std::size_t start, std::size_t count,
+    double *numbers) const;
+
+  // slice(from, to) - Returns the CompactVector of the numbers from index
+  //  from up to (but not including) index to, which must be at most size().
+  CompactVector slice(std::size_t from, std::size_t to) const;
+
+  // getBytes() - Returns the number of bytes that the blocks of this
+  //  CompactVector take, including those it does not include after slicing.
+  std::size_t getBytes() const;
+
+  // countBlocks(encoding) - Returns the number of blocks encoded that way.
+  std::size_t countBlocks(Encoding encoding) const;
+};
+
+#endif
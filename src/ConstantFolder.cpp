@@ -0,0 +1,227 @@
+// File: src/ConstantFolder.cpp
+// Purpose: Source file for ConstantFolders, which evaluate the constant parts
+//  of a TokenTree ahead of time. See src/ConstantFolder.hpp for more
+//  documentation.
+
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "ConstantFolder.hpp"
+#include "Context.hpp"
+#include "Evaluator.hpp"
+#include "NumberValue.hpp"
+#include "Region.hpp"
+#include "StringValue.hpp"
+#include "Token.hpp"
+#include "TokenTree.hpp"
+#include "Value.hpp"
+
+// Constructor(context, ast) - Creates a ConstantFolder for ast in context.
+//  Names that appear in arguments taken unevaluated (e.g. the parameters of
+//  `->` and the names defined with `=`) may refer to something else within
+//  ast than in context, so they are never looked up ahead of time.
+ConstantFolder::ConstantFolder(const Context::Pointer &context,
+  const TokenTree &ast): context { context } {
+  std::vector<std::pair<const TokenTree *, bool>> pending { { &ast, false } };
+  while (!pending.empty()) {
+    const auto [tree, quoted] = pending.back();
+    pending.pop_back();
+    if (const auto token = tree->getTokenPointer()) {
+      if (quoted && (token->getType() == Token::Type::Identifier ||
+          token->getType() == Token::Type::Operator)) {
+        boundNames.insert(token->getValue());
+      }
+    }
+    else if (const auto pair = tree->getFunctionPairPointer()) {
+      if (pair->first && pair->second) {
+        pending.push_back({ pair->first.get(), quoted });
+        pending.push_back({ pair->second.get(),
+          quoted || quotesArgument(*pair->first) });
+      }
+    }
+    else if (const auto lines = tree->getLineListPointer()) {
+      for (const auto &line : *lines) {
+        pending.push_back({ line.get(), quoted });
+      }
+    }
+  }
+}
+
+// lookUp(tree) - Returns the Value that tree refers to if it is a name that
+//  is already defined in the Context and not bound anywhere else, or nullptr
+//  otherwise.
+Value::Pointer ConstantFolder::lookUp(const TokenTree &tree) const {
+  const auto token = tree.getTokenPointer();
+  if (!token || (token->getType() != Token::Type::Identifier &&
+      token->getType() != Token::Type::Operator) ||
+      boundNames.count(token->getValue()) != 0) {
+    return nullptr;
+  }
+  const auto &valueOrErr = context->getValue(token->getValue());
+  if (std::holds_alternative<Error>(valueOrErr)) {
+    return nullptr;
+  }
+  return *std::get_if<Value::Pointer>(&valueOrErr);
+}
+
+// quotesArgument(f) - Returns a boolean indicating whether f is known to take
+//  its argument unevaluated.
+bool ConstantFolder::quotesArgument(const TokenTree &f) const {
+  const auto &value = lookUp(f);
+  return value && value->quotesArgument();
+}
+
+// foldToken(tree) - Decodes number and string literals and looks up the names
+//  of pure Values.
+TokenTree::TreePointer ConstantFolder::foldToken(
+  const TokenTree::TreePointer &tree
+) const {
+  const Token &token = *tree->getTokenPointer();
+  if (token.getType() == Token::Type::Number) {
+    const auto number = NumberValue::parseLiteral(token);
+    return number ? std::make_shared<TokenTree>(
+      Value::Pointer { new NumberValue { *number } }, tree
+    ) : tree;
+  }
+  if (token.getType() == Token::Type::String) {
+    return std::make_shared<TokenTree>(
+      Value::Pointer { new StringValue { token } }, tree
+    );
+  }
+  const auto &value = lookUp(*tree);
+  if (value && value->isPure()) {
+    return std::make_shared<TokenTree>(value, tree);
+  }
+  return tree;
+}
+
+// foldCall(tree, f, x) - Evaluates the call of f with x if f is a pure
+//  constant and x is a constant or implied. tree is the call before f and x
+//  were folded. If the call results in an error, it is left to be evaluated
+//  (and to fail) when the code runs. Returns the folded call, along with the
+//  call of f with x, which is different if the call was evaluated.
+//  f is given in the same form: if f is a call that was evaluated (as in
+//  (3 *) x), but this call cannot be, the call of f is used instead, since the
+//  Evaluator calls a function of two arguments more quickly with both of them
+//  at once than through a partial application.
+std::pair<TokenTree::TreePointer, TokenTree::TreePointer>
+ConstantFolder::foldCall(
+  const TokenTree::TreePointer &tree,
+  const std::pair<TokenTree::TreePointer, TokenTree::TreePointer> &f,
+  const TokenTree::TreePointer &x
+) const {
+  const auto function = f.first->getConstantPointer();
+  const bool constantArgument = x->getConstantPointer() || x->isImplied();
+  const TokenTree::TreePointer &callee = constantArgument ? f.first : f.second;
+  const auto pair = tree->getFunctionPairPointer();
+  const TokenTree::TreePointer call = callee == pair->first &&
+    x == pair->second ? tree : std::make_shared<TokenTree>(callee, x);
+  if (function && function->value->isPure() && constantArgument) {
+    const Value::OrError result = Evaluator { context, false, false }.visit(
+      *f.first, *x
+    );
+    if (std::holds_alternative<Value::Pointer>(result)) {
+      return { std::make_shared<TokenTree>(
+        *std::get_if<Value::Pointer>(&result), tree
+      ), call };
+    }
+  }
+  return { call, call };
+}
+
+// foldTree(tree) - Folds tree from its leaves up. Like the Evaluator, the
+//  ConstantFolder keeps the TokenTrees it has yet to finish on its own stack,
+//  so that it does not recurse on the C++ stack.
+TokenTree::TreePointer ConstantFolder::foldTree(
+  const TokenTree::TreePointer &tree
+) const {
+  struct Step {
+    TokenTree::TreePointer tree;
+    bool quoted;
+    bool expanded;
+  };
+  std::vector<Step> steps { { tree, false, false } };
+  // Each result is a folded TokenTree, along with the unevaluated call of its
+  //  folded parts if it is a call (see foldCall).
+  std::vector<std::pair<TokenTree::TreePointer, TokenTree::TreePointer>>
+    results;
+  while (!steps.empty()) {
+    Step step = steps.back();
+    steps.pop_back();
+    const auto binding = step.tree->getBindingPointer();
+    const auto pair = binding ? nullptr : step.tree->getFunctionPairPointer();
+    const auto lines = step.tree->getLineListPointer();
+    if (step.quoted || step.tree->getConstantPointer() ||
+        (pair && (!pair->first || !pair->second))) {
+      results.push_back({ step.tree, step.tree });
+    }
+    else if (step.tree->getTokenPointer()) {
+      const TokenTree::TreePointer folded = foldToken(step.tree);
+      results.push_back({ folded, folded });
+    }
+    else if (binding && !step.expanded) {
+      steps.push_back({ step.tree, false, true });
+      steps.push_back({ binding->body, false, false });
+      steps.push_back({ binding->value, false, false });
+    }
+    else if (binding) {
+      const TokenTree::TreePointer body = std::move(results.back().first);
+      results.pop_back();
+      const TokenTree::TreePointer value = std::move(results.back().first);
+      results.pop_back();
+      const TokenTree::TreePointer result = value == binding->value &&
+        body == binding->body ? step.tree :
+        std::make_shared<TokenTree>(binding->name, value, body,
+          binding->strict);
+      results.push_back({ result, result });
+    }
+    else if (pair && !step.expanded) {
+      // The results of f and then x are needed when the call is revisited.
+      steps.push_back({ step.tree, false, true });
+      steps.push_back({ pair->second, quotesArgument(*pair->first), false });
+      steps.push_back({ pair->first, false, false });
+    }
+    else if (pair) {
+      const TokenTree::TreePointer x = std::move(results.back().first);
+      results.pop_back();
+      const auto f = std::move(results.back());
+      results.pop_back();
+      results.push_back(foldCall(step.tree, f, x));
+    }
+    else if (lines && !step.expanded) {
+      steps.push_back({ step.tree, false, true });
+      for (std::size_t i = lines->size(); i-- > 0; ) {
+        steps.push_back({ (*lines)[i], false, false });
+      }
+    }
+    else if (lines) {
+      const std::size_t first = results.size() - lines->size();
+      TokenTree::LineList folded;
+      for (std::size_t i = first; i < results.size(); i++) {
+        folded.push_back(std::move(results[i].first));
+      }
+      results.resize(first);
+      const TokenTree::TreePointer result = folded == *lines ? step.tree :
+        std::make_shared<TokenTree>(folded);
+      results.push_back({ result, result });
+    }
+    else {
+      results.push_back({ step.tree, step.tree });
+    }
+  }
+  return results.back().first;
+}
+
+// fold(ast, context) - Folds a copy of ast, which shares the subtrees of ast
+//  that cannot be folded. The Values created ahead of time are kept by the
+//  resulting TokenTree, so they are never allocated in a Region.
+TokenTree ConstantFolder::fold(const TokenTree &ast,
+  const Context::Pointer &context) {
+  const Region::Scope scope { Region::Pointer {} };
+  const ConstantFolder folder { context, ast };
+  return *folder.foldTree(std::make_shared<TokenTree>(ast));
+}
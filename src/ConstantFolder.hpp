@@ -0,0 +1,48 @@
+// File: src/ConstantFolder.hpp
+// Purpose: Header file for ConstantFolders, which evaluate the parts of a
+//  TokenTree that do not depend on anything but constants ahead of time. See
+//  src/ConstantFolder.cpp for implementations.
+
+#ifndef CONSTANTFOLDER_HPP
+#define CONSTANTFOLDER_HPP
+
+#include <set>
+#include <string>
+#include <utility>
+#include "Context.hpp"
+#include "TokenTree.hpp"
+#include "Value.hpp"
+
+// ConstantFolder - Replaces parts of a TokenTree with Constants (see
+//  TokenTree::Constant), so that they are not evaluated again every time the
+//  code runs. Number literals are decoded once, names of pure builtin functions
+//  (see Value::isPure) are looked up once, and calls of pure functions whose
+//  arguments are constants are evaluated once. This includes partial
+//  applications like (+) 2 and sections like (* 2). Arguments that are taken
+//  unevaluated, such as the parameter of `->`, are left as they are, while the
+//  value and body of a Binding (see src/Inliner.hpp) are folded like any other
+//  code.
+class ConstantFolder {
+private:
+  Context::Pointer context;
+  std::set<std::string> boundNames;
+
+  // Private methods are documented in src/ConstantFolder.cpp.
+  ConstantFolder(const Context::Pointer &context, const TokenTree &ast);
+  Value::Pointer lookUp(const TokenTree &tree) const;
+  bool quotesArgument(const TokenTree &f) const;
+  TokenTree::TreePointer foldToken(const TokenTree::TreePointer &tree) const;
+  std::pair<TokenTree::TreePointer, TokenTree::TreePointer> foldCall(
+    const TokenTree::TreePointer &tree,
+    const std::pair<TokenTree::TreePointer, TokenTree::TreePointer> &f,
+    const TokenTree::TreePointer &x) const;
+  TokenTree::TreePointer foldTree(const TokenTree::TreePointer &tree) const;
+
+public:
+  // static fold(ast, context) - Returns a TokenTree that gives the same result
+  //  as ast when it is evaluated in context, but with as much of it as
+  //  possible already evaluated.
+  static TokenTree fold(const TokenTree &ast, const Context::Pointer &context);
+};
+
+#endif
@@ -5,18 +5,27 @@
 
 #include <iterator>
 #include <memory>
-#include <stdexcept>
+#include <set>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <variant>
 #include "Context.hpp"
+#include "Error.hpp"
 #include "IdentifierValue.hpp"
-#include "TypeError.hpp"
+#include "Region.hpp"
+#include "ThunkValue.hpp"
+#include "Token.hpp"
+#include "TokenTree.hpp"
 #include "Value.hpp"
 
 // Constructors
-Context::Context() {}
-Context::Context(Context::Pointer parent): parentContext(parent) {}
-Context::Context(Context::ValueMap initialValues): values { initialValues } {}
+Context::Context(): lastDefined { nullptr } {}
+Context::Context(Context::Pointer parent): parentContext(parent),
+  lastDefined { nullptr } {}
+Context::Context(Context::ValueMap initialValues): values { initialValues },
+  lastDefined { nullptr } {}
 
 // Methods
 
@@ -31,7 +40,7 @@ Value::OrError Context::getValue(const std::string &identifier) {
     if (parentContext) {
       return parentContext->getValue(identifier);
     }
-    return { TypeError { identifier + " is undefined" } };
+    return { Error { Error::Code::Undefined, { identifier } } };
   }
   // If the iterator is not at `end`, the value was found, so return that value.
   return { iterator->second };
@@ -40,32 +49,87 @@ Value::OrError Context::getValue(const std::string &identifier) {
 // define(identifier, value) defines value in the current context with a name of
 //  identifier. If the value already exists, it returns an error. Otherwise,
 //  it returns an empty optional.
-std::optional<std::runtime_error> Context::define(
+std::optional<Error> Context::define(
   const std::string &identifier, Value::Pointer value
 ) {
   auto iterator = values.find(identifier);
   if (iterator != values.end()) {
     // If the value is already defined, it cannot be redefined.
-    return { TypeError { identifier + " is already defined" } };
+    return { Error { Error::Code::AlreadyDefined, { identifier } } };
   }
   // If the value is not already defined, add it to the internal value map.
-  values.insert({
-    { identifier, value }
-  });
+  lastDefined = &values.emplace(identifier, value).first->first;
   return {};
 }
 
-std::optional<std::runtime_error> Context::define(
+std::optional<Error> Context::define(
   const std::shared_ptr<IdentifierValue> &identifier, Value::Pointer value
 ) {
   auto idString = identifier->getIdentifier(value);
   if (!idString) {
-    return { TypeError {
-      static_cast<std::string>(*identifier) + " is not a valid identifier"
+    return { Error {
+      Error::Code::InvalidIdentifier, { Error::Shown { identifier } }
     } };
   }
   return define(*idString, value);
 }
+// isLastDefined(identifier) returns whether identifier was defined last.
+bool Context::isLastDefined(const std::string &identifier) const {
+  return lastDefined && *lastDefined == identifier;
+}
+
+// redefineLast(value) replaces the value in place, so the key that lastDefined
+//  points to stays where it is.
+void Context::redefineLast(Value::Pointer value) {
+  values.find(*lastDefined)->second = std::move(value);
+}
+
+// seal() keeps the identifiers, which stay where they are in values.
+void Context::seal() {
+  for (const auto &[identifier, value] : values) {
+    sealed.insert(&identifier);
+  }
+  lastDefined = nullptr;
+}
+
+// capture(context, names) copies the values of names from context into a new,
+//  flat Context. Since Contexts only change the value of an identifier to give
+//  a function another clause, looking a captured identifier up in the new
+//  Context gives the same result as looking it up in context, except that a
+//  function keeps the clauses it had when it was captured. A permanent
+//  identifier is found in the same Context either way. An identifier that is
+//  not defined yet stands for the code of the identifier itself in context,
+//  which is what looking it up in context later would give.
+Context::Pointer Context::capture(const Context::Pointer &context,
+  const std::set<std::string> &names) {
+  ValueMap captured;
+  Context::Pointer parent;
+  for (const auto &name : names) {
+    const Context::Pointer *layer = &context;
+    ValueMap::const_iterator found;
+    while (*layer && (found = (*layer)->values.find(name)) ==
+        (*layer)->values.end()) {
+      layer = &(*layer)->parentContext;
+    }
+    if (!*layer) {
+      captured.emplace(name, ThunkValue::delay(
+        std::make_shared<const TokenTree>(
+          Token { name, Token::Type::Identifier }
+        ), context
+      ));
+    }
+    else if ((*layer)->sealed.count(&found->first) != 0) {
+      parent = *layer;
+    }
+    else {
+      captured.emplace(name, found->second);
+    }
+  }
+  const auto &result = Region::make<Context>(parent);
+  result->values = std::move(captured);
+  return { result };
+}
+
 // getParentContext() returns a pointer to the parent context - i.e. the context
 //  containing this one. This *can* return a *nil pointer* if there is no parent
 //  context!!
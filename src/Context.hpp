@@ -6,10 +6,12 @@
 #define CONTEXT_HPP
 
 #include <memory>
-#include <stdexcept>
+#include <set>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <variant>
+#include "Error.hpp"
 #include "IdentifierValue.hpp"
 #include "MaybeSharedPtr.hpp"
 #include "Value.hpp"
@@ -20,11 +22,19 @@ public:
   // Context::Pointer and Context::ValueMap can be used as type aliases for
   //  the internal ways contexts and value maps are stored in this class.
   typedef MaybeSharedPtr<Context> Pointer;
-  typedef std::unordered_map<std::string, const Value::Pointer> ValueMap;
+  typedef std::unordered_map<std::string, Value::Pointer> ValueMap;
 
 private:
   ValueMap values;
   Pointer parentContext;
+  // The identifier that was defined last, which is kept by values.
+  const std::string *lastDefined;
+  // The identifiers that were defined before seal was called, which are also
+  //  kept by values.
+  std::unordered_set<const std::string *> sealed;
+
+  // An Evacuation copies the Values of a Context (see src/Evacuation.hpp).
+  friend class Evacuation;
 
 public:
   // Constructors
@@ -41,6 +51,10 @@ public:
   //  according to the ValueMap but with no parent context.
   Context(ValueMap initialValues);
 
+  // A Context cannot be copied, since lastDefined points into its values.
+  Context(const Context &other) = delete;
+  Context &operator=(const Context &other) = delete;
+
   // Methods
 
   // getValue(identifier) - Returns a Value::Pointer if identifier is defined in
@@ -51,14 +65,40 @@ public:
   //  with a name of identifier if identifier is not already defined in *this*
   //  context. If identifier is already defined, it returns an error. Otherwise,
   //  it returns an empty optional.
-  std::optional<std::runtime_error> define(
+  std::optional<Error> define(
     const std::string &identifier, Value::Pointer value
   );
 
-  std::optional<std::runtime_error> define(
+  std::optional<Error> define(
     const std::shared_ptr<IdentifierValue> &identifier, Value::Pointer value
   );
 
+  // isLastDefined(identifier) - Returns whether identifier is the identifier
+  //  that was defined last in this Context.
+  bool isLastDefined(const std::string &identifier) const;
+
+  // redefineLast(value) - Replaces the value of the identifier that was
+  //  defined last in this Context, which must exist. Used to give a function
+  //  another clause (see DefaultContext::set), since the clauses of a
+  //  function must be defined one after another.
+  void redefineLast(Value::Pointer value);
+
+  // seal() - Makes the identifiers defined so far permanent: none of them can
+  //  be given another clause, so their values never change. Used for the
+  //  builtins of a DefaultContext.
+  void seal();
+
+  // static capture(context, names) - Returns a new Context that holds the
+  //  current value of each identifier in names, as found in context. An
+  //  identifier that is permanent where it is found (such as a builtin) is
+  //  not copied; the Context that holds it becomes the parent of the new
+  //  one instead. An identifier that is not defined yet (such as a function
+  //  defined after the one capturing it) is bound to a ThunkValue that looks
+  //  it up in context when it is first used, so only that ThunkValue keeps
+  //  the rest of context alive, and only until then.
+  static Pointer capture(const Pointer &context,
+    const std::set<std::string> &names);
+
   // getParentContext() - Returns a Context::Pointer to the parent Context (i.e.
   //  the Context containing this one). DANGER: This method *can* return a *null
   //  pointer* if there is no parent context!!
@@ -4,15 +4,42 @@
 //  for more documentation.
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <set>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <variant>
+#include <vector>
 #include "DefaultContext.hpp"
+#include "BooleanValue.hpp"
+#include "Bytes.hpp"
+#include "BytesValue.hpp"
 #include "Context.hpp"
+#include "Error.hpp"
+#include "FreeVariables.hpp"
 #include "FunctionValue.hpp"
 #include "IdentifierValue.hpp"
+#include "ListValue.hpp"
+#include "MapValue.hpp"
 #include "NumberValue.hpp"
-#include "TypeError.hpp"
+#include "Pattern.hpp"
+#include "PersistentMap.hpp"
+#include "PersistentVector.hpp"
+#include "RangeValue.hpp"
+#include "Region.hpp"
+#include "Rope.hpp"
+#include "SequenceValue.hpp"
+#include "SetValue.hpp"
+#include "StringValue.hpp"
+#include "TaggedValue.hpp"
+#include "ThunkValue.hpp"
+#include "TupleValue.hpp"
+#include "Type.hpp"
 #include "Value.hpp"
 
 // The default constructor creates a Context containing all the default values.
@@ -20,7 +47,7 @@ DefaultContext::DefaultContext():
   // This function is defined as `+` in DefaultContexts. It takes a Pointer to
   //  a NumberValue and returns a FunctionValue which takes another NumberValue
   //  and returns a pointer containing a number value which is the sum
-  //  of those two numbers.
+  //  of those two numbers. It and the other arithmetic functions are pure.
   add {
     createBiFunc<NumberValue, NumberValue, NumberValue>([](
     const std::shared_ptr<NumberValue> &x,
@@ -28,10 +55,25 @@ DefaultContext::DefaultContext():
     FunctionValue<NumberValue, NumberValue>::Return {
     return { FunctionValue<NumberValue, NumberValue>::Return {
       FunctionValue<NumberValue, NumberValue>::ReturnPointer {
-        new NumberValue { x->getRawNumber() + y->getRawNumber() }
+        Region::make<NumberValue>(NumberValue::add(*x, *y))
       }
     } };
-    })
+    }, { true, true }, true, NumericKernel::Op::Add)
+  },
+
+  // This function is defined as `-` in DefaultContexts. It returns the
+  //  difference of its two arguments.
+  subtract {
+    createBiFunc<NumberValue, NumberValue, NumberValue>([](
+      const std::shared_ptr<NumberValue> &x,
+      const std::shared_ptr<NumberValue> &y) ->
+      FunctionValue<NumberValue, NumberValue>::Return {
+    return { FunctionValue<NumberValue, NumberValue>::Return {
+      FunctionValue<NumberValue, NumberValue>::ReturnPointer {
+        Region::make<NumberValue>(NumberValue::subtract(*x, *y))
+      }
+    } };
+    }, { true, true }, true, NumericKernel::Op::Subtract)
   },
 
   // This function is defined as `*` in DefaultContexts. It returns the product
@@ -43,14 +85,14 @@ DefaultContext::DefaultContext():
       FunctionValue<NumberValue, NumberValue>::Return {
     return { FunctionValue<NumberValue, NumberValue>::Return {
       FunctionValue<NumberValue, NumberValue>::ReturnPointer {
-        new NumberValue { x->getRawNumber() * y->getRawNumber() }
+        Region::make<NumberValue>(NumberValue::multiply(*x, *y))
       }
     } };
-    })
+    }, { true, true }, true, NumericKernel::Op::Multiply)
   },
 
-  // This function is defined as `^` in DefaultContexts. It returns its first
-  //  argument raised to the power of its second argument.
+  // This function is defined as `^` and `**` in DefaultContexts. It returns
+  //  its first argument raised to the power of its second argument.
   pow {
     createBiFunc<NumberValue, NumberValue, NumberValue>([](
       const std::shared_ptr<NumberValue> &x,
@@ -58,30 +100,1358 @@ DefaultContext::DefaultContext():
       FunctionValue<NumberValue, NumberValue>::Return {
     return { FunctionValue<NumberValue, NumberValue>::Return {
       FunctionValue<NumberValue, NumberValue>::ReturnPointer {
-        new NumberValue { std::pow(x->getRawNumber(), y->getRawNumber()) }
+        Region::make<NumberValue>(NumberValue::power(*x, *y))
       }
     } };
-    })
+    }, { true, true }, true, NumericKernel::Op::Power)
+  },
+
+  // This function is defined as `%` in DefaultContexts. It returns the
+  //  remainder of dividing its first argument by its second argument (see
+  //  createDivision).
+  modulo {
+    createDivision(&NumberValue::remainder, NumericKernel::Op::Modulo)
+  },
+
+  // This function is defined as `/` in DefaultContexts. It returns the Float
+  //  quotient of its two arguments.
+  divide {
+    createBiFunc<NumberValue, NumberValue, NumberValue>([](
+      const std::shared_ptr<NumberValue> &x,
+      const std::shared_ptr<NumberValue> &y) ->
+      FunctionValue<NumberValue, NumberValue>::Return {
+    return { FunctionValue<NumberValue, NumberValue>::Return {
+      FunctionValue<NumberValue, NumberValue>::ReturnPointer {
+        Region::make<NumberValue>(NumberValue::divide(*x, *y))
+      }
+    } };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `//` in DefaultContexts. It returns the
+  //  quotient of its two arguments rounded toward 0, so that
+  //  (x // y) * y + x % y is x.
+  quotient { createDivision(&NumberValue::quotient) },
+
+  // These functions are defined as `gcd` and `lcm` in DefaultContexts. They
+  //  return the greatest common divisor and least common multiple of two
+  //  numbers, which are exact for Ints of any size.
+  gcd {
+    createBiFunc<NumberValue, NumberValue, NumberValue>([](
+      const std::shared_ptr<NumberValue> &x,
+      const std::shared_ptr<NumberValue> &y) ->
+      FunctionValue<NumberValue, NumberValue>::Return {
+    return { FunctionValue<NumberValue, NumberValue>::Return {
+      FunctionValue<NumberValue, NumberValue>::ReturnPointer {
+        Region::make<NumberValue>(NumberValue::gcd(*x, *y))
+      }
+    } };
+    }, { true, true }, true)
+  },
+  lcm {
+    createBiFunc<NumberValue, NumberValue, NumberValue>([](
+      const std::shared_ptr<NumberValue> &x,
+      const std::shared_ptr<NumberValue> &y) ->
+      FunctionValue<NumberValue, NumberValue>::Return {
+    return { FunctionValue<NumberValue, NumberValue>::Return {
+      FunctionValue<NumberValue, NumberValue>::ReturnPointer {
+        Region::make<NumberValue>(NumberValue::lcm(*x, *y))
+      }
+    } };
+    }, { true, true }, true)
+  },
+
+  // These functions are defined as `<`, `<=`, `>` and `>=` in DefaultContexts.
+  //  They compare two numbers (see createComparison).
+  lessThan {
+    createComparison([](double x, double y) { return x < y; },
+      NumericKernel::Op::Less)
+  },
+  lessOrEqual {
+    createComparison([](double x, double y) { return x <= y; },
+      NumericKernel::Op::LessOrEqual)
+  },
+  greaterThan {
+    createComparison([](double x, double y) { return x > y; },
+      NumericKernel::Op::Greater)
+  },
+  greaterOrEqual {
+    createComparison([](double x, double y) { return x >= y; },
+      NumericKernel::Op::GreaterOrEqual)
+  },
+
+  // These functions are defined as `==` and `!=` in DefaultContexts. They
+  //  compare any two Values structurally (see Value::equal), so lists, Strings,
+  //  maps and sets are equal if they hold equal elements, and an Int and a
+  //  Float are equal if they are the same number.
+  equal {
+    createBiFunc<Value, Value, BooleanValue>([](
+      const Value::Pointer &x,
+      const Value::Pointer &y) ->
+      FunctionValue<Value, BooleanValue>::Return {
+    return { BooleanValue::of(Value::equal(*x, *y)) };
+    }, { true, true }, true, NumericKernel::Op::Equal)
+  },
+  notEqual {
+    createBiFunc<Value, Value, BooleanValue>([](
+      const Value::Pointer &x,
+      const Value::Pointer &y) ->
+      FunctionValue<Value, BooleanValue>::Return {
+    return { BooleanValue::of(!Value::equal(*x, *y)) };
+    }, { true, true }, true, NumericKernel::Op::NotEqual)
   },
 
   // This function is defined as `=` in DefaultContexts. It sets its first
-  //  argument to be equal to its second argument.
+  //  argument to be equal to its second argument, which is only evaluated
+  //  once the name is used (see src/ThunkValue.hpp). Setting a function
+  //  written in Fleet that is already set adds the new function to it as
+  //  another clause, so that functions can be defined case by case:
+  //    count = 0 -> 0
+  //    count = n -> count (n - 1)
+  //  Setting a tuple of names, as in (x, rest) = splice 0 xs, or a
+  //  constructor of names, as in Some x = tryAt 3 xs, sets each of them to
+  //  the part of the value that it stands for (see destructure).
   set {
-    createBiFunc<IdentifierValue, Value, Value>([](
+    createBiFunc<IdentifierValue, ThunkValue, Value>([](
       const std::shared_ptr<IdentifierValue> &id,
-      const Value::Pointer &value,
+      const std::shared_ptr<ThunkValue> &value,
       const Context::Pointer &context) ->
       Value::OrError {
+    const auto &pattern = Pattern::fromTree(id->getTree());
+    if (pattern && (pattern->getKind() == Pattern::Kind::Tuple ||
+      (pattern->getKind() == Pattern::Kind::Constructor &&
+        !pattern->getBoundNames().empty()))) {
+      return destructure(id->getTree(), *pattern, value, context);
+    }
     auto err = context->define(id, value);
     if (err) {
-      return *err;
+      // Only a function defined just before can be given another clause, and
+      //  only by a function, so both sides are needed.
+      const auto &name = id->getIdentifier(value);
+      const auto &existingOrErr = name && context->isLastDefined(*name) ?
+        context->getValue(*name) : Value::OrError { *err };
+      if (std::holds_alternative<Error>(existingOrErr)) {
+        return *err;
+      }
+      const auto &forcedExisting = ThunkValue::forced(
+        *std::get_if<Value::Pointer>(&existingOrErr)
+      );
+      const auto &forcedClause = value->force();
+      if (std::holds_alternative<Error>(forcedExisting) ||
+        std::holds_alternative<Error>(forcedClause)) {
+        return *err;
+      }
+      const auto &existing = std::dynamic_pointer_cast<
+        FunctionValue<Value, Value>
+      >(*std::get_if<Value::Pointer>(&forcedExisting));
+      const auto &clause = std::dynamic_pointer_cast<
+        FunctionValue<Value, Value>
+      >(*std::get_if<Value::Pointer>(&forcedClause));
+      const auto &combined = existing && clause ?
+        existing->withClause(clause, *name) : nullptr;
+      if (!combined) {
+        return *err;
+      }
+      context->redefineLast(combined);
+      return { Value::Pointer { combined } };
+    }
+    return { Value::Pointer { value } };
+    }, { false, false })
+  },
+
+  // This function is defined as `->` in DefaultContexts. It creates a function
+  //  whose parameter is its first argument and whose body is its second
+  //  argument (see createFunction). Both arguments are taken unevaluated.
+  lambda {
+    createBiFunc<IdentifierValue, IdentifierValue, Value>([](
+      const std::shared_ptr<IdentifierValue> &param,
+      const std::shared_ptr<IdentifierValue> &body) ->
+      Value::OrError {
+    return createFunction(param, body, false);
+    }, { false, false })
+  },
+
+  // This function is defined as `|>` in DefaultContexts. It calls its second
+  //  argument with its first, so that x |> f |> g is g (f x).
+  pipe {
+    createBiFunc<Value, Value, Value>([](
+      const Value::Pointer &x,
+      const Value::Pointer &f) ->
+      Value::OrError {
+    return f->call(x);
+    }, { true, true }, true)
+  },
+
+  // These functions are defined as `..<` and `..<=` in DefaultContexts. They
+  //  return the range of numbers from their first argument up to (but not
+  //  including, for `..<`) their second argument (see src/RangeValue.hpp).
+  rangeBefore {
+    createBiFunc<NumberValue, NumberValue, RangeValue>([](
+      const std::shared_ptr<NumberValue> &start,
+      const std::shared_ptr<NumberValue> &bound) ->
+      FunctionValue<NumberValue, RangeValue>::Return {
+    return { RangeValue::before(start->getRawNumber(), bound->getRawNumber()) };
+    }, { true, true }, true)
+  },
+  rangeThrough {
+    createBiFunc<NumberValue, NumberValue, RangeValue>([](
+      const std::shared_ptr<NumberValue> &start,
+      const std::shared_ptr<NumberValue> &bound) ->
+      FunctionValue<NumberValue, RangeValue>::Return {
+    return { RangeValue::through(start->getRawNumber(), bound->getRawNumber()) };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `arithmetic` in DefaultContexts. It returns the
+  //  range of numbers from its first argument, its second argument apart,
+  //  which does not end, as in `arithmetic 2 1 |> take 10`.
+  arithmetic {
+    createBiFunc<NumberValue, NumberValue, RangeValue>([](
+      const std::shared_ptr<NumberValue> &start,
+      const std::shared_ptr<NumberValue> &step) ->
+      FunctionValue<NumberValue, RangeValue>::Return {
+    return {
+      RangeValue::arithmetic(start->getRawNumber(), step->getRawNumber())
+    };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `@` in DefaultContexts. xs @ i is the element
+  //  of xs at position i, counting from 0.
+  at {
+    createBiFunc<SequenceValue, NumberValue, Value>([](
+      const std::shared_ptr<SequenceValue> &sequence,
+      const std::shared_ptr<NumberValue> &index) ->
+      Value::OrError {
+    return sequence->at(index);
+    }, { true, true }, true)
+  },
+
+  // This value is defined as `[]` in DefaultContexts. It is the empty list,
+  //  which every list literal ends with: `[1, 2]` is `1 [:] 2 [:] []` (see
+  //  TokenTree::listOf).
+  emptyList { Value::Pointer { new ListValue { PersistentVector {} } } },
+
+  // This function is defined as `[:]` in DefaultContexts, which list literals
+  //  are made of. It always needs both arguments, and gives a list (see
+  //  prependTo).
+  prepend {
+    createBiFunc<Value, SequenceValue, SequenceValue>([](
+      const Value::Pointer &element,
+      const std::shared_ptr<SequenceValue> &sequence) ->
+      FunctionValue<SequenceValue, SequenceValue>::Return {
+    return prependTo(element, sequence);
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `:` in DefaultContexts. x : xs is x followed
+  //  by the elements of xs, which is taken lazily: unless it is already a
+  //  list or a String (which x is simply added to, see prependTo), xs is only
+  //  evaluated once an element after x is needed (see SequenceValue::cons).
+  //  Sequences can therefore be defined in terms of themselves, as in
+  //  fibonacci = x -> y -> (x + y) : fibonacci y (x + y).
+  cons {
+    createBiFunc<Value, ThunkValue, SequenceValue>([](
+      const Value::Pointer &element,
+      const std::shared_ptr<ThunkValue> &tail) ->
+      FunctionValue<ThunkValue, SequenceValue>::Return {
+    const auto sequence = std::dynamic_pointer_cast<SequenceValue>(
+      tail->getValue()
+    );
+    if (sequence && (dynamic_cast<const ListValue *>(sequence.get()) ||
+      dynamic_cast<const StringValue *>(sequence.get()))) {
+      return prependTo(element, sequence);
+    }
+    return { SequenceValue::cons(element, tail) };
+    }, { true, false }, true)
+  },
+
+  // This function is defined as `++` in DefaultContexts. xs ++ ys is the list
+  //  of the elements of xs followed by those of ys. It shares the nodes of
+  //  both lists (see src/PersistentVector.hpp), and of both Ropes if xs and
+  //  ys are Strings, which gives a String (see src/Rope.hpp).
+  concatenate {
+    createBiFunc<SequenceValue, SequenceValue, SequenceValue>([](
+      const std::shared_ptr<SequenceValue> &first,
+      const std::shared_ptr<SequenceValue> &second) ->
+      FunctionValue<SequenceValue, SequenceValue>::Return {
+    const auto firstText = std::dynamic_pointer_cast<StringValue>(first);
+    const auto secondText = std::dynamic_pointer_cast<StringValue>(second);
+    if (firstText && secondText) {
+      return { Region::make<StringValue>(
+        firstText->getText().concat(secondText->getText())
+      ) };
+    }
+    PersistentVector left;
+    PersistentVector right;
+    if (const auto error = elementsOf(first, left)) {
+      return { *error };
+    }
+    if (const auto error = elementsOf(second, right)) {
+      return { *error };
+    }
+    return { Region::make<ListValue>(left.concat(right)) };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `splice` in DefaultContexts. splice i xs is
+  //  the pair of the element of xs at position i and the list of the other
+  //  elements of xs, as in (x, rest) = splice i xs.
+  splice {
+    createBiFunc<NumberValue, SequenceValue, TupleValue>([](
+      const std::shared_ptr<NumberValue> &index,
+      const std::shared_ptr<SequenceValue> &sequence) ->
+      FunctionValue<SequenceValue, TupleValue>::Return {
+    PersistentVector elements;
+    if (const auto error = elementsOf(sequence, elements)) {
+      return { *error };
+    }
+    const Value::OrError element = ListValue { elements }.at(index);
+    if (const auto error = std::get_if<Error>(&element)) {
+      return { *error };
+    }
+    const auto position = static_cast<std::size_t>(index->getRawNumber());
+    const PersistentVector &rest = elements.slice(0, position).concat(
+      elements.slice(position + 1, elements.size()));
+    return { Region::make<TupleValue>(
+      *std::get_if<Value::Pointer>(&element),
+      Value::Pointer { Region::make<ListValue>(rest) }
+    ) };
+    }, { true, true }, true)
+  },
+
+  // These functions are defined as `(,)` and `(,+)` in DefaultContexts, which
+  //  tuple literals are made of (see TokenTree::tupleOf): (x, y) is the pair
+  //  of x and y, and (x, y, z) is that pair with z added.
+  pair {
+    createBiFunc<Value, Value, TupleValue>([](
+      const Value::Pointer &first,
+      const Value::Pointer &second) ->
+      FunctionValue<Value, TupleValue>::Return {
+    return { Region::make<TupleValue>(first, second) };
+    }, { true, true }, true)
+  },
+  extendTuple {
+    createBiFunc<TupleValue, Value, TupleValue>([](
+      const std::shared_ptr<TupleValue> &tuple,
+      const Value::Pointer &last) ->
+      FunctionValue<Value, TupleValue>::Return {
+    return { Region::make<TupleValue>(*tuple, last) };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `update` in DefaultContexts. update i x xs is
+  //  the list of the elements of xs with x at position i instead. Only the
+  //  nodes on the path to i are copied.
+  update {
+    createBiFunc<NumberValue, Value, Value>([this](
+      const std::shared_ptr<NumberValue> &index,
+      const Value::Pointer &value) ->
+      Value::OrError {
+    return { createFunc<SequenceValue, Value>([index, value](
+      const std::shared_ptr<SequenceValue> &sequence) ->
+      Value::OrError {
+    PersistentVector elements;
+    if (const auto error = elementsOf(sequence, elements)) {
+      return { *error };
+    }
+    const Value::OrError element = ListValue { elements }.at(index);
+    if (std::holds_alternative<Error>(element)) {
+      return element;
+    }
+    return { Value::Pointer { Region::make<ListValue>(elements.set(
+      static_cast<std::size_t>(index->getRawNumber()), value
+    )) } };
+    }, true) };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `toList` in DefaultContexts. It returns the
+  //  list of the elements of a sequence, which runs the pipeline that built
+  //  the sequence once, so that the elements can then be looked up directly.
+  //  The list is frozen, so long lists of whole numbers are stored compactly.
+  toList { createFunc<SequenceValue, Value>(&ListValue::freeze, true) },
+
+  // These functions are defined as `map`, `filter`, `while`, `concatMap`,
+  //  `take` and `drop` in DefaultContexts. Each takes a function (or a count)
+  //  and a sequence, and adds a stage to the sequence (see createStage and
+  //  src/SequenceValue.hpp), so they can be chained with `|>`:
+  //    1 ..< 10 |> filter (> 3) |> map (* 2) |> take 2
+  map { createStage(SequenceValue::Stage::Kind::Map) },
+  filter { createStage(SequenceValue::Stage::Kind::Filter) },
+  takeWhile { createStage(SequenceValue::Stage::Kind::While) },
+  concatMap { createStage(SequenceValue::Stage::Kind::ConcatMap) },
+  take { createCountedStage(SequenceValue::Stage::Kind::Take) },
+  drop { createCountedStage(SequenceValue::Stage::Kind::Drop) },
+
+  // This function is defined as `zip` in DefaultContexts. xs |> zip ys pairs
+  //  each element of xs with the element of ys at the same position, as a
+  //  sequence of the two.
+  zip {
+    createBiFunc<SequenceValue, SequenceValue, SequenceValue>([](
+      const std::shared_ptr<SequenceValue> &other,
+      const std::shared_ptr<SequenceValue> &sequence) ->
+      FunctionValue<SequenceValue, SequenceValue>::Return {
+    return { sequence->then({
+      SequenceValue::Stage::Kind::Zip, nullptr, 0, other
+    }) };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `reduceLeft` in DefaultContexts. It combines
+  //  the elements of a sequence with a function, from the left.
+  reduceLeft {
+    createBiFunc<Value, SequenceValue, Value>([](
+      const Value::Pointer &f,
+      const std::shared_ptr<SequenceValue> &sequence) ->
+      Value::OrError {
+    return sequence->reduceLeft(f);
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `scanLeft` in DefaultContexts. It is like
+  //  reduceLeft, but gives a sequence of every result along the way.
+  scanLeft { createStage(SequenceValue::Stage::Kind::Scan) },
+
+  // These functions are defined as `sum`, `product`, `min`, `max`, `length`,
+  //  `first` and `last` in DefaultContexts. They reduce a sequence to one
+  //  Value, which runs the whole pipeline that built it (see
+  //  createReduction).
+  sum { createReduction(&SequenceValue::sum) },
+  product { createReduction(&SequenceValue::product) },
+  minimum { createReduction(&SequenceValue::minimum) },
+  maximum { createReduction(&SequenceValue::maximum) },
+  length { createReduction(&SequenceValue::length) },
+  first { createReduction(&SequenceValue::first) },
+  last { createReduction(&SequenceValue::last) },
+
+  // This function is defined as `dot` in DefaultContexts. xs |> dot ys is the
+  //  sum of the products of the elements of xs and ys at the same position.
+  dot {
+    createBiFunc<SequenceValue, SequenceValue, Value>([](
+      const std::shared_ptr<SequenceValue> &other,
+      const std::shared_ptr<SequenceValue> &sequence) ->
+      Value::OrError {
+    return sequence->dot(other);
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `split` in DefaultContexts. s |> split sep is
+  //  the list of the pieces of the String s between occurrences of the String
+  //  sep, which share the text of s (see Rope::split).
+  split {
+    createBiFunc<StringValue, StringValue, Value>([](
+      const std::shared_ptr<StringValue> &separator,
+      const std::shared_ptr<StringValue> &text) ->
+      Value::OrError {
+    return { stringsOf(text->getText().split(separator->getText())) };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `splitWith` in DefaultContexts. s |> splitWith
+  //  f is the list of the pieces of the String s between the characters for
+  //  which f gives True. Splitting with isWhitespace scans the bytes of s
+  //  directly instead of calling it for every character.
+  splitWith {
+    createBiFunc<Value, StringValue, Value>([this](
+      const Value::Pointer &predicate,
+      const std::shared_ptr<StringValue> &text) ->
+      Value::OrError {
+    const Rope &rope = text->getText();
+    if (predicate == isWhitespace) {
+      return { stringsOf(rope.splitWhitespace()) };
+    }
+    std::vector<Rope> pieces;
+    std::size_t start = 0;
+    SequenceValue::Cursor cursor { *text };
+    for (std::size_t i = 0; ; i++) {
+      const Value::OrError next = cursor.next();
+      if (std::holds_alternative<Error>(next)) {
+        return next;
+      }
+      const Value::Pointer &character = *std::get_if<Value::Pointer>(&next);
+      if (!character) {
+        break;
+      }
+      const Value::OrError tested = predicate->call(character);
+      if (std::holds_alternative<Error>(tested)) {
+        return tested;
+      }
+      const Value::Pointer &result = *std::get_if<Value::Pointer>(&tested);
+      const auto boolean = dynamic_cast<const BooleanValue *>(result.get());
+      if (!boolean) {
+        return { Error { Error::Code::ReturnType, {
+          &BooleanValue::getClassName, Error::NameOf { result }
+        } } };
+      }
+      if (boolean->getRawBoolean()) {
+        pieces.push_back(rope.slice(start, i));
+        start = i + 1;
+      }
+    }
+    pieces.push_back(rope.slice(start, rope.length()));
+    return { stringsOf(pieces) };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `join` in DefaultContexts. xs |> join sep is
+  //  the String of the Strings in xs with sep between each two of them.
+  join {
+    createBiFunc<StringValue, SequenceValue, Value>([](
+      const std::shared_ptr<StringValue> &separator,
+      const std::shared_ptr<SequenceValue> &sequence) ->
+      Value::OrError {
+    const std::string between = separator->getText().toUtf8();
+    std::string text;
+    SequenceValue::Cursor cursor { *sequence };
+    for (bool started = false; ; started = true) {
+      const Value::OrError next = cursor.next();
+      if (std::holds_alternative<Error>(next)) {
+        return next;
+      }
+      const Value::Pointer &element = *std::get_if<Value::Pointer>(&next);
+      if (!element) {
+        break;
+      }
+      const auto piece = dynamic_cast<const StringValue *>(element.get());
+      if (!piece) {
+        return { Error { Error::Code::ArgumentType, {
+          &StringValue::getClassName, Error::NameOf { element }
+        } } };
+      }
+      if (started) {
+        text += between;
+      }
+      piece->getText().appendTo(text);
+    }
+    return { Value::Pointer {
+      Region::make<StringValue>(Rope::fromUtf8(std::move(text)))
+    } };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `find` in DefaultContexts. s |> find t is the
+  //  position of the first occurrence of the String t in the String s, or -1
+  //  if there is none.
+  find {
+    createBiFunc<StringValue, StringValue, Value>([](
+      const std::shared_ptr<StringValue> &needle,
+      const std::shared_ptr<StringValue> &text) ->
+      Value::OrError {
+    const std::optional<std::size_t> found =
+      text->getText().find(needle->getText());
+    return { Value::Pointer { Region::make<NumberValue>(
+      found ? static_cast<std::int64_t>(*found) : std::int64_t { -1 }
+    ) } };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `trim` in DefaultContexts. It returns a String
+  //  without the whitespace at its start and end.
+  trim {
+    createFunc<StringValue, Value>([](
+      const std::shared_ptr<StringValue> &text) ->
+      Value::OrError {
+    return { Value::Pointer {
+      Region::make<StringValue>(text->getText().trimmed())
+    } };
+    }, true)
+  },
+
+  // This function is defined as `isWhitespace` in DefaultContexts. It returns
+  //  whether a String has characters and all of them are whitespace, so it
+  //  can be given a character.
+  isWhitespace {
+    createFunc<StringValue, Value>([](
+      const std::shared_ptr<StringValue> &text) ->
+      Value::OrError {
+    return { BooleanValue::of(text->getText().length() != 0 &&
+      text->getText().trimmed().length() == 0) };
+    }, true)
+  },
+
+  // This function is defined as `toString` in DefaultContexts. It returns a
+  //  String as it is, and the String that shows any other Value.
+  toString {
+    createFunc<Value, Value>([](const Value::Pointer &value) ->
+      Value::OrError {
+    if (dynamic_cast<const StringValue *>(value.get())) {
+      return { value };
+    }
+    return { Value::Pointer { Region::make<StringValue>(
+      Rope::fromUtf8(static_cast<std::string>(*value))
+    ) } };
+    }, true)
+  },
+
+  // These values are defined as `Int` and `Float` in DefaultContexts. They are
+  //  the Types of the two kinds of numbers, which tryParseAs is given.
+  integerType { Value::Pointer { new Type { "Int", [](Value::Pointer value) {
+    const auto number = dynamic_cast<const NumberValue *>(value.get());
+    return number && number->isInteger();
+  } } } },
+  floatType { Value::Pointer { new Type { "Float", [](Value::Pointer value) {
+    const auto number = dynamic_cast<const NumberValue *>(value.get());
+    return number && !number->isInteger();
+  } } } },
+
+  // This function is defined as `tryParseAs` in DefaultContexts. tryParseAs
+  //  Int s and tryParseAs Float s give Some of the number written in the
+  //  String s, ignoring whitespace around it, or Nothing if there is none.
+  tryParseAs {
+    createBiFunc<Type, StringValue, Value>([](
+      const std::shared_ptr<Type> &type,
+      const std::shared_ptr<StringValue> &input) ->
+      Value::OrError {
+    const std::string typeName = static_cast<std::string>(*type);
+    const std::string text = input->getText().trimmed().toUtf8();
+    std::optional<NumberValue> parsed;
+    if (typeName == "Int") {
+      parsed = NumberValue::parseInteger(text);
+    }
+    else if (typeName == "Float") {
+      parsed = NumberValue::parseFloat(text);
+    }
+    if (!parsed) {
+      return { TaggedValue::nullary(TaggedValue::nothing) };
     }
-    return value;
+    return { Value::Pointer { Region::make<TaggedValue>(
+      TaggedValue::some, Region::make<NumberValue>(*parsed)
+    ) } };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `readBytes` in DefaultContexts. readBytes path
+  //  is the Bytes of the file at path, which is mapped into memory rather than
+  //  read (see src/Bytes.hpp). It is not pure, since the file can change.
+  readBytes {
+    createFunc<StringValue, Value>([](
+      const std::shared_ptr<StringValue> &path) ->
+      Value::OrError {
+    const std::optional<Bytes> bytes = Bytes::map(path->getText().toUtf8());
+    if (!bytes) {
+      return { Error { Error::Code::CannotOpen, { Error::Shown { path } } } };
+    }
+    return { Value::Pointer { Region::make<BytesValue>(*bytes) } };
     })
-  }
+  },
+
+  // This function is defined as `bytesOf` in DefaultContexts. It returns the
+  //  Bytes of a String in UTF-8.
+  bytesOf {
+    createFunc<StringValue, Value>([](
+      const std::shared_ptr<StringValue> &text) ->
+      Value::OrError {
+    return { Value::Pointer {
+      Region::make<BytesValue>(Bytes::of(text->getText().toUtf8()))
+    } };
+    }, true)
+  },
+
+  // This function is defined as `decodeUtf8` in DefaultContexts. It returns
+  //  the String of Bytes in UTF-8, in which invalid bytes are replaced by
+  //  U+FFFD.
+  decodeUtf8 {
+    createFunc<BytesValue, Value>([](
+      const std::shared_ptr<BytesValue> &bytes) ->
+      Value::OrError {
+    return { Value::Pointer { Region::make<StringValue>(
+      Rope::fromUtf8(bytes->getBytes().toString())
+    ) } };
+    }, true)
+  },
+
+  // These functions are defined as `decodeInts` and `decodeFloats` in
+  //  DefaultContexts. decodeInts 4 b is the list of the signed 4-byte Ints
+  //  stored little-endian in the Bytes b (see createDecoding).
+  decodeInts { createDecoding(false) },
+  decodeFloats { createDecoding(true) },
+
+  // These values are defined as `emptyMap` and `emptySet` in DefaultContexts.
+  //  Maps and sets are immutable hash tries (see src/PersistentMap.hpp), so
+  //  inserting into one returns a new one that shares most of the old one.
+  emptyMap { Value::Pointer { new MapValue { PersistentMap {} } } },
+  emptySet { Value::Pointer { new SetValue { PersistentMap {} } } },
+
+  // This function is defined as `mapOf` in DefaultContexts. mapOf xs is the
+  //  map of the pairs in xs, each a tuple or a sequence of a key and its
+  //  Value, as in mapOf [("a", 1), ("b", 2)] or mapOf (ks |> zip vs). A key
+  //  given twice keeps its last Value.
+  mapOf {
+    createFunc<SequenceValue, Value>([](
+      const std::shared_ptr<SequenceValue> &sequence) ->
+      Value::OrError {
+    const auto second = std::make_shared<NumberValue>(std::int64_t { 1 });
+    PersistentMap::Builder entries;
+    SequenceValue::Cursor cursor { *sequence };
+    while (true) {
+      const Value::OrError next = cursor.next();
+      if (std::holds_alternative<Error>(next)) {
+        return next;
+      }
+      const Value::Pointer &element = *std::get_if<Value::Pointer>(&next);
+      if (!element) {
+        break;
+      }
+      auto tuple = std::dynamic_pointer_cast<TupleValue>(element);
+      const auto pair = std::dynamic_pointer_cast<SequenceValue>(element);
+      if (tuple && tuple->size() != 2) {
+        tuple = nullptr;
+      }
+      if (!tuple && !pair) {
+        return { Error { Error::Code::ArgumentType, {
+          &SequenceValue::getClassName, Error::NameOf { element }
+        } } };
+      }
+      const Value::OrError key = tuple ? Value::OrError { tuple->at(0) } :
+        pair->first();
+      if (std::holds_alternative<Error>(key)) {
+        return key;
+      }
+      const Value::OrError value = tuple ? Value::OrError { tuple->at(1) } :
+        pair->at(second);
+      if (std::holds_alternative<Error>(value)) {
+        return value;
+      }
+      const Value::Pointer &keyValue = *std::get_if<Value::Pointer>(&key);
+      if (const auto error = checkKey(keyValue)) {
+        return { *error };
+      }
+      entries.insert(keyValue, *std::get_if<Value::Pointer>(&value));
+    }
+    return { Value::Pointer { Region::make<MapValue>(entries.build()) } };
+    }, true)
+  },
+
+  // This function is defined as `setOf` in DefaultContexts. setOf xs is the
+  //  set of the elements of xs.
+  setOf {
+    createFunc<SequenceValue, Value>([](
+      const std::shared_ptr<SequenceValue> &sequence) ->
+      Value::OrError {
+    PersistentMap::Builder elements;
+    SequenceValue::Cursor cursor { *sequence };
+    while (true) {
+      const Value::OrError next = cursor.next();
+      if (std::holds_alternative<Error>(next)) {
+        return next;
+      }
+      const Value::Pointer &element = *std::get_if<Value::Pointer>(&next);
+      if (!element) {
+        break;
+      }
+      if (const auto error = checkKey(element)) {
+        return { *error };
+      }
+      elements.insert(element, nullptr);
+    }
+    return { Value::Pointer { Region::make<SetValue>(elements.build()) } };
+    }, true)
+  },
+
+  // This function is defined as `insert` in DefaultContexts. m |> insert k v
+  //  is the map m with the Value of the key k set to v.
+  insert {
+    createBiFunc<Value, Value, Value>([this](
+      const Value::Pointer &key,
+      const Value::Pointer &value) ->
+      Value::OrError {
+    if (const auto error = checkKey(key)) {
+      return { *error };
+    }
+    return { createFunc<MapValue, Value>([key, value](
+      const std::shared_ptr<MapValue> &map) ->
+      Value::OrError {
+    return { Value::Pointer {
+      Region::make<MapValue>(map->getEntries().insert(key, value))
+    } };
+    }, true) };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `include` in DefaultContexts. s |> include x
+  //  is the set s with x in it.
+  include {
+    createBiFunc<Value, SetValue, Value>([](
+      const Value::Pointer &element,
+      const std::shared_ptr<SetValue> &set) ->
+      Value::OrError {
+    if (const auto error = checkKey(element)) {
+      return { *error };
+    }
+    return { Value::Pointer {
+      Region::make<SetValue>(set->getElements().insert(element, nullptr))
+    } };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `remove` in DefaultContexts. m |> remove k is
+  //  the map or set m without the key k, which it need not have.
+  remove {
+    createBiFunc<Value, Value, Value>([](
+      const Value::Pointer &key,
+      const Value::Pointer &collection) ->
+      Value::OrError {
+    const PersistentMap *entries = entriesOf(*collection);
+    if (!entries) {
+      return { collectionError(collection) };
+    }
+    if (const auto error = checkKey(key)) {
+      return { *error };
+    }
+    return { withEntries(*collection, entries->erase(*key)) };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `lookup` in DefaultContexts. m |> lookup k is
+  //  the Value of the key k in the map m, and an error if m does not have k.
+  lookup {
+    createBiFunc<Value, MapValue, Value>([](
+      const Value::Pointer &key,
+      const std::shared_ptr<MapValue> &map) ->
+      Value::OrError {
+    if (const auto error = checkKey(key)) {
+      return { *error };
+    }
+    const PersistentMap::Entry *entry = map->getEntries().find(*key);
+    if (!entry) {
+      return { Error { Error::Code::KeyNotFound, { Error::Shown { key } } } };
+    }
+    return { entry->value };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `contains` in DefaultContexts. m |> contains k
+  //  is whether the map or set m has the key k.
+  contains {
+    createBiFunc<Value, Value, Value>([](
+      const Value::Pointer &key,
+      const Value::Pointer &collection) ->
+      Value::OrError {
+    const PersistentMap *entries = entriesOf(*collection);
+    if (!entries) {
+      return { collectionError(collection) };
+    }
+    if (const auto error = checkKey(key)) {
+      return { *error };
+    }
+    return { BooleanValue::of(entries->find(*key) != nullptr) };
+    }, { true, true }, true)
+  },
+
+  // This function is defined as `size` in DefaultContexts. It returns the
+  //  number of keys of a map or set.
+  size {
+    createFunc<Value, Value>([](
+      const Value::Pointer &collection) ->
+      Value::OrError {
+    const PersistentMap *entries = entriesOf(*collection);
+    if (!entries) {
+      return { collectionError(collection) };
+    }
+    return { Value::Pointer { Region::make<NumberValue>(
+      static_cast<std::int64_t>(entries->size())
+    ) } };
+    }, true)
+  },
+
+  // These functions are defined as `keys` and `values` in DefaultContexts.
+  //  They return the list of the keys of a map or set, and the list of the
+  //  Values of a map, in the same order, which is that of their hashes.
+  keys {
+    createFunc<Value, Value>([](
+      const Value::Pointer &collection) ->
+      Value::OrError {
+    const PersistentMap *entries = entriesOf(*collection);
+    if (!entries) {
+      return { collectionError(collection) };
+    }
+    PersistentVector::Builder elements;
+    entries->forEach([&elements](const PersistentMap::Entry &entry) {
+      elements.push(entry.key);
+    });
+    return { Value::Pointer { Region::make<ListValue>(elements.build()) } };
+    }, true)
+  },
+  values {
+    createFunc<MapValue, Value>([](
+      const std::shared_ptr<MapValue> &map) ->
+      Value::OrError {
+    PersistentVector::Builder elements;
+    map->getEntries().forEach([&elements](const PersistentMap::Entry &entry) {
+      elements.push(entry.value);
+    });
+    return { Value::Pointer { Region::make<ListValue>(elements.build()) } };
+    }, true)
+  },
+
+  // These functions are defined as `union` and `intersection` in
+  //  DefaultContexts. They take two maps or two sets, and keep the Values of
+  //  the second for keys in both, so that m |> union n has the Values of m.
+  //  Parts of the tries that the two share are not looked into.
+  unite { createSetOperation(&PersistentMap::unite) },
+  intersect { createSetOperation(&PersistentMap::intersect) },
+
+  // These values are defined as `Nothing`, `Some`, `Left` and `Right` in
+  //  DefaultContexts, the constructors of `Maybe` and `Either`. Nothing is a
+  //  single shared TaggedValue, and the others wrap their argument without
+  //  copying it (see src/TaggedValue.hpp).
+  nothing { TaggedValue::nullary(TaggedValue::nothing) },
+  some { createConstructor(TaggedValue::some) },
+  left { createConstructor(TaggedValue::left) },
+  right { createConstructor(TaggedValue::right) },
+
+  // These functions are defined as `constructor` and `singleton` in
+  //  DefaultContexts. They create the constructors of types written in
+  //  Fleet: Circle = constructor "Circle" makes Circle r a TaggedValue of r,
+  //  and Empty = singleton "Empty" is the shared TaggedValue of a nullary
+  //  constructor. Constructors of the same name are the same constructor.
+  //  Their names must start with a capital letter, which is how Patterns
+  //  tell them apart from names to bind (see Pattern::isConstructorName).
+  constructor {
+    createFunc<StringValue, Value>([this](
+      const std::shared_ptr<StringValue> &name) ->
+      Value::OrError {
+    const std::string text = name->getText().toUtf8();
+    if (!Pattern::isConstructorName(text)) {
+      return { Error {
+        Error::Code::InvalidIdentifier, { Error::Shown { name } }
+      } };
+    }
+    return { createConstructor(TaggedValue::tagOf(text)) };
+    }, true)
+  },
+  singleton {
+    createFunc<StringValue, Value>([](
+      const std::shared_ptr<StringValue> &name) ->
+      Value::OrError {
+    const std::string text = name->getText().toUtf8();
+    if (!Pattern::isConstructorName(text)) {
+      return { Error {
+        Error::Code::InvalidIdentifier, { Error::Shown { name } }
+      } };
+    }
+    return { TaggedValue::nullary(TaggedValue::tagOf(text)) };
+    }, true)
+  },
+
+  // This function is defined as `tryAt` in DefaultContexts. tryAt i xs is
+  //  Some (xs @ i), or Nothing if xs has no element at position i.
+  tryAt {
+    createBiFunc<NumberValue, SequenceValue, Value>([](
+      const std::shared_ptr<NumberValue> &index,
+      const std::shared_ptr<SequenceValue> &sequence) ->
+      Value::OrError {
+    return optionalOf(sequence->at(index), Error::Code::IndexOutOfRange);
+    }, { true, true }, true)
+  },
+
+  // These functions are defined as `tryFirst` and `tryLast` in
+  //  DefaultContexts. They are first and last, but give Some of the element,
+  //  or Nothing if the sequence is empty (see createOptionalReduction).
+  tryFirst { createOptionalReduction(&SequenceValue::first) },
+  tryLast { createOptionalReduction(&SequenceValue::last) }
 {
   define("+", DefaultContext::add);
+  define("-", DefaultContext::subtract);
   define("*", DefaultContext::multiply);
   define("^", DefaultContext::pow);
+  define("**", DefaultContext::pow);
+  define("%", DefaultContext::modulo);
+  define("/", DefaultContext::divide);
+  define("//", DefaultContext::quotient);
+  define("gcd", DefaultContext::gcd);
+  define("lcm", DefaultContext::lcm);
+  define("<", DefaultContext::lessThan);
+  define("<=", DefaultContext::lessOrEqual);
+  define(">", DefaultContext::greaterThan);
+  define(">=", DefaultContext::greaterOrEqual);
+  define("==", DefaultContext::equal);
+  define("!=", DefaultContext::notEqual);
   define("=", DefaultContext::set);
+  define("->", DefaultContext::lambda);
+  define("|>", DefaultContext::pipe);
+  define("..<", DefaultContext::rangeBefore);
+  define("..<=", DefaultContext::rangeThrough);
+  define("arithmetic", DefaultContext::arithmetic);
+  define("@", DefaultContext::at);
+  define("[]", DefaultContext::emptyList);
+  define("[:]", DefaultContext::prepend);
+  define(":", DefaultContext::cons);
+  define("++", DefaultContext::concatenate);
+  define("splice", DefaultContext::splice);
+  define("(,)", DefaultContext::pair);
+  define("(,+)", DefaultContext::extendTuple);
+  define("update", DefaultContext::update);
+  define("toList", DefaultContext::toList);
+  define("map", DefaultContext::map);
+  define("filter", DefaultContext::filter);
+  define("while", DefaultContext::takeWhile);
+  define("concatMap", DefaultContext::concatMap);
+  define("take", DefaultContext::take);
+  define("drop", DefaultContext::drop);
+  define("zip", DefaultContext::zip);
+  define("reduceLeft", DefaultContext::reduceLeft);
+  define("scanLeft", DefaultContext::scanLeft);
+  define("sum", DefaultContext::sum);
+  define("product", DefaultContext::product);
+  define("min", DefaultContext::minimum);
+  define("max", DefaultContext::maximum);
+  define("length", DefaultContext::length);
+  define("first", DefaultContext::first);
+  define("last", DefaultContext::last);
+  define("dot", DefaultContext::dot);
+  define("split", DefaultContext::split);
+  define("splitWith", DefaultContext::splitWith);
+  define("join", DefaultContext::join);
+  define("find", DefaultContext::find);
+  define("trim", DefaultContext::trim);
+  define("isWhitespace", DefaultContext::isWhitespace);
+  define("toString", DefaultContext::toString);
+  define("Int", DefaultContext::integerType);
+  define("Float", DefaultContext::floatType);
+  define("tryParseAs", DefaultContext::tryParseAs);
+  define("readBytes", DefaultContext::readBytes);
+  define("bytesOf", DefaultContext::bytesOf);
+  define("decodeUtf8", DefaultContext::decodeUtf8);
+  define("decodeInts", DefaultContext::decodeInts);
+  define("decodeFloats", DefaultContext::decodeFloats);
+  define("emptyMap", DefaultContext::emptyMap);
+  define("emptySet", DefaultContext::emptySet);
+  define("mapOf", DefaultContext::mapOf);
+  define("setOf", DefaultContext::setOf);
+  define("insert", DefaultContext::insert);
+  define("include", DefaultContext::include);
+  define("remove", DefaultContext::remove);
+  define("lookup", DefaultContext::lookup);
+  define("contains", DefaultContext::contains);
+  define("size", DefaultContext::size);
+  define("keys", DefaultContext::keys);
+  define("values", DefaultContext::values);
+  define("union", DefaultContext::unite);
+  define("intersection", DefaultContext::intersect);
+  define("Nothing", DefaultContext::nothing);
+  define("Some", DefaultContext::some);
+  define("Left", DefaultContext::left);
+  define("Right", DefaultContext::right);
+  define("constructor", DefaultContext::constructor);
+  define("singleton", DefaultContext::singleton);
+  define("tryAt", DefaultContext::tryAt);
+  define("tryFirst", DefaultContext::tryFirst);
+  define("tryLast", DefaultContext::tryLast);
+  define("True", BooleanValue::of(true));
+  define("False", BooleanValue::of(false));
+  seal();
+}
+
+// This function creates a function written in Fleet. The function is a
+//  closure: it only keeps the values of the variables that its body uses,
+//  rather than the whole Context it was created in.
+Value::OrError DefaultContext::createFunction(
+  const std::shared_ptr<IdentifierValue> &param,
+  const std::shared_ptr<IdentifierValue> &body, bool strict) {
+  const auto &pattern = Pattern::fromTree(param->getTree());
+  if (!pattern) {
+    return { Error {
+      Error::Code::InvalidParameter, { Error::Shown { param } }
+    } };
+  }
+  std::set<std::string> freeVariables = FreeVariables::of(body->getTree());
+  for (const auto &name : pattern->getBoundNames()) {
+    freeVariables.erase(name);
+  }
+  return { Value::Pointer { Region::make<FunctionValue<Value, Value>>(
+    body->getTree(), Context::capture(body->getContext(), freeVariables),
+    *pattern, strict
+  ) } };
+}
+
+// This method defines each name that pattern (the Tuple or Constructor
+//  Pattern of tree) binds as the part of value that it stands for. Like any
+//  name set with `=`, each name is only evaluated when it is used: it stands
+//  for the code `(pattern -> name) value`, with value bound in a layer of its
+//  own to a name that Fleet code cannot write, so that value itself is still
+//  evaluated at most once.
+Value::OrError DefaultContext::destructure(const TokenTree &tree,
+  const Pattern &pattern, const std::shared_ptr<ThunkValue> &value,
+  const Context::Pointer &context) {
+  const Token source { " destructured", Token::Type::Identifier };
+  Context::Pointer layer { Region::make<Context>(context) };
+  layer->define(source.getValue(), value);
+  const TokenTree::TreePointer lambda { new TokenTree {
+    TokenTree::TreePointer { new TokenTree { Token {
+      "->", Token::Type::Operator
+    } } },
+    TokenTree::TreePointer { new TokenTree { tree } }
+  } };
+  const TokenTree::TreePointer sourceTree { new TokenTree { source } };
+  for (const auto &name : pattern.getBoundNames()) {
+    const TokenTree::TreePointer function { new TokenTree {
+      lambda,
+      TokenTree::TreePointer { new TokenTree { Token {
+        name, Token::Type::Identifier
+      } } }
+    } };
+    const std::shared_ptr<const TokenTree> element { new TokenTree {
+      function, sourceTree
+    } };
+    if (const auto error = context->define(name,
+      ThunkValue::delay(element, layer))) {
+      return { *error };
+    }
+  }
+  return { Value::Pointer { value } };
+}
+
+// This method sets elements to the elements of sequence, which is only
+//  produced if it is not already a list (see ListValue::from). Returns the
+//  error that producing the elements resulted in, if any.
+std::optional<Error> DefaultContext::elementsOf(
+  const std::shared_ptr<SequenceValue> &sequence, PersistentVector &elements) {
+  const Value::OrError list = ListValue::from(sequence);
+  if (const auto error = std::get_if<Error>(&list)) {
+    return { *error };
+  }
+  elements = static_cast<const ListValue &>(
+    **std::get_if<Value::Pointer>(&list)
+  ).getElements();
+  return {};
+}
+
+// This method returns the list of element followed by the elements of
+//  sequence, or a String if element is a character and sequence is a String.
+//  The nodes of a list, and the text of a String, are shared.
+FunctionValue<SequenceValue, SequenceValue>::Return DefaultContext::prependTo(
+  const Value::Pointer &element,
+  const std::shared_ptr<SequenceValue> &sequence) {
+  const auto character = dynamic_cast<const StringValue *>(element.get());
+  const auto text = std::dynamic_pointer_cast<StringValue>(sequence);
+  if (character && character->getText().length() == 1 && text) {
+    return { Region::make<StringValue>(
+      character->getText().concat(text->getText())
+    ) };
+  }
+  PersistentVector elements;
+  if (const auto error = elementsOf(sequence, elements)) {
+    return { *error };
+  }
+  return { Region::make<ListValue>(
+    PersistentVector::of({ element }).concat(elements)
+  ) };
+}
+
+// This method creates a pure function taking two numbers and returning whether
+//  compare holds for them. op is the same comparison (see
+//  src/NumericKernel.hpp). Two Ints are compared exactly, by comparing the
+//  result of NumberValue::compareIntegers with 0.
+Value::Pointer DefaultContext::createComparison(
+  bool (*compare)(double, double), NumericKernel::Op op) {
+  return createBiFunc<NumberValue, NumberValue, BooleanValue>([compare](
+    const std::shared_ptr<NumberValue> &x,
+    const std::shared_ptr<NumberValue> &y) ->
+    FunctionValue<NumberValue, BooleanValue>::Return {
+  if (x->isInteger() && y->isInteger()) {
+    return { BooleanValue::of(compare(
+      NumberValue::compareIntegers(*x, *y), 0
+    )) };
+  }
+  return { BooleanValue::of(compare(x->getRawNumber(), y->getRawNumber())) };
+  }, { true, true }, true, op);
+}
+
+// This method creates a pure function taking two numbers and returning the
+//  result of divide for them, which fails if it gives nothing (for an Int
+//  divided by 0). op is the same operator, if any (see src/NumericKernel.hpp).
+Value::Pointer DefaultContext::createDivision(
+  std::optional<NumberValue> (*divide)(const NumberValue &,
+    const NumberValue &), std::optional<NumericKernel::Op> op) {
+  return createBiFunc<NumberValue, NumberValue, NumberValue>([divide](
+    const std::shared_ptr<NumberValue> &x,
+    const std::shared_ptr<NumberValue> &y) ->
+    FunctionValue<NumberValue, NumberValue>::Return {
+  const std::optional<NumberValue> result = divide(*x, *y);
+  if (!result) {
+    return { Error { Error::Code::DivisionByZero } };
+  }
+  return { Region::make<NumberValue>(*result) };
+  }, { true, true }, true, op);
+}
+
+// This method creates a pure function taking a function and a sequence and
+//  returning the sequence with a stage of the given kind that calls the
+//  function.
+Value::Pointer DefaultContext::createStage(SequenceValue::Stage::Kind kind) {
+  return createBiFunc<Value, SequenceValue, SequenceValue>([kind](
+    const Value::Pointer &f,
+    const std::shared_ptr<SequenceValue> &sequence) ->
+    FunctionValue<SequenceValue, SequenceValue>::Return {
+  return { sequence->then({ kind, f, 0, nullptr }) };
+  }, { true, true }, true);
+}
+
+// This method creates a pure function taking a count and a sequence and
+//  returning the sequence with a stage of the given kind for that many
+//  elements. Counts are rounded down, and negative counts are 0.
+Value::Pointer DefaultContext::createCountedStage(
+  SequenceValue::Stage::Kind kind) {
+  return createBiFunc<NumberValue, SequenceValue, SequenceValue>([kind](
+    const std::shared_ptr<NumberValue> &count,
+    const std::shared_ptr<SequenceValue> &sequence) ->
+    FunctionValue<SequenceValue, SequenceValue>::Return {
+  const double number = std::floor(count->getRawNumber());
+  return { sequence->then({
+    kind, nullptr, number > 0 ? static_cast<std::size_t>(number) : 0, nullptr
+  }) };
+  }, { true, true }, true);
+}
+
+// This method returns the list of the Strings of pieces.
+Value::Pointer DefaultContext::stringsOf(const std::vector<Rope> &pieces) {
+  PersistentVector::Builder elements;
+  for (const Rope &piece : pieces) {
+    elements.push(Value::Pointer { Region::make<StringValue>(piece) });
+  }
+  return Value::Pointer { Region::make<ListValue>(elements.build()) };
+}
+
+// This method creates a pure function taking a width and Bytes and returning
+//  the list of the numbers of that many bytes each stored little-endian in
+//  them: Ints of 1, 2, 4 or 8 bytes, or Floats of 4 or 8 bytes if floats is
+//  true. Bytes left over after the last whole number are ignored.
+Value::Pointer DefaultContext::createDecoding(bool floats) {
+  return createBiFunc<NumberValue, BytesValue, Value>([floats](
+    const std::shared_ptr<NumberValue> &width,
+    const std::shared_ptr<BytesValue> &sequence) ->
+    Value::OrError {
+  const double size = width->getRawNumber();
+  if (!(size == 4 || size == 8 || (!floats && (size == 1 || size == 2)))) {
+    return { Error { Error::Code::InvalidWidth, {
+      Error::Shown { width }, floats ? "Float" : "Int"
+    } } };
+  }
+  const Bytes &bytes = sequence->getBytes();
+  const auto step = static_cast<std::size_t>(size);
+  PersistentVector::Builder elements;
+  for (std::size_t offset = 0; offset + step <= bytes.size(); offset += step) {
+    if (floats) {
+      elements.push(bytes.floatAt(offset, step));
+    }
+    else {
+      elements.push(Value::Pointer { Region::make<NumberValue>(
+        bytes.integerAt(offset, step)
+      ) });
+    }
+  }
+  return { Value::Pointer { Region::make<ListValue>(elements.build()) } };
+  }, { true, true }, true);
+}
+
+// This method returns the error of a key that cannot be in a map or set, if
+//  key is one: a key must have a hash (see Value::hash).
+std::optional<Error> DefaultContext::checkKey(const Value::Pointer &key) {
+  if (key->hash()) {
+    return {};
+  }
+  return { Error { Error::Code::Unhashable, { Error::NameOf { key } } } };
+}
+
+// This method returns the entries of collection if it is a map or set, and
+//  nullptr otherwise.
+const PersistentMap *DefaultContext::entriesOf(const Value &collection) {
+  if (const auto map = dynamic_cast<const MapValue *>(&collection)) {
+    return &map->getEntries();
+  }
+  if (const auto set = dynamic_cast<const SetValue *>(&collection)) {
+    return &set->getElements();
+  }
+  return nullptr;
+}
+
+// This method returns the error of passing collection where a map or set was
+//  expected.
+Error DefaultContext::collectionError(const Value::Pointer &collection) {
+  return Error { Error::Code::ArgumentType, {
+    "Map or Set", Error::NameOf { collection }
+  } };
+}
+
+// This method returns a map or set of entries, whichever collection is.
+Value::Pointer DefaultContext::withEntries(const Value &collection,
+  const PersistentMap &entries) {
+  if (dynamic_cast<const MapValue *>(&collection)) {
+    return Value::Pointer { Region::make<MapValue>(entries) };
+  }
+  return Value::Pointer { Region::make<SetValue>(entries) };
+}
+
+// This method creates a pure function taking two maps or two sets and
+//  returning the result of combine for the entries of the second and the
+//  first, in that order.
+Value::Pointer DefaultContext::createSetOperation(
+  PersistentMap (PersistentMap::*combine)(const PersistentMap &) const) {
+  return createBiFunc<Value, Value, Value>([combine](
+    const Value::Pointer &other,
+    const Value::Pointer &collection) ->
+    Value::OrError {
+  const PersistentMap *entries = entriesOf(*collection);
+  if (!entries) {
+    return { collectionError(collection) };
+  }
+  const PersistentMap *otherEntries = entriesOf(*other);
+  if (!otherEntries || typeid(*other) != typeid(*collection)) {
+    return { Error { Error::Code::ArgumentType, {
+      Error::NameOf { collection }, Error::NameOf { other }
+    } } };
+  }
+  return { withEntries(*collection, (entries->*combine)(*otherEntries)) };
+  }, { true, true }, true);
+}
+
+// This method creates a pure function that reduces a sequence with the given
+//  method of SequenceValue.
+Value::Pointer DefaultContext::createReduction(
+  Value::OrError (SequenceValue::*reduce)() const) {
+  return createFunc<SequenceValue, Value>([reduce](
+    const std::shared_ptr<SequenceValue> &sequence) ->
+    Value::OrError {
+  return ((*sequence).*reduce)();
+  }, true);
+}
+
+// This method creates the constructor of tag, which wraps its argument in a
+//  TaggedValue. It is pure, and always needs its argument, so that a
+//  payload is never a ThunkValue that a Pattern would have to force.
+Value::Pointer DefaultContext::createConstructor(TaggedValue::Tag tag) {
+  return createFunc<Value, TaggedValue>([tag](
+    const Value::Pointer &payload) ->
+    FunctionValue<Value, TaggedValue>::Return {
+  return { Region::make<TaggedValue>(tag, payload) };
+  }, true);
+}
+
+// This method returns Some of the Value of result, Nothing if result is an
+//  Error of code missing, and any other Error as it is.
+Value::OrError DefaultContext::optionalOf(const Value::OrError &result,
+  Error::Code missing) {
+  if (const auto error = std::get_if<Error>(&result)) {
+    if (error->getCode() == missing) {
+      return { TaggedValue::nullary(TaggedValue::nothing) };
+    }
+    return { *error };
+  }
+  return { Value::Pointer { Region::make<TaggedValue>(
+    TaggedValue::some, *std::get_if<Value::Pointer>(&result)
+  ) } };
+}
+
+// This method creates a function like the one that createReduction creates
+//  for reduce, but which gives Nothing instead of failing if the sequence is
+//  empty.
+Value::Pointer DefaultContext::createOptionalReduction(
+  Value::OrError (SequenceValue::*reduce)() const) {
+  return createFunc<SequenceValue, Value>([reduce](
+    const std::shared_ptr<SequenceValue> &sequence) ->
+    Value::OrError {
+  return optionalOf(((*sequence).*reduce)(), Error::Code::EmptySequence);
+  }, true);
 }
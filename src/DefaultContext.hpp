@@ -8,9 +8,23 @@
 
 #include <functional>
 #include <memory>
+#include <optional>
+#include <vector>
 #include "Context.hpp"
+#include "Error.hpp"
 #include "FunctionValue.hpp"
+#include "IdentifierValue.hpp"
 #include "NumberValue.hpp"
+#include "NumericKernel.hpp"
+#include "Pattern.hpp"
+#include "PersistentMap.hpp"
+#include "PersistentVector.hpp"
+#include "Region.hpp"
+#include "Rope.hpp"
+#include "SequenceValue.hpp"
+#include "TaggedValue.hpp"
+#include "ThunkValue.hpp"
+#include "TokenTree.hpp"
 #include "Value.hpp"
 
 // DefaultContext - Inherits from Context. It is simply a Context containing all
@@ -33,64 +47,199 @@ public:
     const std::shared_ptr<T2> &
   )>;
 
+  // A Native is a function taking a Value and returning a Value.
+  template <typename T1, typename T2>
+  using Native = std::function<typename FunctionValue<T1, T2>::Return(
+    const std::shared_ptr<T1> &
+  )>;
+
 private:
-  // NOTE: Each call of a function creates a new lambda function encased in a
-  //  FunctionValue. For example, 2 + 3 will evaluate to ((+) 2) 3, so (+) 2
-  //  will be its own unique FunctionValue. This is probably inefficient and is
-  //  not currently optimized.
+  // This function creates a FunctionValue from a unary native function, which
+  //  always needs its argument. pure is the same as for createBiFunc.
+  template <typename T1, typename T2>
+  Value::Pointer createFunc(Native<T1, T2> func, bool pure = false) {
+    return Value::Pointer {
+      new FunctionValue<T1, T2> {
+        [func](const std::shared_ptr<T1> &x,
+          [[maybe_unused]] const Context::Pointer &ignored) {
+          return func(x);
+        },
+        Context::Pointer { this, true }, true, pure, { true }
+      }
+    };
+  }
+
+  // NOTE: Calling a binary function with one argument creates a new lambda
+  //  function encased in a FunctionValue. For example, (+) 2 is its own
+  //  unique FunctionValue. When both arguments are given at once, as in 2 + 3,
+  //  the Evaluator calls func directly instead (see BinaryCallValue in
+  //  src/FunctionValue.hpp), so no intermediate FunctionValue is created.
   // This function creates a FunctionValue from a binary native function.
+  //  strictness declares which of the two arguments func always needs (see
+  //  Value::getStrictness), since this cannot be found out by looking at func.
+  //  pure should only be true if func has no effects (see Value::isPure). op
+  //  should only be given if func is that operator when given two numbers
+  //  (see src/NumericKernel.hpp).
   template <typename T1, typename T2, typename T3>
-  Value::Pointer createBiFunc(NativeBi<T1, T2, T3> func) {
-    const auto lambdaFunc = [func](
-      const std::shared_ptr<T1> &x,
-      [[maybe_unused]] const Context::Pointer &context) {
-      return typename FunctionValue<T1, FunctionValue<T2, T3>>::Return {
-        typename FunctionValue<T1, FunctionValue<T2, T3>>::ReturnPointer {
-          new FunctionValue<T2, T3> {
-            typename FunctionValue<T2, T3>::NativeAction {
-              [x, func](
-                const std::shared_ptr<T2> &y,
-                const Context::Pointer &context
-              ) -> typename FunctionValue<T2, T3>::Return {
-                return func(x, y, context);
-              }
-            },
-            Context::Pointer { context }
-          }
-        }
-      };
-    };
+  Value::Pointer createBiFunc(NativeBi<T1, T2, T3> func,
+    const std::vector<bool> &strictness, bool pure = false,
+    std::optional<NumericKernel::Op> op = {}) {
     return Value::Pointer {
-      new FunctionValue<T1, FunctionValue<T2, T3>> {
-        typename FunctionValue<T1, FunctionValue<T2, T3>>::NativeAction {
-          lambdaFunc
-        },
+      new BinaryFunctionValue<T1, T2, T3> {
+        func,
         // Create a *RAW POINTER* since a shared_ptr will be created by the
         //  object that owns this DefaultContext.
-        Context::Pointer { this, true }
+        Context::Pointer { this, true },
+        pure, strictness, op
       }
     };
   }
 
   template <typename T1, typename T2, typename T3>
-  Value::Pointer createBiFunc(NativeBiNoContext<T1, T2, T3> func) {
+  Value::Pointer createBiFunc(NativeBiNoContext<T1, T2, T3> func,
+    const std::vector<bool> &strictness, bool pure = false,
+    std::optional<NumericKernel::Op> op = {}) {
     return createBiFunc<T1, T2, T3>([func](
       const std::shared_ptr<T1> &x,
       const std::shared_ptr<T2> &y,
       [[maybe_unused]] const Context::Pointer &ignored) {
         return func(x, y);
-    });
+    }, strictness, pure, op);
   }
 
   const Value::Pointer add;
+  const Value::Pointer subtract;
   const Value::Pointer multiply;
   const Value::Pointer pow;
+  const Value::Pointer modulo;
+  const Value::Pointer divide;
+  const Value::Pointer quotient;
+  const Value::Pointer gcd;
+  const Value::Pointer lcm;
+  const Value::Pointer lessThan;
+  const Value::Pointer lessOrEqual;
+  const Value::Pointer greaterThan;
+  const Value::Pointer greaterOrEqual;
+  const Value::Pointer equal;
+  const Value::Pointer notEqual;
   const Value::Pointer set;
+  const Value::Pointer lambda;
+  const Value::Pointer pipe;
+  const Value::Pointer rangeBefore;
+  const Value::Pointer rangeThrough;
+  const Value::Pointer arithmetic;
+  const Value::Pointer at;
+  const Value::Pointer emptyList;
+  const Value::Pointer prepend;
+  const Value::Pointer cons;
+  const Value::Pointer concatenate;
+  const Value::Pointer splice;
+  const Value::Pointer pair;
+  const Value::Pointer extendTuple;
+  const Value::Pointer update;
+  const Value::Pointer toList;
+  const Value::Pointer map;
+  const Value::Pointer filter;
+  const Value::Pointer takeWhile;
+  const Value::Pointer concatMap;
+  const Value::Pointer take;
+  const Value::Pointer drop;
+  const Value::Pointer zip;
+  const Value::Pointer reduceLeft;
+  const Value::Pointer scanLeft;
+  const Value::Pointer sum;
+  const Value::Pointer product;
+  const Value::Pointer minimum;
+  const Value::Pointer maximum;
+  const Value::Pointer length;
+  const Value::Pointer first;
+  const Value::Pointer last;
+  const Value::Pointer dot;
+  const Value::Pointer split;
+  const Value::Pointer splitWith;
+  const Value::Pointer join;
+  const Value::Pointer find;
+  const Value::Pointer trim;
+  const Value::Pointer isWhitespace;
+  const Value::Pointer toString;
+  const Value::Pointer integerType;
+  const Value::Pointer floatType;
+  const Value::Pointer tryParseAs;
+  const Value::Pointer readBytes;
+  const Value::Pointer bytesOf;
+  const Value::Pointer decodeUtf8;
+  const Value::Pointer decodeInts;
+  const Value::Pointer decodeFloats;
+  const Value::Pointer emptyMap;
+  const Value::Pointer emptySet;
+  const Value::Pointer mapOf;
+  const Value::Pointer setOf;
+  const Value::Pointer insert;
+  const Value::Pointer include;
+  const Value::Pointer remove;
+  const Value::Pointer lookup;
+  const Value::Pointer contains;
+  const Value::Pointer size;
+  const Value::Pointer keys;
+  const Value::Pointer values;
+  const Value::Pointer unite;
+  const Value::Pointer intersect;
+  const Value::Pointer nothing;
+  const Value::Pointer some;
+  const Value::Pointer left;
+  const Value::Pointer right;
+  const Value::Pointer constructor;
+  const Value::Pointer singleton;
+  const Value::Pointer tryAt;
+  const Value::Pointer tryFirst;
+  const Value::Pointer tryLast;
+
+  // Private methods are documented in src/DefaultContext.cpp.
+  static std::optional<Error> elementsOf(
+    const std::shared_ptr<SequenceValue> &sequence,
+    PersistentVector &elements);
+  static FunctionValue<SequenceValue, SequenceValue>::Return prependTo(
+    const Value::Pointer &element,
+    const std::shared_ptr<SequenceValue> &sequence);
+  Value::Pointer createComparison(bool (*compare)(double, double),
+    NumericKernel::Op op);
+  Value::Pointer createDivision(std::optional<NumberValue> (*divide)(
+    const NumberValue &, const NumberValue &),
+    std::optional<NumericKernel::Op> op = {});
+  Value::Pointer createStage(SequenceValue::Stage::Kind kind);
+  Value::Pointer createCountedStage(SequenceValue::Stage::Kind kind);
+  Value::Pointer createReduction(Value::OrError (SequenceValue::*reduce)()
+    const);
+  static Value::Pointer stringsOf(const std::vector<Rope> &pieces);
+  Value::Pointer createDecoding(bool floats);
+  static std::optional<Error> checkKey(const Value::Pointer &key);
+  static Value::OrError destructure(const TokenTree &tree,
+    const Pattern &pattern, const std::shared_ptr<ThunkValue> &value,
+    const Context::Pointer &context);
+  static const PersistentMap *entriesOf(const Value &collection);
+  static Error collectionError(const Value::Pointer &collection);
+  static Value::Pointer withEntries(const Value &collection,
+    const PersistentMap &entries);
+  Value::Pointer createSetOperation(
+    PersistentMap (PersistentMap::*combine)(const PersistentMap &) const);
+  Value::Pointer createConstructor(TaggedValue::Tag tag);
+  static Value::OrError optionalOf(const Value::OrError &result,
+    Error::Code missing);
+  Value::Pointer createOptionalReduction(
+    Value::OrError (SequenceValue::*reduce)() const);
 
   public:
   // DefaultContext - The default constructor. Creates a Context with all the
   //  default functions and values included.
   DefaultContext();
+
+  // static createFunction(param, body, strict) - Returns the function that
+  //  `param -> body` creates, or an error if param is not a valid parameter.
+  //  strict should only be true if body always uses the Value of param (see
+  //  src/StrictnessAnalyzer.hpp).
+  static Value::OrError createFunction(
+    const std::shared_ptr<IdentifierValue> &param,
+    const std::shared_ptr<IdentifierValue> &body, bool strict);
 };
 
 #endif
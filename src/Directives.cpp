@@ -0,0 +1,87 @@
+// File: src/Directives.cpp
+// Purpose: Source file for Directives, which are instructions to the
+//  interpreter written in comments. See src/Directives.hpp for more
+//  documentation.
+
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Directives.hpp"
+#include "ParseError.hpp"
+#include "Token.hpp"
+#include "TokenStream.hpp"
+
+// Constructor(code) - Reads the comments of code with a TokenStream. Code that
+//  cannot be tokenized has no directives past the point of the error; the
+//  error itself is reported when the code is parsed. The target of a directive
+//  is the identifier that the next line of code starts with.
+Directives::Directives(const std::string &code) {
+  const std::string prefix { "#[directive " };
+  TokenStream tokens { code };
+  std::vector<std::pair<std::string, std::string>> untargeted;
+  try {
+    while (tokens.hasNext()) {
+      const Token token = tokens.next();
+      const std::string &comment = token.getValue();
+      if (token.getType() == Token::Type::Identifier) {
+        for (const auto &directive : untargeted) {
+          targets[directive].insert(token.getValue());
+        }
+      }
+      if (token.getType() != Token::Type::Comment &&
+          token.getType() != Token::Type::LineBreak) {
+        untargeted.clear();
+      }
+      if (token.getType() != Token::Type::Comment ||
+          comment.compare(0, prefix.size(), prefix) != 0) {
+        continue;
+      }
+      const auto end = comment.find(']', prefix.size());
+      if (end == std::string::npos) {
+        continue;
+      }
+      std::istringstream words {
+        comment.substr(prefix.size(), end - prefix.size())
+      };
+      std::string name;
+      std::string value { "true" };
+      if (words >> name) {
+        words >> value;
+        values[name] = value;
+        untargeted.push_back({ name, value });
+      }
+    }
+  }
+  catch (const ParseError &) {}
+}
+
+// get(name) - Looks name up in the directives that were found.
+std::optional<std::string> Directives::get(const std::string &name) const {
+  const auto iterator = values.find(name);
+  if (iterator == values.end()) {
+    return {};
+  }
+  return { iterator->second };
+}
+
+// isSet(name) - Returns true unless name was not given or was given as false.
+bool Directives::isSet(const std::string &name) const {
+  const auto &value = get(name);
+  return value && *value != "false";
+}
+
+// getTargets(name, value) - Looks name and value up in the targets that were
+//  found.
+std::set<std::string> Directives::getTargets(const std::string &name,
+  const std::string &value) const {
+  const auto iterator = targets.find({ name, value });
+  if (iterator == targets.end()) {
+    return {};
+  }
+  return iterator->second;
+}
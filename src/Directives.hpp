@@ -0,0 +1,44 @@
+// File: src/Directives.hpp
+// Purpose: Header file for Directives, which are instructions to the
+//  interpreter written in comments of the form `#[directive name]` or
+//  `#[directive name value]` (see docs/index.md). See src/Directives.cpp for
+//  implementations.
+
+#ifndef DIRECTIVES_HPP
+#define DIRECTIVES_HPP
+
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Directives {
+private:
+  std::unordered_map<std::string, std::string> values;
+  std::map<std::pair<std::string, std::string>, std::set<std::string>>
+    targets;
+
+public:
+  // Constructor(code) - Finds the directives in the comments of the given code.
+  //  `#[directive name]` is equivalent to `#[directive name true]`.
+  Directives(const std::string &code);
+
+  // get(name) - Returns the value of the directive with the given name, or an
+  //  empty optional if it is not given.
+  std::optional<std::string> get(const std::string &name) const;
+
+  // isSet(name) - Returns a boolean indicating whether the directive with the
+  //  given name is given with a value other than "false".
+  bool isSet(const std::string &name) const;
+
+  // getTargets(name, value) - Returns the names that are defined by the lines
+  //  of code right after the directives with the given name and value, which
+  //  apply to those definitions rather than to the whole code.
+  std::set<std::string> getTargets(const std::string &name,
+    const std::string &value = "true") const;
+};
+
+#endif
@@ -0,0 +1,213 @@
+// File: src/Error.cpp
+// Purpose: Source file for Errors, which are the results of Fleet code that
+//  fails at runtime. See src/Error.hpp for more documentation.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <variant>
+#include "Error.hpp"
+#include "TokenTree.hpp"
+#include "Value.hpp"
+
+// Constructor(code, arguments) - Creates a record with one reference, unless
+//  there are no arguments to keep.
+Error::Error(Error::Code code,
+  std::initializer_list<Error::Argument> arguments):
+  code { code }, record { nullptr } {
+  if (arguments.size() == 0) {
+    return;
+  }
+  record = new Record { { 1 }, 0, {}, nullptr };
+  for (const Argument &argument : arguments) {
+    if (record->count == maxArguments) {
+      break;
+    }
+    record->arguments[record->count++] = argument;
+  }
+}
+
+// Copying an Error adds a reference to its record. Moving an Error takes its
+//  record, so the moved-from Error has none.
+Error::Error(const Error &other): code { other.code }, record { other.record } {
+  if (record) {
+    record->references++;
+  }
+}
+
+Error::Error(Error &&other) noexcept:
+  code { other.code }, record { other.record } {
+  other.record = nullptr;
+}
+
+Error &Error::operator=(const Error &other) {
+  Error copy { other };
+  std::swap(code, copy.code);
+  std::swap(record, copy.record);
+  return *this;
+}
+
+Error &Error::operator=(Error &&other) noexcept {
+  std::swap(code, other.code);
+  std::swap(record, other.record);
+  return *this;
+}
+
+// Destructor - Deletes the record once no Error refers to it.
+Error::~Error() {
+  if (record && --record->references == 0) {
+    delete record;
+  }
+}
+
+// getCode() - Returns the code of the Error.
+Error::Code Error::getCode() const {
+  return code;
+}
+
+// getSource() - Returns the code that the Error occurred in, if known.
+const std::shared_ptr<const TokenTree> &Error::getSource() const {
+  static const std::shared_ptr<const TokenTree> unknown {};
+  return record ? record->source : unknown;
+}
+
+// withSource(source) - Sets the source in place if this is the only Error
+//  using the record, or in a new record otherwise.
+Error Error::withSource(const std::shared_ptr<const TokenTree> &source) const {
+  Error result { *this };
+  if (!source || (record && record->source)) {
+    return result;
+  }
+  if (!record || record->references > 2) {
+    Error copy { code };
+    copy.record = new Record { { 1 }, 0, {}, nullptr };
+    if (record) {
+      copy.record->count = record->count;
+      std::copy(record->arguments, record->arguments + record->count,
+        copy.record->arguments);
+    }
+    result = std::move(copy);
+  }
+  result.record->source = source;
+  return result;
+}
+
+// render(argument) - Converts an Argument to the string used in messages.
+std::string Error::render(const Error::Argument &argument) {
+  if (const auto text = std::get_if<const char *>(&argument)) {
+    return *text;
+  }
+  if (const auto text = std::get_if<std::string>(&argument)) {
+    return *text;
+  }
+  if (const auto getClassName = std::get_if<std::string (*)()>(&argument)) {
+    return (*getClassName)();
+  }
+  if (const auto nameOf = std::get_if<NameOf>(&argument)) {
+    return nameOf->value->getName();
+  }
+  return static_cast<std::string>(*std::get_if<Shown>(&argument)->value);
+}
+
+// getMessage() - Fills in the message of the Error's code with its arguments.
+//  In a message, {0}, {1}, etc. stand for the Error's arguments.
+std::string Error::getMessage() const {
+  const char *kind = "TypeError: ";
+  const char *message = "";
+  switch (code) {
+    case Code::Undefined:
+      message = "{0} is undefined";
+      break;
+    case Code::AlreadyDefined:
+      message = "{0} is already defined";
+      break;
+    case Code::InvalidIdentifier:
+      message = "{0} is not a valid identifier";
+      break;
+    case Code::InvalidParameter:
+      message = "{0} is not a valid parameter";
+      break;
+    case Code::ArgumentType:
+      message = "Expected argument of type {0} but got argument of type {1}";
+      break;
+    case Code::ReturnType:
+      message =
+        "Expected return value of type {0} but got return value of type {1}";
+      break;
+    case Code::CannotReverse:
+      message = "Cannot reverse value of type {0}";
+      break;
+    case Code::NoMatchingClause:
+      message = "No clause of function matches argument {0}";
+      break;
+    case Code::NotCallable:
+      message = "Value of type {0} cannot be called";
+      break;
+    case Code::EmptyBlock:
+      kind = "ParseError: ";
+      message = "Invalid empty code block";
+      break;
+    case Code::Circular:
+      kind = "ValueError: ";
+      message = "Value is defined in terms of itself";
+      break;
+    case Code::EmptySequence:
+      kind = "ValueError: ";
+      message = "Sequence has no elements";
+      break;
+    case Code::InfiniteSequence:
+      kind = "ValueError: ";
+      message = "Sequence has no end";
+      break;
+    case Code::IndexOutOfRange:
+      kind = "ValueError: ";
+      message = "Index {0} is out of range";
+      break;
+    case Code::DivisionByZero:
+      kind = "ValueError: ";
+      message = "Division by zero";
+      break;
+    case Code::CannotParse:
+      kind = "ValueError: ";
+      message = "Cannot parse {0} as {1}";
+      break;
+    case Code::InvalidWidth:
+      kind = "ValueError: ";
+      message = "{0} is not a valid width in bytes for {1}";
+      break;
+    case Code::CannotOpen:
+      kind = "IOError: ";
+      message = "Cannot open {0}";
+      break;
+    case Code::Unhashable:
+      message = "Value of type {0} cannot be a key";
+      break;
+    case Code::KeyNotFound:
+      kind = "ValueError: ";
+      message = "Key {0} is not in the map";
+      break;
+    case Code::Internal:
+      kind = "ParseError: ";
+      message = "Internal error: {0}";
+      break;
+  }
+
+  std::string result { kind };
+  for (const char *c = message; *c != '\0'; c++) {
+    if (*c == '{' && c[1] >= '0' && c[1] <= '9' && c[2] == '}') {
+      const std::size_t index = c[1] - '0';
+      if (record && index < record->count) {
+        result += render(record->arguments[index]);
+      }
+      c += 2;
+    }
+    else {
+      result += *c;
+    }
+  }
+  return result;
+}
@@ -0,0 +1,112 @@
+// File: src/Error.hpp
+// Purpose: Header file for Errors, which are the results of Fleet code that
+//  fails at runtime (e.g. by calling a function with an argument of the wrong
+//  type). An Error is an error code and a pointer to a shared record of the
+//  arguments of its message and the code it occurred in, if known, which is
+//  only created once there is something to put in it. Its message is only
+//  formatted when it is needed. See src/Error.cpp for implementations.
+
+#ifndef ERROR_HPP
+#define ERROR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <variant>
+
+class TokenTree;
+class Value;
+
+class Error {
+public:
+  // The codes of the Errors that can occur. The message of each code is
+  //  listed in src/Error.cpp.
+  enum class Code {
+    Undefined,
+    AlreadyDefined,
+    InvalidIdentifier,
+    InvalidParameter,
+    ArgumentType,
+    ReturnType,
+    CannotReverse,
+    NoMatchingClause,
+    NotCallable,
+    EmptyBlock,
+    Circular,
+    EmptySequence,
+    InfiniteSequence,
+    IndexOutOfRange,
+    DivisionByZero,
+    CannotParse,
+    InvalidWidth,
+    CannotOpen,
+    Unhashable,
+    KeyNotFound,
+    Internal
+  };
+
+  // NameOf and Shown are Arguments that refer to a Value. NameOf is rendered
+  //  as the name of the Value's type, and Shown as the Value itself.
+  struct NameOf {
+    std::shared_ptr<const Value> value;
+  };
+  struct Shown {
+    std::shared_ptr<const Value> value;
+  };
+
+  // An Argument is part of the message of an Error. Strings are used as they
+  //  are, and class name functions (e.g. &NumberValue::getClassName) are only
+  //  called when the message is rendered.
+  typedef std::variant<const char *, std::string, std::string (*)(), NameOf,
+    Shown> Argument;
+
+private:
+  // The most arguments a message has. Any further arguments are ignored.
+  static constexpr std::size_t maxArguments = 2;
+
+  struct Record {
+    std::atomic<std::size_t> references;
+    std::size_t count;
+    Argument arguments[maxArguments];
+    std::shared_ptr<const TokenTree> source;
+  };
+  Code code;
+  Record *record;
+
+  static std::string render(const Argument &argument);
+
+public:
+  // Constructor(code, arguments) - Creates an Error with the given code and
+  //  message arguments.
+  Error(Code code, std::initializer_list<Argument> arguments = {});
+
+  // Copy and move constructors and assignment - Errors share their records. A
+  //  moved-from Error keeps its code but has neither arguments nor a source.
+  Error(const Error &other);
+  Error(Error &&other) noexcept;
+  Error &operator=(const Error &other);
+  Error &operator=(Error &&other) noexcept;
+
+  // Destructor - Releases the Error's record if it is the last Error using it.
+  ~Error();
+
+  // getCode() - Returns the code of the Error.
+  Code getCode() const;
+
+  // getSource() - Returns the code that the Error occurred in, or a null
+  //  pointer if it is not known.
+  const std::shared_ptr<const TokenTree> &getSource() const;
+
+  // withSource(source) - Returns a copy of the Error whose source is source,
+  //  unless the Error already has a source. source is shared rather than
+  //  copied, so it must be owned by the pointer.
+  Error withSource(const std::shared_ptr<const TokenTree> &source) const;
+
+  // getMessage() - Formats and returns the message of the Error, preceded by
+  //  its kind (e.g. "TypeError: x is undefined").
+  std::string getMessage() const;
+};
+
+#endif
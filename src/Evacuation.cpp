@@ -0,0 +1,235 @@
+// File: src/Evacuation.cpp
+// Purpose: Source file for Evacuations, which copy the Values and Contexts that
+//  outlive an evaluation out of its Region. See src/Evacuation.hpp for more
+//  documentation.
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "Evacuation.hpp"
+#include "Context.hpp"
+#include "MemoTable.hpp"
+#include "Region.hpp"
+#include "ThunkValue.hpp"
+#include "TokenTree.hpp"
+#include "Value.hpp"
+
+thread_local std::vector<std::weak_ptr<const ThunkValue>>
+  Evacuation::escapedThunks {};
+thread_local std::vector<std::weak_ptr<MemoTable>>
+  Evacuation::escapedTables {};
+
+// Constructor(region) - Creates an Evacuation that has copied nothing yet.
+Evacuation::Evacuation(const Region &region): region { region }, depth { 0 },
+  kept { false } {}
+
+// finish() - Fills in the copies left to fill in. Filling one in may copy more
+//  Values, and so leave more copies to fill in, until everything reachable
+//  has been copied. Those copies count as nested ones, so they are filled in
+//  by this loop rather than by one of their own.
+void Evacuation::finish() {
+  depth++;
+  while (!pending.empty()) {
+    const std::function<void()> fill = std::move(pending.back());
+    pending.pop_back();
+    fill();
+  }
+  depth--;
+}
+
+// contains(ptr) - Asks the Region.
+bool Evacuation::contains(const void *ptr) const {
+  return region.contains(ptr);
+}
+
+// value(value) - The Value copies itself, and the outermost call fills in
+//  what was left to fill in before returning.
+Value::Pointer Evacuation::value(const Value::Pointer &value) {
+  if (!value || !region.contains(value.get())) {
+    return value;
+  }
+  const auto found = values.find(value.get());
+  if (found != values.end()) {
+    return found->second.second;
+  }
+  depth++;
+  Value::Pointer copy = value->evacuate(*this);
+  if (!copy) {
+    copy = value;
+    kept = true;
+  }
+  values.emplace(value.get(), std::make_pair(value, copy));
+  if (--depth == 0) {
+    finish();
+  }
+  return copy;
+}
+
+// context(context) - The copy is created with the copy of the parent of
+//  context (Contexts do not refer back to themselves through their parents),
+//  and its Values are defined in it later.
+Context::Pointer Evacuation::context(const Context::Pointer &context) {
+  if (!context || !region.contains(&*context)) {
+    return context;
+  }
+  const auto found = contexts.find(&*context);
+  if (found != contexts.end()) {
+    return found->second.second;
+  }
+  depth++;
+  const Context::Pointer copy {
+    std::make_shared<Context>(this->context(context->getParentContext()))
+  };
+  contexts.emplace(&*context, std::make_pair(context, copy));
+  later([this, context, copy] {
+    for (const auto &[name, value] : context->values) {
+      copy->values.emplace(name, this->value(value));
+    }
+  });
+  if (--depth == 0) {
+    finish();
+  }
+  return copy;
+}
+
+// subtree(tree) - Returns tree itself if none of its Constants are in the
+//  Region. Subtrees shared by several trees are only looked at once.
+TokenTree::TreePointer Evacuation::subtree(const TokenTree::TreePointer &tree) {
+  if (!tree) {
+    return tree;
+  }
+  const auto found = trees.find(tree.get());
+  if (found != trees.end()) {
+    return found->second.second;
+  }
+  std::optional<TokenTree> copy = copied(*tree);
+  const TokenTree::TreePointer result = copy ?
+    std::make_shared<TokenTree>(std::move(*copy)) : tree;
+  trees.emplace(tree.get(), std::make_pair(tree, result));
+  return result;
+}
+
+// copied(tree) - Returns the copy of tree, or an empty optional if tree can be
+//  kept as it is.
+std::optional<TokenTree> Evacuation::copied(const TokenTree &tree) {
+  if (const auto constant = tree.getConstantPointer()) {
+    const Value::Pointer copy = value(constant->value);
+    const TokenTree::TreePointer original = subtree(constant->original);
+    if (copy == constant->value && original == constant->original) {
+      return {};
+    }
+    return TokenTree { copy, original };
+  }
+  if (const auto binding = tree.getBindingPointer()) {
+    const TokenTree::TreePointer bound = subtree(binding->value);
+    const TokenTree::TreePointer body = subtree(binding->body);
+    if (bound == binding->value && body == binding->body) {
+      return {};
+    }
+    return TokenTree { binding->name, bound, body, binding->strict };
+  }
+  if (const auto pair = tree.getFunctionPairPointer()) {
+    const TokenTree::TreePointer first = subtree(pair->first);
+    const TokenTree::TreePointer second = subtree(pair->second);
+    if (first == pair->first && second == pair->second) {
+      return {};
+    }
+    return TokenTree { first, second };
+  }
+  if (const auto lines = tree.getLineListPointer()) {
+    TokenTree::LineList copy;
+    bool changed = false;
+    for (const auto &line : *lines) {
+      copy.push_back(subtree(line));
+      changed = changed || copy.back() != line;
+    }
+    if (!changed) {
+      return {};
+    }
+    return TokenTree { copy };
+  }
+  return {};
+}
+
+// tree(tree) - Copies tree itself rather than a pointer to it.
+TokenTree Evacuation::tree(const TokenTree &tree) {
+  std::optional<TokenTree> copy = copied(tree);
+  return copy ? std::move(*copy) : tree;
+}
+
+std::shared_ptr<const TokenTree> Evacuation::tree(
+  const std::shared_ptr<const TokenTree> &tree) {
+  if (!tree) {
+    return tree;
+  }
+  std::optional<TokenTree> copy = copied(*tree);
+  if (!copy) {
+    return tree;
+  }
+  return std::make_shared<const TokenTree>(std::move(*copy));
+}
+
+// later(fill) - Keeps fill until the outermost copy is done.
+void Evacuation::later(const std::function<void()> &fill) {
+  pending.push_back(fill);
+}
+
+// defined(context) - The Values are replaced in place.
+void Evacuation::defined(Context &context) {
+  for (auto &[name, defined] : context.values) {
+    defined = value(defined);
+  }
+}
+
+// evacuateEscapes() - A ThunkValue or MemoTable that is gone no longer holds
+//  anything, and one noted several times is only looked at once.
+void Evacuation::evacuateEscapes() {
+  std::unordered_set<const void *> seen;
+  for (const auto &escaped : escapedThunks) {
+    const auto thunk = escaped.lock();
+    if (thunk && seen.insert(thunk.get()).second) {
+      thunk->evacuateHeld(*this);
+    }
+  }
+  for (const auto &escaped : escapedTables) {
+    const auto table = escaped.lock();
+    if (table && seen.insert(table.get()).second) {
+      table->evacuate(*this);
+    }
+  }
+  escapedThunks.clear();
+  escapedTables.clear();
+}
+
+// release() - The originals are still kept alive by the Evacuation, so they
+//  are only destroyed (along with anything else in the Region that they held)
+//  once it is done.
+void Evacuation::release() {
+  if (kept) {
+    return;
+  }
+  for (const auto &[address, copied] : values) {
+    const auto thunk = dynamic_cast<const ThunkValue *>(copied.first.get());
+    if (thunk) {
+      thunk->release();
+    }
+  }
+  for (const auto &[address, copied] : contexts) {
+    copied.first->values.clear();
+    copied.first->lastDefined = nullptr;
+  }
+}
+
+// escape(thunk), escape(table) - Callers only note escapes while a Region is
+//  current, since nothing can escape otherwise.
+void Evacuation::escape(const std::weak_ptr<const ThunkValue> &thunk) {
+  escapedThunks.push_back(thunk);
+}
+
+void Evacuation::escape(const std::shared_ptr<MemoTable> &table) {
+  escapedTables.push_back(table);
+}
@@ -0,0 +1,117 @@
+// File: src/Evacuation.hpp
+// Purpose: Header file for Evacuations, which copy the Values and Contexts that
+//  outlive an evaluation out of its Region so that the Region can be released.
+//  See src/Evacuation.cpp for implementations.
+
+#ifndef EVACUATION_HPP
+#define EVACUATION_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Context.hpp"
+#include "Region.hpp"
+#include "TokenTree.hpp"
+#include "Value.hpp"
+
+class MemoTable;
+class ThunkValue;
+
+// Evacuation - Copies Values, Contexts and TokenTrees that are (or refer to
+//  anything that is) in a Region to the heap, as each Value does for itself
+//  (see Value::evacuate). A Value that is reached more than once is copied
+//  once, so sharing is kept, and ThunkValues and Contexts, the only things
+//  that can refer back to themselves, are copied empty and filled in once the
+//  outermost copy is done, so cycles end and long chains (such as a sequence
+//  built with `:`) are copied in a loop rather than by nested calls. A Value
+//  that cannot be copied (such as a native function holding its arguments)
+//  is kept as it is, and keeps the Region alive for as long as it is used.
+// Once everything has been copied, the originals let go of each other (see
+//  release), since a recursive function refers to itself through the
+//  Context it captured, and such a cycle would otherwise keep the Region
+//  alive forever.
+// Besides the result of an evaluation and the names it defines, Values in the
+//  Region escape when a ThunkValue or a MemoTable that is not in the Region
+//  keeps them. Those are noted as they happen (see escape) and fixed by
+//  evacuateEscapes.
+class Evacuation {
+private:
+  const Region &region;
+  // The Values, Contexts and subtrees copied so far, each with the original
+  //  it was copied from, which is kept alive until the Evacuation is done.
+  std::unordered_map<const Value *, std::pair<Value::Pointer, Value::Pointer>>
+    values;
+  std::unordered_map<const Context *,
+    std::pair<Context::Pointer, Context::Pointer>> contexts;
+  std::unordered_map<const TokenTree *,
+    std::pair<TokenTree::TreePointer, TokenTree::TreePointer>> trees;
+  // The copies left to fill in, and how many calls are copying.
+  std::vector<std::function<void()>> pending;
+  std::size_t depth;
+  // Whether a Value in the Region was kept since it could not be copied.
+  bool kept;
+
+  static thread_local std::vector<std::weak_ptr<const ThunkValue>>
+    escapedThunks;
+  static thread_local std::vector<std::weak_ptr<MemoTable>> escapedTables;
+
+  // Private methods are documented in src/Evacuation.cpp.
+  void finish();
+  TokenTree::TreePointer subtree(const TokenTree::TreePointer &tree);
+  std::optional<TokenTree> copied(const TokenTree &tree);
+
+public:
+  // Constructor(region) - Creates an Evacuation out of region.
+  explicit Evacuation(const Region &region);
+
+  Evacuation(const Evacuation &other) = delete;
+  Evacuation &operator=(const Evacuation &other) = delete;
+
+  // contains(ptr) - Returns whether ptr points into the Region.
+  bool contains(const void *ptr) const;
+
+  // value(value) - Returns value if it is not in the Region, and otherwise its
+  //  copy, or value itself if it cannot be copied.
+  Value::Pointer value(const Value::Pointer &value);
+
+  // context(context) - Returns context if it is not in the Region, and
+  //  otherwise its copy, whose Values are copied as well.
+  Context::Pointer context(const Context::Pointer &context);
+
+  // tree(tree) - Returns tree if none of its Constants are in the Region, and
+  //  otherwise a copy of it (sharing its other subtrees) whose Constants are.
+  TokenTree tree(const TokenTree &tree);
+  std::shared_ptr<const TokenTree> tree(
+    const std::shared_ptr<const TokenTree> &tree);
+
+  // later(fill) - Calls fill once the outermost copy is done. Used to fill in
+  //  the copy of a Value that may refer back to itself.
+  void later(const std::function<void()> &fill);
+
+  // defined(context) - Replaces each Value defined in context (but not in its
+  //  parents) by its copy. context itself is not in the Region.
+  void defined(Context &context);
+
+  // evacuateEscapes() - Copies the Values that were noted as escaping, and
+  //  forgets them.
+  void evacuateEscapes();
+
+  // release() - Makes the ThunkValues and Contexts that were copied let go of
+  //  what they hold, unless some Value was kept (and so may still use them).
+  //  Nothing may use the originals afterwards.
+  void release();
+
+  // static escape(thunk) - Notes that thunk, which is not in the current
+  //  Region, now holds a Value that may be.
+  static void escape(const std::weak_ptr<const ThunkValue> &thunk);
+
+  // static escape(table) - Notes that table, which does not belong to a
+  //  Value in the current Region, now holds Values that may be.
+  static void escape(const std::shared_ptr<MemoTable> &table);
+};
+
+#endif
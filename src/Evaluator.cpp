@@ -3,32 +3,123 @@
 // the result of evaluating some Fleet in that Context. See src/Evaluator.hpp
 // for more documentation.
 
-#include <stdexcept>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
 #include <variant>
 #include <vector>
 #include "Evaluator.hpp"
 #include "Context.hpp"
+#include "Error.hpp"
+#include "Evacuation.hpp"
 #include "FunctionValue.hpp"
+#include "IdentifierValue.hpp"
+#include "MemoTable.hpp"
 #include "NumberValue.hpp"
+#include "NumericKernel.hpp"
 #include "ParseError.hpp"
+#include "PassManager.hpp"
+#include "Region.hpp"
+#include "RuntimeStats.hpp"
+#include "SegmentedStack.hpp"
+#include "StringValue.hpp"
+#include "ThunkValue.hpp"
 #include "Token.hpp"
 #include "TokenTree.hpp"
 #include "Value.hpp"
 
 // This constructor creates an Evaluator with the given Context.
-Evaluator::Evaluator(const Context::Pointer &context):
-  evaluationContext { context } {}
+Evaluator::Evaluator(const Context::Pointer &context, bool useRegion,
+  bool optimize): evaluationContext { context }, useRegion { useRegion },
+  passes {
+    PassManager::forLevel(optimize ? PassManager::defaultLevel : 0)
+  } {}
+
+// A Continuation is one step of evaluation that remains to be done. The
+// Evaluator keeps a stack of Continuations and a stack of operands (Values)
+// and repeatedly performs the step on top of the Continuation stack (see
+// Evaluator::run). Steps take their inputs from the top of the operand stack
+// and push their results onto it.
+struct Evaluator::Continuation {
+  enum class Kind {
+    // Push the Value of tree in context.
+    Evaluate,
+    // Push tree, unevaluated, as an IdentifierValue with context.
+    Quote,
+    // Push tree, unevaluated, as a ThunkValue with context (see delay).
+    Delay,
+    // Discard the Value of the previous line of tree and evaluate line index.
+    NextLine,
+    // Call the function on top of the operand stack with tree as argument.
+    Apply,
+    // Call the function below the top of the operand stack with the top.
+    Call,
+    // Call the function on top of the operand stack with tree, then call the
+    //  result with second. If the function is a BinaryCallValue, it is called
+    //  with both at once.
+    Binary,
+    // Call binary with the two Values on top of the operand stack.
+    FinishBinary,
+    // Check the Value on top of the operand stack with callee.
+    Return,
+    // Evaluate the body of the Binding tree in a new layer of context in which
+    //  its name is bound to the Value on top of the operand stack.
+    Bind,
+    // Store the Value on top of the operand stack as the Value of function,
+    //  a ThunkValue, leaving it on the stack.
+    Force,
+    // Remember the Value on top of the operand stack as the result of calling
+    //  callee with the Value below it, and leave only the result.
+    Memoize
+  };
+  Kind kind;
+  TreePointer tree;
+  TreePointer second;
+  Context::Pointer context;
+  std::size_t index;
+  Value::Pointer function;
+  const BinaryCallValue *binary;
+  const BodyCallValue *callee;
+};
+
+thread_local SegmentedStack<Evaluator::Continuation> Evaluator::continuations
+  {};
+thread_local SegmentedStack<Value::Pointer> Evaluator::operands {};
 
 // This method returns the result of evaluating the given TokenTree in the
-// evaluator's Context. It uses the fact that each Evaluator is a
-// TokenTreeVisitor (i.e. see the Evaluator::visit methods for further
-// implementation).
+// evaluator's Context. The tree is evaluated by the Evaluator's stack machine
+// (see Evaluator::run).
 Value::OrError Evaluator::evaluate(const TokenTree &ast) {
+  // In region mode, a top-level evaluation runs with a new Region as the
+  // current Region. Nested evaluations (e.g. of function bodies) allocate from
+  // the Region that is already current.
+  if (useRegion && !Region::current()) {
+    const Region::Pointer region { new Region {} };
+    Value::OrError result { Error { Error::Code::Internal, { "No result" } } };
+    {
+      Region::Scope scope { region };
+      result = evaluate(ast);
+    }
+    return evacuate(result, *region);
+  }
+
   bool wasRemoveContextLayer = removeContextLayer;
   removeContextLayer = false;
 
-  // Evaluate the tree using this class as a TokenTreeVisitor.
-  const Value::OrError result = ast.accept(*this);
+  // Evaluate the tree, which is owned by the caller for the whole evaluation.
+  //  A top-level evaluation evaluates an optimized copy of the tree instead,
+  //  which lives until the end of this method. Nested evaluations evaluate
+  //  code that was already optimized along with the code containing it.
+  const std::size_t base = continuations.size();
+  const std::size_t operandBase = operands.size();
+  const bool optimizing = base == 0 && !passes.isEmpty();
+  const TokenTree optimized = optimizing ?
+    passes.run(ast, evaluationContext) : TokenTree {};
+  continuations.push({ Continuation::Kind::Evaluate,
+    TreePointer { TreePointer {}, optimizing ? &optimized : &ast }, {},
+    evaluationContext, 0, {}, nullptr, nullptr });
+  const Value::OrError result = run(base, operandBase);
 
   // Remove the current Context and go to the parent Context if necessary.
   // This should only be necessary if a variable was temporarily defined
@@ -40,11 +131,145 @@ Value::OrError Evaluator::evaluate(const TokenTree &ast) {
   return result;
 }
 
+// This method evaluates code on the Continuation and operand stacks of the
+// thread like a nested evaluation does, but without an Evaluator, whose
+// PassManager would otherwise be created and destroyed for every call.
+Value::OrError Evaluator::evaluateIn(const TokenTree &code,
+  const Context::Pointer &context) {
+  const std::size_t base = continuations.size();
+  const std::size_t operandBase = operands.size();
+  continuations.push({ Continuation::Kind::Evaluate,
+    TreePointer { TreePointer {}, &code }, {}, context, 0, {}, nullptr,
+    nullptr });
+  return run(base, operandBase);
+}
+
+// This method finds the kernels of code from the outermost call inwards. A
+// call x op c or c op x, where op is a builtin operator on numbers and c is a
+// number, applies (op c) or (c op) after whatever x applies, and so does a
+// call f x where f is already such a function, as (* 2) is once it has been
+// folded. The parameter itself applies nothing. Names are looked up in
+// context, where they have the same Values as when code is evaluated, unless
+// they are the parameter.
+bool Evaluator::numericKernelsOf(const TokenTree &code,
+  const std::string &parameter, const Context::Pointer &context,
+  std::vector<NumericKernel> &kernels) {
+  if (code.getConstantPointer() || code.getBindingPointer()) {
+    return false;
+  }
+  if (const auto token = code.getTokenPointer()) {
+    return token->getType() == Token::Type::Identifier &&
+      token->getValue() == parameter;
+  }
+  const auto pair = code.getFunctionPairPointer();
+  if (!pair || !pair->first || !pair->second || pair->second->isImplied()) {
+    return false;
+  }
+  const auto inner = pair->first->getConstantPointer() ? nullptr :
+    pair->first->getFunctionPairPointer();
+  if (!inner || !inner->first || !inner->second ||
+    inner->second->isImplied()) {
+    const Value::Pointer function = knownOperand(*pair->first, parameter,
+      context);
+    const NumericKernel *kernel = function ?
+      function->getNumericKernel() : nullptr;
+    if (!kernel ||
+      !numericKernelsOf(*pair->second, parameter, context, kernels)) {
+      return false;
+    }
+    kernels.push_back(*kernel);
+    return true;
+  }
+  const Value::Pointer function = knownOperand(*inner->first, parameter,
+    context);
+  const auto binary = dynamic_cast<const BinaryCallValue *>(function.get());
+  const auto op = binary ? binary->getNumericOp() : std::nullopt;
+  if (!op) {
+    return false;
+  }
+  const Value::Pointer first = knownOperand(*inner->second, parameter,
+    context);
+  const Value::Pointer second = knownOperand(*pair->second, parameter,
+    context);
+  const auto firstNumber = dynamic_cast<const NumberValue *>(first.get());
+  const auto secondNumber = dynamic_cast<const NumberValue *>(second.get());
+  if (secondNumber &&
+    numericKernelsOf(*inner->second, parameter, context, kernels)) {
+    kernels.emplace_back(*op, secondNumber->getRawNumber(), false);
+    return true;
+  }
+  if (firstNumber &&
+    numericKernelsOf(*pair->second, parameter, context, kernels)) {
+    kernels.emplace_back(*op, firstNumber->getRawNumber(), true);
+    return true;
+  }
+  return false;
+}
+
+// This method returns the Value of tree in context if it is known without
+// evaluating any code, as a constant, a number or a name other than
+// parameter is, and nullptr otherwise.
+Value::Pointer Evaluator::knownOperand(const TokenTree &tree,
+  const std::string &parameter, const Context::Pointer &context) {
+  if (const auto constant = tree.getConstantPointer()) {
+    return constant->value;
+  }
+  const auto token = tree.getTokenPointer();
+  if (!token || token->getType() == Token::Type::String ||
+    token->getValue() == parameter) {
+    return nullptr;
+  }
+  const Value::OrError value = evaluateToken(*token, context);
+  return std::holds_alternative<Value::Pointer>(value) ?
+    *std::get_if<Value::Pointer>(&value) : nullptr;
+}
+
+// This method copies everything that outlives a region-mode evaluation out of
+// its Region (see src/Evacuation.hpp): the result, the Values that the
+// evaluation defined in the evaluation Context or its parents (`=` defines
+// names in the Context it belongs to), and the Values that it gave to
+// ThunkValues and MemoTables outside the Region. Once the copies have
+// replaced them and the originals have let go of each other, the Region is
+// released along with the evaluation's temporaries. Values that cannot be
+// copied keep the Region alive for as long as they are referenced.
+Value::OrError Evaluator::evacuate(const Value::OrError &result,
+  const Region &region) {
+  Evacuation evacuation { region };
+  for (Context::Pointer context = evaluationContext; context;
+    context = context->getParentContext()) {
+    if (!evacuation.contains(&*context)) {
+      evacuation.defined(*context);
+    }
+  }
+  evacuation.evacuateEscapes();
+  Value::OrError evacuated { result };
+  if (std::holds_alternative<Value::Pointer>(result)) {
+    evacuated = evacuation.value(*std::get_if<Value::Pointer>(&result));
+  }
+  evacuation.release();
+  return evacuated;
+}
+
+// This method returns the Context that code is currently evaluated in.
+const Context::Pointer &Evaluator::getContext() const {
+  return evaluationContext;
+}
+
+// This method returns the PassManager that optimizes top-level code.
+const PassManager &Evaluator::getPasses() const {
+  return passes;
+}
+
+// This method sets the PassManager that optimizes top-level code.
+void Evaluator::setPasses(const PassManager &manager) {
+  passes = manager;
+}
+
 // This method defines a variable as a value for the next evaluation (i.e.
 // the next call to the evaluate method).
 void Evaluator::tempDefine(const std::string &name, Value::Pointer value) {
   // Create a new Context with the current Context as the parent Context.
-  Context::Pointer newContext { new Context { evaluationContext } };
+  Context::Pointer newContext { Region::make<Context>(evaluationContext) };
 
   // If there is an error, this function throws an error.
   if (newContext->define(name, value)) {
@@ -54,57 +279,403 @@ void Evaluator::tempDefine(const std::string &name, Value::Pointer value) {
   removeContextLayer = true;
 }
 
-// This method accepts a Token and converts it into a Value Pointer or an error
-// if it cannot be converted. Note that strings conversions are not yet
-// implemented.
-Value::OrError Evaluator::visit(const Token &token) const {
+// This method converts a Token into a Value Pointer in the given Context, or
+// an error if it cannot be converted.
+Value::OrError Evaluator::evaluateToken(const Token &token,
+  const Context::Pointer &context) {
   switch (token.getType()) {
     case Token::Type::Identifier:
     case Token::Type::Operator:
-      return evaluationContext->getValue(token.getValue());
+      return context->getValue(token.getValue());
     case Token::Type::Number:
-      return { Value::Pointer { 
-        new NumberValue { std::stod(token.getValue()) }
-      } };
-    // TODO: String
+      if (const auto number = NumberValue::parseLiteral(token)) {
+        return { Value::Pointer { Region::make<NumberValue>(*number) } };
+      }
+      return { Error { Error::Code::CannotParse, {
+        token.getValue(), "a number"
+      } } };
+    case Token::Type::String:
+      return { Value::Pointer { Region::make<StringValue>(token) } };
     default:
-      return { ParseError { "Internal error: Invalid token type in tree" } };
+      return { Error {
+        Error::Code::Internal, { "Invalid token type in tree" }
+      } };
   }
 }
 
-// This method accepts two TokenTrees (for a function and an argument) and
-// returns the result of calling the function with the argument if possible.
-Value::OrError Evaluator::visit(const TokenTree &f, const TokenTree &x) const {
-  // Evaluate the function TokenTree.
-  const Value::OrError &fValueOrErr = f.accept(*this);
-  if (std::holds_alternative<std::runtime_error>(fValueOrErr)) {
-    return fValueOrErr;
-  }
-  const auto &fValue = *std::get_if<Value::Pointer>(&fValueOrErr);
-
-  // If the argument is implied (i.e. there is no first argument), return the
-  // reverse of the function. An implied function tree results from syntax
-  // like (+ 3), which returns the reverse of the (+) function with 3 as its
-  // first argument.
-  if (x.isImplied()) {
-    const auto &maybeReversible = std::dynamic_pointer_cast<
-      ReversibleCallValue
-    >(fValue);
-    if (maybeReversible) {
-      const auto &maybeReversed = maybeReversible->getReverse();
-      if (std::holds_alternative<std::runtime_error>(maybeReversed)) {
-        return maybeReversed;
+// This method returns the argument or bound Value standing for tree in the
+// given Context, which is only evaluated if it is used. Constants, numbers and
+// strings are known already, and a name that is already defined stands for the
+// same Value (or ThunkValue) as the name, so none of these need a new
+// ThunkValue.
+Value::Pointer Evaluator::delay(const TreePointer &tree,
+  const Context::Pointer &context) {
+  if (const auto constant = tree->getConstantPointer()) {
+    return constant->value;
+  }
+  if (const auto token = tree->getTokenPointer()) {
+    const auto number = token->getType() == Token::Type::Number ?
+      NumberValue::parseLiteral(*token) : std::nullopt;
+    if (number) {
+      return Value::Pointer { Region::make<NumberValue>(*number) };
+    }
+    if (token->getType() == Token::Type::String) {
+      return Value::Pointer { Region::make<StringValue>(*token) };
+    }
+    if (token->getType() == Token::Type::Identifier ||
+      token->getType() == Token::Type::Operator) {
+      auto valueOrErr = context->getValue(token->getValue());
+      if (std::holds_alternative<Value::Pointer>(valueOrErr)) {
+        return std::move(*std::get_if<Value::Pointer>(&valueOrErr));
       }
-      const auto &reversed = *std::get_if<Value::Pointer>(&maybeReversed);
-      return reversed;
     }
-    return { TypeError {
-      std::string { "Cannot reverse value of type " } + fValue->getName()
-    } };
   }
+  return ThunkValue::delay(tree, context);
+}
+
+// This method returns tree, which is shared rather than copied if the pointer
+// owns it. The code of a top-level evaluation or of a function body is not
+// owned by the pointer to it and may be gone by the time tree is used, so
+// only that node is copied (sharing its subtrees).
+Evaluator::TreePointer Evaluator::owned(const TreePointer &tree) {
+  return tree.use_count() > 0 ? tree :
+    std::make_shared<const TokenTree>(*tree);
+}
+
+// This method pushes the Continuation that calls a function with the argument
+// x in the given Context, and returns the TokenTree of the function, which must
+// be evaluated next. If f is itself a call (g a), its result is used only as
+// the function of this call and cannot escape it, so (g a) x is evaluated as a
+// Binary call, which avoids creating the intermediate function if g can take
+// both arguments at once. In that case, g is the function returned.
+Evaluator::TreePointer Evaluator::pushCall(const TreePointer &f,
+  const TreePointer &x, const Context::Pointer &context) {
+  if (!x->isImplied() && !f->getConstantPointer() && !f->getBindingPointer()) {
+    const auto innerPair = f->getFunctionPairPointer();
+    if (innerPair && innerPair->first && innerPair->second &&
+        !innerPair->second->isImplied()) {
+      continuations.push({ Continuation::Kind::Binary, innerPair->second, x,
+        context, 0, {}, nullptr, nullptr });
+      return innerPair->first;
+    }
+  }
+  continuations.push({ Continuation::Kind::Apply, x, {}, context, 0, {},
+    nullptr, nullptr });
+  return f;
+}
+
+// This method performs the Continuations on top of the Continuation stack until
+// only base Continuations remain, and returns the Value that they leave on top
+// of the operand stack. Calls of functions written in Fleet are performed by
+// pushing their bodies rather than by calling them, so nothing here recurses
+// on the C++ stack. Calls in tail position need no Continuation to return to,
+// so tail recursion does not grow the stacks either. If a step results in an
+// error, both stacks are unwound to where they were and the error is returned.
+Value::OrError Evaluator::run(std::size_t base, std::size_t operandBase) {
+  std::optional<Error> error;
+  const auto pushStep = [](Continuation::Kind kind, TreePointer tree,
+    Context::Pointer context) {
+    continuations.push({ kind, std::move(tree), {}, std::move(context), 0, {},
+      nullptr, nullptr });
+  };
+  // A ThunkValue is replaced by the Value it stands for, which is evaluated
+  //  first if it is not known yet. A line whose Value is discarded does not
+  //  need it, though.
+  const auto pushResult = [&error, &pushStep, base](Value::OrError result) {
+    if (std::holds_alternative<Error>(result)) {
+      error = *std::get_if<Error>(&result);
+      return;
+    }
+    Value::Pointer &value = *std::get_if<Value::Pointer>(&result);
+    if (!value->isThunk()) {
+      operands.push(std::move(value));
+      return;
+    }
+    const auto &thunk = static_cast<const ThunkValue &>(*value);
+    if (thunk.getValue()) {
+      operands.push(Value::Pointer { thunk.getValue() });
+      return;
+    }
+    if (continuations.size() > base &&
+      continuations.top().kind == Continuation::Kind::NextLine) {
+      operands.push(std::move(value));
+      return;
+    }
+    auto code = thunk.begin();
+    if (!code) {
+      error = Error { Error::Code::Circular };
+      return;
+    }
+    continuations.push({ Continuation::Kind::Force, {}, {}, {}, 0,
+      std::move(value), nullptr, nullptr });
+    pushStep(Continuation::Kind::Evaluate, std::move(code->tree),
+      std::move(code->context));
+  };
+  // Constants and Tokens cannot contain further code, so one that would be
+  //  evaluated by the very next step is evaluated right away instead of being
+  //  pushed.
+  const auto evaluateNext = [&error, &pushResult, &pushStep](TreePointer tree,
+    Context::Pointer context) {
+    if (const auto constant = tree->getConstantPointer()) {
+      operands.push(Value::Pointer { constant->value });
+    }
+    else if (const auto token = tree->getTokenPointer()) {
+      pushResult(evaluateToken(*token, context));
+      if (error && !error->getSource()) {
+        error = error->withSource(owned(tree));
+      }
+    }
+    else {
+      pushStep(Continuation::Kind::Evaluate, std::move(tree),
+        std::move(context));
+    }
+  };
 
-  // Return the result of calling the function with the argument.
-  return fValue->call(x, this);
+  while (!error && continuations.size() > base) {
+    Continuation step = continuations.pop();
+    switch (step.kind) {
+      case Continuation::Kind::Evaluate: {
+        const TokenTree &tree = *step.tree;
+        if (const auto constant = tree.getConstantPointer()) {
+          operands.push(Value::Pointer { constant->value });
+        }
+        else if (const auto binding = tree.getBindingPointer()) {
+          // A strict Binding always needs its value, so it is evaluated first.
+          if (binding->strict) {
+            continuations.push({ Continuation::Kind::Bind, step.tree, {},
+              step.context, 0, {}, nullptr, nullptr });
+            evaluateNext(binding->value, std::move(step.context));
+            break;
+          }
+          // The body is in tail position, like the body of a called function.
+          Context::Pointer layer { Region::make<Context>(step.context) };
+          layer->define(binding->name, delay(binding->value, step.context));
+          evaluateNext(binding->body, std::move(layer));
+        }
+        else if (const auto token = tree.getTokenPointer()) {
+          pushResult(evaluateToken(*token, step.context));
+        }
+        else if (const auto pair = tree.getFunctionPairPointer()) {
+          if (!pair->first || !pair->second) {
+            error = Error {
+              Error::Code::Internal, { "Invalid function call" }
+            };
+            break;
+          }
+          evaluateNext(pushCall(pair->first, pair->second, step.context),
+            step.context);
+        }
+        else if (const auto lines = tree.getLineListPointer()) {
+          if (lines->empty()) {
+            error = Error { Error::Code::EmptyBlock };
+            break;
+          }
+          if (lines->size() > 1) {
+            continuations.push({ Continuation::Kind::NextLine, step.tree, {},
+              step.context, 1, {}, nullptr, nullptr });
+          }
+          evaluateNext(lines->front(), step.context);
+        }
+        else {
+          error = Error {
+            Error::Code::Internal, { "Invalid implied argument in tree" }
+          };
+        }
+        break;
+      }
+      case Continuation::Kind::Quote:
+        operands.push(Value::Pointer {
+          Region::make<IdentifierValue>(*step.tree, step.context)
+        });
+        break;
+      case Continuation::Kind::Delay:
+        operands.push(delay(step.tree, step.context));
+        break;
+      case Continuation::Kind::NextLine: {
+        // The last line is in tail position, so nothing is left to do after
+        //  it.
+        operands.pop();
+        const auto &lines = *step.tree->getLineListPointer();
+        if (step.index + 1 < lines.size()) {
+          continuations.push({ Continuation::Kind::NextLine, step.tree, {},
+            step.context, step.index + 1, {}, nullptr, nullptr });
+        }
+        evaluateNext(lines[step.index], std::move(step.context));
+        break;
+      }
+      case Continuation::Kind::Apply: {
+        // If the argument is implied (i.e. there is no first argument), return
+        //  the reverse of the function. An implied function tree results from
+        //  syntax like (+ 3), which returns the reverse of the (+) function
+        //  with 3 as its first argument.
+        if (step.tree->isImplied()) {
+          const Value::Pointer fValue = operands.pop();
+          const auto maybeReversible = dynamic_cast<
+            const ReversibleCallValue *
+          >(fValue.get());
+          if (maybeReversible) {
+            pushResult(maybeReversible->getReverse());
+          }
+          else {
+            error = Error {
+              Error::Code::CannotReverse, { Error::NameOf { fValue } }
+            };
+          }
+        }
+        else if (operands.top()->quotesArgument()) {
+          const Value::Pointer fValue = operands.pop();
+          pushResult(fValue->call(Value::Pointer {
+            Region::make<IdentifierValue>(*step.tree, step.context)
+          }));
+        }
+        else if (operands.top()->delaysArgument()) {
+          pushStep(Continuation::Kind::Call, {}, {});
+          operands.push(delay(step.tree, step.context));
+        }
+        else {
+          pushStep(Continuation::Kind::Call, {}, {});
+          evaluateNext(std::move(step.tree), std::move(step.context));
+        }
+        break;
+      }
+      case Continuation::Kind::Call: {
+        const Value::Pointer arg = operands.pop();
+        const Value::Pointer fValue = operands.pop();
+        const auto callee = dynamic_cast<const BodyCallValue *>(fValue.get());
+        if (!callee || !callee->hasBody()) {
+          pushResult(fValue->call(arg));
+          break;
+        }
+        MemoTable *const memo = callee->getMemoTable();
+        if (memo) {
+          Value::Pointer remembered = memo->find(arg);
+          if (remembered) {
+            operands.push(std::move(remembered));
+            break;
+          }
+        }
+        auto bodyOrErr = callee->getBody(arg);
+        if (std::holds_alternative<Error>(bodyOrErr)) {
+          error = *std::get_if<Error>(&bodyOrErr);
+          break;
+        }
+        auto &body = *std::get_if<BodyCallValue::Body>(&bodyOrErr);
+        // A call whose result is remembered is not in tail position, since
+        //  the result must be remembered once the body has been evaluated.
+        if (memo && memo->isRemembering()) {
+          operands.push(Value::Pointer { arg });
+          continuations.push({ Continuation::Kind::Memoize, {}, {}, {}, 0,
+            fValue, nullptr, callee });
+        }
+        if (callee->checksReturn()) {
+          continuations.push({ Continuation::Kind::Return, {}, {}, {}, 0,
+            fValue, nullptr, callee });
+        }
+        // The body belongs to the function, so the function is kept alive for
+        //  as long as the body is being evaluated.
+        evaluateNext(TreePointer { fValue, body.code }, std::move(body.context));
+        break;
+      }
+      case Continuation::Kind::Binary: {
+        const auto binary = dynamic_cast<const BinaryCallValue *>(
+          operands.top().get()
+        );
+        if (!binary) {
+          pushStep(Continuation::Kind::Apply, std::move(step.second),
+            step.context);
+          pushStep(Continuation::Kind::Apply, std::move(step.tree),
+            std::move(step.context));
+          break;
+        }
+        continuations.push({ Continuation::Kind::FinishBinary, {}, {}, {}, 0,
+          operands.pop(), binary, nullptr });
+        pushStep(binary->quotesSecond() ? Continuation::Kind::Quote :
+          binary->delaysSecond() ? Continuation::Kind::Delay :
+          Continuation::Kind::Evaluate, std::move(step.second), step.context);
+        if (binary->quotesFirst() || binary->delaysFirst()) {
+          pushStep(binary->quotesFirst() ? Continuation::Kind::Quote :
+            Continuation::Kind::Delay, std::move(step.tree),
+            std::move(step.context));
+        }
+        else {
+          evaluateNext(std::move(step.tree), std::move(step.context));
+        }
+        break;
+      }
+      case Continuation::Kind::FinishBinary: {
+        const Value::Pointer y = operands.pop();
+        const Value::Pointer x = operands.pop();
+        pushResult(step.binary->callBinary(x, y));
+        break;
+      }
+      case Continuation::Kind::Return:
+        pushResult(step.callee->checkReturn(operands.pop()));
+        break;
+      case Continuation::Kind::Bind: {
+        // The body is in tail position, like the body of a called function.
+        const auto &binding = *step.tree->getBindingPointer();
+        Context::Pointer layer { Region::make<Context>(step.context) };
+        layer->define(binding.name, operands.pop());
+        evaluateNext(binding.body, std::move(layer));
+        break;
+      }
+      case Continuation::Kind::Force:
+        static_cast<const ThunkValue &>(*step.function).finish(operands.top());
+        break;
+      case Continuation::Kind::Memoize: {
+        Value::Pointer result = operands.pop();
+        step.callee->getMemoTable()->remember(operands.pop(), result);
+        operands.push(std::move(result));
+        break;
+      }
+    }
+    // The error occurred while evaluating step.tree, which the Error shares
+    //  (see owned).
+    if (error && step.tree && !error->getSource()) {
+      error = error->withSource(owned(step.tree));
+    }
+  }
+
+  if (base == 0) {
+    RuntimeStats::current().recordStackDepth(continuations.getMaxSize(),
+      operands.getMaxSize());
+    continuations.resetMaxSize();
+    operands.resetMaxSize();
+  }
+  if (error) {
+    // ThunkValues whose code failed are evaluated again if they are needed
+    //  again.
+    while (continuations.size() > base) {
+      const Continuation step = continuations.pop();
+      if (step.kind == Continuation::Kind::Force) {
+        static_cast<const ThunkValue &>(*step.function).abandon();
+      }
+    }
+    while (operands.size() > operandBase) {
+      operands.pop();
+    }
+    return { *error };
+  }
+  return { operands.pop() };
+}
+
+// This method accepts a Token and converts it into a Value Pointer or an error
+// if it cannot be converted.
+Value::OrError Evaluator::visit(const Token &token) const {
+  return evaluateToken(token, evaluationContext);
+}
+
+// This method accepts two TokenTrees (for a function and an argument) and
+// returns the result of calling the function with the argument if possible.
+// Both TokenTrees are owned by the caller for the whole evaluation.
+Value::OrError Evaluator::visit(const TokenTree &f, const TokenTree &x) const {
+  const std::size_t base = continuations.size();
+  const std::size_t operandBase = operands.size();
+  continuations.push({ Continuation::Kind::Evaluate,
+    pushCall(TreePointer { TreePointer {}, &f },
+      TreePointer { TreePointer {}, &x }, evaluationContext),
+    {}, evaluationContext, 0, {}, nullptr, nullptr });
+  return run(base, operandBase);
 }
 
 // This method converts a vector of TokenTrees into a Value Pointer. It
@@ -113,10 +684,10 @@ Value::OrError Evaluator::visit(const TokenTree &f, const TokenTree &x) const {
 // evaluating further lines.
 Value::OrError Evaluator::visit(const std::vector<TokenTree> &lines) const {
   // TODO: New Context?
-  Value::OrError lastValue { ParseError { "Invalid empty code block " } };
+  Value::OrError lastValue { Error { Error::Code::EmptyBlock } };
   for (size_t i = 0; i < lines.size(); i++) {
     lastValue = lines[i].accept(*this);
-    if (std::holds_alternative<std::runtime_error>(lastValue)) {
+    if (std::holds_alternative<Error>(lastValue)) {
       return lastValue;
     }
   }
@@ -127,5 +698,7 @@ Value::OrError Evaluator::visit(const std::vector<TokenTree> &lines) const {
 // since implied arguments should be detected when they are function
 // arguments (see visit(f, x)).
 Value::OrError Evaluator::visit() const {
-  return { ParseError { "Internal error: Invalid implied argument in tree" } };
+  return { Error {
+    Error::Code::Internal, { "Invalid implied argument in tree" }
+  } };
 }
@@ -6,14 +6,22 @@
 #ifndef EVALUATOR_HPP
 #define EVALUATOR_HPP
 
+#include <cstddef>
+#include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 #include "Context.hpp"
+#include "PassManager.hpp"
+#include "Region.hpp"
+#include "SegmentedStack.hpp"
 #include "Token.hpp"
 #include "TokenTree.hpp"
 #include "TokenTreeVisitor.hpp"
 #include "Value.hpp"
 
+class NumericKernel;
+
 // The Evaluator class is a TokenTreeVisitor returning a type of Value::OrError.
 //  This means that it can visit a TokenTree (using tree.visit(*this)) and
 //  will always return a Value::OrError no matter the TokenTree. The accepting/
@@ -23,15 +31,77 @@ class Evaluator: public TokenTreeVisitor<Value::OrError> {
 private:
   Context::Pointer evaluationContext;
   bool removeContextLayer = false;
+  bool useRegion;
+  PassManager passes;
+
+  // A Continuation is one step of evaluation that remains to be done. See
+  //  src/Evaluator.cpp.
+  struct Continuation;
+  typedef std::shared_ptr<const TokenTree> TreePointer;
+
+  // The Evaluator keeps what remains to be done and the intermediate Values
+  //  on these stacks (one pair per thread, shared by nested evaluations)
+  //  rather than on the C++ stack, so that the depth of code and of recursion
+  //  is limited only by memory.
+  static thread_local SegmentedStack<Continuation> continuations;
+  static thread_local SegmentedStack<Value::Pointer> operands;
+
+  // Private methods are documented in src/Evaluator.cpp.
+  Value::OrError evacuate(const Value::OrError &result,
+    const Region &region);
+  static Value::OrError evaluateToken(const Token &token,
+    const Context::Pointer &context);
+  static Value::Pointer delay(const TreePointer &tree,
+    const Context::Pointer &context);
+  static TreePointer pushCall(const TreePointer &f, const TreePointer &x,
+    const Context::Pointer &context);
+  static TreePointer owned(const TreePointer &tree);
+  static Value::OrError run(std::size_t base, std::size_t operandBase);
+  static Value::Pointer knownOperand(const TokenTree &tree,
+    const std::string &parameter, const Context::Pointer &context);
 public:
-  // Constructor(context) - Creates an Evaluator with the given Context as its
-  //  evaluation Context (i.e. the context in which it will parse code).
-  Evaluator(const Context::Pointer &context);
+  // Constructor(context, useRegion, optimize) - Creates an Evaluator with the
+  //  given Context as its evaluation Context (i.e. the context in which it will
+  //  parse code). If useRegion is true, each top-level evaluation allocates its
+  //  Values and Contexts in a Region (see src/Region.hpp) that is released as a
+  //  whole once nothing refers to it anymore. If optimize is true (the
+  //  default), each top-level evaluation first runs the passes of the default
+  //  optimization level over the code (see src/PassManager.hpp).
+  Evaluator(const Context::Pointer &context, bool useRegion = false,
+    bool optimize = true);
 
   // evaluate(ast) - Evaluates the given TokenTree and returns either a Value
   //  Pointer or an error depending on the result of the code.
   Value::OrError evaluate(const TokenTree &ast);
 
+  // static evaluateIn(code, context) - Evaluates code that was already
+  //  optimized (such as the body of a function or the code of a ThunkValue)
+  //  in context, on the stacks of the evaluation that is running, without
+  //  creating an Evaluator. This is how native code calls back into Fleet
+  //  code, once for each element of a sequence, for example.
+  static Value::OrError evaluateIn(const TokenTree &code,
+    const Context::Pointer &context);
+
+  // static numericKernelsOf(code, parameter, context, kernels) - Returns
+  //  whether evaluating code in context, with parameter bound to a number,
+  //  only applies builtin operators with one number given to it in turn, as
+  //  `n % 3 < 1` does, and if so appends the NumericKernels of those
+  //  operators (see src/NumericKernel.hpp) to kernels in the order they are
+  //  applied.
+  static bool numericKernelsOf(const TokenTree &code,
+    const std::string &parameter, const Context::Pointer &context,
+    std::vector<NumericKernel> &kernels);
+
+  // getContext() - Returns the Context in which code is currently evaluated.
+  const Context::Pointer &getContext() const;
+
+  // getPasses() - Returns the PassManager that optimizes top-level code.
+  const PassManager &getPasses() const;
+
+  // setPasses(manager) - Sets the PassManager that optimizes the code of later
+  //  top-level evaluations.
+  void setPasses(const PassManager &manager);
+
   // tempDefine(name, value) - Temporarily (for only the next call of
   //  evaluate(ast)) defines a variable with the given name and value. Note
   //  that this creates a temporary child context rather than adding it to
@@ -0,0 +1,78 @@
+// File: src/FreeVariables.cpp
+// Purpose: Source file for FreeVariables, which is a TokenTreeVisitor that
+//  finds the identifiers and operators a TokenTree refers to without binding
+//  them itself. See src/FreeVariables.hpp for more documentation.
+
+#include <set>
+#include <string>
+#include <vector>
+#include "FreeVariables.hpp"
+#include "Pattern.hpp"
+#include "Token.hpp"
+#include "TokenTree.hpp"
+
+// of(ast) - Returns the free variables of ast by visiting it. Constants were
+//  already evaluated, so they do not refer to any names.
+std::set<std::string> FreeVariables::of(const TokenTree &ast) {
+  if (ast.getConstantPointer()) {
+    return {};
+  }
+  return ast.accept(FreeVariables {});
+}
+
+// visit(token) - Identifiers and operators are looked up by name, so they are
+//  free. Other Tokens (e.g. numbers) do not refer to any names.
+std::set<std::string> FreeVariables::visit(const Token &token) const {
+  switch (token.getType()) {
+    case Token::Type::Identifier:
+    case Token::Type::Operator:
+      return { token.getValue() };
+    default:
+      return {};
+  }
+}
+
+// visit(f, x) - Returns the free variables of both f and x. If the call is a
+//  function definition of the form `param -> x`, the names that the Pattern
+//  param binds are bound within x.
+std::set<std::string> FreeVariables::visit(
+  const TokenTree &f, const TokenTree &x
+) const {
+  const auto definition = f.getFunctionPairPointer();
+  if (definition && definition->first && definition->second) {
+    const auto arrow = definition->first->getTokenPointer();
+    if (arrow && arrow->getType() == Token::Type::Operator &&
+        arrow->getValue() == "->") {
+      const auto &param = Pattern::fromTree(*definition->second);
+      std::set<std::string> result = of(x);
+      if (param) {
+        for (const auto &name : param->getBoundNames()) {
+          result.erase(name);
+        }
+      }
+      result.insert(arrow->getValue());
+      return result;
+    }
+  }
+  std::set<std::string> result = of(f);
+  const std::set<std::string> &xResult = of(x);
+  result.insert(xResult.begin(), xResult.end());
+  return result;
+}
+
+// visit(lines) - Returns the free variables of all lines.
+std::set<std::string> FreeVariables::visit(
+  const std::vector<TokenTree> &lines
+) const {
+  std::set<std::string> result;
+  for (const auto &line : lines) {
+    const std::set<std::string> &lineResult = of(line);
+    result.insert(lineResult.begin(), lineResult.end());
+  }
+  return result;
+}
+
+// visit() - Implied arguments do not refer to any names.
+std::set<std::string> FreeVariables::visit() const {
+  return {};
+}
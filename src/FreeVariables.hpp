@@ -0,0 +1,32 @@
+// File: src/FreeVariables.hpp
+// Purpose: Header file for FreeVariables, which is a TokenTreeVisitor that
+//  finds the identifiers and operators a TokenTree refers to without binding
+//  them itself. See src/FreeVariables.cpp for implementations.
+
+#ifndef FREEVARIABLES_HPP
+#define FREEVARIABLES_HPP
+
+#include <set>
+#include <string>
+#include <vector>
+#include "Token.hpp"
+#include "TokenTree.hpp"
+#include "TokenTreeVisitor.hpp"
+
+// FreeVariables - Visits a TokenTree and returns the set of names that must be
+//  looked up in a Context to evaluate it. Parameters of functions created with
+//  `->` inside the TokenTree are bound by those functions, so they are only
+//  free if they are also used outside of the functions' bodies.
+class FreeVariables: public TokenTreeVisitor<std::set<std::string>> {
+public:
+  // static of(ast) - Returns the free variables of ast.
+  static std::set<std::string> of(const TokenTree &ast);
+
+  // TokenTreeVisitor methods - Used internally to analyze the tree.
+  std::set<std::string> visit(const Token &token) const;
+  std::set<std::string> visit(const TokenTree &f, const TokenTree &x) const;
+  std::set<std::string> visit(const std::vector<TokenTree> &lines) const;
+  std::set<std::string> visit() const;
+};
+
+#endif
@@ -3,21 +3,35 @@
 //  contain a VAlue that can be called with a certain type to produce a
 //  certain type. This file also contains the ReversibleCallValue abstract
 //  class, which should be subclassed for any Values that can be called in
-//  reverse.
+//  reverse, the BinaryCallValue interface, which is implemented by functions
+//  that can take two arguments at once, and the BodyCallValue interface, which
+//  is implemented by functions written in Fleet.
 
 #ifndef FUNCTIONVALUE_HPP
 #define FUNCTIONVALUE_HPP
 
+#include <cstddef>
 #include <functional>
 #include <memory>
-#include <stdexcept>
+#include <optional>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <variant>
+#include <vector>
 #include "Context.hpp"
+#include "Error.hpp"
+#include "Evacuation.hpp"
 #include "Evaluator.hpp"
+#include "FreeVariables.hpp"
 #include "IdentifierValue.hpp"
+#include "MemoTable.hpp"
+#include "NumberValue.hpp"
+#include "NumericKernel.hpp"
+#include "Pattern.hpp"
+#include "Region.hpp"
+#include "ThunkValue.hpp"
 #include "TokenTree.hpp"
-#include "TypeError.hpp"
 #include "Value.hpp"
 
 // ReversibleCallValue - Represents any Value that can be reversed when called.
@@ -31,16 +45,58 @@ public:
   virtual Value::OrError getReverse() const = 0;
 };
 
+// BodyCallValue - Represents any Value that may be called by evaluating Fleet
+//  code (its body) in a Context that depends on the argument. The Evaluator
+//  evaluates such bodies itself instead of calling the Value, so that calls of
+//  Fleet functions do not nest on the C++ stack (see Evaluator::run).
+class BodyCallValue {
+public:
+  // A Body is the code to evaluate for a call and the Context to evaluate it
+  //  in. The code belongs to the Value, so it must be kept alive while the
+  //  code is evaluated.
+  struct Body {
+    const TokenTree *code;
+    Context::Pointer context;
+  };
+  typedef std::variant<Error, Body> BodyOrError;
+
+  // hasBody() - Returns a boolean indicating whether the Value is called by
+  //  evaluating a Body. If not, it must be called normally.
+  virtual bool hasBody() const = 0;
+
+  // getBody(arg) - Returns the Body to evaluate in order to call the Value with
+  //  arg, or an error if arg is not a valid argument.
+  virtual BodyOrError getBody(const Value::Pointer &arg) const = 0;
+
+  // checksReturn() - Returns a boolean indicating whether the result of
+  //  evaluating a Body needs to be passed to checkReturn.
+  virtual bool checksReturn() const = 0;
+
+  // checkReturn(result) - Returns result, or an error if it is a Value of the
+  //  wrong type to be returned.
+  virtual Value::OrError checkReturn(const Value::OrError &result) const = 0;
+
+  // getMemoTable() - Returns the MemoTable that remembers the results of
+  //  calls of the Value (see src/MemoTable.hpp), or nullptr if they are not
+  //  remembered.
+  virtual MemoTable *getMemoTable() const = 0;
+
+  virtual ~BodyCallValue() = default;
+};
+
+template <typename P, typename R>
+class FunctionValue;
+
 // FunctionValueBase<P, R> - Should not be used directly. All FunctionValues
 //  inherit from this class; this class is simply used to reduce code 
 //  repetition. However, the public methods in this class can be used on all
 //  FunctionValues.
 template <typename P, typename R>
-class FunctionValueBase: public ReversibleCallValue {
+class FunctionValueBase: public ReversibleCallValue, public BodyCallValue {
 public:
   // These typedefs can be used in place of their respective types.
   typedef std::shared_ptr<R> ReturnPointer;
-  typedef std::variant<std::runtime_error, ReturnPointer> Return;
+  typedef std::variant<Error, ReturnPointer> Return;
   typedef std::function<Return(std::shared_ptr<P>, Context::Pointer)> NativeAction;
   typedef std::variant<TokenTree, NativeAction> Action;
 private:
@@ -48,73 +104,351 @@ private:
 protected:
   const Context::Pointer internalContext;
 private:
-  mutable Evaluator evaluator; // To allow temporary defining of parameters
   bool isNative;
-  std::string paramName;
+  bool pure;
+  Pattern parameter;
+
+  // Whether the parameters of the function and of all of its clauses are
+  //  plain names, which match any argument without looking at it.
+  bool namesOnly;
+
+  // Whether the function and all of its clauses always use their argument
+  //  (see src/StrictnessAnalyzer.hpp).
+  bool strict;
+
+  // The strictness signature declared for a native function (see
+  //  Value::getStrictness).
+  std::vector<bool> strictness;
+
+  // Clauses that were added to the function after it was created. They are
+  //  tried in order if parameter does not match an argument.
+  std::vector<std::shared_ptr<const FunctionValueBase<P, R>>> clauses;
+
+  // The results of calls of the function (including its clauses) that are
+  //  remembered, if any. A copy of the function (see evacuate) shares them.
+  std::shared_ptr<MemoTable> memoTable;
+
+  // Creates the copy of a native function that holds Values, if it can be
+  //  copied (see setCopier).
+  std::function<Value::Pointer(Evacuation &)> copier;
+
+  // The operation on plain numbers that a native function is the same as, if
+  //  any (see Value::getNumericKernel).
+  std::optional<NumericKernel> kernel;
+
+  // checkArgument(arg) - Returns an error if arg is not of type P.
+  static std::optional<Error> checkArgument(
+    const Value::Pointer &arg
+  ) {
+    if (!arg->canCastValue<P>()) {
+      return { Error {
+        Error::Code::ArgumentType, { &P::getClassName, Error::NameOf { arg } }
+      } };
+    }
+    return {};
+  }
+
+  // recursive(function, name, layers) - Returns a copy of function (without
+  //  its clauses) whose code finds name in a new layer over its Context,
+  //  which is added to layers to have name defined in it, if its code uses
+  //  name.
+  static std::shared_ptr<FunctionValue<P, R>> recursive(
+    const FunctionValueBase<P, R> &function, const std::string &name,
+    std::vector<Context::Pointer> &layers
+  ) {
+    const TokenTree &code = *std::get_if<TokenTree>(&function.action);
+    Context::Pointer context = function.internalContext;
+    if (FreeVariables::of(code).count(name) &&
+      !function.parameter.getBoundNames().count(name)) {
+      context = Context::Pointer { Region::make<Context>(context) };
+      layers.push_back(context);
+    }
+    return Region::make<FunctionValue<P, R>>(code, context,
+      function.parameter, function.strict);
+  }
+
 public:
-  // Constructor(func, context, makeNative) - Creates a FunctionValueBase with
-  //  a native function as its action. makeNative (which defaults to true)
-  //  determines whether the function appears to be native within the code.
+  // toParameter(arg) - Returns arg as it is passed to the function. A function
+  //  that takes a ThunkValue can also be called with a Value that is already
+  //  known, which is wrapped in one.
+  static Value::Pointer toParameter(const Value::Pointer &arg) {
+    if constexpr (std::is_same_v<P, ThunkValue>) {
+      return ThunkValue::wrapped(arg);
+    }
+    else {
+      return arg;
+    }
+  }
+
+  // Constructor(func, context, makeNative, makePure, declaredStrictness,
+  //  numericKernel) - Creates a FunctionValueBase with a native function as
+  //  its action. makeNative (which defaults to true) determines whether the
+  //  function appears to be native within the code. makePure (which defaults
+  //  to false) should only be true if func has no effects and depends on
+  //  nothing but its argument. declaredStrictness is the strictness signature
+  //  of func (see Value::getStrictness), which cannot be found by looking at
+  //  it. numericKernel, if given, must compute what func does for numbers.
   FunctionValueBase(
     const NativeAction &func, const Context::Pointer &context,
-    bool makeNative = true
-  ): action { func }, internalContext { context }, evaluator { context },
-    isNative { makeNative }, paramName {""} {}
-  
+    bool makeNative = true, bool makePure = false,
+    const std::vector<bool> &declaredStrictness = {},
+    const std::optional<NumericKernel> &numericKernel = {}
+  ): action { func }, internalContext { context }, isNative { makeNative },
+    pure { makePure }, parameter { std::string {} }, namesOnly { true },
+    strict { false }, strictness { declaredStrictness },
+    kernel { numericKernel } {}
+
   // getReverse() - Functions cannot be reversed unless they return functions. A
   //  specific subclass is used for this case, so by default, functions cannot
   //  be reversed.
   Value::OrError getReverse() const {
-    return {
-      TypeError {
-        std::string { "Cannot reverse function of type " } + getName()
-      }
-    };
+    return { Error {
+      Error::Code::CannotReverse, { &FunctionValueBase<P, R>::getClassName }
+    } };
   }
 
   // call(arg) - Calls the function with the given argument. This will return
   //  an error if the type is incorrect, or it will return the result of the
   //  internal function action.
   Value::OrError call(Value::Pointer arg) const {
-    // Attempt to cast arg to the appropriate parameter type. If it cannot be
-    //  cast, return an error.
-    if (!arg->canCastValue<P>()) {
-      return { TypeError {
-        std::string { "Expected argument of type " } + P::getClassName() +
-          " but got argument of type " + arg->getName()
-      } };
+    arg = toParameter(arg);
+    // If the internal action is Fleet code, evaluate the matching clause with
+    //  its parameter bound to arg.
+    if (hasBody()) {
+      if (memoTable) {
+        const auto &remembered = memoTable->find(arg);
+        if (remembered) {
+          return { remembered };
+        }
+      }
+      const auto &bodyOrErr = getBody(arg);
+      if (std::holds_alternative<Error>(bodyOrErr)) {
+        return { *std::get_if<Error>(&bodyOrErr) };
+      }
+      const auto &body = *std::get_if<Body>(&bodyOrErr);
+      // The body was already optimized along with the code that created it.
+      const auto &result = checkReturn(
+        Evaluator::evaluateIn(*body.code, body.context)
+      );
+      if (memoTable && memoTable->isRemembering() &&
+        std::holds_alternative<Value::Pointer>(result)) {
+        memoTable->remember(arg, *std::get_if<Value::Pointer>(&result));
+        const Region::Pointer region = Region::current();
+        if (region && !region->contains(this)) {
+          Evacuation::escape(memoTable);
+        }
+      }
+      return result;
+    }
+
+    // Otherwise, attempt to cast arg to the appropriate parameter type. If it
+    //  cannot be cast, return an error.
+    const auto &argErr = checkArgument(arg);
+    if (argErr) {
+      return { *argErr };
     }
 
-    // If the internal action is a native C++ function, call it with a pointer
-    //  to the argument.
+    // Call the native C++ function with a pointer to the argument.
     const auto &castArgPtr = std::dynamic_pointer_cast<P>(arg);
-    if (std::holds_alternative<NativeAction>(action)) {
-      const auto &returnVal = (*std::get_if<NativeAction>(&action))(
-        castArgPtr, internalContext
+    const auto &returnVal = (*std::get_if<NativeAction>(&action))(
+      castArgPtr, internalContext
+    );
+    if (std::holds_alternative<Error>(returnVal)) {
+      return { *std::get_if<Error>(&returnVal) };
+    }
+    return { *std::get_if<ReturnPointer>(&returnVal) };
+  }
+
+  // delaysArgument() - Functions that take a ThunkValue take their argument
+  //  lazily. So do functions written in Fleet whose parameters are all plain
+  //  names, since binding a name does not need the Value of the argument,
+  //  unless they always use it anyway or remember their results (which are
+  //  looked up by argument).
+  bool delaysArgument() const {
+    return std::is_same_v<P, ThunkValue> ||
+      (hasBody() && namesOnly && !strict && !memoTable);
+  }
+
+  // getStrictness() - Returns the declared signature of a native function. A
+  //  function written in Fleet needs its argument unless it delays it.
+  std::vector<bool> getStrictness() const {
+    if (!hasBody()) {
+      return strictness;
+    }
+    if (delaysArgument()) {
+      return {};
+    }
+    return { true };
+  }
+
+  // hasBody() - Only functions written in Fleet have a Body.
+  bool hasBody() const {
+    return std::holds_alternative<TokenTree>(action);
+  }
+
+  // getBody(arg) - Finds the first clause whose parameter matches arg and
+  //  returns its code along with the Context binding the parameter to arg.
+  BodyOrError getBody(const Value::Pointer &arg) const {
+    const auto &argErr = checkArgument(arg);
+    if (argErr) {
+      return { *argErr };
+    }
+    const FunctionValueBase<P, R> *clause = this;
+    for (std::size_t i = 0; ; i++) {
+      const auto &bodyContext = clause->parameter.bind(
+        arg, clause->internalContext
       );
-      if (std::holds_alternative<std::runtime_error>(returnVal)) {
-        return { *std::get_if<std::runtime_error>(&returnVal) };
+      if (bodyContext) {
+        return { Body {
+          std::get_if<TokenTree>(&clause->action), *bodyContext
+        } };
       }
-      return { *std::get_if<ReturnPointer>(&returnVal) };
+      if (i == clauses.size()) {
+        break;
+      }
+      clause = clauses[i].get();
     }
+    return { Error {
+      Error::Code::NoMatchingClause, { Error::Shown { arg } }
+    } };
+  }
 
-    // Otherwise, temporarily define the parameter in the function's Context
-    //  and evaluate the internal function code in that Context.
-    evaluator.tempDefine(paramName, arg);
-    const auto &returnValOrErr = evaluator.evaluate(
-      *std::get_if<TokenTree>(&action)
-    );
-    if (std::holds_alternative<std::runtime_error>(returnValOrErr)) {
+  // checksReturn() - Any Value can be returned if R is Value, so there is
+  //  nothing to check in that case.
+  bool checksReturn() const {
+    return !std::is_same_v<R, Value>;
+  }
+
+  // checkReturn(returnValOrErr) - Returns returnValOrErr, or an error if it is
+  //  a Value that is not of type R.
+  Value::OrError checkReturn(const Value::OrError &returnValOrErr) const {
+    if (std::holds_alternative<Error>(returnValOrErr)) {
       return returnValOrErr;
     }
-    Value::Pointer returnVal = *std::get_if<Value::Pointer>(&returnValOrErr);
+    const auto &returnVal = *std::get_if<Value::Pointer>(&returnValOrErr);
     if (!returnVal->canCastValue<R>()) {
-      return { TypeError {
-        std::string { "Expected return value of type " } + R::getClassName() +
-          " but got return value of type " + returnVal->getName()
+      return { Error {
+        Error::Code::ReturnType,
+        { &R::getClassName, Error::NameOf { returnVal } }
       } };
     }
-    return { returnVal };
+    return returnValOrErr;
+  }
+
+  // getNumericKernel() - Returns the NumericKernel of a native function that
+  //  was created with one.
+  const NumericKernel *getNumericKernel() const {
+    return kernel ? &*kernel : nullptr;
+  }
+
+  // getNumericKernels() - A function written in Fleet whose only clause
+  //  takes its argument by name, such as n -> n % 3 < 1, is the same as the
+  //  NumericKernels that its body applies to the argument, if that is all
+  //  the body does (see Evaluator::numericKernelsOf).
+  std::vector<NumericKernel> getNumericKernels() const {
+    if (!hasBody()) {
+      return Value::getNumericKernels();
+    }
+    std::vector<NumericKernel> kernels;
+    if (!clauses.empty() ||
+      parameter.getKind() != Pattern::Kind::Identifier ||
+      !Evaluator::numericKernelsOf(*std::get_if<TokenTree>(&action),
+        static_cast<std::string>(parameter), internalContext, kernels)) {
+      return {};
+    }
+    return kernels;
+  }
+
+  // getMemoTable() - Returns the MemoTable of the function, if any.
+  MemoTable *getMemoTable() const {
+    return memoTable.get();
+  }
+
+  // memoize(table) - Makes the function remember the results of its calls in
+  //  the given table from now on. Returns false (and does nothing) if the
+  //  function is native or already remembers its results. Since Fleet code has
+  //  no effects, this never changes what the function returns.
+  bool memoize(std::unique_ptr<MemoTable> table) {
+    if (!hasBody() || memoTable) {
+      return false;
+    }
+    memoTable = std::move(table);
+    return true;
+  }
+
+  // evacuate(evacuation) - Returns a copy of a function written in Fleet with
+  //  its code, Context and clauses evacuated, which shares its MemoTable (if
+  //  any), or the copy that the copier of a native function creates. Other
+  //  native functions cannot be copied, since their actions may hold Values.
+  Value::Pointer evacuate(Evacuation &evacuation) const {
+    if (!hasBody()) {
+      return copier ? copier(evacuation) : nullptr;
+    }
+    const auto copy = std::make_shared<FunctionValue<P, R>>(
+      evacuation.tree(*std::get_if<TokenTree>(&action)),
+      evacuation.context(internalContext), parameter, strict
+    );
+    FunctionValueBase<P, R> &copied = *copy;
+    for (const auto &clause : clauses) {
+      copied.clauses.push_back(
+        std::static_pointer_cast<const FunctionValueBase<P, R>>(
+          evacuation.value(
+            std::const_pointer_cast<FunctionValueBase<P, R>>(clause)
+          )
+        )
+      );
+    }
+    copied.namesOnly = namesOnly;
+    copied.memoTable = memoTable;
+    if (memoTable) {
+      const std::shared_ptr<MemoTable> table = memoTable;
+      evacuation.later([table, &evacuation] {
+        table->evacuate(evacuation);
+      });
+    }
+    return copy;
+  }
+
+  // setCopier(copier) - Makes evacuate copy the native function with copier,
+  //  which must return a function that does what this one does, with the
+  //  Values that it holds evacuated.
+  void setCopier(const std::function<Value::Pointer(Evacuation &)> &copier) {
+    this->copier = copier;
+  }
+
+  // withClause(clause, name) - Returns a new function, defined as name, that
+  //  tries the clauses of this function and then those of clause (another
+  //  function defined as name), or nullptr if either function is native.
+  //  Neither function is changed, so a function that was already used as
+  //  this one (or as clause) keeps its clauses. name stands for the new
+  //  function in each of its clauses, and it remembers what this function
+  //  remembered, since the clauses of this function are tried first.
+  std::shared_ptr<FunctionValue<P, R>> withClause(
+    const std::shared_ptr<const FunctionValueBase<P, R>> &clause,
+    const std::string &name
+  ) const {
+    if (!hasBody() || !clause->hasBody()) {
+      return nullptr;
+    }
+    std::vector<Context::Pointer> layers;
+    const auto combined = recursive(*this, name, layers);
+    FunctionValueBase<P, R> &base = *combined;
+    for (const auto &existing : clauses) {
+      base.clauses.push_back(recursive(*existing, name, layers));
+    }
+    base.clauses.push_back(recursive(*clause, name, layers));
+    for (const auto &added : clause->clauses) {
+      base.clauses.push_back(recursive(*added, name, layers));
+    }
+    base.namesOnly = namesOnly && clause->namesOnly;
+    base.strict = strict && clause->strict;
+    if (memoTable) {
+      base.memoTable = std::make_shared<MemoTable>(*memoTable);
+    }
+    for (const auto &layer : layers) {
+      layer->define(name, combined);
+    }
+    return combined;
   }
 
   // A function's "name" is a string representation of its type signature.
@@ -130,13 +464,17 @@ public:
     return P::getClassName() + "->" + R::getClassName();
   }
 
-  // Constructor(ast, context, param) - Creates a function with its internal
-  //  Fleet code as ast, its Context as context, and the name of its parameter
-  //  as param.
+  // Constructor(ast, context, param, makeStrict) - Creates a function with its
+  //  internal Fleet code as ast, its Context as context, and its parameter as
+  //  param. makeStrict (which defaults to false) should only be true if ast
+  //  always uses the Value of param, which is then passed already evaluated.
   FunctionValueBase(
-    const TokenTree &ast, const Context::Pointer &context, std::string param
-  ): action { ast }, internalContext { context }, evaluator { context },
-    isNative { false }, paramName { param } {}
+    const TokenTree &ast, const Context::Pointer &context, const Pattern &param,
+    bool makeStrict = false
+  ): action { ast }, internalContext { context }, isNative { false },
+    pure { false }, parameter { param },
+    namesOnly { param.getKind() == Pattern::Kind::Identifier },
+    strict { makeStrict } {}
 
   // getIsNative() - Returns a boolean indicating whether the function should
   //  look like a native function to the code. Functions actually coded with
@@ -145,6 +483,13 @@ public:
     return isNative;
   }
 
+  // isPure() - Returns a boolean indicating whether the function was created
+  //  as pure. Functions written in Fleet are never considered pure, since
+  //  their bodies may define variables.
+  bool isPure() const {
+    return pure;
+  }
+
   // operator std::string() - Returns a string representation of the type.
   //  Returns "<Native [type]>" if the function should look native, or
   //  "<Function [type]>" if it should not.
@@ -173,8 +518,8 @@ template <typename P1, typename P2, typename RFinal>
 class FunctionValueReversible:
   public FunctionValueBase<P1, FunctionValue<P2, RFinal>> {
 private:
-  typedef std::variant<std::runtime_error, std::shared_ptr<RFinal>> FinalReturn;
-  typedef std::variant<std::runtime_error, std::shared_ptr<FunctionValue<
+  typedef std::variant<Error, std::shared_ptr<RFinal>> FinalReturn;
+  typedef std::variant<Error, std::shared_ptr<FunctionValue<
     P1, RFinal
   >>> FirstReturn;
 public:
@@ -199,10 +544,10 @@ public:
               // Call the original function with the first parameter. If it
               //  returns an error, return that error.
               const auto &firstResultOrErr = this->call(firstParam);
-              if (std::holds_alternative<std::runtime_error>(
+              if (std::holds_alternative<Error>(
                 firstResultOrErr
               )) {
-                return { *std::get_if<std::runtime_error>(&firstResultOrErr) };
+                return { *std::get_if<Error>(&firstResultOrErr) };
               }
               const auto &firstResult = *std::get_if<Value::Pointer>(
                 &firstResultOrErr
@@ -212,10 +557,10 @@ public:
               //  returns an error, return that error. Otherwise, return the
               //  resulting Value.
               const auto &finalResultOrErr = firstResult->call(secondParam);
-              if (std::holds_alternative<std::runtime_error>(
+              if (std::holds_alternative<Error>(
                 finalResultOrErr
               )) {
-                return { *std::get_if<std::runtime_error>(&finalResultOrErr) };
+                return { *std::get_if<Error>(&finalResultOrErr) };
               }
               const auto &finalResult = *std::get_if<Value::Pointer>(
                 &finalResultOrErr
@@ -226,11 +571,9 @@ public:
 
               // Ensure that the correct type is returned.
               if (!finalResultCast) {
-                return FinalReturn { TypeError {
-                  std::string { "Expected return value of type " } +
-                  RFinal::name + " but got return value of type " +
-                  finalResult->getName()
-                } };
+                return FinalReturn { Error { Error::Code::ReturnType, {
+                  &RFinal::getClassName, Error::NameOf { finalResult }
+                } } };
               }
               return FinalReturn { finalResultCast };
             },
@@ -254,10 +597,12 @@ class FunctionValue<IdentifierValue, R>: public FunctionValueBase<
 public:
   using FunctionValueBase<IdentifierValue, R>::FunctionValueBase;
   using FunctionValueBase<IdentifierValue, R>::call;
-  Value::OrError call(const TokenTree &ast,
-    [[maybe_unused]] const Evaluator *eval) const {
+  bool quotesArgument() const {
+    return true;
+  }
+  Value::OrError call(const TokenTree &ast, const Evaluator *eval) const {
     return FunctionValueBase<IdentifierValue, R>::call(
-      Value::Pointer { new IdentifierValue { ast } }
+      Region::make<IdentifierValue>(ast, eval->getContext())
     );
   }
 };
@@ -267,12 +612,237 @@ class FunctionValue<IdentifierValue, FunctionValue<P, R>>:
   public FunctionValueReversible<IdentifierValue, P, R> {
   using FunctionValueReversible<IdentifierValue, P, R>::FunctionValueReversible;
   using FunctionValueReversible<IdentifierValue, P, R>::call;
-  Value::OrError call(const TokenTree &ast,
-    [[maybe_unused]] const Evaluator *eval) const {
+  bool quotesArgument() const {
+    return true;
+  }
+  Value::OrError call(const TokenTree &ast, const Evaluator *eval) const {
     return FunctionValueReversible<IdentifierValue, P, R>::call(
-      Value::Pointer { new IdentifierValue { ast } }
+      Region::make<IdentifierValue>(ast, eval->getContext())
     );
   }
 };
 
+// BinaryCallValue - Represents any Value that, when called with an argument,
+//  returns a function that is immediately called with a second argument. In
+//  a call (f x) y, the intermediate function (f x) is only ever used as the
+//  function of the outer call, so it does not escape. Values implementing this
+//  interface can produce the result of the whole call directly, without
+//  creating the intermediate function at all.
+class BinaryCallValue {
+public:
+  // quotesFirst(), quotesSecond() - Return a boolean indicating whether the
+  //  first or second argument is taken unevaluated, as an IdentifierValue.
+  virtual bool quotesFirst() const = 0;
+  virtual bool quotesSecond() const = 0;
+
+  // delaysFirst(), delaysSecond() - Return a boolean indicating whether the
+  //  first or second argument is taken lazily, as a ThunkValue.
+  virtual bool delaysFirst() const = 0;
+  virtual bool delaysSecond() const = 0;
+
+  // callBinary(x, y) - Returns the same result as calling the Value with x and
+  //  then calling the result with y.
+  virtual Value::OrError callBinary(
+    const Value::Pointer &x, const Value::Pointer &y
+  ) const = 0;
+
+  // virtual getNumericOp() - Returns the operator on numbers that callBinary
+  //  is, with its arguments in the same order, if any, so that it can be
+  //  applied to plain doubles instead (see src/SequenceValue.hpp).
+  virtual std::optional<NumericKernel::Op> getNumericOp() const {
+    return {};
+  }
+
+  virtual ~BinaryCallValue() = default;
+};
+
+// BinaryFunctionValue<P1, P2, R> - A native FunctionValue that takes a P1 and
+//  returns a function taking a P2 and returning an R. In addition to being
+//  callable like any other FunctionValue, it can be called with both arguments
+//  at once (see BinaryCallValue), and it can be reversed, as in (* 2).
+template <typename P1, typename P2, typename R>
+class BinaryFunctionValue: public FunctionValue<P1, FunctionValue<P2, R>>,
+  public BinaryCallValue {
+public:
+  // A BinaryAction is the native function that receives both arguments.
+  typedef std::function<typename FunctionValue<P2, R>::Return(
+    const std::shared_ptr<P1> &,
+    const std::shared_ptr<P2> &,
+    const Context::Pointer &
+  )> BinaryAction;
+private:
+  const BinaryAction binaryAction;
+
+  // The operator on numbers that binaryAction is, if any, and whether its
+  //  arguments are taken in the opposite order (as by getReverse).
+  const std::optional<NumericKernel::Op> kernelOp;
+  const bool reversed;
+
+  // curry(binaryFunc, pure, strictness, op, reversed) - Returns the action of
+  //  a function that takes the first argument of binaryFunc and returns a
+  //  function taking the second. Calling a binary function with one argument
+  //  creates such a function, so (+) 2 is its own unique FunctionValue. If
+  //  binaryFunc is the operator op, calling it with a number gives a function
+  //  with a NumericKernel for op.
+  static typename FunctionValue<P1, FunctionValue<P2, R>>::NativeAction curry(
+    const BinaryAction &binaryFunc, bool pure,
+    const std::vector<bool> &strictness,
+    const std::optional<NumericKernel::Op> &op, bool reversed
+  ) {
+    // The function taking the second argument has the rest of the signature.
+    const std::vector<bool> rest { strictness.size() > 1 ?
+      std::vector<bool> { strictness.begin() + 1, strictness.end() } :
+      std::vector<bool> {} };
+    return [binaryFunc, pure, rest, op, reversed](
+      const std::shared_ptr<P1> &x, const Context::Pointer &context
+    ) {
+      std::optional<NumericKernel> kernel;
+      if constexpr (std::is_same_v<P1, NumberValue>) {
+        if (op) {
+          kernel.emplace(*op, x->getRawNumber(), !reversed);
+        }
+      }
+      else if constexpr (std::is_same_v<P1, Value>) {
+        // An operator on any Values, such as `==`, only has a kernel when it
+        //  is called with a number.
+        const auto number = dynamic_cast<const NumberValue *>(x.get());
+        if (op && number) {
+          kernel.emplace(*op, number->getRawNumber(), !reversed);
+        }
+      }
+      return typename FunctionValue<P1, FunctionValue<P2, R>>::Return {
+        partial(binaryFunc, x, context, pure, rest, kernel)
+      };
+    };
+  }
+
+  // partial(binaryFunc, x, context, pure, strictness, kernel) - Returns the
+  //  function taking the second argument of binaryFunc, given x as its first.
+  //  Its copy (see FunctionValueBase::evacuate) is the same function given
+  //  the copy of x.
+  static std::shared_ptr<FunctionValue<P2, R>> partial(
+    const BinaryAction &binaryFunc, const std::shared_ptr<P1> &x,
+    const Context::Pointer &context, bool pure,
+    const std::vector<bool> &strictness,
+    const std::optional<NumericKernel> &kernel
+  ) {
+    const auto function = Region::make<FunctionValue<P2, R>>(
+      typename FunctionValue<P2, R>::NativeAction {
+        [x, binaryFunc](
+          const std::shared_ptr<P2> &y,
+          const Context::Pointer &context
+        ) -> typename FunctionValue<P2, R>::Return {
+          return binaryFunc(x, y, context);
+        }
+      },
+      context, true, pure, strictness, kernel
+    );
+    function->setCopier([binaryFunc, x, context, pure, strictness, kernel](
+      Evacuation &evacuation
+    ) -> Value::Pointer {
+      return partial(binaryFunc,
+        std::static_pointer_cast<P1>(evacuation.value(x)),
+        evacuation.context(context), pure, strictness, kernel);
+    });
+    return function;
+  }
+public:
+  // Constructor(binaryFunc, context, makePure, declaredStrictness, op,
+  //  makeReversed) - Creates a BinaryFunctionValue whose two-argument action
+  //  is binaryFunc. makePure and declaredStrictness (which says whether each
+  //  of the two arguments is always needed) are the same as for other
+  //  FunctionValues, and they also apply to the functions that result from
+  //  calling the BinaryFunctionValue with one argument. op should only be
+  //  given if binaryFunc is that operator on two numbers (taken in the
+  //  opposite order if makeReversed), so that the functions that result from
+  //  calling it with a number have a NumericKernel.
+  BinaryFunctionValue(
+    const BinaryAction &binaryFunc, const Context::Pointer &context,
+    bool makePure = false, const std::vector<bool> &declaredStrictness = {},
+    const std::optional<NumericKernel::Op> &op = {}, bool makeReversed = false
+  ): FunctionValue<P1, FunctionValue<P2, R>> {
+      curry(binaryFunc, makePure, declaredStrictness, op, makeReversed),
+      context, true, makePure, declaredStrictness
+    }, binaryAction { binaryFunc }, kernelOp { op },
+    reversed { makeReversed } {}
+
+  // evacuate(evacuation) - Returns a copy of the BinaryFunctionValue, whose
+  //  action holds no Values.
+  Value::Pointer evacuate(Evacuation &evacuation) const {
+    return Value::Pointer { std::make_shared<BinaryFunctionValue<P1, P2, R>>(
+      binaryAction, evacuation.context(this->internalContext),
+      this->isPure(), this->getStrictness(), kernelOp, reversed
+    ) };
+  }
+
+  // getReverse() - Returns a BinaryFunctionValue that takes the same arguments
+  //  in the opposite order.
+  Value::OrError getReverse() const {
+    const BinaryAction &binaryFunc = binaryAction;
+    std::vector<bool> strictness = this->getStrictness();
+    strictness.resize(2, false);
+    return { Value::Pointer { Region::make<BinaryFunctionValue<P2, P1, R>>(
+      [binaryFunc](
+        const std::shared_ptr<P2> &y, const std::shared_ptr<P1> &x,
+        const Context::Pointer &context
+      ) {
+        return binaryFunc(x, y, context);
+      },
+      this->internalContext, this->isPure(),
+      std::vector<bool> { strictness[1], strictness[0] }, kernelOp, !reversed
+    ) } };
+  }
+
+  // quotesFirst(), quotesSecond() - IdentifierValue parameters are quoted.
+  bool quotesFirst() const {
+    return std::is_same_v<P1, IdentifierValue>;
+  }
+  bool quotesSecond() const {
+    return std::is_same_v<P2, IdentifierValue>;
+  }
+
+  // delaysFirst(), delaysSecond() - ThunkValue parameters are delayed.
+  bool delaysFirst() const {
+    return std::is_same_v<P1, ThunkValue>;
+  }
+  bool delaysSecond() const {
+    return std::is_same_v<P2, ThunkValue>;
+  }
+
+  // callBinary(x, y) - Checks the types of both arguments and calls the
+  //  two-argument action with them.
+  Value::OrError callBinary(
+    const Value::Pointer &first, const Value::Pointer &second
+  ) const {
+    const Value::Pointer &x = FunctionValue<P1, FunctionValue<P2, R>>::
+      toParameter(first);
+    const Value::Pointer &y = FunctionValue<P2, R>::toParameter(second);
+    if (!x->canCastValue<P1>()) {
+      return { Error {
+        Error::Code::ArgumentType, { &P1::getClassName, Error::NameOf { x } }
+      } };
+    }
+    if (!y->canCastValue<P2>()) {
+      return { Error {
+        Error::Code::ArgumentType, { &P2::getClassName, Error::NameOf { y } }
+      } };
+    }
+    const auto &returnVal = binaryAction(
+      std::static_pointer_cast<P1>(x), std::static_pointer_cast<P2>(y),
+      this->internalContext
+    );
+    if (std::holds_alternative<Error>(returnVal)) {
+      return { *std::get_if<Error>(&returnVal) };
+    }
+    return { *std::get_if<typename FunctionValue<P2, R>::ReturnPointer>(
+      &returnVal
+    ) };
+  }
+
+  // getNumericOp() - Returns op unless the arguments are reversed.
+  std::optional<NumericKernel::Op> getNumericOp() const {
+    return reversed ? std::nullopt : kernelOp;
+  }
+};
+
 #endif
@@ -6,11 +6,26 @@
 #include <string>
 #include <vector>
 #include "IdentifierValue.hpp"
+#include "Context.hpp"
+#include "Error.hpp"
+#include "MaybeSharedPtr.hpp"
 #include "TokenTree.hpp"
 #include "Value.hpp"
 
 // Constructor
-IdentifierValue::IdentifierValue(const TokenTree &ast): tree { new TokenTree { ast } } {}
+IdentifierValue::IdentifierValue(const TokenTree &ast,
+  const MaybeSharedPtr<Context> &context):
+  tree { new TokenTree { ast } }, context { context } {}
+
+// getTree() - Returns the internal token tree.
+const TokenTree &IdentifierValue::getTree() const {
+  return *tree;
+}
+
+// getContext() - Returns the Context the internal token tree appeared in.
+const MaybeSharedPtr<Context> &IdentifierValue::getContext() const {
+  return context;
+}
 
 // operator string() - Returns the string representation of the internal token
 //  tree.
@@ -18,13 +33,14 @@ IdentifierValue::operator std::string() const {
   return static_cast<std::string>(*tree);
 }
 
-// call([unused] arg) - Returns an error, since NumberValues cannot be called.
+// call([unused] arg) - Returns an error, since IdentifierValues cannot be
+//  called.
 Value::OrError IdentifierValue::call(
   [[maybe_unused]] Value::Pointer arg
 ) const {
-  return { std::runtime_error { std::string {
-    "Value of type "
-  } + name + " cannot be called" } };
+  return { Error {
+    Error::Code::NotCallable, { &IdentifierValue::getClassName }
+  } };
 }
 
 const std::string IdentifierValue::name { "Identifier" };
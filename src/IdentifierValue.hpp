@@ -8,20 +8,33 @@
 #include <optional>
 #include <string>
 #include <vector>
+#include "MaybeSharedPtr.hpp"
 #include "TokenTree.hpp"
 #include "Value.hpp"
 
+class Context;
+
 class IdentifierValue: public Value, public TokenTreeVisitor<std::optional<
   std::string>> {
 
 private:
   TokenTree::TreePointer tree;
+  MaybeSharedPtr<Context> context;
   mutable Value::Pointer tempValue;
 
 public:
-  // Constructor(ast) - Creates an IdentifierValue with a given TokenTree
-  //  representation.
-  IdentifierValue(const TokenTree &ast);
+  // Constructor(ast, context) - Creates an IdentifierValue with a given
+  //  TokenTree representation. context is the Context in which the TokenTree
+  //  appeared, if known.
+  IdentifierValue(const TokenTree &ast,
+    const MaybeSharedPtr<Context> &context = MaybeSharedPtr<Context> {});
+
+  // getTree() - Returns the TokenTree that the IdentifierValue represents.
+  const TokenTree &getTree() const;
+
+  // getContext() - Returns the Context in which the TokenTree appeared. This
+  //  may be a null pointer if the Context is not known.
+  const MaybeSharedPtr<Context> &getContext() const;
 
   // operator string() - Returns the string representation of the identifier.
   operator std::string() const;
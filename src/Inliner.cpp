@@ -0,0 +1,546 @@
+// File: src/Inliner.cpp
+// Purpose: Source file for Inliners, which replace calls of small functions
+//  with the bodies of the functions ahead of time. See src/Inliner.hpp for more
+//  documentation.
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "Inliner.hpp"
+#include "Context.hpp"
+#include "FreeVariables.hpp"
+#include "RuntimeStats.hpp"
+#include "Token.hpp"
+#include "TokenTree.hpp"
+#include "Value.hpp"
+
+// Constructor(context, options, ast) - Creates an Inliner for ast in context.
+//  The names that ast binds anywhere but in definitions at its top level (i.e.
+//  parameters and names defined within blocks) are local names, which may mean
+//  something different in one place than in another (the builtins that build
+//  tuple literals are quoted in tuple Patterns, but never bound by them).
+//  Functions are counted by the number of times they are defined, since a
+//  function defined more than once has more than one clause.
+Inliner::Inliner(const Context::Pointer &context, const Options &options,
+  const TokenTree &ast): context { context }, options { options },
+  commonNames { 0 } {
+  std::vector<std::tuple<const TokenTree *, bool, bool>> pending;
+  if (const auto lines = ast.getLineListPointer()) {
+    for (const auto &line : *lines) {
+      pending.push_back({ line.get(), false, true });
+    }
+  }
+  else {
+    pending.push_back({ &ast, false, true });
+  }
+  while (!pending.empty()) {
+    const auto [tree, quoted, topLevel] = pending.back();
+    pending.pop_back();
+    const auto [name, value] = asDefinition(*tree);
+    if (name) {
+      definitionCounts[name->getValue()]++;
+    }
+    if (const auto token = tree->getTokenPointer()) {
+      if (quoted && (token->getType() == Token::Type::Identifier ||
+          token->getType() == Token::Type::Operator) &&
+          token->getValue() != "(,)" && token->getValue() != "(,+)") {
+        localNames.insert(token->getValue());
+      }
+    }
+    else if (name && topLevel) {
+      pending.push_back({ value.get(), false, false });
+    }
+    else if (const auto pair = tree->getFunctionPairPointer()) {
+      if (pair->first && pair->second) {
+        pending.push_back({ pair->first.get(), quoted, false });
+        pending.push_back({ pair->second.get(),
+          quoted || quotesArgument(*pair->first), false });
+      }
+    }
+    else if (const auto lines = tree->getLineListPointer()) {
+      for (const auto &line : *lines) {
+        pending.push_back({ line.get(), quoted, false });
+      }
+    }
+  }
+}
+
+// sizeOf(tree, limit) - Returns the number of Tokens in tree, counting no
+//  further than one more than limit.
+std::size_t Inliner::sizeOf(const TokenTree &tree, std::size_t limit) {
+  std::size_t size = 0;
+  std::vector<const TokenTree *> pending { &tree };
+  while (!pending.empty() && size <= limit) {
+    const TokenTree *next = pending.back();
+    pending.pop_back();
+    if (next->getTokenPointer()) {
+      size++;
+    }
+    else if (const auto pair = next->getFunctionPairPointer()) {
+      if (pair->first && pair->second) {
+        pending.push_back(pair->first.get());
+        pending.push_back(pair->second.get());
+      }
+    }
+    else if (const auto lines = next->getLineListPointer()) {
+      for (const auto &line : *lines) {
+        pending.push_back(line.get());
+      }
+    }
+  }
+  return size;
+}
+
+// definesNames(tree) - Returns a boolean indicating whether tree uses `=`, and
+//  so may define names as it is evaluated.
+bool Inliner::definesNames(const TokenTree &tree) {
+  std::vector<const TokenTree *> pending { &tree };
+  while (!pending.empty()) {
+    const TokenTree *next = pending.back();
+    pending.pop_back();
+    if (const auto token = next->getTokenPointer()) {
+      if (token->getType() == Token::Type::Operator &&
+          token->getValue() == "=") {
+        return true;
+      }
+    }
+    else if (const auto pair = next->getFunctionPairPointer()) {
+      if (pair->first && pair->second) {
+        pending.push_back(pair->first.get());
+        pending.push_back(pair->second.get());
+      }
+    }
+    else if (const auto lines = next->getLineListPointer()) {
+      for (const auto &line : *lines) {
+        pending.push_back(line.get());
+      }
+    }
+  }
+  return false;
+}
+
+// asCall(tree, op) - Returns the first argument and then the second argument
+//  of tree if it is a call of the operator op with both of them, or nullptrs
+//  otherwise.
+std::pair<const TokenTree *, TokenTree::TreePointer> Inliner::asCall(
+  const TokenTree &tree, const std::string &op) {
+  const auto pair = tree.getBindingPointer() ? nullptr :
+    tree.getFunctionPairPointer();
+  if (!pair || !pair->first || !pair->second) {
+    return { nullptr, nullptr };
+  }
+  const auto inner = pair->first->getFunctionPairPointer();
+  if (!inner || !inner->first || !inner->second) {
+    return { nullptr, nullptr };
+  }
+  const auto token = inner->first->getTokenPointer();
+  if (!token || token->getType() != Token::Type::Operator ||
+      token->getValue() != op) {
+    return { nullptr, nullptr };
+  }
+  return { inner->second.get(), pair->second };
+}
+
+// asFunction(tree) - Returns the parameter Token and the body of tree if it is
+//  a function of the form `param -> body` whose parameter is a Token, or
+//  nullptrs otherwise.
+std::pair<const Token *, TokenTree::TreePointer> Inliner::asFunction(
+  const TokenTree &tree) {
+  const auto [param, body] = asCall(tree, "->");
+  if (!param || !param->getTokenPointer()) {
+    return { nullptr, nullptr };
+  }
+  return { param->getTokenPointer(), body };
+}
+
+// asDefinition(tree) - Returns the name Token and the value of tree if it is a
+//  definition of the form `name = value` whose name is an identifier, or
+//  nullptrs otherwise.
+std::pair<const Token *, TokenTree::TreePointer> Inliner::asDefinition(
+  const TokenTree &tree) {
+  const auto [name, value] = asCall(tree, "=");
+  if (!name || !name->getTokenPointer() ||
+      name->getTokenPointer()->getType() != Token::Type::Identifier) {
+    return { nullptr, nullptr };
+  }
+  return { name->getTokenPointer(), value };
+}
+
+// quotesArgument(f) - Returns a boolean indicating whether f is the name of a
+//  function in the Context that takes its argument unevaluated.
+bool Inliner::quotesArgument(const TokenTree &f) const {
+  const auto token = f.getTokenPointer();
+  if (!token || (token->getType() != Token::Type::Identifier &&
+      token->getType() != Token::Type::Operator)) {
+    return false;
+  }
+  const auto &valueOrErr = context->getValue(token->getValue());
+  return std::holds_alternative<Value::Pointer>(valueOrErr) &&
+    (*std::get_if<Value::Pointer>(&valueOrErr))->quotesArgument();
+}
+
+// define(line) - Makes the function that line defines available for inlining
+//  into the lines after it if it is defined only once, is small enough, and
+//  only refers to names that mean the same thing everywhere: builtins and
+//  other names defined at the top level, but not itself. A name that is
+//  already defined in the Context would get another clause, so it is never
+//  inlined.
+void Inliner::define(const TokenTree::TreePointer &line) {
+  const auto [name, function] = asDefinition(*line);
+  if (!name || options.maxInlineSize == 0) {
+    return;
+  }
+  const auto [param, body] = asFunction(*function);
+  if (!param || param->getType() != Token::Type::Identifier ||
+      definitionCounts[name->getValue()] != 1 ||
+      localNames.count(name->getValue()) != 0 ||
+      std::holds_alternative<Value::Pointer>(
+        context->getValue(name->getValue())
+      ) || sizeOf(*body, options.maxInlineSize) > options.maxInlineSize) {
+    return;
+  }
+  std::set<std::string> names = FreeVariables::of(*body);
+  names.erase(param->getValue());
+  for (const auto &other : names) {
+    if (other == name->getValue() || localNames.count(other) != 0) {
+      return;
+    }
+  }
+  definitions[name->getValue()] = { param->getValue(), body };
+}
+
+// apply(f, x) - Returns a Binding that gives the same result as calling f with
+//  x if f is a function of the form `param -> body` or a Binding resulting in
+//  one, or nullptr otherwise. The argument is moved into a Binding only if it
+//  does not refer to the name bound there.
+TokenTree::TreePointer Inliner::apply(const TokenTree::TreePointer &f,
+  const TokenTree::TreePointer &x) const {
+  if (const auto binding = f->getBindingPointer()) {
+    if (FreeVariables::of(*x).count(binding->name) != 0) {
+      return nullptr;
+    }
+    const TokenTree::TreePointer body = apply(binding->body, x);
+    return body ? std::make_shared<TokenTree>(binding->name, binding->value,
+      body) : nullptr;
+  }
+  const auto [param, body] = asFunction(*f);
+  if (!param) {
+    return applyTuple(f, x);
+  }
+  if (param->getType() != Token::Type::Identifier) {
+    return nullptr;
+  }
+  RuntimeStats::current().recordBetaReduction();
+  return std::make_shared<TokenTree>(param->getValue(), x, body);
+}
+
+// tupleOf(tree) - Returns the elements of tree if it is a tuple literal (see
+//  TokenTree::tupleOf), or no elements otherwise.
+std::vector<TokenTree::TreePointer> Inliner::tupleOf(const TokenTree &tree) {
+  std::vector<TokenTree::TreePointer> elements;
+  const TokenTree *rest = &tree;
+  while (true) {
+    const auto [first, last] = asCall(*rest, "(,+)");
+    if (first) {
+      elements.push_back(last);
+      rest = first;
+      continue;
+    }
+    const auto pair = rest->getBindingPointer() ? nullptr :
+      rest->getFunctionPairPointer();
+    const auto call = pair && pair->first && pair->second ?
+      pair->first->getFunctionPairPointer() : nullptr;
+    const auto op = call && call->first && call->second ?
+      call->first->getTokenPointer() : nullptr;
+    if (!op || op->getType() != Token::Type::Operator ||
+        op->getValue() != "(,)") {
+      return {};
+    }
+    elements.push_back(pair->second);
+    elements.push_back(call->second);
+    return { elements.rbegin(), elements.rend() };
+  }
+}
+
+// applyTuple(f, x) - Like apply, but for a function of the form
+//  `(a, b, ...) -> body` whose Pattern only names its elements, called with a
+//  tuple literal of as many elements (or a Binding resulting in one). Each
+//  name is bound to its element in a strict Binding, since building the tuple
+//  would have evaluated every element, and the tuple is never built.
+TokenTree::TreePointer Inliner::applyTuple(const TokenTree::TreePointer &f,
+  const TokenTree::TreePointer &x) const {
+  const auto [pattern, body] = asCall(*f, "->");
+  if (!pattern) {
+    return nullptr;
+  }
+  if (const auto binding = x->getBindingPointer()) {
+    if (FreeVariables::of(*f).count(binding->name) != 0) {
+      return nullptr;
+    }
+    const TokenTree::TreePointer reduced = applyTuple(f, binding->body);
+    return reduced ? std::make_shared<TokenTree>(binding->name,
+      binding->value, reduced, binding->strict) : nullptr;
+  }
+  const std::vector<TokenTree::TreePointer> &params = tupleOf(*pattern);
+  const std::vector<TokenTree::TreePointer> &elements = tupleOf(*x);
+  if (params.empty() || params.size() != elements.size()) {
+    return nullptr;
+  }
+  std::set<std::string> names;
+  for (const auto &param : params) {
+    const auto token = param->getTokenPointer();
+    if (!token || token->getType() != Token::Type::Identifier ||
+        !names.insert(token->getValue()).second) {
+      return nullptr;
+    }
+  }
+  for (const auto &element : elements) {
+    for (const auto &name : FreeVariables::of(*element)) {
+      if (names.count(name) != 0) {
+        return nullptr;
+      }
+    }
+  }
+  TokenTree::TreePointer reduced = body;
+  for (std::size_t i = params.size(); i-- > 0; ) {
+    reduced = std::make_shared<TokenTree>(
+      params[i]->getTokenPointer()->getValue(), elements[i], reduced, true
+    );
+  }
+  RuntimeStats::current().recordBetaReduction();
+  return reduced;
+}
+
+// rewriteCall(tree, f, x) - Rewrites the call tree of f with x, whose parts
+//  have already been rewritten. Calls of inlined functions become Bindings,
+//  calls of functions that are written where they are called are reduced, and
+//  the bodies of functions share their repeated subexpressions.
+TokenTree::TreePointer Inliner::rewriteCall(const TokenTree::TreePointer &tree,
+  const TokenTree::TreePointer &f, const TokenTree::TreePointer &x) {
+  const auto pair = tree->getFunctionPairPointer();
+  TokenTree::TreePointer argument = x;
+  if (!x->isImplied()) {
+    const auto token = f->getTokenPointer();
+    const auto arrow = f->getFunctionPairPointer();
+    if (arrow && arrow->first && arrow->first->getTokenPointer() &&
+        arrow->first->getTokenPointer()->getValue() == "->") {
+      argument = shareCommon(x);
+    }
+    else if (token && token->getType() == Token::Type::Identifier &&
+        definitions.count(token->getValue()) != 0) {
+      const Definition &definition = definitions.at(token->getValue());
+      RuntimeStats::current().recordInlined(token->getValue());
+      return std::make_shared<TokenTree>(definition.param, x, definition.body);
+    }
+    else if (options.betaReduce) {
+      if (const auto reduced = apply(f, x)) {
+        return reduced;
+      }
+    }
+  }
+  return f == pair->first && argument == pair->second ? tree :
+    std::make_shared<TokenTree>(f, argument);
+}
+
+// rewrite(tree) - Rewrites tree from its leaves up. Like the ConstantFolder,
+//  the Inliner keeps the TokenTrees it has yet to finish on its own stack, so
+//  that it does not recurse on the C++ stack.
+TokenTree::TreePointer Inliner::rewrite(const TokenTree::TreePointer &tree) {
+  struct Step {
+    TokenTree::TreePointer tree;
+    bool quoted;
+    bool expanded;
+  };
+  std::vector<Step> steps { { tree, false, false } };
+  std::vector<TokenTree::TreePointer> results;
+  while (!steps.empty()) {
+    Step step = steps.back();
+    steps.pop_back();
+    const bool opaque = step.tree->getConstantPointer() ||
+      step.tree->getBindingPointer();
+    const auto pair = opaque ? nullptr : step.tree->getFunctionPairPointer();
+    const auto lines = opaque ? nullptr : step.tree->getLineListPointer();
+    if (step.quoted || (pair && (!pair->first || !pair->second))) {
+      results.push_back(step.tree);
+    }
+    else if (pair && !step.expanded) {
+      steps.push_back({ step.tree, false, true });
+      steps.push_back({ pair->second, quotesArgument(*pair->first), false });
+      steps.push_back({ pair->first, false, false });
+    }
+    else if (pair) {
+      const TokenTree::TreePointer x = std::move(results.back());
+      results.pop_back();
+      const TokenTree::TreePointer f = std::move(results.back());
+      results.pop_back();
+      results.push_back(rewriteCall(step.tree, f, x));
+    }
+    else if (lines && !step.expanded) {
+      steps.push_back({ step.tree, false, true });
+      for (std::size_t i = lines->size(); i-- > 0; ) {
+        steps.push_back({ (*lines)[i], false, false });
+      }
+    }
+    else if (lines) {
+      const std::size_t first = results.size() - lines->size();
+      const TokenTree::LineList rewritten { results.begin() + first,
+        results.end() };
+      results.resize(first);
+      results.push_back(rewritten == *lines ? step.tree :
+        std::make_shared<TokenTree>(rewritten));
+    }
+    else {
+      results.push_back(step.tree);
+    }
+  }
+  return results.back();
+}
+
+// findCommon(tree, counts, trees) - Counts the subexpressions of tree that are
+//  evaluated whenever tree is (i.e. not those within functions, within the
+//  bodies of Bindings or in arguments taken unevaluated) by their string
+//  forms, keeping one TokenTree for each. Returns a boolean indicating whether
+//  tree itself could be evaluated anywhere else in the same body, which is
+//  only the case for calls of Tokens.
+bool Inliner::findCommon(const TokenTree::TreePointer &tree,
+  std::map<std::string, std::size_t> &counts,
+  std::map<std::string, TokenTree::TreePointer> &trees) const {
+  if (tree->getConstantPointer()) {
+    return false;
+  }
+  if (tree->getTokenPointer()) {
+    return true;
+  }
+  if (const auto binding = tree->getBindingPointer()) {
+    findCommon(binding->value, counts, trees);
+    return false;
+  }
+  if (const auto lines = tree->getLineListPointer()) {
+    for (const auto &line : *lines) {
+      findCommon(line, counts, trees);
+    }
+    return false;
+  }
+  const auto pair = tree->getFunctionPairPointer();
+  if (!pair || !pair->first || !pair->second || asFunction(*tree).first) {
+    return false;
+  }
+  bool movable = findCommon(pair->first, counts, trees);
+  if (quotesArgument(*pair->first) || pair->second->isImplied()) {
+    movable = false;
+  }
+  else {
+    movable = findCommon(pair->second, counts, trees) && movable;
+  }
+  if (movable) {
+    const std::string key = static_cast<std::string>(*tree);
+    counts[key]++;
+    trees.insert({ key, tree });
+  }
+  return movable;
+}
+
+// replaceCommon(tree, key, name) - Replaces the subexpressions of tree that
+//  findCommon counted as key with name.
+TokenTree::TreePointer Inliner::replaceCommon(
+  const TokenTree::TreePointer &tree, const std::string &key,
+  const TokenTree::TreePointer &name) const {
+  if (tree->getConstantPointer() || tree->getTokenPointer()) {
+    return tree;
+  }
+  if (const auto binding = tree->getBindingPointer()) {
+    const auto value = replaceCommon(binding->value, key, name);
+    return value == binding->value ? tree :
+      std::make_shared<TokenTree>(binding->name, value, binding->body);
+  }
+  if (const auto lines = tree->getLineListPointer()) {
+    TokenTree::LineList replaced;
+    for (const auto &line : *lines) {
+      replaced.push_back(replaceCommon(line, key, name));
+    }
+    return replaced == *lines ? tree : std::make_shared<TokenTree>(replaced);
+  }
+  const auto pair = tree->getFunctionPairPointer();
+  if (!pair || !pair->first || !pair->second || asFunction(*tree).first) {
+    return tree;
+  }
+  if (static_cast<std::string>(*tree) == key) {
+    return name;
+  }
+  const auto f = replaceCommon(pair->first, key, name);
+  const auto x = quotesArgument(*pair->first) || pair->second->isImplied() ?
+    pair->second : replaceCommon(pair->second, key, name);
+  return f == pair->first && x == pair->second ? tree :
+    std::make_shared<TokenTree>(f, x);
+}
+
+// shareCommon(body) - Evaluates the largest subexpression that occurs more than
+//  once in body (and is large enough) only once, by binding its Value to a new
+//  name around body, until there are no more such subexpressions. Bodies that
+//  define names are left as they are, since a subexpression might refer to a
+//  name defined within the body.
+TokenTree::TreePointer Inliner::shareCommon(
+  const TokenTree::TreePointer &body) {
+  if (options.minCommonSize == 0 ||
+      sizeOf(*body, options.maxSearchSize) > options.maxSearchSize ||
+      definesNames(*body)) {
+    return body;
+  }
+  TokenTree::TreePointer result = body;
+  std::vector<std::pair<std::string, TokenTree::TreePointer>> shared;
+  while (true) {
+    std::map<std::string, std::size_t> counts;
+    std::map<std::string, TokenTree::TreePointer> trees;
+    findCommon(result, counts, trees);
+    std::string common;
+    std::size_t commonSize = 0;
+    for (const auto &[key, count] : counts) {
+      const std::size_t size = sizeOf(*trees.at(key), options.maxSearchSize);
+      if (count > 1 && size >= options.minCommonSize && size > commonSize) {
+        common = key;
+        commonSize = size;
+      }
+    }
+    if (commonSize == 0) {
+      break;
+    }
+    // Names starting with `$` are never Identifiers in Fleet code.
+    const std::string name = "$" + std::to_string(++commonNames);
+    shared.push_back({ name, trees.at(common) });
+    result = replaceCommon(result, common, std::make_shared<TokenTree>(
+      Token { name, Token::Type::Identifier }
+    ));
+    RuntimeStats::current().recordCommonSubexpression();
+  }
+  // Later subexpressions may refer to the names of earlier ones.
+  for (std::size_t i = shared.size(); i-- > 0; ) {
+    result = std::make_shared<TokenTree>(shared[i].first, shared[i].second,
+      result);
+  }
+  return result;
+}
+
+// inlineCalls(ast, context, options) - Rewrites the lines of ast one after
+//  another, so that the functions defined on each line can be inlined into the
+//  lines after it.
+TokenTree Inliner::inlineCalls(const TokenTree &ast,
+  const Context::Pointer &context, const Options &options) {
+  Inliner inliner { context, options, ast };
+  const auto lines = ast.getLineListPointer();
+  if (!lines) {
+    return *inliner.rewrite(std::make_shared<TokenTree>(ast));
+  }
+  TokenTree::LineList rewritten;
+  for (const auto &line : *lines) {
+    rewritten.push_back(inliner.rewrite(line));
+    inliner.define(rewritten.back());
+  }
+  return rewritten == *lines ? ast : TokenTree { rewritten };
+}
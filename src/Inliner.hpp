@@ -0,0 +1,107 @@
+// File: src/Inliner.hpp
+// Purpose: Header file for Inliners, which replace calls of small functions
+//  with the bodies of the functions ahead of time. See src/Inliner.cpp for
+//  implementations.
+
+#ifndef INLINER_HPP
+#define INLINER_HPP
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Context.hpp"
+#include "Token.hpp"
+#include "TokenTree.hpp"
+
+// Inliner - Rewrites a TokenTree so that fewer functions are created and called
+//  when it is evaluated, by using Bindings (see TokenTree::Binding) in place of
+//  calls:
+//   - A function that is called right where it is written, as in
+//     (x -> x * 2) 21, becomes a Binding of its parameter to the argument in
+//     its body (beta-reduction). A function that only names the elements of
+//     a tuple, called with a tuple literal, as in ((a, b) -> a * b) (2, 3),
+//     binds each name to its element without building the tuple.
+//   - A call of a small function that is defined once at the top level of the
+//     code, as in `double = n -> n * 2` followed by `double 4`, is replaced by
+//     the body of the function in the same way, if the names in the body mean
+//     the same thing where it is called. Functions are only inlined into the
+//     code after their definitions, so recursion is never inlined.
+//   - A subexpression that occurs more than once in the body of a function is
+//     evaluated only once, and its Value is bound to a name that cannot be
+//     written in Fleet.
+//  Since Fleet code has no effects, the resulting code gives the same results
+//  as the code it replaces. The functions inlined are recorded in the
+//  RuntimeStats (see src/RuntimeStats.hpp).
+class Inliner {
+public:
+  // Options - The heuristics that decide what the Inliner does. All sizes are
+  //  numbers of Tokens.
+  struct Options {
+    // The largest size of the body of a function that is inlined, or 0 to
+    //  inline no functions by name.
+    std::size_t maxInlineSize = 16;
+    // Whether functions called right where they are written are reduced.
+    bool betaReduce = true;
+    // The smallest size of a repeated subexpression that is evaluated only
+    //  once, or 0 to evaluate every subexpression as often as it occurs.
+    std::size_t minCommonSize = 5;
+    // The largest size of a body that is searched for repeated subexpressions,
+    //  since the search takes time quadratic in the size.
+    std::size_t maxSearchSize = 256;
+  };
+
+private:
+  // A Definition is the parameter and body of a function that can be inlined.
+  struct Definition {
+    std::string param;
+    TokenTree::TreePointer body;
+  };
+
+  Context::Pointer context;
+  Options options;
+  std::set<std::string> localNames;
+  std::unordered_map<std::string, std::size_t> definitionCounts;
+  std::unordered_map<std::string, Definition> definitions;
+  std::size_t commonNames;
+
+  // Private methods are documented in src/Inliner.cpp.
+  Inliner(const Context::Pointer &context, const Options &options,
+    const TokenTree &ast);
+  static std::size_t sizeOf(const TokenTree &tree, std::size_t limit);
+  static bool definesNames(const TokenTree &tree);
+  static std::pair<const TokenTree *, TokenTree::TreePointer> asCall(
+    const TokenTree &tree, const std::string &op);
+  static std::pair<const Token *, TokenTree::TreePointer> asFunction(
+    const TokenTree &tree);
+  static std::pair<const Token *, TokenTree::TreePointer> asDefinition(
+    const TokenTree &tree);
+  bool quotesArgument(const TokenTree &f) const;
+  void define(const TokenTree::TreePointer &line);
+  TokenTree::TreePointer apply(const TokenTree::TreePointer &f,
+    const TokenTree::TreePointer &x) const;
+  static std::vector<TokenTree::TreePointer> tupleOf(const TokenTree &tree);
+  TokenTree::TreePointer applyTuple(const TokenTree::TreePointer &f,
+    const TokenTree::TreePointer &x) const;
+  TokenTree::TreePointer rewriteCall(const TokenTree::TreePointer &tree,
+    const TokenTree::TreePointer &f, const TokenTree::TreePointer &x);
+  TokenTree::TreePointer rewrite(const TokenTree::TreePointer &tree);
+  bool findCommon(const TokenTree::TreePointer &tree,
+    std::map<std::string, std::size_t> &counts,
+    std::map<std::string, TokenTree::TreePointer> &trees) const;
+  TokenTree::TreePointer replaceCommon(const TokenTree::TreePointer &tree,
+    const std::string &key, const TokenTree::TreePointer &name) const;
+  TokenTree::TreePointer shareCommon(const TokenTree::TreePointer &body);
+
+public:
+  // static inlineCalls(ast, context, options) - Returns a TokenTree that gives
+  //  the same result as ast when it is evaluated in context, but with calls
+  //  inlined and reduced as options allow.
+  static TokenTree inlineCalls(const TokenTree &ast,
+    const Context::Pointer &context, const Options &options);
+};
+
+#endif
@@ -0,0 +1,249 @@
+// File: src/ListValue.cpp
+// Purpose: Source file for ListValues, which are the sequences that list
+//  literals such as `[1, 2, 3]`, `:` and `++` return. See src/ListValue.hpp
+//  for more documentation.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+#include "ListValue.hpp"
+#include "Error.hpp"
+#include "Evacuation.hpp"
+#include "NumberValue.hpp"
+#include "NumericKernel.hpp"
+#include "PersistentVector.hpp"
+#include "Region.hpp"
+#include "SequenceValue.hpp"
+#include "Value.hpp"
+
+// Constructor
+ListValue::ListValue(const PersistentVector &elements): SequenceValue {
+  std::make_shared<const Source>(elements), std::vector<Stage> {}
+} {}
+
+// from(sequence) - The elements are gathered by a PersistentVector::Builder,
+//  so no node of the new list is copied while it is built. If the pipeline
+//  can run on plain doubles, the elements are never boxed at all.
+Value::OrError ListValue::from(const std::shared_ptr<SequenceValue> &sequence) {
+  if (std::dynamic_pointer_cast<ListValue>(sequence)) {
+    return { Value::Pointer { sequence } };
+  }
+  PersistentVector::Builder builder;
+  if (buildUnboxed(*sequence, builder)) {
+    return { Value::Pointer { Region::make<ListValue>(builder.build()) } };
+  }
+  Cursor cursor { *sequence };
+  while (true) {
+    const Value::OrError next = cursor.next();
+    if (std::holds_alternative<Error>(next)) {
+      return next;
+    }
+    const Value::Pointer &element = *std::get_if<Value::Pointer>(&next);
+    if (!element) {
+      break;
+    }
+    builder.push(element);
+  }
+  return { Value::Pointer { Region::make<ListValue>(builder.build()) } };
+}
+
+// freeze(sequence) - Only creates a new ListValue if compacting the elements
+//  changed them.
+Value::OrError ListValue::freeze(
+  const std::shared_ptr<SequenceValue> &sequence) {
+  const Value::OrError list = from(sequence);
+  if (std::holds_alternative<Error>(list)) {
+    return list;
+  }
+  const PersistentVector &elements = static_cast<const ListValue &>(
+    **std::get_if<Value::Pointer>(&list)
+  ).getElements();
+  const PersistentVector compacted = elements.compacted();
+  if (compacted.isCompact() && !elements.isCompact()) {
+    return { Value::Pointer { Region::make<ListValue>(compacted) } };
+  }
+  return list;
+}
+
+// getElements() - A ListValue is always created with a PersistentVector.
+const PersistentVector &ListValue::getElements() const {
+  return *std::get_if<PersistentVector>(source.get());
+}
+
+// size() - Returns the number of elements.
+std::size_t ListValue::size() const {
+  return getElements().size();
+}
+
+// spanAt(elements, index, buffer) - Returns the elements from index to the
+//  end of the leaf holding it. The numbers of a compact vector are decoded
+//  into buffer instead, up to spanNumbers of them.
+ListValue::Span ListValue::spanAt(const PersistentVector &elements,
+  std::size_t index, double *buffer) {
+  if (elements.isCompact()) {
+    const std::size_t count = std::min(spanNumbers, elements.size() - index);
+    elements.copyNumbers(index, count, buffer);
+    return Span { buffer, nullptr, count };
+  }
+  std::size_t start;
+  const PersistentVector::Node &leaf = elements.leafAt(index, start);
+  if (leaf.numeric) {
+    return Span {
+      leaf.numbers.data() + (index - start), nullptr,
+      leaf.numbers.size() - (index - start)
+    };
+  }
+  return Span {
+    nullptr, leaf.elements.data() + (index - start),
+    leaf.elements.size() - (index - start)
+  };
+}
+
+// then(stage) - Slices the elements for Take and Drop.
+std::shared_ptr<SequenceValue> ListValue::then(const Stage &stage) const {
+  switch (stage.kind) {
+    case Stage::Kind::Take:
+      return Region::make<ListValue>(getElements().slice(0, stage.count));
+    case Stage::Kind::Drop:
+      return Region::make<ListValue>(getElements().slice(stage.count, size()));
+    default:
+      return SequenceValue::then(stage);
+  }
+}
+
+// length() - The size of the elements is known.
+Value::OrError ListValue::length() const {
+  return { Value::Pointer {
+    Region::make<NumberValue>(static_cast<std::int64_t>(size()))
+  } };
+}
+
+// first() - Returns the element at 0.
+Value::OrError ListValue::first() const {
+  if (size() == 0) {
+    return { Error { Error::Code::EmptySequence } };
+  }
+  return { getElements().at(0) };
+}
+
+// last() - Returns the element at the end.
+Value::OrError ListValue::last() const {
+  if (size() == 0) {
+    return { Error { Error::Code::EmptySequence } };
+  }
+  return { getElements().at(size() - 1) };
+}
+
+// at(index) - Looks the element up in the PersistentVector.
+Value::OrError ListValue::at(const std::shared_ptr<NumberValue> &index) const {
+  const double position = index->getRawNumber();
+  if (position < 0 || std::floor(position) != position ||
+    !(position < static_cast<double>(size()))) {
+    return {
+      Error { Error::Code::IndexOutOfRange, { Error::Shown { index } } }
+    };
+  }
+  return { getElements().at(static_cast<std::size_t>(position)) };
+}
+
+// evacuate(evacuation) - The elements are only copied if some of them are in
+//  the Region (see SequenceValue::evacuateElements).
+Value::Pointer ListValue::evacuate(Evacuation &evacuation) const {
+  return Value::Pointer { std::make_shared<ListValue>(
+    evacuateElements(getElements(), evacuation)
+  ) };
+}
+
+// hash() - Unboxed numbers are hashed without being boxed (see
+//  NumberValue::hashOf).
+std::optional<std::size_t> ListValue::hash() const {
+  if (cachedHash) {
+    return cachedHash;
+  }
+  const PersistentVector &elements = getElements();
+  std::array<double, spanNumbers> buffer;
+  std::size_t hash = mixHash(elements.size());
+  for (std::size_t i = 0; i < elements.size(); ) {
+    const Span span = spanAt(elements, i, buffer.data());
+    for (std::size_t k = 0; k < span.count; k++) {
+      if (span.numbers) {
+        hash = combineHashes(hash, NumberValue::hashOf(span.numbers[k]));
+        continue;
+      }
+      const std::optional<std::size_t> elementHash = span.values[k]->hash();
+      if (!elementHash) {
+        return {};
+      }
+      hash = combineHashes(hash, *elementHash);
+    }
+    i += span.count;
+  }
+  cachedHash = hash;
+  return cachedHash;
+}
+
+std::optional<std::size_t> ListValue::knownHash() const {
+  return cachedHash;
+}
+
+// equals(other) - Goes through both lists a span at a time, each span ending
+//  where a leaf of either ends. A span of one list that is at the same place
+//  in memory as that of the other is part of a leaf both share.
+bool ListValue::equals(const Value &other) const {
+  const auto otherList = dynamic_cast<const ListValue *>(&other);
+  if (!otherList || size() != otherList->size()) {
+    return false;
+  }
+  const PersistentVector &x = getElements();
+  const PersistentVector &y = otherList->getElements();
+  std::array<double, spanNumbers> xBuffer;
+  std::array<double, spanNumbers> yBuffer;
+  for (std::size_t i = 0; i < x.size(); ) {
+    const Span xSpan = spanAt(x, i, xBuffer.data());
+    const Span ySpan = spanAt(y, i, yBuffer.data());
+    const std::size_t count = std::min(xSpan.count, ySpan.count);
+    if (xSpan.numbers && ySpan.numbers) {
+      if (xSpan.numbers != ySpan.numbers &&
+        !NumericKernel::equalAll(xSpan.numbers, ySpan.numbers, count)) {
+        return false;
+      }
+    }
+    else if (xSpan.values && ySpan.values) {
+      for (std::size_t k = 0; xSpan.values != ySpan.values && k < count;
+        k++) {
+        if (!Value::equal(*xSpan.values[k], *ySpan.values[k])) {
+          return false;
+        }
+      }
+    }
+    else {
+      for (std::size_t k = 0; k < count; k++) {
+        if (xSpan.numbers ?
+          !Value::equal(NumberValue { xSpan.numbers[k] }, *ySpan.values[k]) :
+          !Value::equal(*xSpan.values[k], NumberValue { ySpan.numbers[k] })) {
+          return false;
+        }
+      }
+    }
+    i += count;
+  }
+  return true;
+}
+
+const std::string ListValue::name { "List" };
+
+// getName() - Returns "List", the name of the List type.
+std::string ListValue::getName() const {
+  return ListValue::name;
+}
+
+std::string ListValue::getClassName() {
+  return ListValue::name;
+}
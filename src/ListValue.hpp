@@ -0,0 +1,97 @@
+// File: src/ListValue.hpp
+// Purpose: Header file for ListValues, which are the sequences that list
+//  literals such as `[1, 2, 3]`, `:` and `++` return. See src/ListValue.cpp
+//  for implementations.
+
+#ifndef LISTVALUE_HPP
+#define LISTVALUE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include "NumberValue.hpp"
+#include "PersistentVector.hpp"
+#include "SequenceValue.hpp"
+#include "Value.hpp"
+
+// ListValue - A SequenceValue whose source is a PersistentVector (see
+//  src/PersistentVector.hpp) and which has no stages. Unlike other sequences,
+//  a list holds its elements, so its length, its first and last elements and
+//  the element at any position are found in O(log n) time without producing
+//  anything, and taking or dropping elements from it slices the vector. Other
+//  stages, such as map and filter, are added to a list like to any other
+//  sequence and stay lazy; such a sequence only becomes a list again when it
+//  is passed to `toList`, `:` or `++`, which build the new vector in one pass.
+//  `toList` also freezes the list, which stores it compactly if it is a long
+//  list of whole numbers (see src/CompactVector.hpp).
+class ListValue final: public SequenceValue {
+private:
+  // The most numbers of a compact list decoded at once by spanAt.
+  static constexpr std::size_t spanNumbers = 256;
+
+  // A Span is some of the elements of a list in a row: count numbers held
+  //  unboxed, or count Values.
+  struct Span {
+    const double *numbers;
+    const Value::Pointer *values;
+    std::size_t count;
+  };
+
+  // The hash of the elements, once it has been computed.
+  mutable std::optional<std::size_t> cachedHash;
+
+  // Private methods are documented in src/ListValue.cpp.
+  std::size_t size() const;
+  static Span spanAt(const PersistentVector &elements, std::size_t index,
+    double *buffer);
+
+public:
+  // Constructor(elements) - Creates the list of the given elements.
+  explicit ListValue(const PersistentVector &elements);
+
+  // static from(sequence) - Returns sequence itself if it is a list, and
+  //  otherwise the list of its elements, or the error that producing them
+  //  resulted in. The sequence must end.
+  static Value::OrError from(const std::shared_ptr<SequenceValue> &sequence);
+
+  // static freeze(sequence) - Returns the list of the elements of sequence
+  //  like from does, but stored compactly if they are whole numbers that take
+  //  much less memory that way (see PersistentVector::compacted).
+  static Value::OrError freeze(const std::shared_ptr<SequenceValue> &sequence);
+
+  // getElements() - Returns the elements of the list.
+  const PersistentVector &getElements() const;
+
+  // then(stage) - Returns a slice of the list for stages that take or drop
+  //  elements, and adds stage to the sequence like any other otherwise.
+  std::shared_ptr<SequenceValue> then(const Stage &stage) const;
+
+  // length(), first(), last(), at(index) - Look the result up directly.
+  Value::OrError length() const;
+  Value::OrError first() const;
+  Value::OrError last() const;
+  Value::OrError at(const std::shared_ptr<NumberValue> &index) const;
+
+  // evacuate(evacuation) - Returns the list of the evacuated elements.
+  Value::Pointer evacuate(Evacuation &evacuation) const;
+
+  // hash(), knownHash() - Return the hash of the elements, which is computed
+  //  once, or nothing if one of them has none.
+  std::optional<std::size_t> hash() const;
+  std::optional<std::size_t> knownHash() const;
+
+  // equals(other) - Returns whether other is a list of as many elements, each
+  //  equal to the element of this list at the same position. Runs of numbers
+  //  held unboxed in both lists are compared several at a time (see
+  //  NumericKernel::equalAll), and leaves that both lists share are not
+  //  compared at all.
+  bool equals(const Value &other) const;
+
+  // name/getName() - Returns "List", the name of a ListValue-type value.
+  static const std::string name;
+  static std::string getClassName();
+  std::string getName() const;
+};
+
+#endif
@@ -0,0 +1,104 @@
+// File: src/MapValue.cpp
+// Purpose: A MapValue is a Value that maps keys to Values, such as the result
+//  of mapOf. For more documentation see src/MapValue.hpp.
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include "MapValue.hpp"
+#include "Error.hpp"
+#include "Evacuation.hpp"
+#include "PersistentMap.hpp"
+#include "Value.hpp"
+
+// Constructor
+MapValue::MapValue(const PersistentMap &entries): entries { entries } {}
+
+const PersistentMap &MapValue::getEntries() const {
+  return entries;
+}
+
+// hash() - Adds up a hash of each key and its Value, so that the order of
+//  the entries does not matter.
+std::optional<std::size_t> MapValue::hash() const {
+  if (cachedHash) {
+    return cachedHash;
+  }
+  std::size_t hash = mixHash(entries.size());
+  bool hashable = true;
+  entries.forEach([&hash, &hashable](const PersistentMap::Entry &entry) {
+    const std::optional<std::size_t> valueHash = entry.value->hash();
+    if (!valueHash) {
+      hashable = false;
+      return;
+    }
+    hash += combineHashes(entry.hash, *valueHash);
+  });
+  if (hashable) {
+    cachedHash = hash;
+  }
+  return cachedHash;
+}
+
+std::optional<std::size_t> MapValue::knownHash() const {
+  return cachedHash;
+}
+
+// equals(other) - Looks each key up in other.
+bool MapValue::equals(const Value &other) const {
+  const auto otherMap = dynamic_cast<const MapValue *>(&other);
+  if (!otherMap || entries.size() != otherMap->entries.size()) {
+    return false;
+  }
+  bool equal = true;
+  entries.forEach([&equal, otherMap](const PersistentMap::Entry &entry) {
+    if (!equal) {
+      return;
+    }
+    const PersistentMap::Entry *found = otherMap->entries.find(*entry.key);
+    equal = found && Value::equal(*entry.value, *found->value);
+  });
+  return equal;
+}
+
+// call([unused] arg) - Returns an error, since MapValues cannot be called.
+Value::OrError MapValue::call([[maybe_unused]] Value::Pointer arg) const {
+  return { Error { Error::Code::NotCallable, { &MapValue::getClassName } } };
+}
+
+// evacuate(evacuation) - The keys are hashed again, since their copies have
+//  the same hashes.
+Value::Pointer MapValue::evacuate(Evacuation &evacuation) const {
+  PersistentMap::Builder builder;
+  entries.forEach([&builder, &evacuation](const PersistentMap::Entry &entry) {
+    builder.insert(evacuation.value(entry.key), evacuation.value(entry.value));
+  });
+  return Value::Pointer { std::make_shared<MapValue>(builder.build()) };
+}
+
+// operator string() - The entries are shown in the order that the map keeps
+//  them in, and the empty map is {:}.
+MapValue::operator std::string() const {
+  if (entries.size() == 0) {
+    return "{:}";
+  }
+  std::string shown;
+  entries.forEach([&shown](const PersistentMap::Entry &entry) {
+    shown += shown.empty() ? "{" : ", ";
+    shown += static_cast<std::string>(*entry.key) + ": " +
+      static_cast<std::string>(*entry.value);
+  });
+  return shown + "}";
+}
+
+const std::string MapValue::name { "Map" };
+
+// getName() - Returns "Map", the name of the Map type.
+std::string MapValue::getName() const {
+  return MapValue::name;
+}
+
+std::string MapValue::getClassName() {
+  return MapValue::name;
+}
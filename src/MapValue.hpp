@@ -0,0 +1,56 @@
+// File: src/MapValue.hpp
+// Purpose: A MapValue is a Value that maps keys to Values, such as the result
+//  of mapOf. For implementations see src/MapValue.cpp.
+
+#ifndef MAPVALUE_HPP
+#define MAPVALUE_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include "PersistentMap.hpp"
+#include "Value.hpp"
+
+// MapValue - An immutable map held as a PersistentMap (see
+//  src/PersistentMap.hpp), so that inserting or removing a key returns a new
+//  map that shares nearly all of its nodes with the old one.
+class MapValue final: public Value {
+private:
+  PersistentMap entries;
+
+  // The hash of the keys and Values, once it has been computed.
+  mutable std::optional<std::size_t> cachedHash;
+
+public:
+  // Constructor(entries) - Creates the map of entries.
+  explicit MapValue(const PersistentMap &entries);
+
+  // getEntries() - Returns the entries of the map.
+  const PersistentMap &getEntries() const;
+
+  // hash(), knownHash() - Return the hash of the keys and Values, which does
+  //  not depend on their order and is computed once, or nothing if a Value
+  //  has none.
+  std::optional<std::size_t> hash() const;
+  std::optional<std::size_t> knownHash() const;
+
+  // equals(other) - Returns whether other is a map with the same keys, each
+  //  with an equal Value.
+  bool equals(const Value &other) const;
+
+  // call(arg) - Returns an error, since MapValues cannot be called.
+  Value::OrError call([[maybe_unused]] Value::Pointer arg) const;
+
+  // evacuate(evacuation) - Returns the map of the evacuated keys and Values.
+  Value::Pointer evacuate(Evacuation &evacuation) const;
+
+  // operator string() - Returns the entries as in {key: value, ...}.
+  operator std::string() const;
+
+  // name/getName() - Returns "Map", the name of a MapValue-type value.
+  static const std::string name;
+  static std::string getClassName();
+  std::string getName() const;
+};
+
+#endif
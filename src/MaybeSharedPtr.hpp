@@ -32,6 +32,10 @@ public:
     }
   } {}
 
+  // Constructor(ptr) - Creates a shared MaybeSharedPtr from an existing
+  //  shared_ptr (e.g. one created with a custom allocator).
+  MaybeSharedPtr(const std::shared_ptr<T> &ptr): internalPtr { ptr } {}
+
   T& operator* () const {
     if (std::holds_alternative<T*>(internalPtr)) {
       return **std::get_if<T*>(&internalPtr);
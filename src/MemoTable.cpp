@@ -0,0 +1,159 @@
+// File: src/MemoTable.cpp
+// Purpose: Source file for MemoTables, which remember the results of calls of
+//  a function written in Fleet. See src/MemoTable.hpp for more documentation.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "MemoTable.hpp"
+#include "Evacuation.hpp"
+#include "NumberValue.hpp"
+#include "RuntimeStats.hpp"
+#include "Value.hpp"
+
+// Keys are equal if they are the same number or the same Value.
+bool MemoTable::Key::operator==(const Key &other) const {
+  return bits == other.bits && kind == other.kind;
+}
+
+// A Key is hashed by its bits, which are unique among Keys of the same kind.
+std::size_t MemoTable::KeyHash::operator()(const Key &key) const {
+  return std::hash<std::uint64_t> {}(key.bits) ^
+    static_cast<std::size_t>(key.kind);
+}
+
+// This constructor creates an empty MemoTable. A table in automatic mode
+//  starts out counting calls, and any other table starts out remembering.
+MemoTable::MemoTable(const std::string &name, std::size_t capacity,
+  Mode mode): capacity { capacity }, state { mode == Mode::Automatic ?
+  State::Counting : State::Remembering }, stateCalls { 0 }, stateHits { 0 },
+  hand { 0 }, stats { RuntimeStats::current().recordMemoized(name) } {}
+
+// keyOf(argument) - Returns the Key of argument.
+MemoTable::Key MemoTable::keyOf(const Value::Pointer &argument) {
+  const auto number = dynamic_cast<const NumberValue *>(argument.get());
+  if (number && !number->isInteger()) {
+    const double raw = number->getRawNumber();
+    std::uint64_t bits;
+    std::memcpy(&bits, &raw, sizeof bits);
+    return { bits, KeyKind::Float };
+  }
+  if (const auto small = number ? number->getSmallInteger() : std::nullopt) {
+    return { static_cast<std::uint64_t>(*small), KeyKind::Integer };
+  }
+  return {
+    reinterpret_cast<std::uintptr_t>(argument.get()), KeyKind::Address
+  };
+}
+
+// reject() - Forgets every result and stops remembering results for good.
+void MemoTable::reject() {
+  state = State::Rejected;
+  entries = {};
+  index = {};
+  stats->rejected = true;
+}
+
+// This method counts a call and looks its argument up. It moves a table in
+//  automatic mode from counting to its trial, and from its trial to either
+//  remembering or giving up, once enough calls have been counted.
+Value::Pointer MemoTable::find(const Value::Pointer &argument) {
+  stats->calls++;
+  if (state == State::Rejected) {
+    return nullptr;
+  }
+  if (state == State::Counting) {
+    if (++stateCalls >= warmupCalls) {
+      state = State::Trial;
+      stateCalls = 0;
+    }
+    return nullptr;
+  }
+  Value::Pointer result;
+  const auto found = index.find(keyOf(argument));
+  if (found != index.end()) {
+    Entry &entry = entries[found->second];
+    entry.referenced = true;
+    result = entry.result;
+    stats->hits++;
+  }
+  if (state == State::Trial) {
+    stateCalls++;
+    stateHits += !!result;
+    if (stateCalls >= trialCalls) {
+      if (stateHits * minHitRatio < stateCalls) {
+        reject();
+      }
+      else {
+        state = State::Remembering;
+      }
+    }
+  }
+  return result;
+}
+
+// This method returns whether results are being remembered.
+bool MemoTable::isRemembering() const {
+  return capacity > 0 &&
+    (state == State::Trial || state == State::Remembering);
+}
+
+// This method remembers a result. When the table is full, the clock hand
+//  sweeps over the entries, giving each entry that was found since the hand
+//  last passed it a second chance, and the first entry without one is
+//  replaced.
+void MemoTable::remember(const Value::Pointer &argument,
+  const Value::Pointer &result) {
+  if (!isRemembering()) {
+    return;
+  }
+  const Key key = keyOf(argument);
+  if (index.count(key)) {
+    return;
+  }
+  if (entries.size() < capacity) {
+    index.emplace(key, entries.size());
+    entries.push_back({ key, argument, result, false });
+    return;
+  }
+  while (entries[hand].referenced) {
+    entries[hand].referenced = false;
+    hand = (hand + 1) % capacity;
+  }
+  index.erase(entries[hand].key);
+  entries[hand] = { key, argument, result, false };
+  index.emplace(key, hand);
+  hand = (hand + 1) % capacity;
+  stats->evictions++;
+}
+
+// This method keeps the entries in the order they were in, so the clock hand
+//  starts over from the first entry.
+void MemoTable::evacuate(Evacuation &evacuation) {
+  std::vector<Entry> kept;
+  for (const Entry &entry : entries) {
+    if (entry.key.kind == KeyKind::Address &&
+      evacuation.contains(entry.argument.get())) {
+      continue;
+    }
+    kept.push_back({ entry.key, evacuation.value(entry.argument),
+      evacuation.value(entry.result), entry.referenced });
+  }
+  entries = std::move(kept);
+  index = {};
+  for (std::size_t i = 0; i < entries.size(); i++) {
+    index.emplace(entries[i].key, i);
+  }
+  hand = 0;
+}
+
+// This method returns the number of results remembered.
+std::size_t MemoTable::size() const {
+  return entries.size();
+}
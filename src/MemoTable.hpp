@@ -0,0 +1,121 @@
+// File: src/MemoTable.hpp
+// Purpose: Header file for MemoTables, which remember the results of calls of
+//  a function written in Fleet so that calling it again with the same argument
+//  does not evaluate its body again. See src/MemoTable.cpp for
+//  implementations.
+
+#ifndef MEMOTABLE_HPP
+#define MEMOTABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "RuntimeStats.hpp"
+#include "Value.hpp"
+
+class Evacuation;
+
+// MemoTable - Remembers up to a fixed number of results of a function, keyed on
+//  the argument: a NumberValue by its number and any other Value by its
+//  identity (since Values cannot change, the same Value always gives the same
+//  result). When the table is full, the result to forget is chosen by the
+//  clock algorithm, which approximates forgetting the least recently used
+//  result at the cost of one bit per result. Since Fleet code has no effects,
+//  a remembered result is always the result the call would give. Errors are
+//  never remembered.
+//  A table in automatic mode starts out only counting calls. Once the function
+//  has been called often enough to be worth remembering, the table remembers
+//  results for a trial, and it gives up on the function (and forgets its
+//  results) if too few calls of the trial were hits. The calls and hits of
+//  every table are counted in the RuntimeStats (see src/RuntimeStats.hpp).
+class MemoTable {
+public:
+  enum class Mode {
+    // Remember results from the first call on.
+    Always,
+    // Remember results only for functions that are called often and that are
+    //  often called with the same arguments.
+    Automatic
+  };
+
+  // The number of calls after which a table in automatic mode starts to
+  //  remember results.
+  static constexpr std::size_t warmupCalls = 256;
+  // The number of calls in the trial of a table in automatic mode.
+  static constexpr std::size_t trialCalls = 1024;
+  // A table in automatic mode gives up if fewer than 1 in this many calls of
+  //  its trial are hits.
+  static constexpr std::size_t minHitRatio = 4;
+  // The number of results remembered when no capacity is given.
+  static constexpr std::size_t defaultCapacity = 4096;
+
+private:
+  enum class State { Counting, Trial, Remembering, Rejected };
+
+  // A Key is the number of a Float or of an Int that fits in 64 bits (as
+  //  bits, so that it is compared exactly) or the address of any other Value.
+  //  Floats and Ints are different kinds of Keys, so that 1 and 1.0 are
+  //  remembered apart.
+  enum class KeyKind : std::uint8_t { Address, Float, Integer };
+  struct Key {
+    std::uint64_t bits;
+    KeyKind kind;
+    bool operator==(const Key &other) const;
+  };
+  struct KeyHash {
+    std::size_t operator()(const Key &key) const;
+  };
+
+  // An Entry keeps its argument alive, so that the address of a Value used as
+  //  a Key cannot be reused by another Value while the Entry exists.
+  struct Entry {
+    Key key;
+    Value::Pointer argument;
+    Value::Pointer result;
+    bool referenced;
+  };
+
+  std::size_t capacity;
+  State state;
+  std::size_t stateCalls;
+  std::size_t stateHits;
+  std::vector<Entry> entries;
+  std::unordered_map<Key, std::size_t, KeyHash> index;
+  std::size_t hand;
+  std::shared_ptr<RuntimeStats::Memo> stats;
+
+  // Private methods are documented in src/MemoTable.cpp.
+  static Key keyOf(const Value::Pointer &argument);
+  void reject();
+
+public:
+  // Constructor(name, capacity, mode) - Creates an empty MemoTable for the
+  //  function with the given name that remembers at most capacity results.
+  MemoTable(const std::string &name, std::size_t capacity, Mode mode);
+
+  // find(argument) - Counts a call with the given argument and returns the
+  //  remembered result of the call, or nullptr if there is none.
+  Value::Pointer find(const Value::Pointer &argument);
+
+  // isRemembering() - Returns a boolean indicating whether results should be
+  //  passed to remember(argument, result).
+  bool isRemembering() const;
+
+  // remember(argument, result) - Remembers result as the result of a call with
+  //  argument, forgetting another result if the table is full.
+  void remember(const Value::Pointer &argument, const Value::Pointer &result);
+
+  // evacuate(evacuation) - Replaces the arguments and results that are in the
+  //  Region being evacuated by their copies (see src/Evacuation.hpp). The
+  //  results for arguments in the Region that are not numbers are forgotten
+  //  instead, since their copies are different Keys.
+  void evacuate(Evacuation &evacuation);
+
+  // size() - Returns the number of results remembered.
+  std::size_t size() const;
+};
+
+#endif
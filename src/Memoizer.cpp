@@ -0,0 +1,105 @@
+// File: src/Memoizer.cpp
+// Purpose: Source file for Memoizers, which make functions defined in Fleet
+//  remember the results of their calls. See src/Memoizer.hpp for more
+//  documentation.
+
+#include <memory>
+#include <set>
+#include <string>
+#include "Memoizer.hpp"
+#include "Context.hpp"
+#include "FunctionValue.hpp"
+#include "MemoTable.hpp"
+#include "Token.hpp"
+#include "TokenTree.hpp"
+#include "Value.hpp"
+
+// asOperatorCall(tree, op) - Returns the call of tree if it is a call of the
+//  operator op with two arguments, as in `a op b`, or nullptr otherwise.
+const TokenTree::FunctionPair *Memoizer::asOperatorCall(const TokenTree &tree,
+  const std::string &op) {
+  if (tree.getConstantPointer() || tree.getBindingPointer()) {
+    return nullptr;
+  }
+  const auto pair = tree.getFunctionPairPointer();
+  if (!pair || !pair->first || !pair->second) {
+    return nullptr;
+  }
+  const auto inner = pair->first->getFunctionPairPointer();
+  if (!inner || !inner->first || !inner->second) {
+    return nullptr;
+  }
+  const auto token = inner->first->getTokenPointer();
+  if (!token || token->getType() != Token::Type::Operator ||
+      token->getValue() != op) {
+    return nullptr;
+  }
+  return pair;
+}
+
+// asFunctionDefinition(line) - Returns the name Token of line if it defines a
+//  function, as in `name = param -> body`, or nullptr otherwise.
+const Token *Memoizer::asFunctionDefinition(const TokenTree &line) {
+  const auto definition = asOperatorCall(line, "=");
+  if (!definition || !asOperatorCall(*definition->second, "->")) {
+    return nullptr;
+  }
+  const auto name = definition->first->getFunctionPairPointer()->second->
+    getTokenPointer();
+  if (!name || name->getType() != Token::Type::Identifier) {
+    return nullptr;
+  }
+  return name;
+}
+
+// This function rewrites the first definition of each function to memoize as
+//  `name = memoize (param -> body)`, where memoize is a Constant.
+TokenTree Memoizer::memoizeDefinitions(const TokenTree &ast,
+  const Context::Pointer &context, const Options &options) {
+  const auto lines = ast.getLineListPointer();
+  if (!lines || (options.names.empty() && !options.automatic)) {
+    return ast;
+  }
+  const TokenTree::TreePointer identity {
+    TokenTree::build({ "x -> x" }).getLineListPointer()->front()
+  };
+  TokenTree::LineList rewritten;
+  rewritten.reserve(lines->size());
+  std::set<std::string> defined;
+  bool changed = false;
+  for (const auto &line : *lines) {
+    const auto name = line ? asFunctionDefinition(*line) : nullptr;
+    if (!name || !defined.insert(name->getValue()).second ||
+        (!options.automatic && !options.names.count(name->getValue()))) {
+      rewritten.push_back(line);
+      continue;
+    }
+    const MemoTable::Mode mode = options.names.count(name->getValue()) ?
+      MemoTable::Mode::Always : MemoTable::Mode::Automatic;
+    const std::string &functionName = name->getValue();
+    const std::size_t capacity = options.capacity;
+    const Value::Pointer memoize {
+      new FunctionValue<Value, Value> { [functionName, capacity, mode](
+        const std::shared_ptr<Value> &function,
+        [[maybe_unused]] const Context::Pointer &ignored) ->
+        FunctionValue<Value, Value>::Return {
+        const auto &fleetFunction = std::dynamic_pointer_cast<
+          FunctionValue<Value, Value>
+        >(function);
+        if (fleetFunction) {
+          fleetFunction->memoize(std::make_unique<MemoTable>(functionName,
+            capacity, mode));
+        }
+        return { function };
+      }, context }
+    };
+    const auto &definition = *line->getFunctionPairPointer();
+    rewritten.push_back(std::make_shared<TokenTree>(definition.first,
+      std::make_shared<TokenTree>(
+        std::make_shared<TokenTree>(memoize, identity), definition.second
+      )
+    ));
+    changed = true;
+  }
+  return changed ? TokenTree { rewritten } : ast;
+}
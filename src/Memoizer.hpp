@@ -0,0 +1,52 @@
+// File: src/Memoizer.hpp
+// Purpose: Header file for Memoizers, which make functions defined in Fleet
+//  remember the results of their calls. See src/Memoizer.cpp for
+//  implementations.
+
+#ifndef MEMOIZER_HPP
+#define MEMOIZER_HPP
+
+#include <cstddef>
+#include <set>
+#include <string>
+#include "Context.hpp"
+#include "MemoTable.hpp"
+#include "Token.hpp"
+#include "TokenTree.hpp"
+
+// Memoizer - Rewrites the top-level definitions of functions, such as
+//  `fibonacci = n -> ...`, so that the function that is defined is given a
+//  MemoTable (see src/MemoTable.hpp) as soon as it is created. The value of the
+//  definition is passed through a Constant function that does this and returns
+//  its argument, and that looks like the identity function x -> x to
+//  everything but the Evaluator. Only the first definition of a name is
+//  rewritten, since the function that a later definition gives another
+//  clause takes over its MemoTable (see FunctionValueBase::withClause).
+class Memoizer {
+public:
+  // Options - The functions to memoize and how.
+  struct Options {
+    // The names of the functions whose results are always remembered.
+    std::set<std::string> names;
+    // Whether the results of the other functions are remembered if they turn
+    //  out to be called often with the same arguments.
+    bool automatic = false;
+    // The largest number of results remembered for each function.
+    std::size_t capacity = MemoTable::defaultCapacity;
+  };
+
+private:
+  // Private methods are documented in src/Memoizer.cpp.
+  static const TokenTree::FunctionPair *asOperatorCall(const TokenTree &tree,
+    const std::string &op);
+  static const Token *asFunctionDefinition(const TokenTree &line);
+
+public:
+  // static memoizeDefinitions(ast, context, options) - Returns a TokenTree that
+  //  gives the same results as ast when it is evaluated in context, but whose
+  //  functions remember their results as options say.
+  static TokenTree memoizeDefinitions(const TokenTree &ast,
+    const Context::Pointer &context, const Options &options);
+};
+
+#endif
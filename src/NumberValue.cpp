@@ -1,32 +1,112 @@
 // File: src/NumberValue.cpp
-// Purpose: A NumberValue is a Value that contains a floating point number.
-//  The actual C++ double inside the class should be accessed by built in
-//  functions. Fleet code can build more functions from these built in
-//  functions. For more documentation see src/NumberValue.hpp.
+// Purpose: A NumberValue is a Value that contains a number, which is either a
+//  Float (a C++ double) or an Int (an exact integer). The actual number inside
+//  the class should be accessed by built in functions. Fleet code can build
+//  more functions from these built in functions. For more documentation see
+//  src/NumberValue.hpp.
 
-#include <stdexcept>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <optional>
 #include <string>
+#include <system_error>
 #include "NumberValue.hpp"
-#include "TypeError.hpp"
+#include "BigInt.hpp"
+#include "Error.hpp"
+#include "Evacuation.hpp"
 #include "Value.hpp"
 
 // Constructors
-NumberValue::NumberValue(double rawNumber): number(rawNumber) {}
-NumberValue::NumberValue(const NumberValue &other): number(other.number) {}
-NumberValue::NumberValue(const Token &numberToken):
-  number(stod(numberToken.getValue())) {}
+NumberValue::NumberValue(double rawNumber): number(rawNumber), integer(0),
+  kind(Kind::Float) {}
+NumberValue::NumberValue(std::int64_t integer):
+  number(static_cast<double>(integer)), integer(integer),
+  kind(Kind::Integer) {}
+// A BigInt that fits in 64 bits is not kept.
+NumberValue::NumberValue(const BigInt &integer): number(integer.toDouble()),
+  integer(0), kind(Kind::Big) {
+  if (const auto small = integer.toSmall()) {
+    this->integer = *small;
+    kind = Kind::Integer;
+  }
+  else {
+    big = std::make_shared<const BigInt>(integer);
+  }
+}
+NumberValue::NumberValue(const NumberValue &other): number(other.number),
+  integer(other.integer), big(other.big), kind(other.kind) {}
+// parseInteger(text) - Reads the Int with std::from_chars, which neither
+//  allocates nor depends on the locale, and only with BigInt::parse if it
+//  does not fit in 64 bits.
+std::optional<NumberValue> NumberValue::parseInteger(const std::string &text) {
+  const char *end = text.data() + text.size();
+  std::int64_t parsed;
+  const auto [stop, error] = std::from_chars(text.data(), end, parsed);
+  if (error == std::errc {} && stop == end) {
+    return NumberValue { parsed };
+  }
+  if (error == std::errc::result_out_of_range) {
+    if (const auto big = BigInt::parse(text)) {
+      return NumberValue { *big };
+    }
+  }
+  return {};
+}
+
+// parseFloat(text) - Reads the Float with std::from_chars. A number too large
+//  for a double is not read.
+std::optional<NumberValue> NumberValue::parseFloat(const std::string &text) {
+  const char *end = text.data() + text.size();
+  double parsed;
+  const auto [stop, error] = std::from_chars(text.data(), end, parsed);
+  if (error != std::errc {} || stop != end) {
+    return {};
+  }
+  return NumberValue { parsed };
+}
+
+// parseLiteral(numberToken) - Number Tokens are decoded once each, when they
+//  are folded into Constants or evaluated, rather than by a Token constructor,
+//  so that a Token that is not a number can be reported. An Int literal too
+//  large for 64 bits is read as a BigInt by parseInteger.
+std::optional<NumberValue> NumberValue::parseLiteral(
+  const Token &numberToken) {
+  const std::string value = numberToken.getValue();
+  if (value.find('.') != std::string::npos) {
+    return parseFloat(value);
+  }
+  return parseInteger(value);
+}
 
 // call([unused] arg) - Returns an error, since NumberValues cannot be called.
 Value::OrError NumberValue::call([[maybe_unused]] Value::Pointer arg) const {
-  return { std::runtime_error { std::string {
-    "Value of type "
-  } + name + " cannot be called" } };
+  return { Error { Error::Code::NotCallable, { &NumberValue::getClassName } } };
+}
+
+// evacuate([unused] evacuation) - A big Int shares its digits, which are
+//  never in a Region.
+Value::Pointer NumberValue::evacuate([[maybe_unused]] Evacuation &evacuation)
+  const {
+  return Value::Pointer { std::make_shared<NumberValue>(*this) };
 }
 
 // operator string() - Returns the string representation of the internally
-//  stored double.
+//  stored number. Ints are shown without a decimal point.
 NumberValue::operator std::string() const {
-  return std::to_string(number);
+  switch (kind) {
+    case Kind::Integer:
+      return std::to_string(integer);
+    case Kind::Big:
+      return static_cast<std::string>(*big);
+    default:
+      return std::to_string(number);
+  }
 }
 
 // getRawNumber() - Returns the internal double value in the object.
@@ -34,6 +114,226 @@ double NumberValue::getRawNumber() const {
   return number;
 }
 
+// isInteger() - BigInts are Ints too.
+bool NumberValue::isInteger() const {
+  return kind != Kind::Float;
+}
+
+// getSmallInteger() - Only Ints of the Integer kind fit in 64 bits.
+std::optional<std::int64_t> NumberValue::getSmallInteger() const {
+  if (kind == Kind::Integer) {
+    return integer;
+  }
+  return {};
+}
+
+// getBigInteger() - Converts an Int kept in 64 bits.
+BigInt NumberValue::getBigInteger() const {
+  return kind == Kind::Big ? *big : BigInt { integer };
+}
+
+// add(x, y) - Ints that fit in 64 bits are added directly unless that
+//  overflows.
+NumberValue NumberValue::add(const NumberValue &x, const NumberValue &y) {
+  std::int64_t result;
+  if (x.kind == Kind::Integer && y.kind == Kind::Integer &&
+    !__builtin_add_overflow(x.integer, y.integer, &result)) {
+    return NumberValue { result };
+  }
+  if (x.isInteger() && y.isInteger()) {
+    return NumberValue { BigInt::add(x.getBigInteger(), y.getBigInteger()) };
+  }
+  return NumberValue { x.number + y.number };
+}
+
+// subtract(x, y) - Like add.
+NumberValue NumberValue::subtract(const NumberValue &x, const NumberValue &y) {
+  std::int64_t result;
+  if (x.kind == Kind::Integer && y.kind == Kind::Integer &&
+    !__builtin_sub_overflow(x.integer, y.integer, &result)) {
+    return NumberValue { result };
+  }
+  if (x.isInteger() && y.isInteger()) {
+    return NumberValue {
+      BigInt::subtract(x.getBigInteger(), y.getBigInteger())
+    };
+  }
+  return NumberValue { x.number - y.number };
+}
+
+// multiply(x, y) - Like add.
+NumberValue NumberValue::multiply(const NumberValue &x, const NumberValue &y) {
+  std::int64_t result;
+  if (x.kind == Kind::Integer && y.kind == Kind::Integer &&
+    !__builtin_mul_overflow(x.integer, y.integer, &result)) {
+    return NumberValue { result };
+  }
+  if (x.isInteger() && y.isInteger()) {
+    return NumberValue {
+      BigInt::multiply(x.getBigInteger(), y.getBigInteger())
+    };
+  }
+  return NumberValue { x.number * y.number };
+}
+
+// power(x, y) - Squares in 64 bits while nothing overflows, and with BigInts
+//  otherwise. Since any base but -1, 0 and 1 raised to an exponent of 2^63
+//  or more is far too large to store, such exponents give a Float.
+NumberValue NumberValue::power(const NumberValue &x, const NumberValue &y) {
+  const std::optional<std::int64_t> exponent = y.getSmallInteger();
+  if (!x.isInteger() || !exponent || *exponent < 0) {
+    return NumberValue { std::pow(x.number, y.number) };
+  }
+  if (x.kind == Kind::Integer) {
+    std::int64_t result = 1;
+    std::int64_t square = x.integer;
+    bool overflow = false;
+    for (std::int64_t rest = *exponent; rest != 0; rest >>= 1) {
+      if (rest & 1) {
+        overflow |= __builtin_mul_overflow(result, square, &result);
+      }
+      if (rest > 1) {
+        overflow |= __builtin_mul_overflow(square, square, &square);
+      }
+    }
+    if (!overflow) {
+      return NumberValue { result };
+    }
+  }
+  return NumberValue { BigInt::power(x.getBigInteger(),
+    static_cast<std::uint64_t>(*exponent)) };
+}
+
+// divide(x, y) - Divides the doubles.
+NumberValue NumberValue::divide(const NumberValue &x, const NumberValue &y) {
+  return NumberValue { x.number / y.number };
+}
+
+// quotient(x, y) - Dividing the most negative 64-bit number by -1 is the one
+//  division of Ints in 64 bits that overflows.
+std::optional<NumberValue> NumberValue::quotient(const NumberValue &x,
+  const NumberValue &y) {
+  if (!x.isInteger() || !y.isInteger()) {
+    return NumberValue { std::trunc(x.number / y.number) };
+  }
+  if (y.kind == Kind::Integer && y.integer == 0) {
+    return {};
+  }
+  if (x.kind == Kind::Integer && y.kind == Kind::Integer && !(y.integer == -1 &&
+    x.integer == std::numeric_limits<std::int64_t>::min())) {
+    return NumberValue { x.integer / y.integer };
+  }
+  BigInt quotient { 0 };
+  BigInt remainder { 0 };
+  BigInt::divide(x.getBigInteger(), y.getBigInteger(), quotient, remainder);
+  return NumberValue { quotient };
+}
+
+// remainder(x, y) - Floats are divided with std::fmod, which is exact.
+std::optional<NumberValue> NumberValue::remainder(const NumberValue &x,
+  const NumberValue &y) {
+  if (!x.isInteger() || !y.isInteger()) {
+    return NumberValue { std::fmod(x.number, y.number) };
+  }
+  if (y.kind == Kind::Integer && y.integer == 0) {
+    return {};
+  }
+  if (x.kind == Kind::Integer && y.kind == Kind::Integer) {
+    return NumberValue { y.integer == -1 ? 0 : x.integer % y.integer };
+  }
+  BigInt quotient { 0 };
+  BigInt remainder { 0 };
+  BigInt::divide(x.getBigInteger(), y.getBigInteger(), quotient, remainder);
+  return NumberValue { remainder };
+}
+
+// gcd(x, y) - Ints in 64 bits use std::gcd on their magnitudes, and Floats use
+//  Euclid's algorithm with std::fmod, which is exact.
+NumberValue NumberValue::gcd(const NumberValue &x, const NumberValue &y) {
+  if (x.kind == Kind::Integer && y.kind == Kind::Integer) {
+    const auto magnitude = [](std::int64_t number) {
+      return number < 0 ? 0 - static_cast<std::uint64_t>(number) :
+        static_cast<std::uint64_t>(number);
+    };
+    const std::uint64_t divisor = std::gcd(magnitude(x.integer),
+      magnitude(y.integer));
+    if (divisor <= std::numeric_limits<std::int64_t>::max()) {
+      return NumberValue { static_cast<std::int64_t>(divisor) };
+    }
+  }
+  if (x.isInteger() && y.isInteger()) {
+    return NumberValue { BigInt::gcd(x.getBigInteger(), y.getBigInteger()) };
+  }
+  double larger = std::fabs(x.number);
+  double smaller = std::fabs(y.number);
+  if (!std::isfinite(larger) || !std::isfinite(smaller)) {
+    return NumberValue { std::numeric_limits<double>::quiet_NaN() };
+  }
+  while (smaller != 0) {
+    const double rest = std::fmod(larger, smaller);
+    larger = smaller;
+    smaller = rest;
+  }
+  return NumberValue { larger };
+}
+
+// lcm(x, y) - Divides x by the gcd before multiplying, so that the product is
+//  no larger than it needs to be.
+NumberValue NumberValue::lcm(const NumberValue &x, const NumberValue &y) {
+  const NumberValue divisor = gcd(x, y);
+  if (!x.isInteger() || !y.isInteger()) {
+    return NumberValue { divisor.number == 0 ? 0 :
+      std::fabs(x.number / divisor.number * y.number) };
+  }
+  if (divisor.kind == Kind::Integer && divisor.integer == 0) {
+    return NumberValue { std::int64_t { 0 } };
+  }
+  const NumberValue multiple = multiply(*quotient(x, divisor), y);
+  if (multiple.number < 0) {
+    return subtract(NumberValue { std::int64_t { 0 } }, multiple);
+  }
+  return multiple;
+}
+
+// compareIntegers(x, y) - Ints in 64 bits are compared directly.
+int NumberValue::compareIntegers(const NumberValue &x, const NumberValue &y) {
+  if (x.kind == Kind::Integer && y.kind == Kind::Integer) {
+    return x.integer < y.integer ? -1 : x.integer > y.integer ? 1 : 0;
+  }
+  return BigInt::compare(x.getBigInteger(), y.getBigInteger());
+}
+
+// hash() - Every number is hashed by its double, since an Int only equals a
+//  Float if their doubles are equal.
+std::optional<std::size_t> NumberValue::hash() const {
+  return hashOf(number);
+}
+
+bool NumberValue::equals(const Value &other) const {
+  const auto otherNumber = dynamic_cast<const NumberValue *>(&other);
+  if (!otherNumber) {
+    return false;
+  }
+  if (kind != Kind::Float && otherNumber->kind != Kind::Float) {
+    return compareIntegers(*this, *otherNumber) == 0;
+  }
+  return number == otherNumber->number;
+}
+
+// hashOf(number) - A whole number that fits in 64 bits is hashed as an
+//  integer, so that 0 and -0.0 have the same hash, and any other number by
+//  the bits of its double.
+std::size_t NumberValue::hashOf(double number) {
+  if (std::trunc(number) == number && std::fabs(number) < 9.2e18) {
+    return mixHash(static_cast<std::uint64_t>(
+      static_cast<std::int64_t>(number)
+    ));
+  }
+  std::uint64_t bits;
+  std::memcpy(&bits, &number, sizeof bits);
+  return mixHash(bits);
+}
+
 const std::string NumberValue::name { "Number" };
 
 // getName() - Returns "Number", the name of the Number type.
@@ -1,42 +1,134 @@
 // File: src/NumberValue.hpp
-// Purpose: A NumberValue is a Value that contains a floating point number.
-//  The actual C++ double inside the class should be accessed by built in
-//  functions. Fleet code can build more functions from these built in
-//  functions. For implementations see src/NumberValue.cpp.
+// Purpose: A NumberValue is a Value that contains a number, which is either a
+//  Float (a C++ double) or an Int (an exact integer). The actual number inside
+//  the class should be accessed by built in functions. Fleet code can build
+//  more functions from these built in functions. For implementations see
+//  src/NumberValue.cpp.
 
 #ifndef NUMBERVALUE_HPP
 #define NUMBERVALUE_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include "BigInt.hpp"
 #include "Token.hpp"
 #include "Value.hpp"
 
+// NumberValue - A Float or an Int. Number literals without a `.` are Ints.
+//  An Int is kept in 64 bits as long as it fits, and arithmetic on two such
+//  Ints checks for overflow and only then moves to a BigInt (see
+//  src/BigInt.hpp), so Ints never lose precision. Arithmetic with a Float
+//  gives a Float. Every NumberValue also keeps its number as a double, which
+//  is what getRawNumber returns.
 class NumberValue: public Value {
 private:
+  enum class Kind { Float, Integer, Big };
+
   double number;
+  std::int64_t integer;
+  std::shared_ptr<const BigInt> big;
+  Kind kind;
+
 public:
-  // Constructor(rawNumber) - Creates a NumberValue with rawNumber as its
-  //  internal C++ double.
+  // Constructor(rawNumber) - Creates a Float with rawNumber as its internal
+  //  C++ double.
   NumberValue(double rawNumber);
+  // Constructor(integer) - Creates an Int.
+  NumberValue(std::int64_t integer);
+  // Constructor(integer) - Creates an Int, which is kept in 64 bits if it
+  //  fits.
+  NumberValue(const BigInt &integer);
   // Constructor(other) - Creates a copy of other.
   NumberValue(const NumberValue &other);
-  // Constructor(numberToken) - Creates a NumberValue with its internal number
-  //  as the value of the token.
-  NumberValue(const Token &numberToken);
-
+  // Assignment(other) - Makes this a copy of other.
+  NumberValue &operator=(const NumberValue &other) = default;
   // Destructor - Default
   ~NumberValue() = default;
 
+  // static parseInteger(text) - Returns the Int written in decimal in text,
+  //  which may start with a minus sign, or nothing if text is not such a
+  //  number.
+  static std::optional<NumberValue> parseInteger(const std::string &text);
+
+  // static parseFloat(text) - Returns the Float written in text, in decimal or
+  //  scientific notation, or nothing if text is not such a number.
+  static std::optional<NumberValue> parseFloat(const std::string &text);
+
+  // static parseLiteral(numberToken) - Returns the number written in the
+  //  Number Token numberToken, which is an Int unless it includes a `.`, or
+  //  nothing if numberToken is not such a number.
+  static std::optional<NumberValue> parseLiteral(const Token &numberToken);
+
   // call(arg) - Returns an error, since NumberValues cannot be called.
   Value::OrError call([[maybe_unused]] Value::Pointer arg) const;
 
+  // evacuate(evacuation) - Returns a copy of the number.
+  Value::Pointer evacuate(Evacuation &evacuation) const;
+
   // operator string() - Returns the string reprentation of the NumberValue's
   //  internal number.
   operator std::string() const;
 
-  // getRawNumber() - Returns the NumberValue's internal C++ double.
+  // getRawNumber() - Returns the NumberValue's internal C++ double, which is
+  //  the nearest double to an Int.
   double getRawNumber() const;
 
+  // isInteger() - Returns whether the NumberValue is an Int.
+  bool isInteger() const;
+
+  // getSmallInteger() - Returns the Int if it fits in 64 bits, and nothing
+  //  for a Float or a larger Int.
+  std::optional<std::int64_t> getSmallInteger() const;
+
+  // getBigInteger() - Returns the Int as a BigInt. The NumberValue must be an
+  //  Int.
+  BigInt getBigInteger() const;
+
+  // static add(x, y), subtract(x, y), multiply(x, y) - Return x + y, x - y and
+  //  x * y: an Int if both are Ints, and a Float otherwise.
+  static NumberValue add(const NumberValue &x, const NumberValue &y);
+  static NumberValue subtract(const NumberValue &x, const NumberValue &y);
+  static NumberValue multiply(const NumberValue &x, const NumberValue &y);
+
+  // static power(x, y) - Returns x raised to y, which is an Int if both are
+  //  Ints and y is not negative.
+  static NumberValue power(const NumberValue &x, const NumberValue &y);
+
+  // static divide(x, y) - Returns x / y as a Float.
+  static NumberValue divide(const NumberValue &x, const NumberValue &y);
+
+  // static quotient(x, y), remainder(x, y) - Return x / y rounded toward 0
+  //  and the remainder of that division, which has the sign of x. Both are
+  //  Ints if x and y are, in which case nothing is returned if y is 0.
+  static std::optional<NumberValue> quotient(const NumberValue &x,
+    const NumberValue &y);
+  static std::optional<NumberValue> remainder(const NumberValue &x,
+    const NumberValue &y);
+
+  // static gcd(x, y), lcm(x, y) - Return the greatest common divisor and the
+  //  least common multiple of x and y, which are never negative.
+  static NumberValue gcd(const NumberValue &x, const NumberValue &y);
+  static NumberValue lcm(const NumberValue &x, const NumberValue &y);
+
+  // static compareIntegers(x, y) - Returns a negative number, 0 or a positive
+  //  number if x is less than, equal to or greater than y. Both must be Ints.
+  static int compareIntegers(const NumberValue &x, const NumberValue &y);
+
+  // hash() - Returns the hash of the number, which is the same for an Int and
+  //  a Float that are equal.
+  std::optional<std::size_t> hash() const;
+
+  // equals(other) - Returns whether other is a number equal to this one. Two
+  //  Ints are compared exactly, and any other two numbers as doubles.
+  bool equals(const Value &other) const;
+
+  // static hashOf(number) - Returns the hash of the Float number, without
+  //  creating a NumberValue for it.
+  static std::size_t hashOf(double number);
+
   // name/getName() - Returns "Number", the name of a NumberValue-type value.
   static const std::string name;
   static std::string getClassName();
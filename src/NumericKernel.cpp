@@ -0,0 +1,386 @@
+// File: src/NumericKernel.cpp
+// Purpose: Source file for NumericKernels, which describe builtin arithmetic
+//  operators and comparisons with one argument given, such as (* 2), as
+//  operations on plain numbers. See src/NumericKernel.hpp for more
+//  documentation.
+
+#include <cmath>
+#include <cstddef>
+#include "NumericKernel.hpp"
+
+// The AVX2 copies of the loops are only compiled by GCC and Clang for x86,
+//  which can compile single functions for AVX2 and check for it at run time.
+#if (defined(__GNUC__) || defined(__clang__)) && \
+  (defined(__x86_64__) || defined(__i386__))
+#define NUMERICKERNEL_AVX2
+#endif
+
+// Constructor
+NumericKernel::NumericKernel(NumericKernel::Op op, double constant,
+  bool constantFirst): op { op }, constant { constant },
+  constantFirst { constantFirst } {}
+
+// isComparison() - Comparisons follow the arithmetic operators in Op.
+bool NumericKernel::isComparison() const {
+  return op >= Op::Less;
+}
+
+// apply(x) - Computes the operator the same way its builtin does.
+double NumericKernel::apply(double x) const {
+  const double first = constantFirst ? constant : x;
+  const double second = constantFirst ? x : constant;
+  switch (op) {
+    case Op::Add:
+      return first + second;
+    case Op::Subtract:
+      return first - second;
+    case Op::Multiply:
+      return first * second;
+    case Op::Power:
+      return std::pow(first, second);
+    case Op::Modulo:
+      return std::fmod(first, second);
+    default:
+      return test(x) ? 1 : 0;
+  }
+}
+
+// test(x) - Compares the same way the builtin comparisons do.
+bool NumericKernel::test(double x) const {
+  const double first = constantFirst ? constant : x;
+  const double second = constantFirst ? x : constant;
+  switch (op) {
+    case Op::Less:
+      return first < second;
+    case Op::LessOrEqual:
+      return first <= second;
+    case Op::Greater:
+      return first > second;
+    case Op::GreaterOrEqual:
+      return first >= second;
+    case Op::Equal:
+      return first == second;
+    case Op::NotEqual:
+      return first != second;
+    default:
+      return apply(x) != 0;
+  }
+}
+
+// applyAll(numbers, count) - The operator is chosen once, outside the loops,
+//  so that the compiler can vectorize the common ones. Squaring is by far the
+//  most common power, and is done without calling std::pow.
+void NumericKernel::applyAll(double *numbers, std::size_t count) const {
+  const double c = constant;
+  switch (op) {
+    case Op::Add:
+      for (std::size_t i = 0; i < count; i++) {
+        numbers[i] += c;
+      }
+      return;
+    case Op::Subtract:
+      if (constantFirst) {
+        for (std::size_t i = 0; i < count; i++) {
+          numbers[i] = c - numbers[i];
+        }
+      }
+      else {
+        for (std::size_t i = 0; i < count; i++) {
+          numbers[i] -= c;
+        }
+      }
+      return;
+    case Op::Multiply:
+      for (std::size_t i = 0; i < count; i++) {
+        numbers[i] *= c;
+      }
+      return;
+    case Op::Power:
+      if (!constantFirst && c == 2) {
+        for (std::size_t i = 0; i < count; i++) {
+          numbers[i] *= numbers[i];
+        }
+        return;
+      }
+      break;
+    default:
+      break;
+  }
+  for (std::size_t i = 0; i < count; i++) {
+    numbers[i] = apply(numbers[i]);
+  }
+}
+
+// testAll(numbers, passed, count) - Like applyAll, chooses the comparison once.
+void NumericKernel::testAll(const double *numbers, bool *passed,
+  std::size_t count) const {
+  // A comparison with the constant first is the opposite comparison with the
+  //  constant second, as in (2 <) x and x > 2. Equal and NotEqual are their
+  //  own opposites.
+  Op flipped = op;
+  if (constantFirst) {
+    switch (op) {
+      case Op::Less:
+        flipped = Op::Greater;
+        break;
+      case Op::LessOrEqual:
+        flipped = Op::GreaterOrEqual;
+        break;
+      case Op::Greater:
+        flipped = Op::Less;
+        break;
+      case Op::GreaterOrEqual:
+        flipped = Op::LessOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  const double c = constant;
+  switch (flipped) {
+    case Op::Less:
+      for (std::size_t i = 0; i < count; i++) {
+        passed[i] = numbers[i] < c;
+      }
+      return;
+    case Op::LessOrEqual:
+      for (std::size_t i = 0; i < count; i++) {
+        passed[i] = numbers[i] <= c;
+      }
+      return;
+    case Op::Greater:
+      for (std::size_t i = 0; i < count; i++) {
+        passed[i] = numbers[i] > c;
+      }
+      return;
+    case Op::GreaterOrEqual:
+      for (std::size_t i = 0; i < count; i++) {
+        passed[i] = numbers[i] >= c;
+      }
+      return;
+    case Op::Equal:
+      for (std::size_t i = 0; i < count; i++) {
+        passed[i] = numbers[i] == c;
+      }
+      return;
+    case Op::NotEqual:
+      for (std::size_t i = 0; i < count; i++) {
+        passed[i] = numbers[i] != c;
+      }
+      return;
+    default:
+      for (std::size_t i = 0; i < count; i++) {
+        passed[i] = test(numbers[i]);
+      }
+  }
+}
+
+// hasAvx2() - __builtin_cpu_supports reads the result of CPUID, which is
+//  kept after the first call.
+bool NumericKernel::hasAvx2() {
+#ifdef NUMERICKERNEL_AVX2
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+// foldLanes<fold>(x, y, count) - Folds the count numbers of x (multiplied by
+//  those of y for Dot) in 16 lanes, one for each position modulo 16, and then
+//  folds the lanes pairwise. Each lane is only ever combined in order, so the
+//  compiler can vectorize the loop without -ffast-math, and the result does
+//  not depend on the instructions it uses. Minimum and Maximum let NaN win.
+//  It is always inlined, so that it is compiled for the instructions of
+//  whichever copy calls it.
+template <NumericKernel::Fold fold>
+__attribute__((always_inline)) inline double NumericKernel::foldLanes(
+  const double *x, const double *y, std::size_t count) {
+  const std::size_t width = 16;
+  double lanes[width];
+  for (std::size_t j = 0; j < width; j++) {
+    lanes[j] = fold == Fold::Product ? 1 :
+      fold == Fold::Minimum || fold == Fold::Maximum ? x[0] : 0;
+  }
+  std::size_t i = 0;
+  for (; i + width <= count; i += width) {
+    for (std::size_t j = 0; j < width; j++) {
+      const double next = x[i + j];
+      switch (fold) {
+        case Fold::Sum:
+          lanes[j] += next;
+          break;
+        case Fold::Product:
+          lanes[j] *= next;
+          break;
+        case Fold::Minimum:
+          lanes[j] = next < lanes[j] || next != next ? next : lanes[j];
+          break;
+        case Fold::Maximum:
+          lanes[j] = next > lanes[j] || next != next ? next : lanes[j];
+          break;
+        case Fold::Dot:
+          lanes[j] += next * y[i + j];
+          break;
+      }
+    }
+  }
+  for (std::size_t j = 0; i < count; i++, j++) {
+    const double next = x[i];
+    switch (fold) {
+      case Fold::Sum:
+        lanes[j] += next;
+        break;
+      case Fold::Product:
+        lanes[j] *= next;
+        break;
+      case Fold::Minimum:
+        lanes[j] = next < lanes[j] || next != next ? next : lanes[j];
+        break;
+      case Fold::Maximum:
+        lanes[j] = next > lanes[j] || next != next ? next : lanes[j];
+        break;
+      case Fold::Dot:
+        lanes[j] += next * y[i];
+        break;
+    }
+  }
+  for (std::size_t half = width / 2; half > 0; half /= 2) {
+    for (std::size_t j = 0; j < half; j++) {
+      const double next = lanes[j + half];
+      switch (fold) {
+        case Fold::Sum:
+        case Fold::Dot:
+          lanes[j] += next;
+          break;
+        case Fold::Product:
+          lanes[j] *= next;
+          break;
+        case Fold::Minimum:
+          lanes[j] = next < lanes[j] || next != next ? next : lanes[j];
+          break;
+        case Fold::Maximum:
+          lanes[j] = next > lanes[j] || next != next ? next : lanes[j];
+          break;
+      }
+    }
+  }
+  return lanes[0];
+}
+
+// foldAvx2<fold>(x, y, count), foldDefault<fold>(x, y, count) - The copies
+//  of foldLanes compiled for AVX2 and for the baseline.
+#ifdef NUMERICKERNEL_AVX2
+template <NumericKernel::Fold fold>
+__attribute__((target("avx2"))) double NumericKernel::foldAvx2(
+  const double *x, const double *y, std::size_t count) {
+  return foldLanes<fold>(x, y, count);
+}
+#else
+template <NumericKernel::Fold fold>
+double NumericKernel::foldAvx2(const double *x, const double *y,
+  std::size_t count) {
+  return foldLanes<fold>(x, y, count);
+}
+#endif
+
+template <NumericKernel::Fold fold>
+double NumericKernel::foldDefault(const double *x, const double *y,
+  std::size_t count) {
+  return foldLanes<fold>(x, y, count);
+}
+
+// foldPairwise<fold>(x, y, count, avx2) - Splits the numbers in halves until
+//  there are at most 256 of them, which foldLanes folds, and combines the
+//  halves. Since each number only goes through about log2(count / 256) + 20
+//  additions, the error of a sum stays small even for millions of numbers.
+template <NumericKernel::Fold fold>
+double NumericKernel::foldPairwise(const double *x, const double *y,
+  std::size_t count, bool avx2) {
+  if (count <= 256) {
+    return avx2 ? foldAvx2<fold>(x, y, count) :
+      foldDefault<fold>(x, y, count);
+  }
+  const std::size_t half = count / 2;
+  return foldPairwise<fold>(x, y, half, avx2) +
+    foldPairwise<fold>(x + half, y ? y + half : y, count - half, avx2);
+}
+
+// sumAll(numbers, count) - Adds pairwise.
+double NumericKernel::sumAll(const double *numbers, std::size_t count) {
+  return foldPairwise<Fold::Sum>(numbers, nullptr, count, hasAvx2());
+}
+
+// productAll(numbers, count) - Products are not made more accurate by
+//  multiplying pairwise, so the lanes go through every number.
+double NumericKernel::productAll(const double *numbers, std::size_t count) {
+  return hasAvx2() ? foldAvx2<Fold::Product>(numbers, nullptr, count) :
+    foldDefault<Fold::Product>(numbers, nullptr, count);
+}
+
+// minimumAll(numbers, count), maximumAll(numbers, count) - Every lane starts
+//  at the first number, so no lane is left without one.
+double NumericKernel::minimumAll(const double *numbers, std::size_t count) {
+  return hasAvx2() ? foldAvx2<Fold::Minimum>(numbers, nullptr, count) :
+    foldDefault<Fold::Minimum>(numbers, nullptr, count);
+}
+
+double NumericKernel::maximumAll(const double *numbers, std::size_t count) {
+  return hasAvx2() ? foldAvx2<Fold::Maximum>(numbers, nullptr, count) :
+    foldDefault<Fold::Maximum>(numbers, nullptr, count);
+}
+
+// dotAll(x, y, count) - Multiplies and adds pairwise.
+double NumericKernel::dotAll(const double *x, const double *y,
+  std::size_t count) {
+  return foldPairwise<Fold::Dot>(x, y, count, hasAvx2());
+}
+
+// equalLanes(x, y, count) - Compares 16 numbers at a time, combining whether
+//  each pair differs without branching, and stops after the first 16 with a
+//  pair that does. It is always inlined, so that it is compiled for the
+//  instructions of whichever copy calls it.
+__attribute__((always_inline)) inline bool NumericKernel::equalLanes(
+  const double *x, const double *y, std::size_t count) {
+  const std::size_t width = 16;
+  std::size_t i = 0;
+  for (; i + width <= count; i += width) {
+    bool differ = false;
+    for (std::size_t j = 0; j < width; j++) {
+      differ |= x[i + j] != y[i + j];
+    }
+    if (differ) {
+      return false;
+    }
+  }
+  for (; i < count; i++) {
+    if (x[i] != y[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// equalAvx2(x, y, count), equalDefault(x, y, count) - The copies of
+//  equalLanes compiled for AVX2 and for the baseline.
+#ifdef NUMERICKERNEL_AVX2
+__attribute__((target("avx2"))) bool NumericKernel::equalAvx2(
+  const double *x, const double *y, std::size_t count) {
+  return equalLanes(x, y, count);
+}
+#else
+bool NumericKernel::equalAvx2(const double *x, const double *y,
+  std::size_t count) {
+  return equalLanes(x, y, count);
+}
+#endif
+
+bool NumericKernel::equalDefault(const double *x, const double *y,
+  std::size_t count) {
+  return equalLanes(x, y, count);
+}
+
+bool NumericKernel::equalAll(const double *x, const double *y,
+  std::size_t count) {
+  return hasAvx2() ? equalAvx2(x, y, count) : equalDefault(x, y, count);
+}
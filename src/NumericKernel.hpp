@@ -0,0 +1,114 @@
+// File: src/NumericKernel.hpp
+// Purpose: Header file for NumericKernels, which describe builtin arithmetic
+//  operators and comparisons with one argument given, such as (* 2), as
+//  operations on plain numbers. See src/NumericKernel.cpp for
+//  implementations.
+
+#ifndef NUMERICKERNEL_HPP
+#define NUMERICKERNEL_HPP
+
+#include <cstddef>
+
+// NumericKernel - A builtin operator on two numbers with one of them fixed,
+//  such as (* 2), (2 -) or (< 10). Calling such a function creates a
+//  NumberValue (or a BooleanValue) per call, so code that applies it to many
+//  numbers at once (see src/SequenceValue.hpp) applies its NumericKernel to
+//  plain doubles instead. The functions that builtin operators return when
+//  called with one number have a NumericKernel (see Value::getNumericKernel).
+// NumericKernel also has the loops that reduce arrays of plain doubles, such
+//  as sumAll. They keep several partial results (lanes) at once, so that the
+//  compiler can vectorize them without reordering any one lane. On x86
+//  processors with AVX2 they run a copy compiled for AVX2, which handles four
+//  doubles per instruction, and otherwise a copy for the baseline (SSE2).
+class NumericKernel {
+public:
+  // The builtin operators that have kernels. The first five are arithmetic and
+  //  the rest are comparisons.
+  enum class Op {
+    Add,
+    Subtract,
+    Multiply,
+    Power,
+    Modulo,
+    Less,
+    LessOrEqual,
+    Greater,
+    GreaterOrEqual,
+    Equal,
+    NotEqual
+  };
+
+  Op op;
+  double constant;
+  // Whether constant is the first argument of op, as in (2 -), rather than
+  //  the second, as in (- 2).
+  bool constantFirst;
+
+  // Constructor(op, constant, constantFirst) - Creates a NumericKernel.
+  NumericKernel(Op op, double constant, bool constantFirst);
+
+  // isComparison() - Returns whether op is a comparison.
+  bool isComparison() const;
+
+  // apply(x) - Returns the result of an arithmetic kernel for x.
+  double apply(double x) const;
+
+  // test(x) - Returns the result of a comparison kernel for x.
+  bool test(double x) const;
+
+  // applyAll(numbers, count) - Replaces each of the count numbers with the
+  //  result of an arithmetic kernel for it.
+  void applyAll(double *numbers, std::size_t count) const;
+
+  // testAll(numbers, passed, count) - Sets passed[i] to the result of a
+  //  comparison kernel for numbers[i], for each of the count numbers.
+  void testAll(const double *numbers, bool *passed, std::size_t count) const;
+
+  // static sumAll(numbers, count), productAll(numbers, count) - Return the
+  //  sum or the product of the count numbers. Sums are computed pairwise, so
+  //  that the rounding error only grows with the logarithm of count.
+  static double sumAll(const double *numbers, std::size_t count);
+  static double productAll(const double *numbers, std::size_t count);
+
+  // static minimumAll(numbers, count), maximumAll(numbers, count) - Return
+  //  the smallest or the largest of the count numbers, or NaN if any of them
+  //  is NaN. count must not be 0.
+  static double minimumAll(const double *numbers, std::size_t count);
+  static double maximumAll(const double *numbers, std::size_t count);
+
+  // static dotAll(x, y, count) - Returns the sum of x[i] * y[i] for each of
+  //  the count numbers of x and y, computed pairwise like sumAll.
+  static double dotAll(const double *x, const double *y, std::size_t count);
+
+  // static equalAll(x, y, count) - Returns whether x[i] == y[i] for each of
+  //  the count numbers of x and y.
+  static bool equalAll(const double *x, const double *y, std::size_t count);
+
+  // static hasAvx2() - Returns whether the processor supports AVX2, which is
+  //  only checked once.
+  static bool hasAvx2();
+
+private:
+  // The ways in which fold can combine numbers.
+  enum class Fold { Sum, Product, Minimum, Maximum, Dot };
+
+  // Private methods are documented in src/NumericKernel.cpp.
+  template <Fold fold>
+  static double foldLanes(const double *x, const double *y,
+    std::size_t count);
+  template <Fold fold>
+  static double foldAvx2(const double *x, const double *y, std::size_t count);
+  template <Fold fold>
+  static double foldDefault(const double *x, const double *y,
+    std::size_t count);
+  template <Fold fold>
+  static double foldPairwise(const double *x, const double *y,
+    std::size_t count, bool avx2);
+  static bool equalLanes(const double *x, const double *y,
+    std::size_t count);
+  static bool equalAvx2(const double *x, const double *y, std::size_t count);
+  static bool equalDefault(const double *x, const double *y,
+    std::size_t count);
+};
+
+#endif
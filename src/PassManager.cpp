@@ -0,0 +1,260 @@
+// File: src/PassManager.cpp
+// Purpose: Source file for PassManagers, which run an ordered list of
+//  optimization passes over a TokenTree before it is evaluated. See
+//  src/PassManager.hpp for more documentation.
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include "PassManager.hpp"
+#include "ConstantFolder.hpp"
+#include "Context.hpp"
+#include "Directives.hpp"
+#include "Inliner.hpp"
+#include "Memoizer.hpp"
+#include "ParseError.hpp"
+#include "StrictnessAnalyzer.hpp"
+#include "TokenTree.hpp"
+
+// This constructor creates a PassManager without any passes.
+PassManager::PassManager(bool verifying): verifying { verifying } {}
+
+// This function returns a PassManager with the passes of an optimization level.
+PassManager PassManager::forLevel(int level, const Inliner::Options &inlining,
+  const Memoizer::Options &memoizing) {
+  PassManager manager;
+  if (level >= 2) {
+    manager.add("inline", [inlining](const TokenTree &ast,
+      const Context::Pointer &context) {
+      return Inliner::inlineCalls(ast, context, inlining);
+    });
+  }
+  if (!memoizing.names.empty() || memoizing.automatic) {
+    manager.add("memoize", [memoizing](const TokenTree &ast,
+      const Context::Pointer &context) {
+      return Memoizer::memoizeDefinitions(ast, context, memoizing);
+    });
+  }
+  if (level >= 1) {
+    manager.add("fold", ConstantFolder::fold);
+    manager.add("strictness", StrictnessAnalyzer::analyze);
+  }
+  return manager;
+}
+
+// This function returns the PassManager for a level as adjusted by the
+//  directives of the code.
+PassManager PassManager::forCode(int level, const Directives &directives) {
+  Inliner::Options inlining;
+  readSize(directives, "inline_size", inlining.maxInlineSize);
+  readSize(directives, "common_size", inlining.minCommonSize);
+  Memoizer::Options memoizing;
+  memoizing.names = directives.getTargets("memoize");
+  memoizing.automatic = directives.get("memoize") == std::string { "auto" };
+  readSize(directives, "memo_size", memoizing.capacity);
+  return forLevel(directives.isSet("no_optimize") ? 0 : level, inlining,
+    memoizing);
+}
+
+// This function returns whether PassManagers verify code by default, which
+//  they do in debug builds (built with DEBUG defined; see the Makefile).
+bool PassManager::verifiesByDefault() {
+#ifdef DEBUG
+  return true;
+#else
+  return false;
+#endif
+}
+
+// readSize(directives, name, size) - Sets size to the value of the directive
+//  with the given name if it is given as a whole number.
+void PassManager::readSize(const Directives &directives,
+  const std::string &name, std::size_t &size) {
+  const auto &value = directives.get(name);
+  if (value) {
+    std::size_t result = 0;
+    const char *end = value->data() + value->size();
+    const auto [next, error] = std::from_chars(value->data(), end, result);
+    if (error == std::errc {} && next == end) {
+      size = result;
+    }
+  }
+}
+
+// check(tree, stage) - Throws a ParseError describing the problem with tree if
+//  verification is enabled and tree is not valid code. stage says where in the
+//  pipeline tree came from.
+void PassManager::check(const TokenTree &tree, const std::string &stage) const {
+  if (!verifying) {
+    return;
+  }
+  const auto &problem = verify(tree);
+  if (problem) {
+    throw ParseError { "Internal error: Invalid code " + stage + ": " +
+      *problem };
+  }
+}
+
+// This method adds a pass after the passes already added.
+void PassManager::add(const std::string &name, const Pass &pass) {
+  passes.push_back(pass);
+  timings.push_back({ name });
+}
+
+// This method runs every pass in order and records their Timings.
+TokenTree PassManager::run(const TokenTree &ast,
+  const Context::Pointer &context) {
+  check(ast, "before the first pass");
+  TokenTree tree = ast;
+  std::size_t size = sizeOf(tree);
+  for (std::size_t i = 0; i < passes.size(); i++) {
+    Timing &timing = timings.at(i);
+    const auto start = std::chrono::steady_clock::now();
+    TokenTree next = passes.at(i)(tree, context);
+    const auto end = std::chrono::steady_clock::now();
+    check(next, "after pass " + timing.name);
+    const std::size_t nextSize = sizeOf(next);
+    timing.milliseconds +=
+      std::chrono::duration<double, std::milli>(end - start).count();
+    timing.sizeBefore += size;
+    timing.sizeAfter += nextSize;
+    tree = std::move(next);
+    size = nextSize;
+  }
+  return tree;
+}
+
+// This method returns whether there are no passes.
+bool PassManager::isEmpty() const {
+  return passes.empty();
+}
+
+// This method returns the Timings of the passes, in order.
+const std::vector<PassManager::Timing> &PassManager::getTimings() const {
+  return timings;
+}
+
+// This method returns a table with a header line and one line per pass giving
+//  its name, its time in milliseconds, the sizes before and after it, and the
+//  percentage by which it shrank the code (negative if it grew the code).
+std::string PassManager::getTimingReport() const {
+  std::size_t nameWidth = 4;
+  for (const auto &timing : timings) {
+    nameWidth = std::max(nameWidth, timing.name.size());
+  }
+  std::ostringstream report;
+  report << std::left << std::setw(nameWidth) << "Pass" << std::right <<
+    std::setw(12) << "Time (ms)" << std::setw(10) << "Before" <<
+    std::setw(10) << "After" << std::setw(10) << "Shrink" << "\n";
+  for (const auto &timing : timings) {
+    const double shrink = timing.sizeBefore == 0 ? 0 : 100.0 *
+      (static_cast<double>(timing.sizeBefore) -
+        static_cast<double>(timing.sizeAfter)) / timing.sizeBefore;
+    report << std::left << std::setw(nameWidth) << timing.name << std::right <<
+      std::fixed << std::setprecision(3) << std::setw(12) <<
+      timing.milliseconds << std::setw(10) << timing.sizeBefore <<
+      std::setw(10) << timing.sizeAfter << std::setprecision(1) <<
+      std::setw(9) << shrink << "%\n";
+  }
+  return report.str();
+}
+
+// This function counts the nodes of a TokenTree as it will be evaluated. It
+//  uses an explicit stack so that deep trees cannot overflow the C++ stack.
+std::size_t PassManager::sizeOf(const TokenTree &tree) {
+  std::size_t size = 0;
+  std::vector<const TokenTree *> pending { &tree };
+  while (!pending.empty()) {
+    const TokenTree *next = pending.back();
+    pending.pop_back();
+    if (!next) {
+      continue;
+    }
+    size++;
+    if (next->getConstantPointer()) {
+      continue;
+    }
+    if (const auto binding = next->getBindingPointer()) {
+      pending.push_back(binding->value.get());
+      pending.push_back(binding->body.get());
+    }
+    else if (const auto pair = next->getFunctionPairPointer()) {
+      pending.push_back(pair->first.get());
+      pending.push_back(pair->second.get());
+    }
+    else if (const auto lines = next->getLineListPointer()) {
+      for (const auto &line : *lines) {
+        pending.push_back(line.get());
+      }
+    }
+  }
+  return size;
+}
+
+// This function checks the invariants that the Evaluator relies on, using an
+//  explicit stack of subtrees paired with whether each is part of a call.
+std::optional<std::string> PassManager::verify(const TokenTree &tree) {
+  // A Constant or a Binding must stand for a plain TokenTree, since
+  //  TokenTree::unfolded() only looks through one level.
+  const auto isPlain = [](const TokenTree &original) {
+    return !original.getConstantPointer() && !original.getBindingPointer();
+  };
+  std::vector<std::pair<const TokenTree *, bool>> pending { { &tree, false } };
+  while (!pending.empty()) {
+    const auto [next, inCall] = pending.back();
+    pending.pop_back();
+    if (const auto constant = next->getConstantPointer()) {
+      if (!constant->value || !constant->original) {
+        return { "Constant without a value or an original" };
+      }
+      if (!isPlain(*constant->original)) {
+        return { "Constant of " +
+          static_cast<std::string>(*constant->original) +
+          " stands for another Constant or Binding" };
+      }
+      continue;
+    }
+    if (const auto binding = next->getBindingPointer()) {
+      if (binding->name.empty() || !binding->value || !binding->body ||
+        !binding->original) {
+        return { "Binding without a name, value, body or original" };
+      }
+      if (!isPlain(*binding->original)) {
+        return { "Binding of " + binding->name +
+          " stands for another Constant or Binding" };
+      }
+      pending.push_back({ binding->value.get(), false });
+      pending.push_back({ binding->body.get(), false });
+      continue;
+    }
+    if (next->isImplied()) {
+      if (!inCall) {
+        return { "Implied argument outside of a call" };
+      }
+    }
+    else if (const auto pair = next->getFunctionPairPointer()) {
+      if (!pair->first || !pair->second) {
+        return { "Call without a function or an argument" };
+      }
+      pending.push_back({ pair->first.get(), true });
+      pending.push_back({ pair->second.get(), true });
+    }
+    else if (const auto lines = next->getLineListPointer()) {
+      for (const auto &line : *lines) {
+        if (!line) {
+          return { "Missing line" };
+        }
+        pending.push_back({ line.get(), false });
+      }
+    }
+  }
+  return {};
+}
@@ -0,0 +1,116 @@
+// File: src/PassManager.hpp
+// Purpose: Header file for PassManagers, which run an ordered list of
+//  optimization passes over a TokenTree before it is evaluated. See
+//  src/PassManager.cpp for implementations.
+
+#ifndef PASSMANAGER_HPP
+#define PASSMANAGER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Context.hpp"
+#include "Directives.hpp"
+#include "Inliner.hpp"
+#include "Memoizer.hpp"
+#include "TokenTree.hpp"
+
+// PassManager - Runs optimization passes, such as the Inliner (see
+//  src/Inliner.hpp), the Memoizer (see src/Memoizer.hpp) and the
+//  ConstantFolder (see src/ConstantFolder.hpp), over
+//  the code in the order they were added. Each pass returns a TokenTree that
+//  gives the same result as the one it is given. If verification is enabled
+//  (the default in debug builds), the code is checked with verify(tree) before
+//  the first pass and after every pass, so that a pass that produces invalid
+//  code is caught where it does so. The time each pass takes and the sizes of
+//  the code before and after it are recorded for every run.
+class PassManager {
+public:
+  // A Pass takes the code and the Context it will be evaluated in.
+  typedef std::function<TokenTree(const TokenTree &, const Context::Pointer &)>
+    Pass;
+
+  // A Timing is the total time spent in a pass over all runs and the total
+  //  sizes (see sizeOf(tree)) of the code it was given and returned.
+  struct Timing {
+    std::string name;
+    double milliseconds = 0;
+    std::size_t sizeBefore = 0;
+    std::size_t sizeAfter = 0;
+  };
+
+  // The level used when none is given.
+  static constexpr int defaultLevel = 2;
+
+private:
+  std::vector<Pass> passes;
+  std::vector<Timing> timings;
+  bool verifying;
+
+  // Private methods are documented in src/PassManager.cpp.
+  static void readSize(const Directives &directives, const std::string &name,
+    std::size_t &size);
+  void check(const TokenTree &tree, const std::string &stage) const;
+
+public:
+  // Constructor(verifying) - Creates a PassManager without any passes, which
+  //  leaves code as it is.
+  PassManager(bool verifying = verifiesByDefault());
+
+  // static forLevel(level, inlining, memoizing) - Returns a PassManager with
+  //  the passes of the given optimization level:
+  //   0 - no passes, so code is evaluated exactly as it is written.
+  //   1 - constant folding followed by strictness analysis.
+  //   2 - inlining (with the given options) followed by the passes of level
+  //       1.
+  //  Levels above 2 are treated as 2. At every level, functions are memoized
+  //  as memoizing asks, after inlining and before constant folding, since
+  //  memoization is only done when the code asks for it.
+  static PassManager forLevel(int level,
+    const Inliner::Options &inlining = Inliner::Options {},
+    const Memoizer::Options &memoizing = Memoizer::Options {});
+
+  // static forCode(level, directives) - Returns the PassManager for the given
+  //  level as adjusted by the directives of the code: `no_optimize` selects
+  //  level 0, `inline_size` and `common_size` set the sizes used by the
+  //  Inliner, `memoize` memoizes the definition after it (or, given as
+  //  `auto`, every function that turns out to benefit), and `memo_size` sets
+  //  the number of results each memoized function remembers.
+  static PassManager forCode(int level, const Directives &directives);
+
+  // static verifiesByDefault() - Returns a boolean indicating whether this is a
+  //  debug build, in which PassManagers verify code between passes.
+  static bool verifiesByDefault();
+
+  // add(name, pass) - Adds a pass to run after the passes already added.
+  void add(const std::string &name, const Pass &pass);
+
+  // run(ast, context) - Returns the result of running every pass in order,
+  //  starting with ast. Throws a ParseError if verification is enabled and
+  //  a pass produces invalid code.
+  TokenTree run(const TokenTree &ast, const Context::Pointer &context);
+
+  // isEmpty() - Returns a boolean indicating whether there are no passes.
+  bool isEmpty() const;
+
+  // getTimings() - Returns the Timings of the passes, in order.
+  const std::vector<Timing> &getTimings() const;
+
+  // getTimingReport() - Returns a table of the Timings, one pass per line.
+  std::string getTimingReport() const;
+
+  // static sizeOf(tree) - Returns the number of nodes in tree as it will be
+  //  evaluated: a Constant counts as one node, and a Binding counts as one
+  //  node plus its value and body.
+  static std::size_t sizeOf(const TokenTree &tree);
+
+  // static verify(tree) - Returns a description of the first problem found in
+  //  tree, or an empty optional if it is valid code for the Evaluator. Valid
+  //  code has no missing subtrees, implied arguments only as parts of calls,
+  //  and Constants and Bindings that stand for plain TokenTrees.
+  static std::optional<std::string> verify(const TokenTree &tree);
+};
+
+#endif
@@ -0,0 +1,251 @@
+// File: src/Pattern.cpp
+// Purpose: Source file for Patterns, which are the parameters of functions
+//  created with `->`. See src/Pattern.hpp for more documentation.
+
+#include <cctype>
+#include <cstddef>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+#include "Pattern.hpp"
+#include "Context.hpp"
+#include "NumberValue.hpp"
+#include "Region.hpp"
+#include "TaggedValue.hpp"
+#include "Token.hpp"
+#include "TokenTree.hpp"
+#include "TupleValue.hpp"
+#include "Value.hpp"
+
+// Constructors
+Pattern::Pattern(Pattern::Kind kind, const std::string &name, double number):
+  kind { kind }, name { name }, number { number },
+  tag { kind == Pattern::Kind::Constructor ? TaggedValue::tagOf(name) : 0 } {}
+
+Pattern::Pattern(const std::string &name):
+  Pattern { Pattern::Kind::Identifier, name, 0.0 } {}
+
+// isConstructorName(name) - Checks the first character of name.
+bool Pattern::isConstructorName(const std::string &name) {
+  return !name.empty() &&
+    std::isupper(static_cast<unsigned char>(name.front()));
+}
+
+// fromTree(ast) - Identifier Tokens become Identifier Patterns, or nullary
+//  Constructor Patterns if they are constructor names, and Number Tokens
+//  become Number Patterns. A constructor name applied to a valid Pattern, as
+//  in Some x, becomes a Constructor Pattern of that Pattern. Tuple literals
+//  (see TokenTree::tupleOf) of valid Patterns become Tuple Patterns, unless
+//  they bind a name twice. Nothing else is currently a valid Pattern.
+std::optional<Pattern> Pattern::fromTree(const TokenTree &ast) {
+  const auto &token = ast.getToken();
+  if (!token) {
+    const auto pair = ast.getFunctionPairPointer();
+    const auto constructor = pair && pair->first && pair->second ?
+      pair->first->getTokenPointer() : nullptr;
+    if (constructor && constructor->getType() == Token::Type::Identifier &&
+      isConstructorName(constructor->getValue())) {
+      const auto &payload = fromTree(*pair->second);
+      if (!payload) {
+        return {};
+      }
+      Pattern tagged {
+        Pattern::Kind::Constructor, constructor->getValue(), 0.0
+      };
+      tagged.elements.push_back(*payload);
+      return { tagged };
+    }
+    Pattern tuple { Pattern::Kind::Tuple, "", 0.0 };
+    if (!addElements(ast, tuple.elements)) {
+      return {};
+    }
+    std::size_t bound = 0;
+    for (const Pattern &element : tuple.elements) {
+      bound += element.getBoundNames().size();
+    }
+    if (tuple.getBoundNames().size() != bound) {
+      return {};
+    }
+    return { tuple };
+  }
+  switch (token->getType()) {
+    case Token::Type::Identifier:
+      if (isConstructorName(token->getValue())) {
+        return { Pattern {
+          Pattern::Kind::Constructor, token->getValue(), 0.0
+        } };
+      }
+      return { Pattern { token->getValue() } };
+    case Token::Type::Number: {
+      const auto number = NumberValue::parseLiteral(*token);
+      if (!number) {
+        return {};
+      }
+      return { Pattern {
+        Pattern::Kind::Number, "", number->getRawNumber()
+      } };
+    }
+    default:
+      return {};
+  }
+}
+
+// addElements(ast, elements) - Adds the Patterns of the elements of the tuple
+//  literal ast to elements, first to last, and returns whether ast is one
+//  and all of them are valid. The first two elements are the arguments of
+//  `(,)` and each later one the second argument of `(,+)`, whose first
+//  argument holds the elements before it.
+bool Pattern::addElements(const TokenTree &ast,
+  std::vector<Pattern> &elements) {
+  const auto pair = ast.getFunctionPairPointer();
+  const auto call = pair && pair->first ?
+    pair->first->getFunctionPairPointer() : nullptr;
+  const auto op = call && call->first ? call->first->getTokenPointer() :
+    nullptr;
+  if (!op || op->getType() != Token::Type::Operator || !pair->second ||
+    !call->second) {
+    return false;
+  }
+  if (op->getValue() == "(,+)") {
+    if (!addElements(*call->second, elements)) {
+      return false;
+    }
+  }
+  else if (op->getValue() == "(,)") {
+    const auto &first = fromTree(*call->second);
+    if (!first) {
+      return false;
+    }
+    elements.push_back(*first);
+  }
+  else {
+    return false;
+  }
+  const auto &last = fromTree(*pair->second);
+  if (!last) {
+    return false;
+  }
+  elements.push_back(*last);
+  return true;
+}
+
+// getKind() - Returns the kind of the Pattern.
+Pattern::Kind Pattern::getKind() const {
+  return kind;
+}
+
+// getBoundNames() - Identifier Patterns bind a name, and Tuple and
+//  Constructor Patterns the names of their elements.
+std::set<std::string> Pattern::getBoundNames() const {
+  if (kind == Pattern::Kind::Identifier) {
+    return { name };
+  }
+  std::set<std::string> names;
+  for (const Pattern &element : elements) {
+    const std::set<std::string> &elementNames = element.getBoundNames();
+    names.insert(elementNames.begin(), elementNames.end());
+  }
+  return names;
+}
+
+// matches(value) - Returns whether value matches the Pattern, without binding
+//  anything.
+bool Pattern::matches(const Value &value) const {
+  switch (kind) {
+    case Pattern::Kind::Identifier:
+      return true;
+    case Pattern::Kind::Number: {
+      const auto numberValue = dynamic_cast<const NumberValue *>(&value);
+      return numberValue && numberValue->getRawNumber() == number;
+    }
+    case Pattern::Kind::Tuple: {
+      const auto tuple = dynamic_cast<const TupleValue *>(&value);
+      if (!tuple || tuple->size() != elements.size()) {
+        return false;
+      }
+      for (std::size_t i = 0; i < elements.size(); i++) {
+        if (!elements[i].matches(*tuple->at(i))) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case Pattern::Kind::Constructor: {
+      const auto tagged = dynamic_cast<const TaggedValue *>(&value);
+      if (!tagged || tagged->getTag() != tag) {
+        return false;
+      }
+      const Value::Pointer &payload = tagged->getPayload();
+      return elements.empty() ? !payload :
+        payload && elements.front().matches(*payload);
+    }
+  }
+  return false;
+}
+
+// defineIn(value, context, layer) - Defines the names that the Pattern binds
+//  to value or to the elements of value, which must match the Pattern, in
+//  layer, which is created as a child of context when the first name is
+//  defined.
+void Pattern::defineIn(const Value::Pointer &value,
+  const Context::Pointer &context, Context::Pointer &layer) const {
+  if (kind == Pattern::Kind::Identifier) {
+    if (!layer) {
+      layer = Context::Pointer { Region::make<Context>(context) };
+    }
+    layer->define(name, value);
+  }
+  else if (kind == Pattern::Kind::Tuple) {
+    const auto &tuple = static_cast<const TupleValue &>(*value);
+    for (std::size_t i = 0; i < elements.size(); i++) {
+      elements[i].defineIn(tuple.at(i), context, layer);
+    }
+  }
+  else if (kind == Pattern::Kind::Constructor && !elements.empty()) {
+    const auto &tagged = static_cast<const TaggedValue &>(*value);
+    elements.front().defineIn(tagged.getPayload(), context, layer);
+  }
+}
+
+// bind(value, context) - Matches value against the Pattern, creating a new
+//  Context layer only if a name needs to be bound. The elements of a tuple
+//  are all bound in the same layer, straight from the tuple, and the payload
+//  of a TaggedValue straight from the TaggedValue, so taking Some x apart
+//  allocates nothing but the layer.
+std::optional<Context::Pointer> Pattern::bind(const Value::Pointer &value,
+  const Context::Pointer &context) const {
+  if (!matches(*value)) {
+    return {};
+  }
+  Context::Pointer layer;
+  defineIn(value, context, layer);
+  return { layer ? layer : context };
+}
+
+// operator std::string() - Returns the name or number of the Pattern, the
+//  Patterns of its elements as in (x, y), or its constructor and the
+//  Pattern of its payload as in Some x.
+Pattern::operator std::string() const {
+  if (kind == Pattern::Kind::Identifier) {
+    return name;
+  }
+  if (kind == Pattern::Kind::Constructor) {
+    if (elements.empty()) {
+      return name;
+    }
+    const Pattern &payload = elements.front();
+    const std::string shown = payload;
+    return payload.kind == Pattern::Kind::Constructor &&
+      !payload.elements.empty() ? name + " (" + shown + ")" :
+      name + " " + shown;
+  }
+  if (kind == Pattern::Kind::Tuple) {
+    std::string shown = "(";
+    for (std::size_t i = 0; i < elements.size(); i++) {
+      shown += (i == 0 ? "" : ", ") + static_cast<std::string>(elements[i]);
+    }
+    return shown + ")";
+  }
+  return NumberValue { number };
+}
@@ -0,0 +1,80 @@
+// File: src/Pattern.hpp
+// Purpose: Header file for Patterns, which are the parameters of functions
+//  created with `->`. A Pattern decides whether a function accepts a Value and
+//  which names the Value is bound to within the function's body. See
+//  src/Pattern.cpp for implementations.
+
+#ifndef PATTERN_HPP
+#define PATTERN_HPP
+
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+#include "Context.hpp"
+#include "TaggedValue.hpp"
+#include "TokenTree.hpp"
+#include "Value.hpp"
+
+class Pattern {
+public:
+  // The kinds of Patterns that exist. Identifier Patterns accept any Value and
+  //  bind it to a name. Number Patterns only accept a NumberValue equal to
+  //  their number and bind nothing. Tuple Patterns, such as `(x, 0)`, only
+  //  accept a TupleValue of as many elements, each accepted by the Pattern at
+  //  the same position, and bind the names that those Patterns bind.
+  //  Constructor Patterns, such as `Nothing` or `Some x`, only accept a
+  //  TaggedValue of their constructor, whose payload (if any) is accepted by
+  //  their one element, and bind the names that it binds.
+  enum class Kind {
+    Identifier,
+    Number,
+    Tuple,
+    Constructor
+  };
+
+private:
+  Kind kind;
+  std::string name;
+  double number;
+  std::vector<Pattern> elements;
+  TaggedValue::Tag tag;
+
+  // Private methods are documented in src/Pattern.cpp.
+  Pattern(Kind kind, const std::string &name, double number);
+  static bool addElements(const TokenTree &ast,
+    std::vector<Pattern> &elements);
+  bool matches(const Value &value) const;
+  void defineIn(const Value::Pointer &value, const Context::Pointer &context,
+    Context::Pointer &layer) const;
+
+public:
+  // Constructor(name) - Creates an Identifier Pattern that binds name.
+  explicit Pattern(const std::string &name);
+
+  // static isConstructorName(name) - Returns whether name is the name of a
+  //  constructor, which starts with a capital letter.
+  static bool isConstructorName(const std::string &name);
+
+  // static fromTree(ast) - Returns the Pattern that ast represents, or an
+  //  empty optional if ast is not a valid Pattern.
+  static std::optional<Pattern> fromTree(const TokenTree &ast);
+
+  // getKind() - Returns the kind of the Pattern.
+  Kind getKind() const;
+
+  // getBoundNames() - Returns the names that the Pattern binds.
+  std::set<std::string> getBoundNames() const;
+
+  // bind(value, context) - Returns the Context that a function body should be
+  //  evaluated in if value matches the Pattern: either context itself (if
+  //  nothing is bound) or a child of context holding the bound names. Returns
+  //  an empty optional if value does not match.
+  std::optional<Context::Pointer> bind(const Value::Pointer &value,
+    const Context::Pointer &context) const;
+
+  // operator std::string() - Returns the Pattern as it would be written.
+  operator std::string() const;
+};
+
+#endif
@@ -0,0 +1,459 @@
+// File: src/PersistentMap.cpp
+// Purpose: Source file for PersistentMaps, which are the immutable hash maps
+//  that MapValues and SetValues hold. See src/PersistentMap.hpp for more
+//  documentation.
+
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "PersistentMap.hpp"
+#include "Value.hpp"
+
+// Constructors
+PersistentMap::PersistentMap() {}
+PersistentMap::PersistentMap(const NodePointer &root): root { root } {}
+
+// Builder constructor - The numbers of Builders start from 1, since 0 marks
+//  the nodes that no Builder may change.
+PersistentMap::Builder::Builder(const PersistentMap &map): root { map.root } {
+  static std::atomic<std::uint64_t> builders { 0 };
+  owner = ++builders;
+}
+
+// slotOf(hash, shift) - Returns the slot of hash at the level using the bits
+//  of hash from shift.
+std::size_t PersistentMap::slotOf(std::size_t hash, std::size_t shift) {
+  return (hash >> shift) & ((std::size_t { 1 } << bits) - 1);
+}
+
+// indexOf(map, slot) - Returns the position in the array that map indexes of
+//  the slot, which is the number of slots before it that are used.
+std::size_t PersistentMap::indexOf(std::uint32_t map, std::size_t slot) {
+  return std::bitset<32> {
+    map & ((std::uint32_t { 1 } << slot) - 1)
+  }.count();
+}
+
+// nodeOf(entry, shift, owner) - Returns the node of the level at shift that
+//  holds only entry.
+PersistentMap::NodePointer PersistentMap::nodeOf(const Entry &entry,
+  std::size_t shift, std::uint64_t owner) {
+  const std::uint32_t entryMap = shift < hashBits ?
+    std::uint32_t { 1 } << slotOf(entry.hash, shift) : 0;
+  return std::make_shared<Node>(Node { entryMap, 0, { entry }, {}, 1, owner });
+}
+
+// pairOf(first, second, shift, owner) - Returns the node of the level at
+//  shift that holds the two entries, which go under a child if they have the
+//  same slot.
+PersistentMap::NodePointer PersistentMap::pairOf(const Entry &first,
+  const Entry &second, std::size_t shift, std::uint64_t owner) {
+  if (shift >= hashBits) {
+    return std::make_shared<Node>(Node {
+      0, 0, { first, second }, {}, 2, owner
+    });
+  }
+  const std::size_t firstSlot = slotOf(first.hash, shift);
+  const std::size_t secondSlot = slotOf(second.hash, shift);
+  if (firstSlot == secondSlot) {
+    return std::make_shared<Node>(Node {
+      0, std::uint32_t { 1 } << firstSlot, {},
+      { pairOf(first, second, shift + bits, owner) }, 2, owner
+    });
+  }
+  return std::make_shared<Node>(Node {
+    (std::uint32_t { 1 } << firstSlot) | (std::uint32_t { 1 } << secondSlot),
+    0, firstSlot < secondSlot ? std::vector<Entry> { first, second } :
+      std::vector<Entry> { second, first },
+    {}, 2, owner
+  });
+}
+
+// editable(node, owner, result) - Returns node itself if the Builder numbered
+//  owner created it, and otherwise a copy of it that the Builder owns. Sets
+//  result to the node returned. The nodes of a persistent change (with owner
+//  0) are always copied.
+PersistentMap::Node &PersistentMap::editable(const NodePointer &node,
+  std::uint64_t owner, NodePointer &result) {
+  if (owner != 0 && node->owner == owner) {
+    result = node;
+    return const_cast<Node &>(*node);
+  }
+  auto copy = std::make_shared<Node>(*node);
+  copy->owner = owner;
+  result = copy;
+  return *copy;
+}
+
+// find(node, hash, key, shift) - Follows the slots of hash down to the entry
+//  of key, if there is one.
+const PersistentMap::Entry *PersistentMap::find(const Node &node,
+  std::size_t hash, const Value &key, std::size_t shift) {
+  if (shift >= hashBits) {
+    for (const Entry &entry : node.entries) {
+      if (Value::equal(*entry.key, key)) {
+        return &entry;
+      }
+    }
+    return nullptr;
+  }
+  const std::size_t slot = slotOf(hash, shift);
+  const std::uint32_t bit = std::uint32_t { 1 } << slot;
+  if (node.entryMap & bit) {
+    const Entry &entry = node.entries[indexOf(node.entryMap, slot)];
+    return entry.hash == hash && Value::equal(*entry.key, key) ? &entry :
+      nullptr;
+  }
+  if (node.childMap & bit) {
+    return find(*node.children[indexOf(node.childMap, slot)], hash, key,
+      shift + bits);
+  }
+  return nullptr;
+}
+
+// insert(node, entry, shift, owner, replace) - Returns node with entry added
+//  under it, changing the nodes on the way that the Builder numbered owner
+//  created in place. If the key of entry is already there, its entry is
+//  replaced only if replace is true. An entry in the slot of entry is moved
+//  down into a new child along with entry.
+PersistentMap::NodePointer PersistentMap::insert(const NodePointer &node,
+  const Entry &entry, std::size_t shift, std::uint64_t owner, bool replace) {
+  if (!node) {
+    return nodeOf(entry, shift, owner);
+  }
+  NodePointer result;
+  if (shift >= hashBits) {
+    for (std::size_t i = 0; i < node->entries.size(); i++) {
+      if (Value::equal(*node->entries[i].key, *entry.key)) {
+        if (!replace) {
+          return node;
+        }
+        editable(node, owner, result).entries[i] = entry;
+        return result;
+      }
+    }
+    Node &edited = editable(node, owner, result);
+    edited.entries.push_back(entry);
+    edited.size++;
+    return result;
+  }
+  const std::size_t slot = slotOf(entry.hash, shift);
+  const std::uint32_t bit = std::uint32_t { 1 } << slot;
+  if (node->entryMap & bit) {
+    const std::size_t index = indexOf(node->entryMap, slot);
+    const Entry &existing = node->entries[index];
+    if (existing.hash == entry.hash &&
+      Value::equal(*existing.key, *entry.key)) {
+      if (!replace) {
+        return node;
+      }
+      editable(node, owner, result).entries[index] = entry;
+      return result;
+    }
+    const NodePointer child = pairOf(existing, entry, shift + bits, owner);
+    Node &edited = editable(node, owner, result);
+    edited.entries.erase(edited.entries.begin() + index);
+    edited.entryMap ^= bit;
+    edited.children.insert(edited.children.begin() +
+      indexOf(edited.childMap, slot), child);
+    edited.childMap |= bit;
+    edited.size++;
+    return result;
+  }
+  if (node->childMap & bit) {
+    const std::size_t index = indexOf(node->childMap, slot);
+    const NodePointer child = node->children[index];
+    const std::size_t before = child->size;
+    const NodePointer updated = insert(child, entry, shift + bits, owner,
+      replace);
+    // A child that the Builder owns was changed in place, and so was its
+    //  parent, which the Builder owns too.
+    if (updated == child) {
+      if (owner != 0 && node->owner == owner) {
+        const_cast<Node &>(*node).size += updated->size - before;
+      }
+      return node;
+    }
+    Node &edited = editable(node, owner, result);
+    edited.children[index] = updated;
+    edited.size += updated->size - before;
+    return result;
+  }
+  Node &edited = editable(node, owner, result);
+  edited.entries.insert(edited.entries.begin() +
+    indexOf(edited.entryMap, slot), entry);
+  edited.entryMap |= bit;
+  edited.size++;
+  return result;
+}
+
+// erase(node, hash, key, shift) - Returns node without the entry of key, or
+//  nullptr if that leaves it empty. A child left with one entry is replaced
+//  by that entry.
+PersistentMap::NodePointer PersistentMap::erase(const NodePointer &node,
+  std::size_t hash, const Value &key, std::size_t shift) {
+  if (shift >= hashBits) {
+    for (std::size_t i = 0; i < node->entries.size(); i++) {
+      if (Value::equal(*node->entries[i].key, key)) {
+        if (node->size == 1) {
+          return nullptr;
+        }
+        auto copy = std::make_shared<Node>(*node);
+        copy->entries.erase(copy->entries.begin() + i);
+        copy->size--;
+        copy->owner = 0;
+        return copy;
+      }
+    }
+    return node;
+  }
+  const std::size_t slot = slotOf(hash, shift);
+  const std::uint32_t bit = std::uint32_t { 1 } << slot;
+  if (node->entryMap & bit) {
+    const std::size_t index = indexOf(node->entryMap, slot);
+    const Entry &existing = node->entries[index];
+    if (existing.hash != hash || !Value::equal(*existing.key, key)) {
+      return node;
+    }
+    if (node->size == 1) {
+      return nullptr;
+    }
+    auto copy = std::make_shared<Node>(*node);
+    copy->entries.erase(copy->entries.begin() + index);
+    copy->entryMap ^= bit;
+    copy->size--;
+    copy->owner = 0;
+    return copy;
+  }
+  if (node->childMap & bit) {
+    const std::size_t index = indexOf(node->childMap, slot);
+    const NodePointer updated = erase(node->children[index], hash, key,
+      shift + bits);
+    if (updated == node->children[index]) {
+      return node;
+    }
+    auto copy = std::make_shared<Node>(*node);
+    if (updated->size == 1) {
+      copy->children.erase(copy->children.begin() + index);
+      copy->childMap ^= bit;
+      copy->entries.insert(copy->entries.begin() +
+        indexOf(copy->entryMap, slot), updated->entries[0]);
+      copy->entryMap |= bit;
+    }
+    else {
+      copy->children[index] = updated;
+    }
+    copy->size--;
+    copy->owner = 0;
+    return copy;
+  }
+  return node;
+}
+
+// unite(first, second, shift) - Merges the two nodes slot by slot. A slot
+//  used by only one of them keeps its entry or child as it is, so only the
+//  nodes on the paths to slots used by both are created.
+PersistentMap::NodePointer PersistentMap::unite(const NodePointer &first,
+  const NodePointer &second, std::size_t shift) {
+  if (!first) {
+    return second;
+  }
+  if (!second || first == second) {
+    return first;
+  }
+  if (shift >= hashBits) {
+    NodePointer result = first;
+    for (const Entry &entry : second->entries) {
+      result = insert(result, entry, shift, 0, false);
+    }
+    return result;
+  }
+  Node merged { 0, 0, {}, {}, 0, 0 };
+  for (std::size_t slot = 0; slot < 32; slot++) {
+    const std::uint32_t bit = std::uint32_t { 1 } << slot;
+    const Entry *firstEntry = first->entryMap & bit ?
+      &first->entries[indexOf(first->entryMap, slot)] : nullptr;
+    const Entry *secondEntry = second->entryMap & bit ?
+      &second->entries[indexOf(second->entryMap, slot)] : nullptr;
+    const NodePointer firstChild = first->childMap & bit ?
+      first->children[indexOf(first->childMap, slot)] : nullptr;
+    const NodePointer secondChild = second->childMap & bit ?
+      second->children[indexOf(second->childMap, slot)] : nullptr;
+    NodePointer child;
+    const Entry *entry = nullptr;
+    if (firstChild && secondChild) {
+      child = unite(firstChild, secondChild, shift + bits);
+    }
+    else if (firstChild) {
+      child = secondEntry ?
+        insert(firstChild, *secondEntry, shift + bits, 0, false) : firstChild;
+    }
+    else if (secondChild) {
+      child = firstEntry ?
+        insert(secondChild, *firstEntry, shift + bits, 0, true) : secondChild;
+    }
+    else if (firstEntry && secondEntry) {
+      if (firstEntry->hash == secondEntry->hash &&
+        Value::equal(*firstEntry->key, *secondEntry->key)) {
+        entry = firstEntry;
+      }
+      else {
+        child = pairOf(*firstEntry, *secondEntry, shift + bits, 0);
+      }
+    }
+    else {
+      entry = firstEntry ? firstEntry : secondEntry;
+    }
+    if (child) {
+      merged.children.push_back(child);
+      merged.childMap |= bit;
+      merged.size += child->size;
+    }
+    else if (entry) {
+      merged.entries.push_back(*entry);
+      merged.entryMap |= bit;
+      merged.size++;
+    }
+  }
+  // The union has every key of first, so it is first if it is no larger.
+  if (merged.size == first->size) {
+    return first;
+  }
+  return std::make_shared<Node>(std::move(merged));
+}
+
+// intersect(first, second, shift) - Keeps the entries of first whose keys
+//  second has, slot by slot. A child left with one entry is replaced by that
+//  entry.
+PersistentMap::NodePointer PersistentMap::intersect(const NodePointer &first,
+  const NodePointer &second, std::size_t shift) {
+  if (!first || !second) {
+    return nullptr;
+  }
+  if (first == second) {
+    return first;
+  }
+  Node kept { 0, 0, {}, {}, 0, 0 };
+  if (shift >= hashBits) {
+    for (const Entry &entry : first->entries) {
+      if (find(*second, entry.hash, *entry.key, shift)) {
+        kept.entries.push_back(entry);
+        kept.size++;
+      }
+    }
+  }
+  else {
+    for (std::size_t slot = 0; slot < 32; slot++) {
+      const std::uint32_t bit = std::uint32_t { 1 } << slot;
+      if (first->entryMap & bit) {
+        const Entry &entry = first->entries[indexOf(first->entryMap, slot)];
+        if (find(*second, entry.hash, *entry.key, shift)) {
+          kept.entries.push_back(entry);
+          kept.entryMap |= bit;
+          kept.size++;
+        }
+        continue;
+      }
+      if (!(first->childMap & bit)) {
+        continue;
+      }
+      const NodePointer &firstChild =
+        first->children[indexOf(first->childMap, slot)];
+      NodePointer child;
+      const Entry *entry = nullptr;
+      if (second->childMap & bit) {
+        child = intersect(firstChild,
+          second->children[indexOf(second->childMap, slot)], shift + bits);
+      }
+      else if (second->entryMap & bit) {
+        const Entry &other = second->entries[indexOf(second->entryMap, slot)];
+        entry = find(*firstChild, other.hash, *other.key, shift + bits);
+      }
+      if (child && child->size == 1) {
+        entry = &child->entries[0];
+      }
+      if (entry) {
+        kept.entries.push_back(*entry);
+        kept.entryMap |= bit;
+        kept.size++;
+      }
+      else if (child) {
+        kept.children.push_back(child);
+        kept.childMap |= bit;
+        kept.size += child->size;
+      }
+    }
+  }
+  if (kept.size == 0) {
+    return nullptr;
+  }
+  // The intersection only has keys of first, so it is first if it is as
+  //  large.
+  if (kept.size == first->size) {
+    return first;
+  }
+  return std::make_shared<Node>(std::move(kept));
+}
+
+// forEachIn(node, visit) - Visits the entries of node before those of its
+//  children.
+void PersistentMap::forEachIn(const Node &node,
+  const std::function<void(const Entry &)> &visit) {
+  for (const Entry &entry : node.entries) {
+    visit(entry);
+  }
+  for (const NodePointer &child : node.children) {
+    forEachIn(*child, visit);
+  }
+}
+
+std::size_t PersistentMap::size() const {
+  return root ? root->size : 0;
+}
+
+const PersistentMap::Entry *PersistentMap::find(const Value &key) const {
+  return root ? find(*root, *key.hash(), key, 0) : nullptr;
+}
+
+PersistentMap PersistentMap::insert(const Value::Pointer &key,
+  const Value::Pointer &value) const {
+  return PersistentMap {
+    insert(root, Entry { *key->hash(), key, value }, 0, 0, true)
+  };
+}
+
+PersistentMap PersistentMap::erase(const Value &key) const {
+  return root ? PersistentMap { erase(root, *key.hash(), key, 0) } : *this;
+}
+
+PersistentMap PersistentMap::unite(const PersistentMap &other) const {
+  return PersistentMap { unite(root, other.root, 0) };
+}
+
+PersistentMap PersistentMap::intersect(const PersistentMap &other) const {
+  return PersistentMap { intersect(root, other.root, 0) };
+}
+
+void PersistentMap::forEach(const std::function<void(const Entry &)> &visit)
+  const {
+  if (root) {
+    forEachIn(*root, visit);
+  }
+}
+
+// insert(key, value) - Replaces the Value of a key given before.
+void PersistentMap::Builder::insert(const Value::Pointer &key,
+  const Value::Pointer &value) {
+  root = PersistentMap::insert(root, Entry { *key->hash(), key, value }, 0,
+    owner, true);
+}
+
+PersistentMap PersistentMap::Builder::build() {
+  return PersistentMap { root };
+}
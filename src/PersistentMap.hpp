@@ -0,0 +1,146 @@
+// File: src/PersistentMap.hpp
+// Purpose: Header file for PersistentMaps, which are the immutable hash maps
+//  that MapValues and SetValues hold. See src/PersistentMap.cpp for
+//  implementations.
+
+#ifndef PERSISTENTMAP_HPP
+#define PERSISTENTMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "Value.hpp"
+
+// PersistentMap - An immutable map from keys to Values stored as a hash array
+//  mapped trie (HAMT). Each level of the trie uses 5 bits of the hash of a
+//  key to choose one of 32 slots, so a map of a million keys is about four
+//  levels deep, and looking a key up, inserting it or removing it takes
+//  O(log32 n) time. Each node keeps the entries that have a slot to
+//  themselves inline and the nodes for slots shared by several entries apart,
+//  each in a bitmap-indexed array with no empty slots (a CHAMP). Removing an
+//  entry moves a lone entry left in a child back up into its parent, so a map
+//  has the same shape however it was built, and unions and intersections of
+//  maps that share nodes reuse those nodes without looking inside them.
+// Keys are compared structurally (see Value::equal). Every entry keeps the
+//  hash of its key, so no key is ever hashed twice, and keys are only
+//  compared when their hashes are equal. Keys whose hashes are equal in every
+//  bit share a collision node below the last level.
+// A Builder (a "transient" map) changes the nodes that it created itself in
+//  place instead of copying them, so building a map of n keys only allocates
+//  O(n) nodes.
+class PersistentMap {
+public:
+  // Entry - A key, its hash and its Value. A set has no Values.
+  struct Entry {
+    std::size_t hash;
+    Value::Pointer key;
+    Value::Pointer value;
+  };
+
+private:
+  // The number of bits of a hash used per level, and the bits of a hash.
+  static constexpr std::size_t bits = 5;
+  static constexpr std::size_t hashBits =
+    std::numeric_limits<std::size_t>::digits;
+
+  // A Node holds the entries with a slot to themselves in entries and the
+  //  nodes for shared slots in children, in order of slot, with a bit set for
+  //  each slot used in entryMap and childMap. A collision node (below the last
+  //  level) has neither map, and holds entries of equal hash. size is the
+  //  number of entries under the node. owner is the number of the Builder
+  //  that created the node and may change it, or 0.
+  struct Node {
+    std::uint32_t entryMap;
+    std::uint32_t childMap;
+    std::vector<Entry> entries;
+    std::vector<std::shared_ptr<const Node>> children;
+    std::size_t size;
+    std::uint64_t owner;
+  };
+  typedef std::shared_ptr<const Node> NodePointer;
+
+  NodePointer root;
+
+  // Private methods are documented in src/PersistentMap.cpp.
+  explicit PersistentMap(const NodePointer &root);
+  static std::size_t slotOf(std::size_t hash, std::size_t shift);
+  static std::size_t indexOf(std::uint32_t map, std::size_t slot);
+  static NodePointer nodeOf(const Entry &entry, std::size_t shift,
+    std::uint64_t owner);
+  static NodePointer pairOf(const Entry &first, const Entry &second,
+    std::size_t shift, std::uint64_t owner);
+  static Node &editable(const NodePointer &node, std::uint64_t owner,
+    NodePointer &result);
+  static const Entry *find(const Node &node, std::size_t hash,
+    const Value &key, std::size_t shift);
+  static NodePointer insert(const NodePointer &node, const Entry &entry,
+    std::size_t shift, std::uint64_t owner, bool replace);
+  static NodePointer erase(const NodePointer &node, std::size_t hash,
+    const Value &key, std::size_t shift);
+  static NodePointer unite(const NodePointer &first,
+    const NodePointer &second, std::size_t shift);
+  static NodePointer intersect(const NodePointer &first,
+    const NodePointer &second, std::size_t shift);
+  static void forEachIn(const Node &node,
+    const std::function<void(const Entry &)> &visit);
+
+public:
+  // Builder - Builds a PersistentMap from entries given one at a time. Each
+  //  Builder has a number of its own, which the nodes it creates are marked
+  //  with, and which no other Builder ever has.
+  class Builder {
+  private:
+    NodePointer root;
+    std::uint64_t owner;
+
+  public:
+    // Constructor(map) - Creates a Builder with the entries of map, which is
+    //  empty by default. The nodes of map are copied before being changed.
+    explicit Builder(const PersistentMap &map = PersistentMap {});
+
+    // insert(key, value) - Sets the Value of key to value. key must have a
+    //  hash (see Value::hash).
+    void insert(const Value::Pointer &key, const Value::Pointer &value);
+
+    // build() - Returns the map of every entry given so far. The Builder must
+    //  not be used afterwards.
+    PersistentMap build();
+  };
+
+  // Constructor() - Creates an empty map.
+  PersistentMap();
+
+  // size() - Returns the number of keys.
+  std::size_t size() const;
+
+  // find(key) - Returns the entry of key, or nullptr if there is none. key
+  //  must have a hash.
+  const Entry *find(const Value &key) const;
+
+  // insert(key, value) - Returns the map with the Value of key set to value.
+  //  key must have a hash.
+  PersistentMap insert(const Value::Pointer &key,
+    const Value::Pointer &value) const;
+
+  // erase(key) - Returns the map without key. key must have a hash.
+  PersistentMap erase(const Value &key) const;
+
+  // unite(other) - Returns the map of the keys of this map and of other, with
+  //  the Values of this map for keys in both. Nodes that both maps share are
+  //  kept as they are.
+  PersistentMap unite(const PersistentMap &other) const;
+
+  // intersect(other) - Returns the map of the keys of this map that other
+  //  also has, with the Values of this map. Nodes that both maps share are
+  //  kept as they are.
+  PersistentMap intersect(const PersistentMap &other) const;
+
+  // forEach(visit) - Calls visit with every entry, in no particular order.
+  void forEach(const std::function<void(const Entry &)> &visit) const;
+};
+
+#endif
@@ -0,0 +1,592 @@
+// File: src/PersistentVector.cpp
+// Purpose: Source file for PersistentVectors, which are the immutable arrays
+//  of Values that ListValues hold. See src/PersistentVector.hpp for more
+//  documentation.
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "PersistentVector.hpp"
+#include "CompactVector.hpp"
+#include "NumberValue.hpp"
+#include "Region.hpp"
+#include "RuntimeStats.hpp"
+#include "Value.hpp"
+
+// Constructor
+PersistentVector::Builder::Builder(): leaf { {}, {}, {}, {}, true } {}
+
+// add(node, height) - Adds a full node of the given height, and gives the
+//  nodes of that height a parent once there are enough of them to fill it.
+void PersistentVector::Builder::add(NodePointer node, std::size_t height) {
+  while (true) {
+    if (levels.size() == height) {
+      levels.emplace_back();
+    }
+    std::vector<NodePointer> &level = levels[height];
+    level.push_back(std::move(node));
+    if (level.size() < width) {
+      return;
+    }
+    node = makeNode(std::move(level), height + 1);
+    level = {};
+    height++;
+  }
+}
+
+// push(value) - Values are gathered in a leaf until it is full. Floats are
+//  unboxed as long as every Value of the leaf is a Float.
+void PersistentVector::Builder::push(const Value::Pointer &value) {
+  if (const NumberValue *number = floatOf(value)) {
+    push(number->getRawNumber());
+    return;
+  }
+  append(leafOf(value), 0, 1, leaf);
+  if (slots(leaf, 0) == width) {
+    add(makeLeaf(std::move(leaf)), 0);
+    leaf = Node { {}, {}, {}, {}, true };
+  }
+}
+
+void PersistentVector::Builder::push(double number) {
+  if (leaf.numeric) {
+    leaf.numbers.push_back(number);
+  }
+  else {
+    leaf.elements.push_back(box(number));
+  }
+  if (slots(leaf, 0) == width) {
+    add(makeLeaf(std::move(leaf)), 0);
+    leaf = Node { {}, {}, {}, {}, true };
+  }
+}
+
+// build() - Gives the nodes left at each height a parent, from the leaves up.
+//  Only the last node of each height can be partly full.
+PersistentVector PersistentVector::Builder::build() {
+  NodePointer last = slots(leaf, 0) == 0 ? nullptr :
+    makeLeaf(std::move(leaf));
+  for (std::size_t height = 0; height < levels.size(); height++) {
+    std::vector<NodePointer> children = std::move(levels[height]);
+    if (last) {
+      children.push_back(std::move(last));
+    }
+    last = children.empty() ? nullptr :
+      makeNode(std::move(children), height + 1);
+  }
+  if (!last) {
+    return PersistentVector {};
+  }
+  return PersistentVector { last, levels.size() };
+}
+
+// Constructors
+PersistentVector::PersistentVector(): root { nullptr }, count { 0 },
+  height { 0 } {}
+
+PersistentVector::PersistentVector(const CompactVector &compact):
+  root { nullptr }, count { compact.size() }, height { 0 },
+  compact { compact } {}
+
+// A root with only one child is replaced by that child, so that a vector is
+//  never deeper than it needs to be.
+PersistentVector::PersistentVector(NodePointer root, std::size_t height):
+  root { std::move(root) }, count { 0 }, height { height } {
+  while (this->height > 0 && this->root->children.size() == 1) {
+    NodePointer child = this->root->children.front();
+    this->root = std::move(child);
+    this->height--;
+  }
+  count = sizeOf(*this->root, this->height);
+}
+
+// of(values) - Uses a Builder, which keeps numbers unboxed.
+PersistentVector PersistentVector::of(
+  const std::vector<Value::Pointer> &values) {
+  Builder builder;
+  for (const auto &value : values) {
+    builder.push(value);
+  }
+  return builder.build();
+}
+
+// capacity(height) - Returns the number of Values in a full node of the given
+//  height.
+std::size_t PersistentVector::capacity(std::size_t height) {
+  return std::size_t { 1 } << (bits * (height + 1));
+}
+
+// slots(node, height) - Returns the number of Values in a leaf or children in
+//  any other node.
+std::size_t PersistentVector::slots(const Node &node, std::size_t height) {
+  return height == 0 ? node.elements.size() + node.numbers.size() :
+    node.children.size();
+}
+
+// sizeOf(node, height) - Returns the number of Values under node. Only the
+//  last child of a node without sizes needs to be looked into.
+std::size_t PersistentVector::sizeOf(const Node &node, std::size_t height) {
+  std::size_t size = 0;
+  const Node *current = &node;
+  for (; height > 0 && current->sizes.empty(); height--) {
+    size += (current->children.size() - 1) * capacity(height - 1);
+    current = current->children.back().get();
+  }
+  return size + (height == 0 ? slots(*current, 0) : current->sizes.back());
+}
+
+// sizeOfChild(node, height, slot) - Returns the number of Values under the
+//  child of node at slot.
+std::size_t PersistentVector::sizeOfChild(const Node &node, std::size_t height,
+  std::size_t slot) {
+  if (!node.sizes.empty()) {
+    return node.sizes[slot] - (slot == 0 ? 0 : node.sizes[slot - 1]);
+  }
+  if (slot + 1 < node.children.size()) {
+    return capacity(height - 1);
+  }
+  return sizeOf(*node.children[slot], height - 1);
+}
+
+// slotOf(node, height, index) - Returns the slot of the child of node that
+//  holds the Value at index, and makes index relative to that child. No child
+//  holds more than a full node's Values, so the child is never before the
+//  slot that the radix of index gives.
+std::size_t PersistentVector::slotOf(const Node &node, std::size_t height,
+  std::size_t &index) {
+  const std::size_t shift = bits * height;
+  std::size_t slot = index >> shift;
+  if (node.sizes.empty()) {
+    index -= slot << shift;
+    return slot;
+  }
+  while (node.sizes[slot] <= index) {
+    slot++;
+  }
+  if (slot > 0) {
+    index -= node.sizes[slot - 1];
+  }
+  return slot;
+}
+
+// box(number) - Returns the NumberValue of an unboxed number.
+Value::Pointer PersistentVector::box(double number) {
+  return Value::Pointer { Region::make<NumberValue>(number) };
+}
+
+// floatOf(value) - Returns value as a NumberValue if it is a Float, which is
+//  all that an unboxed number can be. Ints stay boxed, so that they keep their
+//  exact value.
+const NumberValue *PersistentVector::floatOf(const Value::Pointer &value) {
+  const auto number = dynamic_cast<const NumberValue *>(value.get());
+  return number && !number->isInteger() ? number : nullptr;
+}
+
+// leafOf(value) - Returns a leaf holding only value, unboxed if it is a
+//  Float.
+PersistentVector::Node PersistentVector::leafOf(const Value::Pointer &value) {
+  if (const NumberValue *number = floatOf(value)) {
+    return Node { {}, { number->getRawNumber() }, {}, {}, true };
+  }
+  return Node { { value }, {}, {}, {}, false };
+}
+
+// append(from, start, count, leaf) - Adds the count Values of the leaf from
+//  from index start on to leaf, which is numeric if it only holds numbers so
+//  far. Numbers stay unboxed while both leaves are numeric, and otherwise
+//  every number of leaf is boxed.
+void PersistentVector::append(const Node &from, std::size_t start,
+  std::size_t count, Node &leaf) {
+  if (leaf.numeric && from.numeric) {
+    leaf.numbers.insert(leaf.numbers.end(), from.numbers.begin() + start,
+      from.numbers.begin() + start + count);
+    return;
+  }
+  if (leaf.numeric) {
+    for (double number : leaf.numbers) {
+      leaf.elements.push_back(box(number));
+    }
+    leaf.numbers = {};
+    leaf.numeric = false;
+  }
+  if (from.numeric) {
+    for (std::size_t i = start; i < start + count; i++) {
+      leaf.elements.push_back(box(from.numbers[i]));
+    }
+  }
+  else {
+    leaf.elements.insert(leaf.elements.end(), from.elements.begin() + start,
+      from.elements.begin() + start + count);
+  }
+}
+
+// makeLeaf(leaf) - Returns a shared leaf. A leaf whose Values are all Floats
+//  (as after the other Values were sliced away or replaced) is unboxed, so
+//  that a vector of Floats is always numeric.
+PersistentVector::NodePointer PersistentVector::makeLeaf(Node leaf) {
+  if (!leaf.numeric && std::all_of(leaf.elements.begin(), leaf.elements.end(),
+    [](const Value::Pointer &value) {
+    return floatOf(value) != nullptr;
+  })) {
+    for (const Value::Pointer &value : leaf.elements) {
+      leaf.numbers.push_back(floatOf(value)->getRawNumber());
+    }
+    leaf.elements = {};
+    leaf.numeric = true;
+  }
+  return std::make_shared<const Node>(std::move(leaf));
+}
+
+// makeNode(children, height) - Returns a node of the given height with the
+//  given children, which only has sizes if some child but the last is not
+//  full.
+PersistentVector::NodePointer PersistentVector::makeNode(
+  std::vector<NodePointer> children, std::size_t height) {
+  std::vector<std::size_t> sizes;
+  sizes.reserve(children.size());
+  bool relaxed = false;
+  bool numeric = true;
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < children.size(); i++) {
+    numeric = numeric && children[i]->numeric;
+    const std::size_t size = sizeOf(*children[i], height - 1);
+    relaxed = relaxed ||
+      (i + 1 < children.size() && size != capacity(height - 1));
+    total += size;
+    sizes.push_back(total);
+  }
+  if (!relaxed) {
+    sizes = {};
+  }
+  return std::make_shared<const Node>(Node {
+    {}, {}, std::move(children), std::move(sizes), numeric
+  });
+}
+
+// setIn(node, height, index, value) - Copies the nodes on the path to index.
+//  A numeric leaf stays numeric if value is a number, and is boxed otherwise.
+PersistentVector::NodePointer PersistentVector::setIn(const NodePointer &node,
+  std::size_t height, std::size_t index, const Value::Pointer &value) {
+  if (height == 0) {
+    Node leaf { {}, {}, {}, {}, true };
+    append(*node, 0, index, leaf);
+    append(leafOf(value), 0, 1, leaf);
+    append(*node, index + 1, slots(*node, 0) - index - 1, leaf);
+    return makeLeaf(std::move(leaf));
+  }
+  Node copy { *node };
+  const std::size_t slot = slotOf(*node, height, index);
+  copy.children[slot] = setIn(node->children[slot], height - 1, index, value);
+  return makeNode(std::move(copy.children), height);
+}
+
+// sliceOf(node, height, from, to) - Returns the node of the Values of node
+//  from index from up to index to, where from < to. Children that are wholly
+//  inside the slice are shared, and only the first and the last child kept
+//  are sliced in turn.
+PersistentVector::NodePointer PersistentVector::sliceOf(
+  const NodePointer &node, std::size_t height, std::size_t from,
+  std::size_t to) {
+  if (from == 0 && to == sizeOf(*node, height)) {
+    return node;
+  }
+  if (height == 0) {
+    Node leaf { {}, {}, {}, {}, true };
+    append(*node, from, to - from, leaf);
+    return makeLeaf(std::move(leaf));
+  }
+  std::vector<NodePointer> children;
+  std::size_t start = 0;
+  for (std::size_t slot = 0; slot < node->children.size() && start < to;
+    slot++) {
+    const std::size_t end = start + sizeOfChild(*node, height, slot);
+    if (end > from) {
+      children.push_back(sliceOf(node->children[slot], height - 1,
+        std::max(from, start) - start, std::min(to, end) - start));
+    }
+    start = end;
+  }
+  return makeNode(std::move(children), height);
+}
+
+// join(left, leftHeight, right, rightHeight) - Returns a node one level
+//  higher than the higher of left and right, holding the Values of left
+//  followed by those of right. The nodes along the right edge of left and the
+//  left edge of right are merged from the bottom up, and each level of
+//  merged nodes is rebalanced (see rebalance).
+PersistentVector::NodePointer PersistentVector::join(const NodePointer &left,
+  std::size_t leftHeight, const NodePointer &right, std::size_t rightHeight) {
+  if (leftHeight > rightHeight) {
+    const NodePointer center = join(left->children.back(), leftHeight - 1,
+      right, rightHeight);
+    return rebalance(left, center, nullptr, leftHeight);
+  }
+  if (leftHeight < rightHeight) {
+    const NodePointer center = join(left, leftHeight,
+      right->children.front(), rightHeight - 1);
+    return rebalance(nullptr, center, right, rightHeight);
+  }
+  if (leftHeight == 0) {
+    const std::size_t leftSize = slots(*left, 0);
+    const std::size_t rightSize = slots(*right, 0);
+    if (leftSize + rightSize > width) {
+      return makeNode({ left, right }, 1);
+    }
+    Node leaf { {}, {}, {}, {}, true };
+    append(*left, 0, leftSize, leaf);
+    append(*right, 0, rightSize, leaf);
+    return makeNode({ makeLeaf(std::move(leaf)) }, 1);
+  }
+  const NodePointer center = join(left->children.back(), leftHeight - 1,
+    right->children.front(), rightHeight - 1);
+  return rebalance(left, center, right, leftHeight);
+}
+
+// rebalance(left, center, right, height) - Returns a node of height + 1
+//  holding the children of left but its last, then the children of center,
+//  then the children of right but its first, after redistributing them.
+//  left and right may be null. They and center have the given height.
+PersistentVector::NodePointer PersistentVector::rebalance(
+  const NodePointer &left, const NodePointer &center, const NodePointer &right,
+  std::size_t height) {
+  std::vector<NodePointer> all;
+  if (left) {
+    all.insert(all.end(), left->children.begin(), left->children.end() - 1);
+  }
+  all.insert(all.end(), center->children.begin(), center->children.end());
+  if (right) {
+    all.insert(all.end(), right->children.begin() + 1, right->children.end());
+  }
+  const std::vector<NodePointer> &nodes = redistribute(all, height - 1);
+  std::vector<NodePointer> parents;
+  for (std::size_t i = 0; i < nodes.size(); i += width) {
+    const auto end = nodes.begin() + std::min(nodes.size(), i + width);
+    parents.push_back(makeNode(
+      std::vector<NodePointer>(nodes.begin() + i, end), height
+    ));
+  }
+  return makeNode(std::move(parents), height + 1);
+}
+
+// redistribute(nodes, height) - Returns nodes of the given height holding the
+//  same Values or children as nodes, in the same order, but no more than two
+//  more of them than the fewest that could hold them. This is the
+//  concatenation plan of Bagwell and Rompf's RRB-Vectors: going from the
+//  left, the slots of the first node that is not full are moved into the
+//  nodes after it until one node fewer is needed, as long as there are too
+//  many nodes. Nodes whose slots do not move are shared.
+std::vector<PersistentVector::NodePointer> PersistentVector::redistribute(
+  const std::vector<NodePointer> &nodes, std::size_t height) {
+  std::vector<std::size_t> counts;
+  std::size_t total = 0;
+  for (const auto &node : nodes) {
+    counts.push_back(slots(*node, height));
+    total += counts.back();
+  }
+  const std::size_t optimal = (total + width - 1) / width;
+  std::size_t length = counts.size();
+  std::size_t i = 0;
+  while (length > optimal + 2) {
+    // Every node before i is full, so the nodes from i on have room for more
+    //  than a whole node, and the slots of node i fit in the nodes after it.
+    while (counts[i] == width) {
+      i++;
+    }
+    std::size_t remaining = counts[i];
+    do {
+      const std::size_t size = std::min(remaining + counts[i + 1], width);
+      remaining = remaining + counts[i + 1] - size;
+      counts[i] = size;
+      i++;
+    } while (remaining > 0);
+    for (std::size_t j = i; j + 1 < length; j++) {
+      counts[j] = counts[j + 1];
+    }
+    length--;
+    i--;
+  }
+
+  std::vector<NodePointer> result;
+  std::size_t source = 0;
+  std::size_t offset = 0;
+  for (std::size_t k = 0; k < length; k++) {
+    if (offset == 0 && slots(*nodes[source], height) == counts[k]) {
+      result.push_back(nodes[source++]);
+      continue;
+    }
+    Node leaf { {}, {}, {}, {}, true };
+    std::vector<NodePointer> children;
+    for (std::size_t filled = 0; filled < counts[k];) {
+      const Node &from = *nodes[source];
+      const std::size_t taken = std::min(counts[k] - filled,
+        slots(from, height) - offset);
+      if (height == 0) {
+        append(from, offset, taken, leaf);
+      }
+      else {
+        children.insert(children.end(), from.children.begin() + offset,
+          from.children.begin() + offset + taken);
+      }
+      filled += taken;
+      offset += taken;
+      if (offset == slots(from, height)) {
+        source++;
+        offset = 0;
+      }
+    }
+    result.push_back(height == 0 ? makeLeaf(std::move(leaf)) :
+      makeNode(std::move(children), height));
+  }
+  return result;
+}
+
+// size() - The size is known without looking at any node.
+std::size_t PersistentVector::size() const {
+  return count;
+}
+
+// isNumeric() - The root knows whether all of its leaves are numeric. The
+//  empty vector is numeric too.
+bool PersistentVector::isNumeric() const {
+  return !root || root->numeric;
+}
+
+// isCompact() - Returns whether there is a CompactVector.
+bool PersistentVector::isCompact() const {
+  return compact.has_value();
+}
+
+// compacted() - Encodes the numbers a block at a time, and gives up as soon
+//  as one is not whole. Records the result in the RuntimeStats.
+PersistentVector PersistentVector::compacted() const {
+  const std::size_t blockSize = CompactVector::blockSize;
+  if (compact || count < blockSize || !isNumeric()) {
+    return *this;
+  }
+  CompactVector::Builder builder;
+  double numbers[blockSize];
+  for (std::size_t start = 0; start < count; start += blockSize) {
+    const std::size_t size = std::min(blockSize, count - start);
+    copyNumbers(start, size, numbers);
+    if (!builder.add(numbers, size)) {
+      return *this;
+    }
+  }
+  const CompactVector built = builder.build();
+  if (built.getBytes() * 2 > count * sizeof(double)) {
+    return *this;
+  }
+  RuntimeStats::current().recordCompaction(count, built.getBytes(),
+    built.countBlocks(CompactVector::Encoding::Packed),
+    built.countBlocks(CompactVector::Encoding::Delta),
+    built.countBlocks(CompactVector::Encoding::Runs));
+  return PersistentVector { built };
+}
+
+// thawed() - Returns the vector stored as a tree, which a compact vector is
+//  built into a block at a time.
+PersistentVector PersistentVector::thawed() const {
+  if (!compact) {
+    return *this;
+  }
+  const std::size_t blockSize = CompactVector::blockSize;
+  Builder builder;
+  double numbers[blockSize];
+  for (std::size_t start = 0; start < count; start += blockSize) {
+    const std::size_t size = std::min(blockSize, count - start);
+    compact->copyNumbers(start, size, numbers);
+    for (std::size_t i = 0; i < size; i++) {
+      builder.push(numbers[i]);
+    }
+  }
+  return builder.build();
+}
+
+// at(index) - Goes down one level of the tree at a time, and boxes the Value
+//  if it is an unboxed number. A compact vector decodes the number instead.
+Value::Pointer PersistentVector::at(std::size_t index) const {
+  if (compact) {
+    return box(compact->at(index));
+  }
+  std::size_t start = 0;
+  const Node &leaf = leafAt(index, start);
+  return leaf.numeric ? box(leaf.numbers[index - start]) :
+    leaf.elements[index - start];
+}
+
+// leafAt(index, start) - Goes down to the leaf, keeping track of how many
+//  Values come before each node on the way.
+const PersistentVector::Node &PersistentVector::leafAt(std::size_t index,
+  std::size_t &start) const {
+  const Node *node = root.get();
+  std::size_t relative = index;
+  for (std::size_t level = height; level > 0; level--) {
+    const std::size_t slot = slotOf(*node, level, relative);
+    node = node->children[slot].get();
+  }
+  start = index - relative;
+  return *node;
+}
+
+// copyNumbers(start, count, numbers) - Copies whole runs of each leaf.
+void PersistentVector::copyNumbers(std::size_t start, std::size_t count,
+  double *numbers) const {
+  if (compact) {
+    compact->copyNumbers(start, count, numbers);
+    return;
+  }
+  const std::size_t end = start + count;
+  while (start < end) {
+    std::size_t leafStart = 0;
+    const Node &leaf = leafAt(start, leafStart);
+    const std::size_t taken = std::min(end - start,
+      leaf.numbers.size() - (start - leafStart));
+    std::copy_n(leaf.numbers.begin() + (start - leafStart), taken, numbers);
+    numbers += taken;
+    start += taken;
+  }
+}
+
+// set(index, value) - Copies the path to index and nothing else. A compact
+//  vector is built into a tree first.
+PersistentVector PersistentVector::set(std::size_t index,
+  const Value::Pointer &value) const {
+  if (compact) {
+    return thawed().set(index, value);
+  }
+  return PersistentVector { setIn(root, height, index, value), height };
+}
+
+// slice(from, to) - Bounds beyond the size are treated as the size.
+PersistentVector PersistentVector::slice(std::size_t from,
+  std::size_t to) const {
+  to = std::min(to, count);
+  if (from >= to) {
+    return PersistentVector {};
+  }
+  if (compact) {
+    return PersistentVector { compact->slice(from, to) };
+  }
+  return PersistentVector { sliceOf(root, height, from, to), height };
+}
+
+// concat(other) - Joins the two trees along their facing edges, building
+//  the tree of a compact vector first.
+PersistentVector PersistentVector::concat(
+  const PersistentVector &other) const {
+  if (count == 0) {
+    return other;
+  }
+  if (other.count == 0) {
+    return *this;
+  }
+  if (compact || other.compact) {
+    return thawed().concat(other.thawed());
+  }
+  return PersistentVector {
+    join(root, height, other.root, other.height),
+    std::max(height, other.height) + 1
+  };
+}
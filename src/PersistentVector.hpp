@@ -0,0 +1,174 @@
+// File: src/PersistentVector.hpp
+// Purpose: Header file for PersistentVectors, which are the immutable arrays
+//  of Values that ListValues hold. See src/PersistentVector.cpp for
+//  implementations.
+
+#ifndef PERSISTENTVECTOR_HPP
+#define PERSISTENTVECTOR_HPP
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "CompactVector.hpp"
+#include "Value.hpp"
+
+class NumberValue;
+
+// PersistentVector - An immutable array of Values stored as a relaxed radix
+//  balanced (RRB) tree. The Values are kept in leaves of up to 32 of them, and
+//  each node above the leaves has up to 32 children, so a vector of a million
+//  Values is only four nodes deep. Updating, slicing or concatenating vectors
+//  returns a new vector that shares every node it did not change with the
+//  vectors it came from, so it only copies the nodes on a few paths from the
+//  root. Indexing is by radix (5 bits of the index per level) as long as every
+//  child but the last of a node is full. A node whose children are not all
+//  full after slicing or concatenation is "relaxed": it keeps the running
+//  total of the sizes of its children, and indexing searches those from the
+//  slot the radix gives. Concatenation rebalances the nodes it goes through so
+//  that they stay nearly full, which keeps the tree shallow.
+// A leaf whose Values are all Floats holds them unboxed, as plain doubles,
+//  which takes about a fifth of the memory of NumberValues and lets numeric
+//  code (see src/NumericKernel.hpp) go over them in blocks. A number is only
+//  boxed into a NumberValue when it is looked at as a Value. A vector whose
+//  leaves all hold numbers is numeric (see isNumeric).
+// A numeric vector of whole numbers can also be stored as a CompactVector
+//  (see src/CompactVector.hpp and compacted) instead of a tree. Such a
+//  vector is read and sliced without building the tree, which is only built
+//  (once per call) to update or concatenate it.
+class PersistentVector {
+public:
+  // The number of bits of an index used per level and the most Values in a
+  //  leaf or children in a node.
+  static constexpr std::size_t bits = 5;
+  static constexpr std::size_t width = std::size_t { 1 } << bits;
+
+  // A Node is a leaf (at height 0) holding either elements or numbers, or a
+  //  node holding children one level lower. sizes is empty if every child but
+  //  the last is full, and otherwise holds the number of Values in the first
+  //  i + 1 children at i. numeric is true if every Value under the node is in
+  //  numbers. Nodes are never changed once they are shared.
+  struct Node {
+    std::vector<Value::Pointer> elements;
+    std::vector<double> numbers;
+    std::vector<std::shared_ptr<const Node>> children;
+    std::vector<std::size_t> sizes;
+    bool numeric;
+  };
+  typedef std::shared_ptr<const Node> NodePointer;
+
+  // Builder - Builds a PersistentVector from Values given one at a time. The
+  //  Builder fills each node completely before giving it a parent, so no node
+  //  is ever copied, and building a vector of n Values takes O(n) time.
+  class Builder {
+  private:
+    Node leaf;
+    // The full nodes of each height that do not have a parent yet.
+    std::vector<std::vector<NodePointer>> levels;
+
+    // Private methods are documented in src/PersistentVector.cpp.
+    void add(NodePointer node, std::size_t height);
+
+  public:
+    // Constructor() - Creates a Builder with no Values.
+    Builder();
+
+    // push(value) - Adds value after the Values given so far.
+    void push(const Value::Pointer &value);
+
+    // push(number) - Adds the Float number after the Values given so far,
+    //  without boxing it.
+    void push(double number);
+
+    // build() - Returns the vector of every Value given so far. The Builder
+    //  must not be used afterwards.
+    PersistentVector build();
+  };
+
+private:
+  NodePointer root;
+  std::size_t count;
+  std::size_t height;
+  // The numbers of a compact vector, which has no root.
+  std::optional<CompactVector> compact;
+
+  // Private methods are documented in src/PersistentVector.cpp.
+  PersistentVector(NodePointer root, std::size_t height);
+  explicit PersistentVector(const CompactVector &compact);
+  static std::size_t capacity(std::size_t height);
+  static std::size_t slots(const Node &node, std::size_t height);
+  static std::size_t sizeOf(const Node &node, std::size_t height);
+  static std::size_t sizeOfChild(const Node &node, std::size_t height,
+    std::size_t slot);
+  static std::size_t slotOf(const Node &node, std::size_t height,
+    std::size_t &index);
+  static Value::Pointer box(double number);
+  static const NumberValue *floatOf(const Value::Pointer &value);
+  static Node leafOf(const Value::Pointer &value);
+  static void append(const Node &from, std::size_t start, std::size_t count,
+    Node &leaf);
+  static NodePointer makeLeaf(Node leaf);
+  static NodePointer makeNode(std::vector<NodePointer> children,
+    std::size_t height);
+  static NodePointer setIn(const NodePointer &node, std::size_t height,
+    std::size_t index, const Value::Pointer &value);
+  static NodePointer sliceOf(const NodePointer &node, std::size_t height,
+    std::size_t from, std::size_t to);
+  static NodePointer join(const NodePointer &left, std::size_t leftHeight,
+    const NodePointer &right, std::size_t rightHeight);
+  static NodePointer rebalance(const NodePointer &left,
+    const NodePointer &center, const NodePointer &right, std::size_t height);
+  static std::vector<NodePointer> redistribute(
+    const std::vector<NodePointer> &nodes, std::size_t height);
+  PersistentVector thawed() const;
+
+public:
+  // Constructor() - Creates an empty vector.
+  PersistentVector();
+
+  // static of(values) - Returns the vector of the given Values.
+  static PersistentVector of(const std::vector<Value::Pointer> &values);
+
+  // size() - Returns the number of Values.
+  std::size_t size() const;
+
+  // isNumeric() - Returns whether every Value is a number held unboxed.
+  bool isNumeric() const;
+
+  // isCompact() - Returns whether the numbers are stored as a CompactVector.
+  bool isCompact() const;
+
+  // compacted() - Returns the vector stored as a CompactVector if it holds at
+  //  least a block of whole numbers that take at most half the memory that
+  //  way, and otherwise returns this vector. Takes O(n) time.
+  PersistentVector compacted() const;
+
+  // at(index) - Returns the Value at index, which must be less than size().
+  //  Takes O(log n) time.
+  Value::Pointer at(std::size_t index) const;
+
+  // leafAt(index, start) - Returns the leaf holding the Value at index, which
+  //  must be less than size(), and sets start to the index of its first
+  //  Value. Used to go through the Values in order quickly. The vector must
+  //  not be compact.
+  const Node &leafAt(std::size_t index, std::size_t &start) const;
+
+  // copyNumbers(start, count, numbers) - Copies the count numbers from index
+  //  start on into numbers. The vector must be numeric.
+  void copyNumbers(std::size_t start, std::size_t count,
+    double *numbers) const;
+
+  // set(index, value) - Returns the vector with value at index instead, which
+  //  must be less than size(). Takes O(log n) time.
+  PersistentVector set(std::size_t index, const Value::Pointer &value) const;
+
+  // slice(from, to) - Returns the vector of the Values from index from up to
+  //  (but not including) index to. Takes O(log n) time.
+  PersistentVector slice(std::size_t from, std::size_t to) const;
+
+  // concat(other) - Returns the vector of the Values of this vector followed
+  //  by those of other. Takes O(log n) time.
+  PersistentVector concat(const PersistentVector &other) const;
+};
+
+#endif
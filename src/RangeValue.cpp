@@ -0,0 +1,201 @@
+// File: src/RangeValue.cpp
+// Purpose: Source file for RangeValues, which are the sequences of numbers
+//  that `..<`, `..<=` and `arithmetic` return. See src/RangeValue.hpp for more
+//  documentation.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+#include "RangeValue.hpp"
+#include "Error.hpp"
+#include "Evacuation.hpp"
+#include "NumberValue.hpp"
+#include "NumericKernel.hpp"
+#include "Region.hpp"
+#include "SequenceValue.hpp"
+#include "Value.hpp"
+
+// Constructor
+RangeValue::RangeValue(const Range &range): SequenceValue {
+  std::make_shared<const Source>(range), std::vector<Stage> {}
+} {}
+
+// before(start, bound) - There are as many numbers as whole steps of 1 that
+//  stay below bound.
+std::shared_ptr<RangeValue> RangeValue::before(double start, double bound) {
+  const double count = std::ceil(bound - start);
+  return Region::make<RangeValue>(Range { start, 1, 0, count > 0 ? count : 0 });
+}
+
+// through(start, bound) - Includes bound itself if it is a whole number of
+//  steps from start.
+std::shared_ptr<RangeValue> RangeValue::through(double start, double bound) {
+  const double count = std::floor(bound - start) + 1;
+  return Region::make<RangeValue>(Range { start, 1, 0, count > 0 ? count : 0 });
+}
+
+// arithmetic(start, step) - The Range ends at infinity.
+std::shared_ptr<RangeValue> RangeValue::arithmetic(double start, double step) {
+  return Region::make<RangeValue>(Range {
+    start, step, 0, std::numeric_limits<double>::infinity()
+  });
+}
+
+// getRange() - Returns the Range that the RangeValue was created with.
+const SequenceValue::Range &RangeValue::getRange() const {
+  return *std::get_if<Range>(source.get());
+}
+
+// numberAt(k) - Returns the kth number of the Range, computed the same way as
+//  when the numbers are produced one by one.
+Value::OrError RangeValue::numberAt(double k) const {
+  const Range &range = getRange();
+  return { Value::Pointer {
+    Region::make<NumberValue>(range.start + k * range.step)
+  } };
+}
+
+// mapped(kernel) - Returns the Range of the results of an arithmetic kernel
+//  that adds, subtracts or multiplies, or nothing if it is some other kernel
+//  or if the new Range would not compute exactly the same numbers as mapping
+//  each number does. That is the case for ranges of whole numbers that stay
+//  exact.
+std::optional<SequenceValue::Range> RangeValue::mapped(
+  const NumericKernel &kernel) const {
+  Range result = getRange();
+  const double constant = kernel.constant;
+  switch (kernel.op) {
+    case NumericKernel::Op::Add:
+      result.start += constant;
+      break;
+    case NumericKernel::Op::Subtract:
+      if (kernel.constantFirst) {
+        result.start = constant - result.start;
+        result.step = -result.step;
+      }
+      else {
+        result.start -= constant;
+      }
+      break;
+    case NumericKernel::Op::Multiply:
+      result.start *= constant;
+      result.step *= constant;
+      break;
+    default:
+      return {};
+  }
+  if (!isExact(constant) || !isExact(getRange()) || !isExact(result)) {
+    return {};
+  }
+  return { result };
+}
+
+// then(stage) - Slices the Range for Take and Drop, and maps it for Map if the
+//  function has a kernel that gives another Range.
+std::shared_ptr<SequenceValue> RangeValue::then(const Stage &stage) const {
+  Range range = getRange();
+  const auto count = static_cast<double>(stage.count);
+  switch (stage.kind) {
+    case Stage::Kind::Take:
+      range.to = std::min(range.to, range.from + count);
+      return Region::make<RangeValue>(range);
+    case Stage::Kind::Drop:
+      range.from = std::min(range.to, range.from + count);
+      return Region::make<RangeValue>(range);
+    case Stage::Kind::Map: {
+      const NumericKernel *kernel = stage.function->getNumericKernel();
+      const std::optional<Range> &result = kernel ? mapped(*kernel) :
+        std::optional<Range> {};
+      if (result) {
+        return Region::make<RangeValue>(*result);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return SequenceValue::then(stage);
+}
+
+// length() - Counts the numbers without producing them.
+Value::OrError RangeValue::length() const {
+  const Range &range = getRange();
+  if (std::isinf(range.to)) {
+    return { Error { Error::Code::InfiniteSequence } };
+  }
+  return { Value::Pointer {
+    Region::make<NumberValue>(static_cast<std::int64_t>(range.to - range.from))
+  } };
+}
+
+// first() - Returns the number at from.
+Value::OrError RangeValue::first() const {
+  const Range &range = getRange();
+  if (range.from == range.to) {
+    return { Error { Error::Code::EmptySequence } };
+  }
+  return numberAt(range.from);
+}
+
+// last() - Returns the number just before to.
+Value::OrError RangeValue::last() const {
+  const Range &range = getRange();
+  if (std::isinf(range.to)) {
+    return { Error { Error::Code::InfiniteSequence } };
+  }
+  if (range.from == range.to) {
+    return { Error { Error::Code::EmptySequence } };
+  }
+  return numberAt(range.to - 1);
+}
+
+// at(index) - Returns the number index positions after from.
+Value::OrError RangeValue::at(const std::shared_ptr<NumberValue> &index) const {
+  const Range &range = getRange();
+  const double position = index->getRawNumber();
+  if (position < 0 || std::floor(position) != position ||
+    !(range.from + position < range.to)) {
+    return {
+      Error { Error::Code::IndexOutOfRange, { Error::Shown { index } } }
+    };
+  }
+  return numberAt(range.from + position);
+}
+
+// evacuate([unused] evacuation) - A range holds no Values.
+Value::Pointer RangeValue::evacuate([[maybe_unused]] Evacuation &evacuation)
+  const {
+  return Value::Pointer { std::make_shared<RangeValue>(*this) };
+}
+
+// operator string() - Only shows the start of a range that does not end.
+RangeValue::operator std::string() const {
+  const Range &range = getRange();
+  if (!std::isinf(range.to)) {
+    return SequenceValue::operator std::string();
+  }
+  std::string shown { "[" };
+  for (double k = range.from; k < range.from + 3; k++) {
+    const Value::OrError number = numberAt(k);
+    shown += static_cast<std::string>(**std::get_if<Value::Pointer>(&number)) +
+      ", ";
+  }
+  return shown + "...]";
+}
+
+const std::string RangeValue::name { "Range" };
+
+// getName() - Returns "Range", the name of the Range type.
+std::string RangeValue::getName() const {
+  return RangeValue::name;
+}
+
+std::string RangeValue::getClassName() {
+  return RangeValue::name;
+}
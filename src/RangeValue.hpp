@@ -0,0 +1,70 @@
+// File: src/RangeValue.hpp
+// Purpose: Header file for RangeValues, which are the sequences of numbers
+//  that `..<`, `..<=` and `arithmetic` return. See src/RangeValue.cpp for
+//  implementations.
+
+#ifndef RANGEVALUE_HPP
+#define RANGEVALUE_HPP
+
+#include <memory>
+#include <optional>
+#include <string>
+#include "NumberValue.hpp"
+#include "NumericKernel.hpp"
+#include "SequenceValue.hpp"
+#include "Value.hpp"
+
+// RangeValue - A SequenceValue whose source is a Range and which has no
+//  stages. A RangeValue only stores where its numbers start, how far apart
+//  they are and which of them it includes, so it takes the same memory for a
+//  billion numbers as for one. Its length, first and last numbers and the
+//  number at any position are computed directly, taking or dropping numbers
+//  from it only slices the Range, and mapping it with a builtin operator
+//  (as in `map (* 2)`) gives another RangeValue where that is exact.
+class RangeValue final: public SequenceValue {
+private:
+  // Private methods are documented in src/RangeValue.cpp.
+  const Range &getRange() const;
+  Value::OrError numberAt(double k) const;
+  std::optional<Range> mapped(const NumericKernel &kernel) const;
+
+public:
+  // Constructor(range) - Creates a RangeValue of the numbers in range. Use
+  //  before, through or arithmetic instead.
+  explicit RangeValue(const Range &range);
+
+  // static before(start, bound), through(start, bound) - Return the range of
+  //  numbers from start, counting up by 1, before bound (or up to bound).
+  static std::shared_ptr<RangeValue> before(double start, double bound);
+  static std::shared_ptr<RangeValue> through(double start, double bound);
+
+  // static arithmetic(start, step) - Returns the range of numbers from start,
+  //  step apart, that does not end.
+  static std::shared_ptr<RangeValue> arithmetic(double start, double step);
+
+  // then(stage) - Returns a RangeValue for stages that take, drop or exactly
+  //  map numbers, and adds stage to the sequence like any other otherwise.
+  std::shared_ptr<SequenceValue> then(const Stage &stage) const;
+
+  // length(), first(), last(), at(index) - Compute the result directly. A
+  //  range that does not end has no length or last number.
+  Value::OrError length() const;
+  Value::OrError first() const;
+  Value::OrError last() const;
+  Value::OrError at(const std::shared_ptr<NumberValue> &index) const;
+
+  // evacuate(evacuation) - Returns a copy of the range.
+  Value::Pointer evacuate(Evacuation &evacuation) const;
+
+  // operator string() - Returns the numbers in brackets like any sequence,
+  //  or only the first three of them followed by "..." if the range does not
+  //  end.
+  operator std::string() const;
+
+  // name/getName() - Returns "Range", the name of a RangeValue-type value.
+  static const std::string name;
+  static std::string getClassName();
+  std::string getName() const;
+};
+
+#endif
@@ -0,0 +1,84 @@
+// File: src/Region.cpp
+// Purpose: Source file for Regions, which are arenas that hold the Values and
+//  Contexts created during a single evaluation. See src/Region.hpp for more
+//  documentation.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "Region.hpp"
+
+const std::size_t Region::defaultChunkSize = 64 * 1024;
+
+thread_local Region::Pointer Region::currentRegion {};
+
+// Constructor(chunkSize) - Creates a Region with no chunks. The first chunk is
+//  requested by the first allocation.
+Region::Region(std::size_t chunkSize): chunkSize { chunkSize },
+  cursor { nullptr }, remaining { 0 }, bytesAllocated { 0 } {}
+
+// addChunk(minimumSize) - Requests a new chunk of memory with room for at least
+//  minimumSize bytes and makes it the chunk that allocations are taken from.
+void Region::addChunk(std::size_t minimumSize) {
+  const std::size_t size = std::max(chunkSize, minimumSize);
+  chunks.push_back({ std::unique_ptr<char[]> { new char[size] }, size });
+  cursor = chunks.back().memory.get();
+  remaining = size;
+}
+
+// allocate(size, alignment) - Bumps the cursor of the current chunk past size
+//  bytes (after aligning it) and returns the old cursor. A new chunk is
+//  requested if the current one is too small.
+void *Region::allocate(std::size_t size, std::size_t alignment) {
+  std::size_t padding = (alignment - reinterpret_cast<std::uintptr_t>(cursor) %
+    alignment) % alignment;
+  if (cursor == nullptr || padding + size > remaining) {
+    // new char[] is aligned for any fundamental type, so the worst case for an
+    //  over-aligned type is alignment - 1 bytes of padding.
+    addChunk(size + alignment);
+    padding = (alignment - reinterpret_cast<std::uintptr_t>(cursor) %
+      alignment) % alignment;
+  }
+  char *result = cursor + padding;
+  cursor = result + size;
+  remaining -= padding + size;
+  bytesAllocated += size;
+  return result;
+}
+
+// contains(ptr) - Returns true iff ptr is within one of the Region's chunks.
+bool Region::contains(const void *ptr) const {
+  const char *address = static_cast<const char *>(ptr);
+  for (const auto &chunk : chunks) {
+    const char *start = chunk.memory.get();
+    const char *end = start + chunk.size;
+    if (std::greater_equal<const char *>{}(address, start) &&
+        std::less<const char *>{}(address, end)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// getBytesAllocated() - Returns the number of bytes allocated so far.
+std::size_t Region::getBytesAllocated() const {
+  return bytesAllocated;
+}
+
+// current() - Returns the Region of the innermost active Scope on this thread.
+Region::Pointer Region::current() {
+  return currentRegion;
+}
+
+// Scope(region) - Makes region the current Region, remembering the previous one.
+Region::Scope::Scope(const Region::Pointer &region):
+  previous { Region::currentRegion } {
+  Region::currentRegion = region;
+}
+
+// ~Scope() - Restores the previously current Region.
+Region::Scope::~Scope() {
+  Region::currentRegion = previous;
+}
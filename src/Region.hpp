@@ -0,0 +1,140 @@
+// File: src/Region.hpp
+// Purpose: Header file for Regions, which are arenas that hold the Values and
+//  Contexts created during a single evaluation. Allocation from a Region is a
+//  pointer bump, and all of a Region's memory is released at once when the
+//  Region is destroyed. See src/Region.cpp for implementations.
+
+#ifndef REGION_HPP
+#define REGION_HPP
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class Region {
+public:
+  // Region::Pointer can be used to refer to a shared Region.
+  typedef std::shared_ptr<Region> Pointer;
+
+  // The default number of bytes in each chunk of memory the Region requests.
+  static const std::size_t defaultChunkSize;
+
+  // Region::Allocator<T> - A standard allocator that allocates from a Region.
+  //  Deallocation does nothing, since memory is only reclaimed when the whole
+  //  Region is destroyed. Each Allocator keeps its Region alive, so objects
+  //  that outlive the evaluation that created them (e.g. Values stored in a
+  //  long-lived Context) remain valid.
+  template <typename T>
+  class Allocator {
+  private:
+    Pointer region;
+
+    template <typename U>
+    friend class Allocator;
+  public:
+    typedef T value_type;
+
+    // Constructor(region) - Creates an Allocator that allocates from region.
+    Allocator(const Pointer &region): region { region } {}
+
+    // Constructor(other) - Creates an Allocator for T from an Allocator for
+    //  another type. Both allocate from the same Region.
+    template <typename U>
+    Allocator(const Allocator<U> &other): region { other.region } {}
+
+    // allocate(count) - Returns memory for count objects of type T.
+    T *allocate(std::size_t count) {
+      return static_cast<T *>(
+        region->allocate(count * sizeof(T), alignof(T))
+      );
+    }
+
+    // deallocate(ptr, count) - Does nothing. See above.
+    void deallocate(
+      [[maybe_unused]] T *ptr, [[maybe_unused]] std::size_t count
+    ) {}
+
+    template <typename U>
+    bool operator==(const Allocator<U> &rhs) const {
+      return region == rhs.region;
+    }
+    template <typename U>
+    bool operator!=(const Allocator<U> &rhs) const {
+      return region != rhs.region;
+    }
+  };
+
+  // Region::Scope - While a Scope exists, its Region is the current Region for
+  //  this thread (see Region::make). The previously current Region is restored
+  //  when the Scope is destroyed.
+  class Scope {
+  private:
+    Pointer previous;
+  public:
+    Scope(const Pointer &region);
+    Scope(const Scope &other) = delete;
+    Scope &operator=(const Scope &other) = delete;
+    ~Scope();
+  };
+
+private:
+  // A Chunk is one contiguous block of memory requested by the Region.
+  struct Chunk {
+    std::unique_ptr<char[]> memory;
+    std::size_t size;
+  };
+
+  std::vector<Chunk> chunks;
+  std::size_t chunkSize;
+  char *cursor;
+  std::size_t remaining;
+  std::size_t bytesAllocated;
+
+  static thread_local Pointer currentRegion;
+
+  // Private methods are documented in src/Region.cpp.
+  void addChunk(std::size_t minimumSize);
+
+public:
+  // Constructor(chunkSize) - Creates an empty Region that requests memory in
+  //  chunks of (at least) chunkSize bytes.
+  Region(std::size_t chunkSize = defaultChunkSize);
+
+  Region(const Region &other) = delete;
+  Region &operator=(const Region &other) = delete;
+
+  // allocate(size, alignment) - Returns size bytes of memory aligned to
+  //  alignment. The memory is valid until the Region is destroyed.
+  void *allocate(std::size_t size, std::size_t alignment);
+
+  // contains(ptr) - Returns true iff ptr points into memory owned by this
+  //  Region.
+  bool contains(const void *ptr) const;
+
+  // getBytesAllocated() - Returns the total number of bytes handed out by
+  //  allocate(size, alignment).
+  std::size_t getBytesAllocated() const;
+
+  // static current() - Returns the current Region for this thread, or a null
+  //  pointer if no Region::Scope is active.
+  static Pointer current();
+
+  // static make<T>(args...) - Creates a shared T from args. The T is placed in
+  //  the current Region if there is one, or on the heap otherwise.
+  template <typename T, typename... Args>
+  static std::shared_ptr<T> make(Args&&... args) {
+    const Pointer &region = currentRegion;
+    if (region) {
+      return std::allocate_shared<T>(
+        Allocator<T> { region }, std::forward<Args>(args)...
+      );
+    }
+    return std::make_shared<T>(std::forward<Args>(args)...);
+  }
+
+  // Destructor - Releases every chunk at once.
+  ~Region() = default;
+};
+
+#endif
@@ -0,0 +1,685 @@
+// File: src/Rope.cpp
+// Purpose: Source file for Ropes, which are the immutable texts that
+//  StringValues hold. See src/Rope.hpp for more documentation.
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Rope.hpp"
+#include "TextKernel.hpp"
+
+// Constructors
+Rope::Rope() {}
+Rope::Rope(const NodePointer &root): root { root } {}
+
+// leafOf(bytes, begin, end) - Reads the UTF-8 text once to count its code
+//  points and find the largest, skipping over runs of ASCII with
+//  TextKernel::asciiLength. ASCII text is kept as it is, since it is already
+//  Latin-1, and other text that fits in Latin-1 is converted to it. Any other
+//  text stays UTF-8, and is only copied to replace invalid bytes. Returns a
+//  null pointer for empty text.
+Rope::NodePointer Rope::leafOf(std::string bytes, std::size_t begin,
+  std::size_t end) {
+  std::size_t count = 0;
+  char32_t largest = 0;
+  bool valid = true;
+  for (std::size_t i = begin; i < end; count++) {
+    const std::size_t ascii = TextKernel::asciiLength(bytes.data() + i,
+      end - i);
+    i += ascii;
+    count += ascii;
+    if (i == end) {
+      break;
+    }
+    char32_t codePoint;
+    const std::size_t size = readUtf8(bytes, i, end, codePoint);
+    valid = valid && size != 0;
+    largest = std::max(largest, size == 0 ? char32_t { 0xFFFD } : codePoint);
+    i += std::max(size, std::size_t { 1 });
+  }
+  if (count == 0) {
+    return nullptr;
+  }
+  auto buffer = std::make_shared<Buffer>();
+  buffer->encoding = largest <= 0xFF ? Encoding::Latin1 : Encoding::Utf8;
+  if (largest < 0x80 || (valid && largest > 0xFF)) {
+    buffer->bytes = std::move(bytes);
+    buffer->begin = begin;
+  }
+  else {
+    buffer->begin = 0;
+    for (std::size_t i = begin; i < end; ) {
+      char32_t codePoint;
+      const std::size_t size = readUtf8(bytes, i, end, codePoint);
+      if (buffer->encoding == Encoding::Latin1) {
+        buffer->bytes.push_back(static_cast<char>(codePoint));
+      }
+      else {
+        encode(size == 0 ? char32_t { 0xFFFD } : codePoint, buffer->bytes);
+      }
+      i += std::max(size, std::size_t { 1 });
+    }
+  }
+  if (buffer->encoding == Encoding::Utf8) {
+    std::size_t i = buffer->begin;
+    for (std::size_t k = 0; k < count; k++) {
+      if (k % markStride == 0) {
+        buffer->marks.push_back(i);
+      }
+      i += sequenceLength(buffer->bytes[i]);
+    }
+  }
+  return leafOf(buffer, 0, count);
+}
+
+// leafOf(buffer, first, length) - Creates a leaf viewing part of buffer, which
+//  must not be empty.
+Rope::NodePointer Rope::leafOf(const std::shared_ptr<const Buffer> &buffer,
+  std::size_t first, std::size_t length) {
+  const std::size_t byte = offsetOf(*buffer, first);
+  const std::size_t last = offsetOf(*buffer, first + length - 1);
+  const std::size_t end = buffer->encoding == Encoding::Latin1 ? last + 1 :
+    last + sequenceLength(buffer->bytes[last]);
+  return std::make_shared<const Node>(Node {
+    buffer, first, byte, nullptr, nullptr, length, end - byte, 0
+  });
+}
+
+// nodeOf(left, right) - Creates the node above left and right, neither of
+//  which may be null.
+Rope::NodePointer Rope::nodeOf(const NodePointer &left,
+  const NodePointer &right) {
+  return std::make_shared<const Node>(Node {
+    nullptr, 0, 0, left, right, left->length + right->length,
+    left->bytes + right->bytes, std::max(left->depth, right->depth) + 1
+  });
+}
+
+// join(left, right) - Concatenates two balanced trees (in which the depths of
+//  the children of any node differ by at most 1) into one. If one tree is
+//  more than one level deeper, the other is joined to its child on the near
+//  side, and if that child became too deep, the result is rotated like an
+//  AVL tree. Small texts are flattened into a single leaf, which also merges
+//  a small text into the last (or first) leaf of a larger one.
+Rope::NodePointer Rope::join(const NodePointer &left,
+  const NodePointer &right) {
+  if (!left) {
+    return right;
+  }
+  if (!right) {
+    return left;
+  }
+  if (left->bytes + right->bytes <= leafBytes) {
+    std::string text;
+    appendUtf8(*left, text);
+    appendUtf8(*right, text);
+    const std::size_t size = text.size();
+    return leafOf(std::move(text), 0, size);
+  }
+  if (left->depth > right->depth + 1) {
+    const NodePointer joined = join(left->right, right);
+    if (joined->depth <= left->left->depth + 1) {
+      return nodeOf(left->left, joined);
+    }
+    if (joined->left->depth <= joined->right->depth) {
+      return nodeOf(nodeOf(left->left, joined->left), joined->right);
+    }
+    return nodeOf(nodeOf(left->left, joined->left->left),
+      nodeOf(joined->left->right, joined->right));
+  }
+  if (right->depth > left->depth + 1) {
+    const NodePointer joined = join(left, right->left);
+    if (joined->depth <= right->right->depth + 1) {
+      return nodeOf(joined, right->right);
+    }
+    if (joined->right->depth <= joined->left->depth) {
+      return nodeOf(joined->left, nodeOf(joined->right, right->right));
+    }
+    return nodeOf(nodeOf(joined->left, joined->right->left),
+      nodeOf(joined->right->right, right->right));
+  }
+  return nodeOf(left, right);
+}
+
+// slice(node, from, to) - Leaves are sliced by viewing less of their buffer,
+//  and the slices of both children of a node are joined.
+Rope::NodePointer Rope::slice(const NodePointer &node, std::size_t from,
+  std::size_t to) {
+  if (from >= to) {
+    return nullptr;
+  }
+  if (from == 0 && to == node->length) {
+    return node;
+  }
+  if (node->depth == 0) {
+    return leafOf(node->buffer, node->first + from, to - from);
+  }
+  const std::size_t middle = node->left->length;
+  if (to <= middle) {
+    return slice(node->left, from, to);
+  }
+  if (from >= middle) {
+    return slice(node->right, from - middle, to - middle);
+  }
+  return join(slice(node->left, from, middle),
+    slice(node->right, 0, to - middle));
+}
+
+// offsetOf(buffer, codePoint) - Starts from the nearest index entry before
+//  codePoint in UTF-8, skipping over the code points in between by their
+//  first bytes alone.
+std::size_t Rope::offsetOf(const Buffer &buffer, std::size_t codePoint) {
+  if (buffer.encoding == Encoding::Latin1) {
+    return buffer.begin + codePoint;
+  }
+  std::size_t byte = buffer.marks[codePoint / markStride];
+  for (std::size_t rest = codePoint % markStride; rest != 0; rest--) {
+    byte += sequenceLength(buffer.bytes[byte]);
+  }
+  return byte;
+}
+
+// sequenceLength(lead) - Returns the number of bytes in the valid UTF-8
+//  sequence starting with the byte lead.
+std::size_t Rope::sequenceLength(unsigned char lead) {
+  return lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+}
+
+// readUtf8(text, byte, end, codePoint) - Sets codePoint to the code point
+//  whose UTF-8 sequence starts at position byte of text and returns the
+//  length of the sequence, or returns 0 if there is no valid sequence there
+//  before end. Overlong sequences, surrogates and numbers past U+10FFFF are
+//  not valid.
+std::size_t Rope::readUtf8(const std::string &text, std::size_t byte,
+  std::size_t end, char32_t &codePoint) {
+  const auto lead = static_cast<unsigned char>(text[byte]);
+  std::size_t size;
+  if (lead < 0x80) {
+    codePoint = lead;
+    return 1;
+  }
+  else if (lead >= 0xC2 && lead <= 0xDF) {
+    size = 2;
+    codePoint = lead & 0x1F;
+  }
+  else if (lead >= 0xE0 && lead <= 0xEF) {
+    size = 3;
+    codePoint = lead & 0x0F;
+  }
+  else if (lead >= 0xF0 && lead <= 0xF4) {
+    size = 4;
+    codePoint = lead & 0x07;
+  }
+  else {
+    return 0;
+  }
+  if (end - byte < size) {
+    return 0;
+  }
+  for (std::size_t k = 1; k < size; k++) {
+    const auto next = static_cast<unsigned char>(text[byte + k]);
+    if ((next & 0xC0) != 0x80) {
+      return 0;
+    }
+    codePoint = (codePoint << 6) | (next & 0x3F);
+  }
+  if ((size == 3 && (codePoint < 0x800 ||
+    (codePoint >= 0xD800 && codePoint <= 0xDFFF))) ||
+    (size == 4 && (codePoint < 0x10000 || codePoint > 0x10FFFF))) {
+    return 0;
+  }
+  return size;
+}
+
+// appendUtf8(node, text) - Appends the text under node, converting Latin-1
+//  leaves to UTF-8.
+void Rope::appendUtf8(const Node &node, std::string &text) {
+  if (node.depth != 0) {
+    appendUtf8(*node.left, text);
+    appendUtf8(*node.right, text);
+  }
+  else if (node.buffer->encoding == Encoding::Utf8) {
+    text.append(node.buffer->bytes, node.byte, node.bytes);
+  }
+  else {
+    for (std::size_t i = node.byte; i < node.byte + node.bytes; i++) {
+      encode(static_cast<unsigned char>(node.buffer->bytes[i]), text);
+    }
+  }
+}
+
+// pieceOf(leaf, first, byte, length, bytes) - Returns the Rope viewing the
+//  length code points of leaf from position first, which take bytes bytes
+//  from position byte of leaf.
+Rope Rope::pieceOf(const Node &leaf, std::size_t first, std::size_t byte,
+  std::size_t length, std::size_t bytes) {
+  if (length == 0) {
+    return Rope {};
+  }
+  return Rope { std::make_shared<const Node>(Node {
+    leaf.buffer, leaf.first + first, leaf.byte + byte, nullptr, nullptr,
+    length, bytes, 0
+  }) };
+}
+
+// flattened() - Returns the Rope itself if it has at most one leaf, and
+//  otherwise the Rope of a single leaf holding a copy of its text.
+Rope Rope::flattened() const {
+  if (!root || root->depth == 0) {
+    return *this;
+  }
+  return fromUtf8(toUtf8());
+}
+
+// encodedAs(encoding) - Returns the bytes of the text in encoding, or nothing
+//  if some code point cannot be encoded in it.
+std::optional<std::string> Rope::encodedAs(Encoding encoding) const {
+  if (encoding == Encoding::Utf8) {
+    return toUtf8();
+  }
+  std::string text;
+  for (std::size_t i = 0; i < length(); i++) {
+    const char32_t codePoint = at(i);
+    if (codePoint > 0xFF) {
+      return {};
+    }
+    text.push_back(static_cast<char>(codePoint));
+  }
+  return text;
+}
+
+// equalSpans(x, xIndex, y, yIndex, count) - Returns whether the count code
+//  points of leaf x from position xIndex are those of leaf y from position
+//  yIndex. Spans of the same buffer at the same place are equal, spans in the
+//  same encoding are compared a block of bytes at a time (see
+//  TextKernel::equal), and spans in different encodings a code point at a
+//  time.
+bool Rope::equalSpans(const Node &x, std::size_t xIndex, const Node &y,
+  std::size_t yIndex, std::size_t count) {
+  if (x.buffer == y.buffer && x.first + xIndex == y.first + yIndex) {
+    return true;
+  }
+  std::size_t xByte = byteOf(x, xIndex);
+  std::size_t yByte = byteOf(y, yIndex);
+  if (x.buffer->encoding == y.buffer->encoding) {
+    const std::size_t xEnd = endOf(x, xIndex + count);
+    const std::size_t yEnd = endOf(y, yIndex + count);
+    return xEnd - xByte == yEnd - yByte && TextKernel::equal(
+      x.buffer->bytes.data() + xByte, y.buffer->bytes.data() + yByte,
+      xEnd - xByte
+    );
+  }
+  for (std::size_t i = 0; i < count; i++) {
+    if (decode(x, xByte) != decode(y, yByte)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// endOf(leaf, index) - Returns the position in the buffer of leaf of the
+//  byte after the code points of leaf before index, which may be its length.
+std::size_t Rope::endOf(const Node &leaf, std::size_t index) {
+  return index == leaf.length ? leaf.byte + leaf.bytes : byteOf(leaf, index);
+}
+
+// hashInto(node, pending, hash) - Adds the UTF-8 bytes under node to pending,
+//  and hashes each block of hashBlock bytes into hash as soon as it is full.
+//  The blocks are counted from the start of the text, so the hash does not
+//  depend on where leaves start. Runs of ASCII in Latin-1 leaves are the same
+//  in UTF-8, and are added as they are.
+void Rope::hashInto(const Node &node, std::string &pending,
+  std::size_t &hash) {
+  if (node.depth != 0) {
+    hashInto(*node.left, pending, hash);
+    hashInto(*node.right, pending, hash);
+    return;
+  }
+  const auto flush = [&pending, &hash]() {
+    hash = (hash ^ std::hash<std::string_view> {}(
+      std::string_view { pending.data(), hashBlock }
+    )) * 0x100000001B3;
+    pending.erase(0, hashBlock);
+  };
+  const auto add = [&pending, &flush](const char *bytes, std::size_t size) {
+    while (size != 0) {
+      const std::size_t taken = std::min(size, hashBlock - pending.size());
+      pending.append(bytes, taken);
+      bytes += taken;
+      size -= taken;
+      if (pending.size() >= hashBlock) {
+        flush();
+      }
+    }
+  };
+  const char *bytes = node.buffer->bytes.data() + node.byte;
+  if (node.buffer->encoding == Encoding::Utf8) {
+    add(bytes, node.bytes);
+    return;
+  }
+  for (std::size_t i = 0; i < node.bytes; ) {
+    const std::size_t ascii = TextKernel::asciiLength(bytes + i,
+      node.bytes - i);
+    add(bytes + i, ascii);
+    i += ascii;
+    if (i < node.bytes) {
+      encode(static_cast<unsigned char>(bytes[i++]), pending);
+      if (pending.size() >= hashBlock) {
+        flush();
+      }
+    }
+  }
+}
+
+// fromUtf8(text, begin, end) - Keeps text as the buffer of a single leaf.
+Rope Rope::fromUtf8(std::string text, std::size_t begin, std::size_t end) {
+  return Rope { leafOf(std::move(text), begin, end) };
+}
+
+Rope Rope::fromUtf8(std::string text) {
+  const std::size_t size = text.size();
+  return fromUtf8(std::move(text), 0, size);
+}
+
+// of(codePoint) - Encodes codePoint as UTF-8 first.
+Rope Rope::of(char32_t codePoint) {
+  std::string text;
+  encode(codePoint, text);
+  return fromUtf8(std::move(text));
+}
+
+// length() - The length of the root is kept.
+std::size_t Rope::length() const {
+  return root ? root->length : 0;
+}
+
+// at(index) - Decodes the code point in the leaf holding it.
+char32_t Rope::at(std::size_t index) const {
+  std::size_t leafStart;
+  const Node &leaf = leafAt(index, leafStart);
+  std::size_t byte = byteOf(leaf, index - leafStart);
+  return decode(leaf, byte);
+}
+
+// slice(from, to) - Shares the buffers of every leaf.
+Rope Rope::slice(std::size_t from, std::size_t to) const {
+  to = std::min(to, length());
+  if (from >= to) {
+    return Rope {};
+  }
+  return Rope { slice(root, from, to) };
+}
+
+// concat(other) - Joins both trees.
+Rope Rope::concat(const Rope &other) const {
+  return Rope { join(root, other.root) };
+}
+
+// leafAt(index, leafStart) - Goes down to the child holding index until it
+//  reaches a leaf.
+const Rope::Node &Rope::leafAt(std::size_t index, std::size_t &leafStart)
+  const {
+  const Node *node = root.get();
+  leafStart = 0;
+  while (node->depth != 0) {
+    if (index - leafStart < node->left->length) {
+      node = node->left.get();
+    }
+    else {
+      leafStart += node->left->length;
+      node = node->right.get();
+    }
+  }
+  return *node;
+}
+
+// byteOf(leaf, index) - Looks the code point up in the buffer of leaf.
+std::size_t Rope::byteOf(const Node &leaf, std::size_t index) {
+  return offsetOf(*leaf.buffer, leaf.first + index);
+}
+
+// decode(leaf, byte) - Reads one byte for Latin-1, and the whole sequence
+//  for UTF-8, which is known to be valid.
+char32_t Rope::decode(const Node &leaf, std::size_t &byte) {
+  const std::string &bytes = leaf.buffer->bytes;
+  const auto lead = static_cast<unsigned char>(bytes[byte]);
+  if (leaf.buffer->encoding == Encoding::Latin1 || lead < 0x80) {
+    byte++;
+    return lead;
+  }
+  const std::size_t size = sequenceLength(lead);
+  char32_t codePoint = lead & (0x7F >> size);
+  for (std::size_t k = 1; k < size; k++) {
+    codePoint = (codePoint << 6) |
+      (static_cast<unsigned char>(bytes[byte + k]) & 0x3F);
+  }
+  byte += size;
+  return codePoint;
+}
+
+// encode(codePoint, text) - Uses as few bytes as codePoint needs.
+void Rope::encode(char32_t codePoint, std::string &text) {
+  if (codePoint < 0x80) {
+    text.push_back(static_cast<char>(codePoint));
+  }
+  else if (codePoint < 0x800) {
+    text.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+    text.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  }
+  else if (codePoint < 0x10000) {
+    text.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+    text.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+    text.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  }
+  else {
+    text.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+    text.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+    text.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+    text.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  }
+}
+
+// split(separator) - Encodes separator like the text, so that its bytes can
+//  be searched for, and counts the code points between occurrences. In
+//  Latin-1, that is the number of bytes.
+std::vector<Rope> Rope::split(const Rope &separator) const {
+  const Rope text = flattened();
+  if (separator.length() == 0) {
+    std::vector<Rope> characters;
+    for (std::size_t i = 0; i < text.length(); i++) {
+      characters.push_back(text.slice(i, i + 1));
+    }
+    return characters;
+  }
+  const std::optional<std::string> needle = text.root ?
+    separator.encodedAs(text.root->buffer->encoding) : std::nullopt;
+  if (!needle) {
+    return { text };
+  }
+  const Node &leaf = *text.root;
+  const char *bytes = leaf.buffer->bytes.data() + leaf.byte;
+  const bool latin1 = leaf.buffer->encoding == Encoding::Latin1;
+  std::vector<Rope> pieces;
+  std::size_t byte = 0;
+  std::size_t position = 0;
+  while (true) {
+    const std::size_t found = byte + TextKernel::find(bytes + byte,
+      leaf.bytes - byte, *needle);
+    const std::size_t length = latin1 ? found - byte :
+      TextKernel::countCodePoints(bytes + byte, found - byte);
+    pieces.push_back(pieceOf(leaf, position, byte, length, found - byte));
+    if (found == leaf.bytes) {
+      return pieces;
+    }
+    position += length + separator.length();
+    byte = found + needle->size();
+  }
+}
+
+// splitWhitespace() - TextKernel::findSpace stops at ASCII whitespace and at
+//  every code point that is not ASCII, which is decoded to see whether it is
+//  whitespace.
+std::vector<Rope> Rope::splitWhitespace() const {
+  const Rope text = flattened();
+  if (!text.root) {
+    return { text };
+  }
+  const Node &leaf = *text.root;
+  const char *bytes = leaf.buffer->bytes.data() + leaf.byte;
+  const bool latin1 = leaf.buffer->encoding == Encoding::Latin1;
+  std::vector<Rope> pieces;
+  // The start of the current piece and the place scanned up to, in bytes and
+  //  in code points.
+  std::size_t start = 0;
+  std::size_t startPosition = 0;
+  std::size_t byte = 0;
+  std::size_t position = 0;
+  while (true) {
+    const std::size_t found = byte + TextKernel::findSpace(bytes + byte,
+      leaf.bytes - byte);
+    position += latin1 ? found - byte :
+      TextKernel::countCodePoints(bytes + byte, found - byte);
+    if (found == leaf.bytes) {
+      break;
+    }
+    std::size_t next = leaf.byte + found;
+    const char32_t codePoint = decode(leaf, next);
+    next -= leaf.byte;
+    if (TextKernel::isWhitespace(codePoint)) {
+      pieces.push_back(pieceOf(leaf, startPosition, start,
+        position - startPosition, found - start));
+      start = next;
+      startPosition = position + 1;
+    }
+    byte = next;
+    position++;
+  }
+  pieces.push_back(pieceOf(leaf, startPosition, start,
+    position - startPosition, leaf.bytes - start));
+  return pieces;
+}
+
+// find(needle) - Searches for the bytes of needle in the encoding of the
+//  text.
+std::optional<std::size_t> Rope::find(const Rope &needle) const {
+  if (needle.length() == 0) {
+    return 0;
+  }
+  const Rope text = flattened();
+  const std::optional<std::string> encoded = text.root ?
+    needle.encodedAs(text.root->buffer->encoding) : std::nullopt;
+  if (!encoded) {
+    return {};
+  }
+  const Node &leaf = *text.root;
+  const char *bytes = leaf.buffer->bytes.data() + leaf.byte;
+  const std::size_t found = TextKernel::find(bytes, leaf.bytes, *encoded);
+  if (found == leaf.bytes) {
+    return {};
+  }
+  return leaf.buffer->encoding == Encoding::Latin1 ? found :
+    TextKernel::countCodePoints(bytes, found);
+}
+
+// trimmed() - Skips ASCII whitespace from the start with
+//  TextKernel::skipSpaces, and goes back from the end a code point at a time,
+//  since there is rarely much whitespace there.
+Rope Rope::trimmed() const {
+  const Rope text = flattened();
+  if (!text.root) {
+    return text;
+  }
+  const Node &leaf = *text.root;
+  const char *bytes = leaf.buffer->bytes.data() + leaf.byte;
+  const bool latin1 = leaf.buffer->encoding == Encoding::Latin1;
+  std::size_t front = 0;
+  while (true) {
+    front += TextKernel::skipSpaces(bytes + front, leaf.bytes - front);
+    if (front == leaf.bytes) {
+      return Rope {};
+    }
+    std::size_t next = leaf.byte + front;
+    if (!TextKernel::isWhitespace(decode(leaf, next))) {
+      break;
+    }
+    front = next - leaf.byte;
+  }
+  std::size_t back = leaf.bytes;
+  while (true) {
+    std::size_t start = back - 1;
+    while (!latin1 &&
+      (static_cast<unsigned char>(bytes[start]) & 0xC0) == 0x80) {
+      start--;
+    }
+    std::size_t next = leaf.byte + start;
+    if (!TextKernel::isWhitespace(decode(leaf, next))) {
+      break;
+    }
+    back = start;
+  }
+  if (latin1) {
+    return pieceOf(leaf, front, front, back - front, back - front);
+  }
+  return pieceOf(leaf, TextKernel::countCodePoints(bytes, front), front,
+    TextKernel::countCodePoints(bytes + front, back - front), back - front);
+}
+
+// appendTo(text) - Appends every leaf in order.
+void Rope::appendTo(std::string &text) const {
+  if (root) {
+    appendUtf8(*root, text);
+  }
+}
+
+// toUtf8() - Appends every leaf in order.
+// equals(other) - Goes through both texts a span at a time, each span ending
+//  where a leaf of either ends.
+bool Rope::equals(const Rope &other) const {
+  if (root == other.root) {
+    return true;
+  }
+  if (length() != other.length()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < length(); ) {
+    std::size_t xStart;
+    std::size_t yStart;
+    const Node &x = leafAt(i, xStart);
+    const Node &y = other.leafAt(i, yStart);
+    const std::size_t count = std::min(x.length - (i - xStart),
+      y.length - (i - yStart));
+    if (!equalSpans(x, i - xStart, y, i - yStart, count)) {
+      return false;
+    }
+    i += count;
+  }
+  return true;
+}
+
+// hash() - Hashes the last block, which may not be full, with the length.
+std::size_t Rope::hash() const {
+  std::size_t hash = 0xCBF29CE484222325;
+  if (!root) {
+    return hash;
+  }
+  std::string pending;
+  pending.reserve(hashBlock + 4);
+  hashInto(*root, pending, hash);
+  return (hash ^ std::hash<std::string_view> {}(pending)) * 0x100000001B3 +
+    root->length;
+}
+
+std::string Rope::toUtf8() const {
+  std::string text;
+  if (root) {
+    text.reserve(root->bytes);
+    appendUtf8(*root, text);
+  }
+  return text;
+}
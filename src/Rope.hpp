@@ -0,0 +1,181 @@
+// File: src/Rope.hpp
+// Purpose: Header file for Ropes, which are the immutable texts that
+//  StringValues hold. See src/Rope.cpp for implementations.
+
+#ifndef ROPE_HPP
+#define ROPE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Rope - An immutable sequence of Unicode code points, stored as a balanced
+//  binary tree whose leaves are views of shared buffers. Each buffer holds its
+//  text in Latin-1 (one byte per code point) if every code point fits in a
+//  byte, which is the case for all ASCII text, and in UTF-8 otherwise. A
+//  UTF-8 buffer also keeps a sparse index of where every markStride-th code
+//  point starts, so the code point at any position is found after decoding at
+//  most markStride - 1 others, and the length of a Rope is always known.
+//  Concatenating Ropes makes a new node above both, rotating nodes as an AVL
+//  tree does so that no path is much longer than another, except that texts
+//  of at most leafBytes bytes in total are copied into a single leaf, so that
+//  text built a little at a time does not end up as a tree of tiny leaves.
+//  Slicing a Rope shares the buffers of its leaves, so neither slicing nor
+//  concatenating ever copies more than leafBytes bytes.
+// Searching a Rope, as split, find and trimmed do, scans the bytes of a single
+//  buffer with the loops of TextKernel (see src/TextKernel.hpp), so a Rope of
+//  several leaves is first copied into one. The pieces that split returns
+//  are views of that buffer, and are never copied.
+class Rope {
+public:
+  // The number of code points between two entries of the index of a UTF-8
+  //  buffer.
+  static constexpr std::size_t markStride = 64;
+
+  // The most bytes in a leaf made by concatenating smaller ones.
+  static constexpr std::size_t leafBytes = 256;
+
+  // The number of bytes of UTF-8 hashed at once by hash.
+  static constexpr std::size_t hashBlock = 4096;
+
+  // How the bytes of a Buffer encode its code points.
+  enum class Encoding { Latin1, Utf8 };
+
+  // A Buffer is text shared by the leaves that view it. Its code points start
+  //  at byte begin of bytes, and for UTF-8, the code point at k * markStride
+  //  starts at byte marks[k]. Its bytes are always valid in its encoding.
+  struct Buffer {
+    std::string bytes;
+    std::size_t begin;
+    Encoding encoding;
+    std::vector<std::size_t> marks;
+  };
+
+  // A Node is a leaf (of depth 0) viewing the length code points of buffer
+  //  starting with the one at first, whose bytes start at byte, or a node
+  //  with a left and right child that are concatenated. length and bytes are
+  //  the number of code points and of bytes under the node. Nodes are never
+  //  changed once they are shared.
+  struct Node {
+    std::shared_ptr<const Buffer> buffer;
+    std::size_t first;
+    std::size_t byte;
+    std::shared_ptr<const Node> left;
+    std::shared_ptr<const Node> right;
+    std::size_t length;
+    std::size_t bytes;
+    std::size_t depth;
+  };
+  typedef std::shared_ptr<const Node> NodePointer;
+
+private:
+  // The root of the tree, which is null for the empty text.
+  NodePointer root;
+
+  // Private methods are documented in src/Rope.cpp.
+  explicit Rope(const NodePointer &root);
+  static NodePointer leafOf(std::string bytes, std::size_t begin,
+    std::size_t end);
+  static NodePointer leafOf(const std::shared_ptr<const Buffer> &buffer,
+    std::size_t first, std::size_t length);
+  static NodePointer nodeOf(const NodePointer &left, const NodePointer &right);
+  static NodePointer join(const NodePointer &left, const NodePointer &right);
+  static NodePointer slice(const NodePointer &node, std::size_t from,
+    std::size_t to);
+  static std::size_t offsetOf(const Buffer &buffer, std::size_t codePoint);
+  static std::size_t sequenceLength(unsigned char lead);
+  static std::size_t readUtf8(const std::string &text, std::size_t byte,
+    std::size_t end, char32_t &codePoint);
+  static void appendUtf8(const Node &node, std::string &text);
+  static Rope pieceOf(const Node &leaf, std::size_t first, std::size_t byte,
+    std::size_t length, std::size_t bytes);
+  Rope flattened() const;
+  std::optional<std::string> encodedAs(Encoding encoding) const;
+  static bool equalSpans(const Node &x, std::size_t xIndex, const Node &y,
+    std::size_t yIndex, std::size_t count);
+  static std::size_t endOf(const Node &leaf, std::size_t index);
+  static void hashInto(const Node &node, std::string &pending,
+    std::size_t &hash);
+
+public:
+  // Constructor() - Creates the empty Rope.
+  Rope();
+
+  // static fromUtf8(text, begin, end) - Returns the Rope of the UTF-8 text
+  //  from byte begin of text up to byte end, which keeps text itself (without
+  //  copying it) if it is valid and can be stored as it is. Bytes that are
+  //  not valid UTF-8 are read as U+FFFD, the replacement character.
+  static Rope fromUtf8(std::string text, std::size_t begin, std::size_t end);
+
+  // static fromUtf8(text) - Returns the Rope of the whole UTF-8 text.
+  static Rope fromUtf8(std::string text);
+
+  // static of(codePoint) - Returns the Rope of one code point.
+  static Rope of(char32_t codePoint);
+
+  // length() - Returns the number of code points.
+  std::size_t length() const;
+
+  // at(index) - Returns the code point at the given position, counting from
+  //  0, which must be less than the length.
+  char32_t at(std::size_t index) const;
+
+  // slice(from, to) - Returns the Rope of the code points from position from
+  //  up to (but not including) position to, which are clamped to the length.
+  Rope slice(std::size_t from, std::size_t to) const;
+
+  // concat(other) - Returns the Rope of these code points followed by those
+  //  of other.
+  Rope concat(const Rope &other) const;
+
+  // leafAt(index, leafStart) - Returns the leaf holding the code point at
+  //  index, which must be less than the length, and sets leafStart to the
+  //  position of the first code point in that leaf.
+  const Node &leafAt(std::size_t index, std::size_t &leafStart) const;
+
+  // static byteOf(leaf, index) - Returns the position in the buffer of leaf
+  //  of the first byte of the code point at index in leaf.
+  static std::size_t byteOf(const Node &leaf, std::size_t index);
+
+  // static decode(leaf, byte) - Returns the code point whose first byte is at
+  //  position byte of the buffer of leaf, and moves byte past it.
+  static char32_t decode(const Node &leaf, std::size_t &byte);
+
+  // static encode(codePoint, text) - Appends codePoint to text in UTF-8.
+  static void encode(char32_t codePoint, std::string &text);
+
+  // split(separator) - Returns the pieces of the text between occurrences of
+  //  separator, including empty ones, so that there is always one more piece
+  //  than there are occurrences. If separator is empty, each code point is a
+  //  piece.
+  std::vector<Rope> split(const Rope &separator) const;
+
+  // splitWhitespace() - Returns the pieces of the text between whitespace
+  //  code points (see TextKernel::isWhitespace), including empty ones.
+  std::vector<Rope> splitWhitespace() const;
+
+  // find(needle) - Returns the position of the first occurrence of needle,
+  //  or nothing if there is none.
+  std::optional<std::size_t> find(const Rope &needle) const;
+
+  // trimmed() - Returns the text without whitespace at its start and end.
+  Rope trimmed() const;
+
+  // appendTo(text) - Appends the text to text in UTF-8.
+  void appendTo(std::string &text) const;
+
+  // equals(other) - Returns whether the text is the same as that of other,
+  //  however either is split into leaves and encoded.
+  bool equals(const Rope &other) const;
+
+  // hash() - Returns the hash of the text in UTF-8, which is the same for
+  //  any Ropes that are equal. Takes O(n) time.
+  std::size_t hash() const;
+
+  // toUtf8() - Returns the text in UTF-8.
+  std::string toUtf8() const;
+};
+
+#endif
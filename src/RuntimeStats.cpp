@@ -0,0 +1,149 @@
+// File: src/RuntimeStats.cpp
+// Purpose: Source file for RuntimeStats, which collect statistics about the
+//  evaluation of Fleet code on the current thread. See src/RuntimeStats.hpp
+//  for more documentation.
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include "RuntimeStats.hpp"
+
+thread_local RuntimeStats RuntimeStats::currentStats {};
+
+// Constructor() - Starts all statistics at zero.
+RuntimeStats::RuntimeStats(): maxStackDepth { 0 }, maxOperandDepth { 0 },
+  betaReductions { 0 }, commonSubexpressions { 0 } {}
+
+// current() - Returns the RuntimeStats of the current thread.
+RuntimeStats &RuntimeStats::current() {
+  return currentStats;
+}
+
+// recordStackDepth(stackDepth, operandDepth) - Keeps the largest depths seen.
+void RuntimeStats::recordStackDepth(std::size_t stackDepth,
+  std::size_t operandDepth) {
+  maxStackDepth = std::max(maxStackDepth, stackDepth);
+  maxOperandDepth = std::max(maxOperandDepth, operandDepth);
+}
+
+// getMaxStackDepth() - Returns the largest continuation stack depth.
+std::size_t RuntimeStats::getMaxStackDepth() const {
+  return maxStackDepth;
+}
+
+// getMaxOperandDepth() - Returns the largest operand stack depth.
+std::size_t RuntimeStats::getMaxOperandDepth() const {
+  return maxOperandDepth;
+}
+
+// recordInlined(name) - Counts one more inlined call of name.
+void RuntimeStats::recordInlined(const std::string &name) {
+  inlined[name]++;
+}
+
+// recordBetaReduction() - Counts one more reduced call.
+void RuntimeStats::recordBetaReduction() {
+  betaReductions++;
+}
+
+// recordCommonSubexpression() - Counts one more shared subexpression.
+void RuntimeStats::recordCommonSubexpression() {
+  commonSubexpressions++;
+}
+
+// getInlined() - Returns the inlined calls of each function.
+const std::map<std::string, std::size_t> &RuntimeStats::getInlined() const {
+  return inlined;
+}
+
+// getBetaReductions() - Returns the number of reduced calls.
+std::size_t RuntimeStats::getBetaReductions() const {
+  return betaReductions;
+}
+
+// getCommonSubexpressions() - Returns the number of shared subexpressions.
+std::size_t RuntimeStats::getCommonSubexpressions() const {
+  return commonSubexpressions;
+}
+
+// recordMemoized(name) - Returns the Memo of name, creating it if needed.
+std::shared_ptr<RuntimeStats::Memo> RuntimeStats::recordMemoized(
+  const std::string &name) {
+  auto &memo = memoized[name];
+  if (!memo) {
+    memo = std::make_shared<Memo>();
+  }
+  return memo;
+}
+
+// getMemoized() - Returns the Memo of each memoized function.
+const std::map<std::string, std::shared_ptr<RuntimeStats::Memo>> &
+  RuntimeStats::getMemoized() const {
+  return memoized;
+}
+
+// recordCompaction(numbers, bytes, packed, delta, runs) - Adds to the totals.
+void RuntimeStats::recordCompaction(std::size_t numbers, std::size_t bytes,
+  std::size_t packed, std::size_t delta, std::size_t runs) {
+  compaction.lists++;
+  compaction.numbers += numbers;
+  compaction.bytes += bytes;
+  compaction.packedBlocks += packed;
+  compaction.deltaBlocks += delta;
+  compaction.runBlocks += runs;
+}
+
+// getCompaction() - Returns the totals of the compact lists.
+const RuntimeStats::Compaction &RuntimeStats::getCompaction() const {
+  return compaction;
+}
+
+// reset() - Sets all statistics back to zero.
+void RuntimeStats::reset() {
+  *this = RuntimeStats {};
+}
+
+// operator std::string() - Returns one "name: value" line per statistic. The
+//  inlined functions are listed as "name (calls)", and the memoized functions
+//  as "name (hits/calls hits)" followed by the number of results evicted to
+//  make room for others and whether memoization was given up on. Compact
+//  lists are reported with how many times smaller they are than the same
+//  numbers unboxed (8 bytes each).
+RuntimeStats::operator std::string() const {
+  std::string inlinedList;
+  for (const auto &[name, calls] : inlined) {
+    inlinedList += " " + name + " (" + std::to_string(calls) + ")";
+  }
+  std::string memoizedList;
+  for (const auto &[name, memo] : memoized) {
+    memoizedList += " " + name + " (" + std::to_string(memo->hits) + "/" +
+      std::to_string(memo->calls) + " hits";
+    if (memo->evictions) {
+      memoizedList += ", " + std::to_string(memo->evictions) + " evicted";
+    }
+    memoizedList += memo->rejected ? ", rejected)" : ")";
+  }
+  std::string compactList;
+  if (compaction.lists) {
+    const double ratio = 8.0 * compaction.numbers / compaction.bytes;
+    std::ostringstream shown;
+    shown << " " << compaction.lists << " (" << compaction.numbers <<
+      " numbers in " << compaction.bytes << " bytes, " << std::fixed <<
+      std::setprecision(1) << ratio << "x smaller; blocks: " <<
+      compaction.packedBlocks << " packed, " << compaction.deltaBlocks <<
+      " delta, " << compaction.runBlocks << " runs)";
+    compactList = shown.str();
+  }
+  return std::string { "Max stack depth: " } + std::to_string(maxStackDepth) +
+    "\nMax operand depth: " + std::to_string(maxOperandDepth) +
+    "\nInlined functions:" + (inlined.empty() ? " none" : inlinedList) +
+    "\nBeta reductions: " + std::to_string(betaReductions) +
+    "\nCommon subexpressions: " + std::to_string(commonSubexpressions) +
+    "\nMemoized functions:" + (memoized.empty() ? " none" : memoizedList) +
+    "\nCompact lists:" + (compactList.empty() ? " none" : compactList) +
+    "\n";
+}
@@ -0,0 +1,117 @@
+// File: src/RuntimeStats.hpp
+// Purpose: Header file for RuntimeStats, which collect statistics about the
+//  evaluation of Fleet code on the current thread. See src/RuntimeStats.cpp
+//  for implementations.
+
+#ifndef RUNTIMESTATS_HPP
+#define RUNTIMESTATS_HPP
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+
+class RuntimeStats {
+public:
+  // A Memo counts the calls of the memoized functions with a name (see
+  //  src/MemoTable.hpp) and how many of them were answered from memory.
+  struct Memo {
+    std::size_t calls = 0;
+    std::size_t hits = 0;
+    std::size_t evictions = 0;
+    // Whether memoization was given up on because too few calls were hits.
+    bool rejected = false;
+  };
+
+  // A Compaction counts the lists stored compactly (see
+  //  src/CompactVector.hpp), the numbers they hold, the bytes they take and
+  //  how many of their blocks use each encoding.
+  struct Compaction {
+    std::size_t lists = 0;
+    std::size_t numbers = 0;
+    std::size_t bytes = 0;
+    std::size_t packedBlocks = 0;
+    std::size_t deltaBlocks = 0;
+    std::size_t runBlocks = 0;
+  };
+
+private:
+  std::size_t maxStackDepth;
+  std::size_t maxOperandDepth;
+  std::map<std::string, std::size_t> inlined;
+  std::size_t betaReductions;
+  std::size_t commonSubexpressions;
+  std::map<std::string, std::shared_ptr<Memo>> memoized;
+  Compaction compaction;
+
+  static thread_local RuntimeStats currentStats;
+
+public:
+  // Constructor() - Creates RuntimeStats with all statistics at zero.
+  RuntimeStats();
+
+  // static current() - Returns the RuntimeStats of the current thread.
+  static RuntimeStats &current();
+
+  // recordStackDepth(stackDepth, operandDepth) - Records the depths that the
+  //  Evaluator's continuation and operand stacks have reached.
+  void recordStackDepth(std::size_t stackDepth, std::size_t operandDepth);
+
+  // getMaxStackDepth() - Returns the largest depth that the Evaluator's
+  //  continuation stack has reached.
+  std::size_t getMaxStackDepth() const;
+
+  // getMaxOperandDepth() - Returns the largest depth that the Evaluator's
+  //  operand stack has reached.
+  std::size_t getMaxOperandDepth() const;
+
+  // recordInlined(name) - Records that a call of the function with the given
+  //  name was inlined (see src/Inliner.hpp).
+  void recordInlined(const std::string &name);
+
+  // recordBetaReduction() - Records that a call of a function written where
+  //  it is called was reduced.
+  void recordBetaReduction();
+
+  // recordCommonSubexpression() - Records that a repeated subexpression was
+  //  made to be evaluated only once.
+  void recordCommonSubexpression();
+
+  // getInlined() - Returns the names of the functions whose calls were
+  //  inlined, along with the number of calls inlined for each.
+  const std::map<std::string, std::size_t> &getInlined() const;
+
+  // getBetaReductions() - Returns the number of calls that were reduced.
+  std::size_t getBetaReductions() const;
+
+  // getCommonSubexpressions() - Returns the number of repeated subexpressions
+  //  that are evaluated only once.
+  std::size_t getCommonSubexpressions() const;
+
+  // recordMemoized(name) - Returns the Memo that counts the calls of the
+  //  memoized functions with the given name. The Memo stays valid after
+  //  reset(), but it is then no longer reported.
+  std::shared_ptr<Memo> recordMemoized(const std::string &name);
+
+  // getMemoized() - Returns the names of the memoized functions, along with
+  //  the Memo of each.
+  const std::map<std::string, std::shared_ptr<Memo>> &getMemoized() const;
+
+  // recordCompaction(numbers, bytes, packed, delta, runs) - Records that a
+  //  list of the given number of numbers was stored compactly in the given
+  //  number of bytes, with the given numbers of blocks of each encoding.
+  void recordCompaction(std::size_t numbers, std::size_t bytes,
+    std::size_t packed, std::size_t delta, std::size_t runs);
+
+  // getCompaction() - Returns the totals of the lists stored compactly.
+  const Compaction &getCompaction() const;
+
+  // reset() - Sets all statistics back to zero.
+  void reset();
+
+  // operator std::string() - Returns a human-readable report of the
+  //  statistics, one per line.
+  operator std::string() const;
+};
+
+#endif
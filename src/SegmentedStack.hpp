@@ -0,0 +1,85 @@
+// File: src/SegmentedStack.hpp
+// Purpose: Header file for SegmentedStacks, which are stacks stored on the heap
+//  in segments of growing size. Unlike a single growable array, a
+//  SegmentedStack never moves its elements when it grows, and it keeps the
+//  segments it has allocated so that pushing after popping is cheap.
+
+#ifndef SEGMENTEDSTACK_HPP
+#define SEGMENTEDSTACK_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class SegmentedStack {
+private:
+  // Each segment is a vector whose capacity is reserved when it is created and
+  //  is never exceeded, so its elements are never moved.
+  std::vector<std::vector<T>> segments;
+  std::size_t currentSegment = 0;
+  std::size_t count = 0;
+  std::size_t maxCount = 0;
+
+  static const std::size_t firstSegmentSize = 256;
+
+public:
+  // push(value) - Adds value to the top of the stack, moving on to the next
+  //  segment (and allocating it if necessary) if the current one is full.
+  void push(T &&value) {
+    if (segments.empty()) {
+      segments.emplace_back();
+      segments.back().reserve(firstSegmentSize);
+    }
+    else if (segments[currentSegment].size() ==
+      segments[currentSegment].capacity()) {
+      if (currentSegment + 1 == segments.size()) {
+        const std::size_t size = 2 * segments[currentSegment].capacity();
+        segments.emplace_back();
+        segments.back().reserve(size);
+      }
+      currentSegment++;
+    }
+    segments[currentSegment].push_back(std::move(value));
+    count++;
+    if (count > maxCount) {
+      maxCount = count;
+    }
+  }
+
+  // top() - Returns the element on top of the stack. The stack must not be
+  //  empty.
+  T &top() {
+    return segments[currentSegment].back();
+  }
+
+  // pop() - Removes the element on top of the stack and returns it. The stack
+  //  must not be empty.
+  T pop() {
+    T value = std::move(segments[currentSegment].back());
+    segments[currentSegment].pop_back();
+    if (segments[currentSegment].empty() && currentSegment > 0) {
+      currentSegment--;
+    }
+    count--;
+    return value;
+  }
+
+  // size() - Returns the number of elements in the stack.
+  std::size_t size() const {
+    return count;
+  }
+
+  // getMaxSize() - Returns the largest number of elements the stack has held
+  //  since it was created or since resetMaxSize() was last called.
+  std::size_t getMaxSize() const {
+    return maxCount;
+  }
+
+  // resetMaxSize() - Makes the current size the largest size so far.
+  void resetMaxSize() {
+    maxCount = count;
+  }
+};
+
+#endif
@@ -0,0 +1,1130 @@
+// File: src/SequenceValue.cpp
+// Purpose: Source file for SequenceValues, which are lazy sequences of Values
+//  such as `1 ..< 1000 |> filter divisible`. See src/SequenceValue.hpp for
+//  more documentation.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "SequenceValue.hpp"
+#include "BooleanValue.hpp"
+#include "Bytes.hpp"
+#include "BytesValue.hpp"
+#include "Error.hpp"
+#include "Evacuation.hpp"
+#include "FunctionValue.hpp"
+#include "ListValue.hpp"
+#include "NumberValue.hpp"
+#include "NumericKernel.hpp"
+#include "PersistentVector.hpp"
+#include "Region.hpp"
+#include "Rope.hpp"
+#include "StringValue.hpp"
+#include "ThunkValue.hpp"
+#include "TupleValue.hpp"
+#include "Value.hpp"
+
+// Constructor
+SequenceValue::Cursor::Cursor(const SequenceValue &sequence):
+  sequence { sequence }, position { 0 }, states(sequence.stages.size()),
+  cell { std::get_if<Cons>(sequence.source.get()) }, headGiven { false },
+  leaf { nullptr }, leafStart { 0 }, piece { nullptr }, byte { 0 },
+  numbers {}, copied { 0 } {}
+
+// fromSource() - Returns the next element of the source.
+Value::OrError SequenceValue::Cursor::fromSource() {
+  if (cell || rest) {
+    return fromCells();
+  }
+  if (const auto range = std::get_if<Range>(sequence.source.get())) {
+    // Each number is computed from the start, so that no error accumulates.
+    const double k = range->from + position;
+    if (!(k < range->to)) {
+      return { Value::Pointer {} };
+    }
+    position++;
+    return { Value::Pointer {
+      Region::make<NumberValue>(range->start + k * range->step)
+    } };
+  }
+  // The code points of a Rope are decoded one after another in each leaf.
+  if (const auto text = std::get_if<Rope>(sequence.source.get())) {
+    if (position == text->length()) {
+      return { Value::Pointer {} };
+    }
+    if (!piece || position - leafStart == piece->length) {
+      piece = &text->leafAt(position, leafStart);
+      byte = Rope::byteOf(*piece, position - leafStart);
+    }
+    position++;
+    return { Value::Pointer {
+      StringValue::of(Rope::decode(*piece, byte))
+    } };
+  }
+  if (const auto bytes = std::get_if<Bytes>(sequence.source.get())) {
+    if (position == bytes->size()) {
+      return { Value::Pointer {} };
+    }
+    return { Value::Pointer { BytesValue::elementOf(bytes->at(position++)) } };
+  }
+  // The elements of a PersistentVector are read one leaf at a time, and
+  //  unboxed numbers are boxed as they are read. The numbers of a numeric
+  //  vector, which may be compact, are copied out of it instead.
+  const auto &elements = *std::get_if<PersistentVector>(sequence.source.get());
+  if (position == elements.size()) {
+    return { Value::Pointer {} };
+  }
+  if (elements.isNumeric()) {
+    if (position - leafStart == copied) {
+      leafStart = position;
+      copied = std::min(numbers.size(), elements.size() - position);
+      elements.copyNumbers(position, copied, numbers.data());
+    }
+    return { Value::Pointer {
+      Region::make<NumberValue>(numbers[position++ - leafStart])
+    } };
+  }
+  if (!leaf || position - leafStart == (leaf->numeric ?
+    leaf->numbers.size() : leaf->elements.size())) {
+    leaf = &elements.leafAt(position, leafStart);
+  }
+  const std::size_t index = position++ - leafStart;
+  if (leaf->numeric) {
+    return { Value::Pointer {
+      Region::make<NumberValue>(leaf->numbers[index])
+    } };
+  }
+  return { leaf->elements[index] };
+}
+
+// fromCells() - Returns the next element of a Cons source. A tail that is a
+//  plain Cons in turn (as that of a sequence defined in terms of itself is)
+//  is walked in this Cursor, keeping only the Cons it is at, so that going
+//  through a long sequence of them neither recurses nor keeps the elements
+//  already given.
+Value::OrError SequenceValue::Cursor::fromCells() {
+  if (rest) {
+    return rest->next();
+  }
+  if (!headGiven) {
+    headGiven = true;
+    position++;
+    return { cell->head };
+  }
+  const Value::OrError forced = cell->tail->force();
+  if (std::holds_alternative<Error>(forced)) {
+    return forced;
+  }
+  const Value::Pointer &tail = *std::get_if<Value::Pointer>(&forced);
+  const auto tailSequence = std::dynamic_pointer_cast<SequenceValue>(tail);
+  if (!tailSequence) {
+    return { Error { Error::Code::ArgumentType, {
+      &SequenceValue::getClassName, Error::NameOf { tail }
+    } } };
+  }
+  const auto next = tailSequence->stages.empty() ?
+    std::get_if<Cons>(tailSequence->source.get()) : nullptr;
+  held = tailSequence;
+  if (next) {
+    cell = next;
+    position++;
+    return { cell->head };
+  }
+  cell = nullptr;
+  rest = std::make_unique<Cursor>(*held);
+  return rest->next();
+}
+
+// pull(count) - Returns the next element after the first count stages. Each
+//  stage pulls from the stages before it, so this recurses once per stage.
+Value::OrError SequenceValue::Cursor::pull(std::size_t count) {
+  if (count == 0) {
+    return fromSource();
+  }
+  const Stage &stage = sequence.stages[count - 1];
+  State &state = states[count - 1];
+  if (state.done) {
+    return { Value::Pointer {} };
+  }
+  while (true) {
+    // ConcatMap gives the elements of the sequence it is flattening first.
+    if (state.cursor && stage.kind == Stage::Kind::ConcatMap) {
+      const Value::OrError inner = state.cursor->next();
+      if (std::holds_alternative<Error>(inner) ||
+        *std::get_if<Value::Pointer>(&inner)) {
+        return inner;
+      }
+      state.cursor = nullptr;
+      state.inner = nullptr;
+    }
+    if (stage.kind == Stage::Kind::Take && state.seen == stage.count) {
+      state.done = true;
+      return { Value::Pointer {} };
+    }
+    const Value::OrError previous = pull(count - 1);
+    if (std::holds_alternative<Error>(previous)) {
+      return previous;
+    }
+    const Value::Pointer &element = *std::get_if<Value::Pointer>(&previous);
+    if (!element) {
+      state.done = true;
+      return previous;
+    }
+    switch (stage.kind) {
+      case Stage::Kind::Map:
+        return stage.function->call(element);
+      case Stage::Kind::Filter:
+      case Stage::Kind::While: {
+        bool kept = false;
+        const Value::OrError result = test(stage.function, element, kept);
+        if (std::holds_alternative<Error>(result) || kept) {
+          return result;
+        }
+        if (stage.kind == Stage::Kind::While) {
+          state.done = true;
+          return { Value::Pointer {} };
+        }
+        break;
+      }
+      case Stage::Kind::Take:
+        state.seen++;
+        return previous;
+      case Stage::Kind::Drop:
+        if (state.seen == stage.count) {
+          return previous;
+        }
+        state.seen++;
+        break;
+      case Stage::Kind::Zip: {
+        if (!state.cursor) {
+          state.cursor = std::make_unique<Cursor>(*stage.other);
+        }
+        const Value::OrError paired = state.cursor->next();
+        if (std::holds_alternative<Error>(paired)) {
+          return paired;
+        }
+        const Value::Pointer &other = *std::get_if<Value::Pointer>(&paired);
+        if (!other) {
+          state.done = true;
+          return paired;
+        }
+        return {
+          Value::Pointer { Region::make<TupleValue>(element, other) }
+        };
+      }
+      case Stage::Kind::ConcatMap: {
+        const Value::OrError inner = stage.function->call(element);
+        if (std::holds_alternative<Error>(inner)) {
+          return inner;
+        }
+        state.inner = *std::get_if<Value::Pointer>(&inner);
+        const auto flattened =
+          dynamic_cast<const SequenceValue *>(state.inner.get());
+        if (!flattened) {
+          return { Error { Error::Code::ReturnType, {
+            &SequenceValue::getClassName, Error::NameOf { state.inner }
+          } } };
+        }
+        state.cursor = std::make_unique<Cursor>(*flattened);
+        break;
+      }
+      case Stage::Kind::Scan: {
+        if (!state.inner) {
+          state.inner = element;
+          return previous;
+        }
+        const Value::OrError combined = combine(stage.function,
+          dynamic_cast<const BinaryCallValue *>(stage.function.get()),
+          state.inner, element);
+        if (std::holds_alternative<Value::Pointer>(combined)) {
+          state.inner = *std::get_if<Value::Pointer>(&combined);
+        }
+        return combined;
+      }
+    }
+  }
+}
+
+// next() - Pulls an element through every stage.
+Value::OrError SequenceValue::Cursor::next() {
+  return pull(states.size());
+}
+
+// Constructor
+SequenceValue::SequenceValue(const std::shared_ptr<const Source> &source,
+  const std::vector<Stage> &stages): source { source }, stages { stages } {}
+
+// cons(head, tail) - Creates a SequenceValue with a Cons source.
+std::shared_ptr<SequenceValue> SequenceValue::cons(const Value::Pointer &head,
+  const std::shared_ptr<const ThunkValue> &tail) {
+  return Region::make<SequenceValue>(
+    std::make_shared<const Source>(Cons { head, tail }), std::vector<Stage> {}
+  );
+}
+
+// of(elements) - Creates a ListValue.
+std::shared_ptr<SequenceValue> SequenceValue::of(
+  const std::vector<Value::Pointer> &elements) {
+  return Region::make<ListValue>(PersistentVector::of(elements));
+}
+
+// then(stage) - The new SequenceValue shares the source of this one.
+std::shared_ptr<SequenceValue> SequenceValue::then(const Stage &stage) const {
+  std::vector<Stage> next { stages };
+  next.push_back(stage);
+  return Region::make<SequenceValue>(source, next);
+}
+
+// test(predicate, element, result) - Calls predicate with element and sets
+//  result to whether it returned True. Returns element, or an error if the
+//  call failed or did not return a BooleanValue.
+Value::OrError SequenceValue::test(const Value::Pointer &predicate,
+  const Value::Pointer &element, bool &result) {
+  const Value::OrError tested = predicate->call(element);
+  if (std::holds_alternative<Error>(tested)) {
+    return tested;
+  }
+  const Value::Pointer &value = *std::get_if<Value::Pointer>(&tested);
+  const auto boolean = dynamic_cast<const BooleanValue *>(value.get());
+  if (!boolean) {
+    return { Error { Error::Code::ReturnType, {
+      &BooleanValue::getClassName, Error::NameOf { value }
+    } } };
+  }
+  result = boolean->getRawBoolean();
+  return { element };
+}
+
+// combine(f, binary, x, y) - Returns f x y. binary is f if it is a
+//  BinaryCallValue, in which case it is called with both arguments at once,
+//  so that no partial application is created.
+Value::OrError SequenceValue::combine(const Value::Pointer &f,
+  const BinaryCallValue *binary, const Value::Pointer &x,
+  const Value::Pointer &y) {
+  if (binary) {
+    return binary->callBinary(x, y);
+  }
+  const Value::OrError partial = f->call(x);
+  if (std::holds_alternative<Error>(partial)) {
+    return partial;
+  }
+  return (*std::get_if<Value::Pointer>(&partial))->call(y);
+}
+
+// isExact(number) - Every whole number below 2^53 is a double, and so are the
+//  sums and products of such numbers while they stay below it.
+bool SequenceValue::isExact(double number) {
+  return std::floor(number) == number &&
+    std::fabs(number) < 9007199254740992.0;
+}
+
+// isExact(range) - The numbers between the first and the last one of a range
+//  of whole numbers are whole and smaller than either.
+bool SequenceValue::isExact(const Range &range) {
+  return isExact(range.to - range.from) && isExact(range.start) &&
+    isExact(range.step) && isExact(range.from * range.step) &&
+    isExact((range.to - 1) * range.step) &&
+    isExact(range.start + range.from * range.step) &&
+    isExact(range.start + (range.to - 1) * range.step);
+}
+
+// add(x, y, result), multiply(x, y, result) - Set result to x + y or x * y
+//  and return true, or return false if it might not fit in 62 bits. Since
+//  every number they are given fits, neither can overflow.
+bool SequenceValue::add(std::int64_t x, std::int64_t y, std::int64_t &result) {
+  if (std::fabs(static_cast<long double>(x) + y) >= std::ldexp(1.0L, 62)) {
+    return false;
+  }
+  result = x + y;
+  return true;
+}
+
+bool SequenceValue::multiply(std::int64_t x, std::int64_t y,
+  std::int64_t &result) {
+  if (std::fabs(static_cast<long double>(x) * y) >= std::ldexp(1.0L, 62)) {
+    return false;
+  }
+  result = x * y;
+  return true;
+}
+
+// multiply(p, q, result) - Sets result to the product of two Polynomials and
+//  returns true, or returns false if its degree is over 3 or a coefficient
+//  might not fit in 62 bits.
+bool SequenceValue::multiply(const Polynomial &p, const Polynomial &q,
+  Polynomial &result) {
+  Polynomial product { 0, 0, 0, 0 };
+  for (std::size_t i = 0; i < p.size(); i++) {
+    for (std::size_t j = 0; j < q.size(); j++) {
+      if (p[i] == 0 || q[j] == 0) {
+        continue;
+      }
+      std::int64_t term = 0;
+      if (i + j >= product.size() || !multiply(p[i], q[j], term) ||
+        !add(product[i + j], term, product[i + j])) {
+        return false;
+      }
+    }
+  }
+  result = product;
+  return true;
+}
+
+// forEach(step) - Calls step with each element in turn until step returns an
+//  error, which is returned. Returns a null pointer once every element was
+//  stepped through.
+template <typename Step>
+Value::OrError SequenceValue::forEach(Step step) const {
+  Cursor cursor { *this };
+  while (true) {
+    const Value::OrError next = cursor.next();
+    if (std::holds_alternative<Error>(next)) {
+      return next;
+    }
+    const Value::Pointer &element = *std::get_if<Value::Pointer>(&next);
+    if (!element) {
+      return next;
+    }
+    const std::optional<Error> &error = step(element);
+    if (error) {
+      return { *error };
+    }
+  }
+}
+
+// PairwiseSum::add(number) - Works like incrementing a binary counter, whose
+//  bits are the sums kept.
+void SequenceValue::PairwiseSum::add(double number) {
+  std::size_t count = 1;
+  while (!sums.empty() && sums.back().second == count) {
+    number = sums.back().first + number;
+    count *= 2;
+    sums.pop_back();
+  }
+  sums.emplace_back(number, count);
+}
+
+// PairwiseSum::total() - Adds the sums kept from the smallest up.
+double SequenceValue::PairwiseSum::total() const {
+  double total = 0;
+  for (auto sum = sums.rbegin(); sum != sums.rend(); sum++) {
+    total = sum->first + total;
+  }
+  return total;
+}
+
+// forEachBlock(visit) - Runs the whole pipeline on plain doubles, one block of
+//  elements at a time, and calls visit with each block of elements that come
+//  out of it and its size, until visit returns false. Each stage goes over a
+//  whole block in a loop of its own (see NumericKernel::applyAll), which the
+//  compiler can vectorize, and no Value is created for any element. Returns
+//  false without calling visit if the source is neither a Range nor a
+//  numeric PersistentVector, or if some stage has no NumericKernels of the
+//  right kind (or, for Scan, is not + or *), in which case the pipeline has
+//  to be run on Values instead. A stage whose function applies several
+//  kernels in turn, such as filter (n -> n % 3 < 1), applies all of them:
+//  for Filter and While, the last one is the comparison, and the others
+//  are applied to a copy of the block.
+template <typename Visit>
+bool SequenceValue::forEachBlock(Visit visit) const {
+  const auto range = std::get_if<Range>(source.get());
+  const auto elements = std::get_if<PersistentVector>(source.get());
+  if (!range && !(elements && elements->isNumeric())) {
+    return false;
+  }
+  std::vector<std::vector<NumericKernel>> kernels;
+  std::vector<NumericKernel::Op> scans;
+  for (const Stage &stage : stages) {
+    std::vector<NumericKernel> applied;
+    if (stage.kind == Stage::Kind::Map || stage.kind == Stage::Kind::Filter ||
+      stage.kind == Stage::Kind::While) {
+      applied = stage.function->getNumericKernels();
+    }
+    // The comparison, if the stage has one, comes last.
+    const std::size_t arithmetic = !applied.empty() &&
+      applied.back().isComparison() ? applied.size() - 1 : applied.size();
+    for (std::size_t i = 0; i < arithmetic; i++) {
+      if (applied[i].isComparison()) {
+        return false;
+      }
+    }
+    std::optional<NumericKernel::Op> scan;
+    switch (stage.kind) {
+      case Stage::Kind::Map:
+        if (applied.empty() || arithmetic < applied.size()) {
+          return false;
+        }
+        break;
+      case Stage::Kind::Filter:
+      case Stage::Kind::While:
+        if (arithmetic == applied.size()) {
+          return false;
+        }
+        break;
+      case Stage::Kind::Take:
+      case Stage::Kind::Drop:
+        break;
+      case Stage::Kind::Scan: {
+        const auto binary =
+          dynamic_cast<const BinaryCallValue *>(stage.function.get());
+        scan = binary ? binary->getNumericOp() : std::nullopt;
+        if (scan != NumericKernel::Op::Add &&
+          scan != NumericKernel::Op::Multiply) {
+          return false;
+        }
+        break;
+      }
+      default:
+        return false;
+    }
+    kernels.push_back(std::move(applied));
+    scans.push_back(scan.value_or(NumericKernel::Op::Add));
+  }
+
+  const std::size_t blockSize = 256;
+  double numbers[blockSize];
+  double mapped[blockSize];
+  bool passed[blockSize];
+  // test(s, block, size) - Sets passed to the results of the comparison of
+  //  stage s for the size numbers of block, after its other kernels.
+  const auto test = [&kernels, &mapped, &passed](std::size_t s,
+    const double *block, std::size_t size) {
+    const std::vector<NumericKernel> &applied = kernels[s];
+    const double *tested = block;
+    if (applied.size() > 1) {
+      std::copy(block, block + size, mapped);
+      for (std::size_t i = 0; i + 1 < applied.size(); i++) {
+        applied[i].applyAll(mapped, size);
+      }
+      tested = mapped;
+    }
+    applied.back().testAll(tested, passed, size);
+  };
+  std::vector<std::size_t> seen(stages.size(), 0);
+  // The last result of each Scan.
+  std::vector<double> totals(stages.size(), 0);
+  const double from = range ? range->from : 0;
+  const double to = range ? range->to : static_cast<double>(elements->size());
+  bool done = false;
+  for (double k = from; k < to && !done; k += blockSize) {
+    std::size_t size = to - k < blockSize ?
+      static_cast<std::size_t>(to - k) : blockSize;
+    if (range) {
+      for (std::size_t i = 0; i < size; i++) {
+        numbers[i] = range->start + (k + i) * range->step;
+      }
+    }
+    else {
+      elements->copyNumbers(static_cast<std::size_t>(k), size, numbers);
+    }
+    double *block = numbers;
+    for (std::size_t s = 0; s < stages.size() && size > 0; s++) {
+      const Stage &stage = stages[s];
+      switch (stage.kind) {
+        case Stage::Kind::Map:
+          for (const NumericKernel &kernel : kernels[s]) {
+            kernel.applyAll(block, size);
+          }
+          break;
+        case Stage::Kind::Filter: {
+          // Every element is copied, but only the kept ones move forward.
+          test(s, block, size);
+          std::size_t kept = 0;
+          for (std::size_t i = 0; i < size; i++) {
+            block[kept] = block[i];
+            kept += passed[i];
+          }
+          size = kept;
+          break;
+        }
+        case Stage::Kind::While: {
+          test(s, block, size);
+          const std::size_t kept = std::find(passed, passed + size, false) -
+            passed;
+          done = done || kept < size;
+          size = kept;
+          break;
+        }
+        case Stage::Kind::Take: {
+          const std::size_t left = stage.count - seen[s];
+          if (size >= left) {
+            size = left;
+            done = true;
+          }
+          seen[s] += size;
+          break;
+        }
+        case Stage::Kind::Drop: {
+          const std::size_t skipped = std::min(size, stage.count - seen[s]);
+          block += skipped;
+          size -= skipped;
+          seen[s] += skipped;
+          break;
+        }
+        case Stage::Kind::Scan: {
+          // Each result depends on the one before, so this stays in order,
+          //  which gives exactly the results of combining Values.
+          double total = seen[s] == 0 ? block[0] : totals[s];
+          for (std::size_t i = seen[s] == 0 ? 1 : 0; i < size; i++) {
+            total = scans[s] == NumericKernel::Op::Add ? total + block[i] :
+              total * block[i];
+            block[i] = total;
+          }
+          totals[s] = total;
+          seen[s] += size;
+          break;
+        }
+        default:
+          break;
+      }
+    }
+    if (size > 0 && !visit(static_cast<const double *>(block), size)) {
+      break;
+    }
+  }
+  return true;
+}
+
+// reduceUnboxed(reduction, count) - Combines the elements that come out of
+//  forEachBlock, one block at a time (see NumericKernel::sumAll), and sets
+//  count to their number. Returns nothing if the pipeline has to be run on
+//  Values instead. The sums of the blocks are added pairwise, so that even
+//  sums of millions of elements are accurate.
+std::optional<double> SequenceValue::reduceUnboxed(Reduction reduction,
+  std::size_t &count) const {
+  PairwiseSum sum;
+  double total = reduction == Reduction::Product ? 1 : 0;
+  count = 0;
+  const bool unboxed = forEachBlock(
+    [reduction, &sum, &total, &count](const double *block, std::size_t size) {
+    switch (reduction) {
+      case Reduction::Sum:
+        sum.add(NumericKernel::sumAll(block, size));
+        break;
+      case Reduction::Product:
+        total *= NumericKernel::productAll(block, size);
+        break;
+      case Reduction::Count:
+        break;
+      case Reduction::Minimum: {
+        // Once total is NaN, it stays NaN.
+        const double least = NumericKernel::minimumAll(block, size);
+        total = count == 0 || least < total || least != least ? least : total;
+        break;
+      }
+      case Reduction::Maximum: {
+        const double most = NumericKernel::maximumAll(block, size);
+        total = count == 0 || most > total || most != most ? most : total;
+        break;
+      }
+    }
+    count += size;
+    return true;
+  });
+  if (!unboxed) {
+    return {};
+  }
+  switch (reduction) {
+    case Reduction::Sum:
+      return sum.total();
+    case Reduction::Count:
+      return static_cast<double>(count);
+    default:
+      return total;
+  }
+}
+
+// sumExactly() - Returns the sum of a pipeline that only maps a Range of whole
+//  numbers through polynomials of degree up to 3 with whole coefficients (as
+//  `map (* 2)`, `map (1 -)` and `map (^ 2)` do), computed with integers in
+//  closed form: the sum of p(a + s * i) for i from 0 to n - 1 is a sum of
+//  multiples of the sums of the powers of i, which have formulas. The sum is
+//  an Int, since every element is a whole number. Returns nothing if the
+//  pipeline is not of that kind, or if any element or the computation itself
+//  is too large to be exact.
+std::optional<std::int64_t> SequenceValue::sumExactly() const {
+  const auto range = std::get_if<Range>(source.get());
+  if (!range || !isExact(*range)) {
+    return {};
+  }
+  const double firstNumber = range->start + range->from * range->step;
+  const double lastNumber = range->start + (range->to - 1) * range->step;
+
+  // Every element is at most largest in size, so a Polynomial p is at most
+  //  the sum of |p[j]| * largest^j for every element.
+  const long double largest = std::max(std::fabs(firstNumber),
+    std::fabs(lastNumber));
+  Polynomial p { 0, 1, 0, 0 };
+  for (const Stage &stage : stages) {
+    const NumericKernel *kernel = stage.kind == Stage::Kind::Map ?
+      stage.function->getNumericKernel() : nullptr;
+    if (!kernel || !isExact(kernel->constant)) {
+      return {};
+    }
+    const auto constant = static_cast<std::int64_t>(kernel->constant);
+    Polynomial next { p };
+    bool exact = true;
+    switch (kernel->op) {
+      case NumericKernel::Op::Add:
+        exact = add(p[0], constant, next[0]);
+        break;
+      case NumericKernel::Op::Subtract:
+        if (kernel->constantFirst) {
+          for (std::int64_t &coefficient : next) {
+            coefficient = -coefficient;
+          }
+        }
+        exact = add(next[0], kernel->constantFirst ? constant : -constant,
+          next[0]);
+        break;
+      case NumericKernel::Op::Multiply:
+        for (std::int64_t &coefficient : next) {
+          exact = exact && multiply(coefficient, constant, coefficient);
+        }
+        break;
+      case NumericKernel::Op::Power:
+        if (kernel->constantFirst || constant < 0 || constant > 3) {
+          return {};
+        }
+        next = { 1, 0, 0, 0 };
+        for (std::int64_t i = 0; i < constant; i++) {
+          exact = exact && multiply(next, p, next);
+        }
+        break;
+      default:
+        return {};
+    }
+    long double bound = 0;
+    for (std::size_t j = next.size(); j-- > 0; ) {
+      bound = bound * largest + std::fabs(static_cast<long double>(next[j]));
+    }
+    if (!exact || bound >= 9007199254740992.0L) {
+      return {};
+    }
+    p = next;
+  }
+
+  const auto a = static_cast<std::int64_t>(firstNumber);
+  const auto s = static_cast<std::int64_t>(range->step);
+  const auto n = static_cast<std::int64_t>(range->to - range->from);
+  std::size_t degree = p.size() - 1;
+  while (degree > 0 && p[degree] == 0) {
+    degree--;
+  }
+  // The sums of i^t for i from 0 to n - 1, for t up to degree.
+  Polynomial powerSums { n, 0, 0, 0 };
+  if (degree >= 1 && !multiply(n % 2 == 0 ? n / 2 : n,
+    n % 2 == 0 ? n - 1 : (n - 1) / 2, powerSums[1])) {
+    return {};
+  }
+  if (degree >= 2) {
+    if (!multiply(powerSums[1], 2 * n - 1, powerSums[2])) {
+      return {};
+    }
+    powerSums[2] /= 3;
+  }
+  if (degree >= 3 && !multiply(powerSums[1], powerSums[1], powerSums[3])) {
+    return {};
+  }
+
+  // (a + s * i)^j is the sum of C(j, t) * a^(j - t) * s^t * i^t over t.
+  const std::int64_t binomials[4][4] = {
+    { 1, 0, 0, 0 }, { 1, 1, 0, 0 }, { 1, 2, 1, 0 }, { 1, 3, 3, 1 }
+  };
+  std::int64_t total = 0;
+  for (std::size_t t = 0; t <= degree; t++) {
+    std::int64_t coefficient = 0;
+    for (std::size_t j = t; j <= degree; j++) {
+      std::int64_t term = 0;
+      if (!multiply(p[j], binomials[j][t], term)) {
+        return {};
+      }
+      for (std::size_t i = 0; i < j; i++) {
+        if (!multiply(term, i < j - t ? a : s, term)) {
+          return {};
+        }
+      }
+      if (!add(coefficient, term, coefficient)) {
+        return {};
+      }
+    }
+    std::int64_t summed = 0;
+    if (!multiply(coefficient, powerSums[t], summed) ||
+      !add(total, summed, total)) {
+      return {};
+    }
+  }
+  return total;
+}
+
+// ends() - Returns whether the sequence is sure to end, because its source
+//  does or because it takes a number of elements. Whether a Cons ends is not
+//  known before its tail is produced.
+bool SequenceValue::ends() const {
+  const auto range = std::get_if<Range>(source.get());
+  const bool endless = range ? std::isinf(range->to) :
+    std::holds_alternative<Cons>(*source);
+  return !endless ||
+    std::any_of(stages.begin(), stages.end(), [](const Stage &stage) {
+      return stage.kind == Stage::Kind::Take;
+    });
+}
+
+// buildUnboxed(sequence, builder) - Pushes each block as it comes out of the
+//  pipeline.
+bool SequenceValue::buildUnboxed(const SequenceValue &sequence,
+  PersistentVector::Builder &builder) {
+  return sequence.forEachBlock(
+    [&builder](const double *block, std::size_t size) {
+    for (std::size_t i = 0; i < size; i++) {
+      builder.push(block[i]);
+    }
+    return true;
+  });
+}
+
+// sum() - Adds the elements, failing on the first that is not a number. The
+//  sum is computed without producing the elements if possible. Otherwise the
+//  elements are added like `+` adds them, so the sum of Ints is exact.
+Value::OrError SequenceValue::sum() const {
+  if (const std::optional<std::int64_t> exact = sumExactly()) {
+    return { Value::Pointer { Region::make<NumberValue>(*exact) } };
+  }
+  std::size_t count = 0;
+  const std::optional<double> known = reduceUnboxed(Reduction::Sum, count);
+  if (known) {
+    return { Value::Pointer { Region::make<NumberValue>(*known) } };
+  }
+  NumberValue total { std::int64_t { 0 } };
+  const Value::OrError result = forEach([&total](const Value::Pointer &x) {
+    const auto number = dynamic_cast<const NumberValue *>(x.get());
+    if (!number) {
+      return std::optional<Error> { Error { Error::Code::ArgumentType, {
+        &NumberValue::getClassName, Error::NameOf { x }
+      } } };
+    }
+    total = NumberValue::add(total, *number);
+    return std::optional<Error> {};
+  });
+  if (std::holds_alternative<Error>(result)) {
+    return result;
+  }
+  return { Value::Pointer { Region::make<NumberValue>(total) } };
+}
+
+// product() - Multiplies the elements, failing on the first that is not a
+//  number. Like sum, the product of Ints is exact.
+Value::OrError SequenceValue::product() const {
+  std::size_t count = 0;
+  const std::optional<double> known = reduceUnboxed(Reduction::Product, count);
+  if (known) {
+    return { Value::Pointer { Region::make<NumberValue>(*known) } };
+  }
+  NumberValue total { std::int64_t { 1 } };
+  const Value::OrError result = forEach([&total](const Value::Pointer &x) {
+    const auto number = dynamic_cast<const NumberValue *>(x.get());
+    if (!number) {
+      return std::optional<Error> { Error { Error::Code::ArgumentType, {
+        &NumberValue::getClassName, Error::NameOf { x }
+      } } };
+    }
+    total = NumberValue::multiply(total, *number);
+    return std::optional<Error> {};
+  });
+  if (std::holds_alternative<Error>(result)) {
+    return result;
+  }
+  return { Value::Pointer { Region::make<NumberValue>(total) } };
+}
+
+// length() - Counts the elements.
+Value::OrError SequenceValue::length() const {
+  std::size_t count = 0;
+  if (!reduceUnboxed(Reduction::Count, count)) {
+    const Value::OrError result = forEach(
+      [&count]([[maybe_unused]] const Value::Pointer &x) {
+      count++;
+      return std::optional<Error> {};
+    });
+    if (std::holds_alternative<Error>(result)) {
+      return result;
+    }
+  }
+  return { Value::Pointer {
+    Region::make<NumberValue>(static_cast<std::int64_t>(count))
+  } };
+}
+
+// minimum(), maximum() - Find the extremum of the elements.
+Value::OrError SequenceValue::minimum() const {
+  return extremum(Reduction::Minimum);
+}
+
+Value::OrError SequenceValue::maximum() const {
+  return extremum(Reduction::Maximum);
+}
+
+// extremum(reduction) - Returns the minimum or the maximum of the elements,
+//  failing on the first that is not a number. It is found without producing
+//  the elements if possible. Otherwise the element itself is returned, and
+//  Ints are compared exactly.
+Value::OrError SequenceValue::extremum(Reduction reduction) const {
+  std::size_t count = 0;
+  const std::optional<double> known = reduceUnboxed(reduction, count);
+  if (known && count == 0) {
+    return { Error { Error::Code::EmptySequence } };
+  }
+  if (known) {
+    return { Value::Pointer { Region::make<NumberValue>(*known) } };
+  }
+  const bool least = reduction == Reduction::Minimum;
+  Value::Pointer best;
+  const Value::OrError result = forEach(
+    [least, &best](const Value::Pointer &x) {
+    const auto number = dynamic_cast<const NumberValue *>(x.get());
+    if (!number) {
+      return std::optional<Error> { Error { Error::Code::ArgumentType, {
+        &NumberValue::getClassName, Error::NameOf { x }
+      } } };
+    }
+    // Once best is NaN, it stays NaN.
+    const auto current = static_cast<const NumberValue *>(best.get());
+    const double next = number->getRawNumber();
+    const double total = current ? current->getRawNumber() : 0;
+    const int order = !current ? -1 :
+      number->isInteger() && current->isInteger() ?
+      NumberValue::compareIntegers(*number, *current) :
+      next < total ? -1 : next > total ? 1 : 0;
+    if (!current || (total == total &&
+      ((least ? order < 0 : order > 0) || next != next))) {
+      best = x;
+    }
+    return std::optional<Error> {};
+  });
+  if (std::holds_alternative<Error>(result)) {
+    return result;
+  }
+  if (!best) {
+    return { Error { Error::Code::EmptySequence } };
+  }
+  return { best };
+}
+
+// dot(other) - If both pipelines can run on plain doubles, the elements of the
+//  one that is sure to end are gathered, and the other is multiplied with
+//  them a block at a time (see NumericKernel::dotAll). Otherwise the elements
+//  of both are produced in step.
+Value::OrError SequenceValue::dot(const std::shared_ptr<SequenceValue> &other)
+  const {
+  const SequenceValue &gathered = other->ends() ? *other : *this;
+  const SequenceValue &streamed = other->ends() ? *this : *other;
+  std::vector<double> numbers;
+  if (gathered.ends() && gathered.forEachBlock(
+    [&numbers](const double *block, std::size_t size) {
+    numbers.insert(numbers.end(), block, block + size);
+    return true;
+  })) {
+    PairwiseSum sum;
+    std::size_t used = 0;
+    const bool unboxed = numbers.empty() || streamed.forEachBlock(
+      [&numbers, &sum, &used](const double *block, std::size_t size) {
+      const std::size_t count = std::min(size, numbers.size() - used);
+      sum.add(NumericKernel::dotAll(block, numbers.data() + used, count));
+      used += count;
+      return used < numbers.size();
+    });
+    if (unboxed) {
+      return { Value::Pointer { Region::make<NumberValue>(sum.total()) } };
+    }
+  }
+  Cursor left { *this };
+  Cursor right { *other };
+  NumberValue total { std::int64_t { 0 } };
+  while (true) {
+    NumberValue product { std::int64_t { 1 } };
+    for (Cursor *cursor : { &left, &right }) {
+      const Value::OrError next = cursor->next();
+      if (std::holds_alternative<Error>(next)) {
+        return next;
+      }
+      const Value::Pointer &factor = *std::get_if<Value::Pointer>(&next);
+      if (!factor) {
+        return { Value::Pointer { Region::make<NumberValue>(total) } };
+      }
+      const auto number = dynamic_cast<const NumberValue *>(factor.get());
+      if (!number) {
+        return { Error { Error::Code::ArgumentType, {
+          &NumberValue::getClassName, Error::NameOf { factor }
+        } } };
+      }
+      product = NumberValue::multiply(product, *number);
+    }
+    total = NumberValue::add(total, product);
+  }
+}
+
+// first() - Only produces the first element, so the rest of the sequence is
+//  never looked at.
+Value::OrError SequenceValue::first() const {
+  const Value::OrError next = Cursor { *this }.next();
+  if (std::holds_alternative<Value::Pointer>(next) &&
+    !*std::get_if<Value::Pointer>(&next)) {
+    return { Error { Error::Code::EmptySequence } };
+  }
+  return next;
+}
+
+// last() - Produces every element and keeps the last.
+Value::OrError SequenceValue::last() const {
+  Value::Pointer last;
+  const Value::OrError result = forEach([&last](const Value::Pointer &x) {
+    last = x;
+    return std::optional<Error> {};
+  });
+  if (std::holds_alternative<Error>(result)) {
+    return result;
+  }
+  if (!last) {
+    return { Error { Error::Code::EmptySequence } };
+  }
+  return { last };
+}
+
+// at(index) - Produces the elements up to the one at index.
+Value::OrError SequenceValue::at(const std::shared_ptr<NumberValue> &index)
+  const {
+  const double position = index->getRawNumber();
+  if (position >= 0 && std::floor(position) == position) {
+    Cursor cursor { *this };
+    for (double i = 0; ; i++) {
+      const Value::OrError next = cursor.next();
+      if (std::holds_alternative<Error>(next)) {
+        return next;
+      }
+      if (!*std::get_if<Value::Pointer>(&next)) {
+        break;
+      }
+      if (i == position) {
+        return next;
+      }
+    }
+  }
+  return { Error { Error::Code::IndexOutOfRange, { Error::Shown { index } } } };
+}
+
+// reduceLeft(f) - Calls f with both arguments at once if it can be (see
+//  BinaryCallValue), so that no partial application is created per element.
+Value::OrError SequenceValue::reduceLeft(const Value::Pointer &f) const {
+  const auto binary = dynamic_cast<const BinaryCallValue *>(f.get());
+  Value::Pointer total;
+  const Value::OrError result = forEach(
+    [&total, &f, binary](const Value::Pointer &x) {
+    if (!total) {
+      total = x;
+      return std::optional<Error> {};
+    }
+    const Value::OrError combined = combine(f, binary, total, x);
+    if (std::holds_alternative<Error>(combined)) {
+      return std::optional<Error> { *std::get_if<Error>(&combined) };
+    }
+    total = *std::get_if<Value::Pointer>(&combined);
+    return std::optional<Error> {};
+  });
+  if (std::holds_alternative<Error>(result)) {
+    return result;
+  }
+  if (!total) {
+    return { Error { Error::Code::EmptySequence } };
+  }
+  return { total };
+}
+
+// call([unused] arg) - Returns an error, since SequenceValues cannot be
+//  called.
+Value::OrError SequenceValue::call([[maybe_unused]] Value::Pointer arg) const {
+  return {
+    Error { Error::Code::NotCallable, { &SequenceValue::getClassName } }
+  };
+}
+
+// evacuate(evacuation) - Only a Cons or a vector of Values holds Values of
+//  its own among the sources, and stages hold their functions and the
+//  sequences they zip with.
+Value::Pointer SequenceValue::evacuate(Evacuation &evacuation) const {
+  std::shared_ptr<const Source> copied = source;
+  if (const auto cons = std::get_if<Cons>(source.get())) {
+    copied = std::make_shared<const Source>(Cons {
+      evacuation.value(cons->head),
+      std::static_pointer_cast<const ThunkValue>(evacuation.value(
+        std::const_pointer_cast<ThunkValue>(cons->tail)
+      ))
+    });
+  }
+  else if (const auto elements = std::get_if<PersistentVector>(
+    source.get())) {
+    copied = std::make_shared<const Source>(
+      evacuateElements(*elements, evacuation)
+    );
+  }
+  std::vector<Stage> copiedStages = stages;
+  for (Stage &stage : copiedStages) {
+    stage.function = evacuation.value(stage.function);
+    if (stage.other) {
+      stage.other = std::static_pointer_cast<const SequenceValue>(
+        evacuation.value(std::const_pointer_cast<SequenceValue>(stage.other))
+      );
+    }
+  }
+  return Value::Pointer {
+    std::make_shared<SequenceValue>(copied, copiedStages)
+  };
+}
+
+// evacuateElements(elements, evacuation) - Numbers are held unboxed, so a
+//  numeric vector holds no Values at all.
+PersistentVector SequenceValue::evacuateElements(
+  const PersistentVector &elements, Evacuation &evacuation) {
+  if (elements.isNumeric()) {
+    return elements;
+  }
+  std::vector<Value::Pointer> copies;
+  bool changed = false;
+  for (std::size_t i = 0; i < elements.size(); i++) {
+    const Value::Pointer element = elements.at(i);
+    copies.push_back(evacuation.value(element));
+    changed = changed || copies.back() != element;
+  }
+  return changed ? PersistentVector::of(copies) : elements;
+}
+
+// operator string() - Shows the elements, or only the type if producing them
+//  fails.
+SequenceValue::operator std::string() const {
+  std::string shown;
+  const Value::OrError result = forEach([&shown](const Value::Pointer &x) {
+    shown += (shown.empty() ? "[" : ", ") + static_cast<std::string>(*x);
+    return std::optional<Error> {};
+  });
+  if (std::holds_alternative<Error>(result)) {
+    return "<Sequence>";
+  }
+  return shown.empty() ? "[]" : shown + "]";
+}
+
+const std::string SequenceValue::name { "Sequence" };
+
+// getName() - Returns "Sequence", the name of the Sequence type.
+std::string SequenceValue::getName() const {
+  return SequenceValue::name;
+}
+
+std::string SequenceValue::getClassName() {
+  return SequenceValue::name;
+}
@@ -0,0 +1,299 @@
+// File: src/SequenceValue.hpp
+// Purpose: Header file for SequenceValues, which are lazy sequences of Values
+//  such as `1 ..< 1000 |> filter divisible`. See src/SequenceValue.cpp for
+//  implementations.
+
+#ifndef SEQUENCEVALUE_HPP
+#define SEQUENCEVALUE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "Bytes.hpp"
+#include "NumberValue.hpp"
+#include "PersistentVector.hpp"
+#include "Rope.hpp"
+#include "Value.hpp"
+
+class BinaryCallValue;
+class Evacuation;
+class ThunkValue;
+
+// SequenceValue - A sequence is a source of elements (such as a range of
+//  numbers, or the text of a String) followed by the stages its elements go
+//  through, such as map and filter. Adding a stage does not look at any
+//  element: it returns a new SequenceValue with one more stage. Elements are
+//  only produced when the sequence is reduced (as by sum or last), by a
+//  Cursor that pulls each element from the source through every stage in
+//  turn. A pipeline such as `1 ..< 1000 |> filter divisible |> map (* 2) |>
+//  sum` is therefore run as a single loop, and no intermediate sequence is
+//  ever built (stream fusion). Since stages are Values like any other, a
+//  function that is not a known stage (such as one written in Fleet) is
+//  simply called with the SequenceValue, and the stages after it fuse with
+//  those before it.
+// When the source is a Range and every stage is a builtin operator given one
+//  number (see src/NumericKernel.hpp), such as `1 ..< 1000 |> map (* 2) |>
+//  filter (> 10) |> sum`, or a function that only applies such operators to
+//  its argument, such as `filter (n -> n % 3 < 1)`, the elements are never
+//  boxed at all: sum, product and length run the pipeline over blocks of
+//  plain doubles, and sums of polynomials over ranges of whole numbers are
+//  computed in closed form. The same goes for lists of numbers, which hold
+//  them unboxed (see src/PersistentVector.hpp), and for scanLeft with + or
+//  *.
+class SequenceValue: public Value {
+public:
+  // A Range is the source of `start ..< bound` and of `arithmetic start step`:
+  //  the numbers start + k * step for each whole number k from `from` up to
+  //  (but not including) `to`, which is infinite if the range does not end.
+  //  Slicing a Range only changes from and to, so each of its numbers is
+  //  always computed the same way.
+  struct Range {
+    double start;
+    double step;
+    double from;
+    double to;
+  };
+
+  // A Cons is the source of `x : xs`: head, followed by the elements of the
+  //  sequence that tail stands for. tail is only evaluated once an element
+  //  after head is needed, so a sequence can be defined in terms of itself,
+  //  as in `from = n -> n : from (n + 1)`, and only as much of it as is used
+  //  is ever produced.
+  struct Cons {
+    Value::Pointer head;
+    std::shared_ptr<const ThunkValue> tail;
+  };
+
+  // A Stage is one step that elements go through after the source.
+  struct Stage {
+    enum class Kind {
+      // Call function with each element.
+      Map,
+      // Keep the elements for which function returns True.
+      Filter,
+      // Keep the elements until function returns False for one.
+      While,
+      // Keep the first count elements.
+      Take,
+      // Skip the first count elements.
+      Drop,
+      // Pair each element with the element of other at the same position, as
+      //  a TupleValue, until either runs out.
+      Zip,
+      // Call function with each element and keep the elements of the
+      //  sequences it returns.
+      ConcatMap,
+      // Combine the elements so far with function, as reduceLeft does, and
+      //  keep each result.
+      Scan
+    };
+    Kind kind;
+    Value::Pointer function;
+    std::size_t count;
+    std::shared_ptr<const SequenceValue> other;
+  };
+
+  // Cursor - Produces the elements of a SequenceValue one at a time. The
+  //  SequenceValue must outlive the Cursor.
+  class Cursor {
+  private:
+    // The progress of a Stage. Zip and ConcatMap keep a Cursor of their own
+    //  over other or over the sequence being flattened (held by inner). Scan
+    //  keeps its last result in inner.
+    struct State {
+      std::size_t seen = 0;
+      bool done = false;
+      Value::Pointer inner;
+      std::unique_ptr<Cursor> cursor;
+    };
+
+    const SequenceValue &sequence;
+    std::size_t position;
+    std::vector<State> states;
+    // The leaf of a PersistentVector source that position is in, and the
+    //  index of its first element. The elements of a numeric source are
+    //  copied a leaf's worth at a time to numbers instead, from leafStart on.
+    //  For a Rope source, piece is the leaf that position is in, leafStart
+    //  is the index of its first code point, and byte is where the code point
+    //  at position starts in its buffer.
+    // For a Cons source, cell is the Cons whose head is next (or was just
+    //  given, if headGiven), which belongs to sequence or to held. Once a
+    //  tail that is not itself a plain Cons is reached, the rest of the
+    //  elements come from its own Cursor, rest, over held.
+    const Cons *cell;
+    bool headGiven;
+    std::shared_ptr<const SequenceValue> held;
+    std::unique_ptr<Cursor> rest;
+    const PersistentVector::Node *leaf;
+    std::size_t leafStart;
+    const Rope::Node *piece;
+    std::size_t byte;
+    std::array<double, PersistentVector::width> numbers;
+    std::size_t copied;
+
+    // Private methods are documented in src/SequenceValue.cpp.
+    Value::OrError fromSource();
+    Value::OrError fromCells();
+    Value::OrError pull(std::size_t count);
+
+  public:
+    // Constructor(sequence) - Creates a Cursor at the start of sequence.
+    explicit Cursor(const SequenceValue &sequence);
+
+    // next() - Returns the next element, a null pointer once there are no
+    //  elements left, or the error that producing the element resulted in.
+    Value::OrError next();
+  };
+
+protected:
+  typedef std::variant<Range, PersistentVector, Rope, Bytes, Cons> Source;
+
+  std::shared_ptr<const Source> source;
+  std::vector<Stage> stages;
+
+  // static isExact(number) - Returns whether number is a whole number small
+  //  enough that adding and multiplying it as a double gives exact results.
+  static bool isExact(double number);
+
+  // static isExact(range) - Returns whether range ends and each of its
+  //  numbers, and each step in computing them, is exact.
+  static bool isExact(const Range &range);
+
+  // static buildUnboxed(sequence, builder) - Pushes the elements of sequence
+  //  to builder as plain doubles and returns true if the whole pipeline of
+  //  sequence can run on them (see forEachBlock), and otherwise returns false
+  //  without pushing anything. The sequence must end.
+  static bool buildUnboxed(const SequenceValue &sequence,
+    PersistentVector::Builder &builder);
+
+  // static evacuateElements(elements, evacuation) - Returns elements if none
+  //  of them are in the Region being evacuated (as is always so for numbers),
+  //  and otherwise the vector of their evacuated copies.
+  static PersistentVector evacuateElements(const PersistentVector &elements,
+    Evacuation &evacuation);
+
+private:
+  // The ways in which reduceUnboxed can combine the elements.
+  enum class Reduction { Sum, Product, Count, Minimum, Maximum };
+
+  // PairwiseSum - Adds numbers, such as the sums of blocks of elements,
+  //  pairwise: each sum kept is of a power of two numbers, and two sums of
+  //  the same number of numbers are added as soon as there are two.
+  class PairwiseSum {
+  private:
+    // The sums kept and how many numbers each is of, largest first.
+    std::vector<std::pair<double, std::size_t>> sums;
+
+  public:
+    // add(number) - Adds number after the numbers added so far.
+    void add(double number);
+
+    // total() - Returns the sum of every number added so far.
+    double total() const;
+  };
+
+  // A polynomial in the elements of a Range, as its coefficients from the
+  //  constant one up.
+  typedef std::array<std::int64_t, 4> Polynomial;
+
+  // Private methods are documented in src/SequenceValue.cpp.
+  static Value::OrError test(const Value::Pointer &predicate,
+    const Value::Pointer &element, bool &result);
+  static Value::OrError combine(const Value::Pointer &f,
+    const BinaryCallValue *binary, const Value::Pointer &x,
+    const Value::Pointer &y);
+  static bool add(std::int64_t x, std::int64_t y, std::int64_t &result);
+  static bool multiply(std::int64_t x, std::int64_t y, std::int64_t &result);
+  static bool multiply(const Polynomial &p, const Polynomial &q,
+    Polynomial &result);
+  template <typename Step>
+  Value::OrError forEach(Step step) const;
+  template <typename Visit>
+  bool forEachBlock(Visit visit) const;
+  std::optional<double> reduceUnboxed(Reduction reduction,
+    std::size_t &count) const;
+  std::optional<std::int64_t> sumExactly() const;
+  bool ends() const;
+  Value::OrError extremum(Reduction reduction) const;
+
+public:
+  // Constructor(source, stages) - Creates a SequenceValue with the given source
+  //  and stages. Use of or the constructors of RangeValue and ListValue (see
+  //  src/RangeValue.hpp and src/ListValue.hpp) instead.
+  SequenceValue(const std::shared_ptr<const Source> &source,
+    const std::vector<Stage> &stages);
+
+  // static cons(head, tail) - Returns the sequence of head followed by the
+  //  elements of the sequence that tail stands for, which is only evaluated
+  //  when they are needed (see Cons).
+  static std::shared_ptr<SequenceValue> cons(const Value::Pointer &head,
+    const std::shared_ptr<const ThunkValue> &tail);
+
+  // static of(elements) - Returns the list of the given elements (see
+  //  src/ListValue.hpp).
+  static std::shared_ptr<SequenceValue> of(
+    const std::vector<Value::Pointer> &elements);
+
+  // virtual then(stage) - Returns the sequence whose elements are the elements
+  //  of this one after going through stage.
+  virtual std::shared_ptr<SequenceValue> then(const Stage &stage) const;
+
+  // sum(), product() - Return the sum or the product of the elements, which
+  //  must be numbers.
+  Value::OrError sum() const;
+  Value::OrError product() const;
+
+  // minimum(), maximum() - Return the smallest or the largest element, which
+  //  must be numbers, or an error if there are none. If any element is NaN,
+  //  the result is NaN.
+  Value::OrError minimum() const;
+  Value::OrError maximum() const;
+
+  // dot(other) - Returns the sum of the products of the elements of this
+  //  sequence and of other at the same position, which must be numbers,
+  //  until either runs out.
+  Value::OrError dot(const std::shared_ptr<SequenceValue> &other) const;
+
+  // virtual length() - Returns the number of elements.
+  virtual Value::OrError length() const;
+
+  // virtual first(), last() - Return the first or the last element, or an
+  //  error if there are none.
+  virtual Value::OrError first() const;
+  virtual Value::OrError last() const;
+
+  // virtual at(index) - Returns the element at the given position, counting
+  //  from 0, or an error if there is none.
+  virtual Value::OrError at(const std::shared_ptr<NumberValue> &index) const;
+
+  // reduceLeft(f) - Returns the result of combining the elements in order with
+  //  f, as in f (f a b) c for the elements a, b and c, or an error if there
+  //  are none.
+  Value::OrError reduceLeft(const Value::Pointer &f) const;
+
+  // call(arg) - Returns an error, since SequenceValues cannot be called.
+  Value::OrError call([[maybe_unused]] Value::Pointer arg) const;
+
+  // evacuate(evacuation) - Returns the sequence of the evacuated source and
+  //  stages.
+  Value::Pointer evacuate(Evacuation &evacuation) const;
+
+  // operator string() - Returns the elements in brackets, as in [1, 2, 3].
+  //  Since this produces every element, it must not be used on sequences
+  //  that do not end.
+  operator std::string() const;
+
+  // name/getName() - Returns "Sequence", the name of a SequenceValue-type
+  //  value.
+  static const std::string name;
+  static std::string getClassName();
+  std::string getName() const;
+};
+
+#endif
@@ -0,0 +1,89 @@
+// File: src/SetValue.cpp
+// Purpose: A SetValue is a Value that holds a set of keys, such as the result
+//  of setOf. For more documentation see src/SetValue.hpp.
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include "SetValue.hpp"
+#include "Error.hpp"
+#include "Evacuation.hpp"
+#include "PersistentMap.hpp"
+#include "Value.hpp"
+
+// Constructor
+SetValue::SetValue(const PersistentMap &elements): elements { elements } {}
+
+const PersistentMap &SetValue::getElements() const {
+  return elements;
+}
+
+// hash() - Adds up the hashes of the elements, so that their order does not
+//  matter.
+std::optional<std::size_t> SetValue::hash() const {
+  if (!cachedHash) {
+    std::size_t hash = mixHash(elements.size());
+    elements.forEach([&hash](const PersistentMap::Entry &entry) {
+      hash += mixHash(entry.hash);
+    });
+    cachedHash = hash;
+  }
+  return cachedHash;
+}
+
+std::optional<std::size_t> SetValue::knownHash() const {
+  return cachedHash;
+}
+
+// equals(other) - Looks each element up in other.
+bool SetValue::equals(const Value &other) const {
+  const auto otherSet = dynamic_cast<const SetValue *>(&other);
+  if (!otherSet || elements.size() != otherSet->elements.size()) {
+    return false;
+  }
+  bool equal = true;
+  elements.forEach([&equal, otherSet](const PersistentMap::Entry &entry) {
+    equal = equal && otherSet->elements.find(*entry.key);
+  });
+  return equal;
+}
+
+// call([unused] arg) - Returns an error, since SetValues cannot be called.
+Value::OrError SetValue::call([[maybe_unused]] Value::Pointer arg) const {
+  return { Error { Error::Code::NotCallable, { &SetValue::getClassName } } };
+}
+
+// evacuate(evacuation) - Builds the set again, like MapValue::evacuate.
+Value::Pointer SetValue::evacuate(Evacuation &evacuation) const {
+  PersistentMap::Builder builder;
+  elements.forEach([&builder, &evacuation](const PersistentMap::Entry &entry) {
+    builder.insert(evacuation.value(entry.key), nullptr);
+  });
+  return Value::Pointer { std::make_shared<SetValue>(builder.build()) };
+}
+
+// operator string() - The elements are shown in the order that the set keeps
+//  them in.
+SetValue::operator std::string() const {
+  if (elements.size() == 0) {
+    return "{}";
+  }
+  std::string shown;
+  elements.forEach([&shown](const PersistentMap::Entry &entry) {
+    shown += (shown.empty() ? "{" : ", ") +
+      static_cast<std::string>(*entry.key);
+  });
+  return shown + "}";
+}
+
+const std::string SetValue::name { "Set" };
+
+// getName() - Returns "Set", the name of the Set type.
+std::string SetValue::getName() const {
+  return SetValue::name;
+}
+
+std::string SetValue::getClassName() {
+  return SetValue::name;
+}
@@ -0,0 +1,53 @@
+// File: src/SetValue.hpp
+// Purpose: A SetValue is a Value that holds a set of keys, such as the result
+//  of setOf. For implementations see src/SetValue.cpp.
+
+#ifndef SETVALUE_HPP
+#define SETVALUE_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include "PersistentMap.hpp"
+#include "Value.hpp"
+
+// SetValue - An immutable set held as a PersistentMap (see
+//  src/PersistentMap.hpp) whose entries have no Values.
+class SetValue final: public Value {
+private:
+  PersistentMap elements;
+
+  // The hash of the elements, once it has been computed.
+  mutable std::optional<std::size_t> cachedHash;
+
+public:
+  // Constructor(elements) - Creates the set of the keys of elements.
+  explicit SetValue(const PersistentMap &elements);
+
+  // getElements() - Returns the elements of the set as the keys of a map.
+  const PersistentMap &getElements() const;
+
+  // hash(), knownHash() - Return the hash of the elements, which does not
+  //  depend on their order and is computed once.
+  std::optional<std::size_t> hash() const;
+  std::optional<std::size_t> knownHash() const;
+
+  // equals(other) - Returns whether other is a set with the same elements.
+  bool equals(const Value &other) const;
+
+  // call(arg) - Returns an error, since SetValues cannot be called.
+  Value::OrError call([[maybe_unused]] Value::Pointer arg) const;
+
+  // evacuate(evacuation) - Returns the set of the evacuated elements.
+  Value::Pointer evacuate(Evacuation &evacuation) const;
+
+  // operator string() - Returns the elements as in {x, y, ...}.
+  operator std::string() const;
+
+  // name/getName() - Returns "Set", the name of a SetValue-type value.
+  static const std::string name;
+  static std::string getClassName();
+  std::string getName() const;
+};
+
+#endif
@@ -0,0 +1,450 @@
+// File: src/StrictnessAnalyzer.cpp
+// Purpose: Source file for StrictnessAnalyzers, which find the parameters of
+//  functions that are always used. See src/StrictnessAnalyzer.hpp for more
+//  documentation.
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "StrictnessAnalyzer.hpp"
+#include "Context.hpp"
+#include "DefaultContext.hpp"
+#include "FunctionValue.hpp"
+#include "IdentifierValue.hpp"
+#include "Pattern.hpp"
+#include "Region.hpp"
+#include "Token.hpp"
+#include "TokenTree.hpp"
+#include "Value.hpp"
+
+// Constructor(context, ast) - Finds the signatures of the functions that ast
+//  defines at the top level. A function is only analyzed if every definition
+//  of its name is a top-level line of the form `name = param -> body` and it
+//  is not defined in context yet, since it could otherwise get clauses that
+//  are not known here.
+StrictnessAnalyzer::StrictnessAnalyzer(const Context::Pointer &context,
+  const TokenTree &ast): context { context } {
+  std::map<std::string, std::size_t> definitionCounts;
+  std::vector<const TokenTree *> pending { &ast };
+  while (!pending.empty()) {
+    const TokenTree *tree = pending.back();
+    pending.pop_back();
+    if (const auto binding = tree->getBindingPointer()) {
+      pending.push_back(binding->value.get());
+      pending.push_back(binding->body.get());
+      continue;
+    }
+    if (const auto name = asDefinition(*tree)) {
+      definitionCounts[name->getValue()]++;
+    }
+    if (const auto pair = asCall(*tree)) {
+      pending.push_back(pair->first.get());
+      pending.push_back(pair->second.get());
+    }
+    else if (const auto lines = tree->getLineListPointer()) {
+      for (const auto &line : *lines) {
+        pending.push_back(line.get());
+      }
+    }
+  }
+
+  // Each clause is a chain of functions, such as n -> acc -> body, given as
+  //  the parameter and body of each function in the chain.
+  typedef std::vector<std::pair<const TokenTree *, const TokenTree *>> Chain;
+  std::map<std::string, std::vector<Chain>> clauses;
+  const auto lines = ast.getLineListPointer();
+  for (std::size_t i = 0; lines && i < lines->size(); i++) {
+    const TokenTree &line = *(*lines)[i];
+    const auto name = asDefinition(line);
+    if (!name) {
+      continue;
+    }
+    Chain chain;
+    const TokenTree *value = asCall(line)->second.get();
+    while (const auto lambda = asLambda(*value)) {
+      chain.push_back({ lambda->first->getFunctionPairPointer()->second.get(),
+        lambda->second.get() });
+      value = lambda->second.get();
+    }
+    clauses[name->getValue()].push_back(chain);
+  }
+  for (auto iterator = clauses.begin(); iterator != clauses.end(); ) {
+    const auto &[name, chains] = *iterator;
+    std::size_t depth = chains.front().size();
+    for (const auto &chain : chains) {
+      depth = std::min(depth, chain.size());
+    }
+    if (depth == 0 || definitionCounts[name] != chains.size() ||
+        std::holds_alternative<Value::Pointer>(context->getValue(name))) {
+      iterator = clauses.erase(iterator);
+      continue;
+    }
+    signatures[name] = std::vector<bool>(depth, true);
+    ++iterator;
+  }
+
+  // Weaken the signatures until each follows from the others. Each pass only
+  //  turns entries off, so this ends.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const auto &[name, chains] : clauses) {
+      std::vector<bool> &signature = signatures.at(name);
+      for (std::size_t i = 0; i < signature.size(); i++) {
+        if (!signature[i]) {
+          continue;
+        }
+        // Matching the first clause against a number or a tuple needs the
+        //  argument.
+        const auto &first = Pattern::fromTree(*chains.front()[0].first);
+        bool strict = i == 0 && first &&
+          first->getKind() != Pattern::Kind::Identifier;
+        for (std::size_t j = 0; !strict && j < chains.size(); j++) {
+          Locals locals { new std::set<std::string> {} };
+          for (std::size_t k = 0; k < i; k++) {
+            const auto &outer = Pattern::fromTree(*chains[j][k].first);
+            if (outer) {
+              locals = with(locals, outer->getBoundNames());
+            }
+          }
+          if (!isStrict(*chains[j][i].first, *chains[j][i].second, locals)) {
+            break;
+          }
+          strict = j + 1 == chains.size();
+        }
+        if (!strict) {
+          signature[i] = false;
+          changed = true;
+        }
+      }
+    }
+  }
+}
+
+// asCall(tree) - Returns the call of tree if it is a call (but not a Constant
+//  or a Binding), or nullptr otherwise.
+const TokenTree::FunctionPair *StrictnessAnalyzer::asCall(
+  const TokenTree &tree) {
+  if (tree.getConstantPointer() || tree.getBindingPointer()) {
+    return nullptr;
+  }
+  const auto pair = tree.getFunctionPairPointer();
+  if (!pair || !pair->first || !pair->second) {
+    return nullptr;
+  }
+  return pair;
+}
+
+// asLambda(tree) - Returns the call of tree if it creates a function, as in
+//  `param -> body`, or nullptr otherwise. The `->` may already be a Constant.
+const TokenTree::FunctionPair *StrictnessAnalyzer::asLambda(
+  const TokenTree &tree) {
+  const auto pair = asCall(tree);
+  const auto inner = pair ? asCall(*pair->first) : nullptr;
+  const auto arrow = inner ? inner->first->getTokenPointer() : nullptr;
+  if (!arrow || arrow->getType() != Token::Type::Operator ||
+      arrow->getValue() != "->") {
+    return nullptr;
+  }
+  return pair;
+}
+
+// asDefinition(tree) - Returns the name Token of tree if it defines a name, as
+//  in `name = value`, or nullptr otherwise.
+const Token *StrictnessAnalyzer::asDefinition(const TokenTree &tree) {
+  const auto pair = asCall(tree);
+  const auto inner = pair ? asCall(*pair->first) : nullptr;
+  const auto op = inner ? inner->first->getTokenPointer() : nullptr;
+  if (!op || op->getType() != Token::Type::Operator || op->getValue() != "=") {
+    return nullptr;
+  }
+  const auto name = inner->second->getTokenPointer();
+  if (!name || name->getType() != Token::Type::Identifier) {
+    return nullptr;
+  }
+  return name;
+}
+
+// with(locals, names) - Returns locals along with names.
+StrictnessAnalyzer::Locals StrictnessAnalyzer::with(const Locals &locals,
+  const std::set<std::string> &names) {
+  std::set<std::string> result = *locals;
+  result.insert(names.begin(), names.end());
+  return Locals { new std::set<std::string> { std::move(result) } };
+}
+
+// signatureOf(f, locals) - Returns the strictness signature of the function f
+//  refers to, which is empty if it is not known.
+std::vector<bool> StrictnessAnalyzer::signatureOf(const TokenTree &f,
+  const Locals &locals) const {
+  if (const auto constant = f.getConstantPointer()) {
+    return constant->value->getStrictness();
+  }
+  const auto token = f.getTokenPointer();
+  if (!token || f.getBindingPointer() ||
+      (token->getType() != Token::Type::Identifier &&
+        token->getType() != Token::Type::Operator) ||
+      locals->count(token->getValue())) {
+    return {};
+  }
+  const auto signature = signatures.find(token->getValue());
+  if (signature != signatures.end()) {
+    return signature->second;
+  }
+  const auto &valueOrErr = context->getValue(token->getValue());
+  if (std::holds_alternative<Error>(valueOrErr)) {
+    return {};
+  }
+  return (*std::get_if<Value::Pointer>(&valueOrErr))->getStrictness();
+}
+
+// neededNames(tree, locals) - Returns the names whose Values are certainly
+//  needed when tree is evaluated. Like the ConstantFolder, this keeps the
+//  TokenTrees it has yet to finish on its own stack, and each step leaves the
+//  names it finds on a stack of results.
+std::set<std::string> StrictnessAnalyzer::neededNames(const TokenTree &tree,
+  const Locals &locals) const {
+  struct Step {
+    enum class Kind {
+      // Find the names needed by tree.
+      Visit,
+      // Replace the top count results with their union.
+      Join,
+      // Finish the Binding tree, whose body's names are on top.
+      Bind
+    };
+    Kind kind;
+    const TokenTree *tree;
+    Locals locals;
+    std::size_t count;
+  };
+  std::vector<Step> steps { { Step::Kind::Visit, &tree, locals, 0 } };
+  std::vector<std::set<std::string>> results;
+  while (!steps.empty()) {
+    const Step step = steps.back();
+    steps.pop_back();
+    if (step.kind == Step::Kind::Join) {
+      std::set<std::string> joined;
+      for (std::size_t i = results.size() - step.count; i < results.size();
+        i++) {
+        joined.insert(results[i].begin(), results[i].end());
+      }
+      results.resize(results.size() - step.count);
+      results.push_back(std::move(joined));
+      continue;
+    }
+    if (step.kind == Step::Kind::Bind) {
+      // The value is only needed if the body needs the name.
+      const auto &binding = *step.tree->getBindingPointer();
+      std::set<std::string> &body = results.back();
+      if (body.erase(binding.name) != 0) {
+        steps.push_back({ Step::Kind::Join, nullptr, nullptr, 2 });
+        steps.push_back({ Step::Kind::Visit, binding.value.get(), step.locals,
+          0 });
+      }
+      continue;
+    }
+    const TokenTree &next = *step.tree;
+    if (const auto binding = next.getBindingPointer()) {
+      steps.push_back({ Step::Kind::Bind, &next, step.locals, 0 });
+      steps.push_back({ Step::Kind::Visit, binding->body.get(),
+        with(step.locals, { binding->name }), 0 });
+    }
+    else if (const auto pair = asCall(next)) {
+      // Evaluating f a b needs f, then the arguments that f is strict in.
+      std::vector<const TokenTree *> arguments { pair->second.get() };
+      const TokenTree *f = pair->first.get();
+      while (const auto inner = asCall(*f)) {
+        arguments.push_back(inner->second.get());
+        f = inner->first.get();
+      }
+      std::vector<bool> signature = signatureOf(*f, step.locals);
+      signature.resize(arguments.size(), false);
+      std::vector<const TokenTree *> needed { f };
+      for (std::size_t i = 0; i < signature.size(); i++) {
+        const TokenTree *argument = arguments[arguments.size() - 1 - i];
+        if (argument->isImplied()) {
+          break;
+        }
+        if (signature[i]) {
+          needed.push_back(argument);
+        }
+      }
+      steps.push_back({ Step::Kind::Join, nullptr, nullptr, needed.size() });
+      for (const TokenTree *subtree : needed) {
+        steps.push_back({ Step::Kind::Visit, subtree, step.locals, 0 });
+      }
+    }
+    else if (const auto lines = next.getLineListPointer()) {
+      // A line whose Value is discarded is only evaluated if it is a call.
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < lines->size(); i++) {
+        if (i + 1 == lines->size() || asCall(*(*lines)[i])) {
+          steps.push_back({ Step::Kind::Visit, (*lines)[i].get(), step.locals,
+            0 });
+          count++;
+        }
+      }
+      steps.insert(steps.end() - count,
+        { Step::Kind::Join, nullptr, nullptr, count });
+    }
+    else if (const auto token = next.getTokenPointer();
+      token && !next.getConstantPointer() &&
+      (token->getType() == Token::Type::Identifier ||
+        token->getType() == Token::Type::Operator)) {
+      results.push_back({ token->getValue() });
+    }
+    else {
+      results.push_back({});
+    }
+  }
+  return results.back();
+}
+
+// needs(body, name, locals) - Returns whether evaluating body certainly needs
+//  the Value of name, which is bound (along with locals) around body.
+bool StrictnessAnalyzer::needs(const TokenTree &body, const std::string &name,
+  const Locals &locals) const {
+  return neededNames(body, with(locals, { name })).count(name) != 0;
+}
+
+// isStrict(param, body, locals) - Returns whether the function `param -> body`
+//  always needs its argument, either to match it against a number or a tuple
+//  or because body needs the name it binds.
+bool StrictnessAnalyzer::isStrict(const TokenTree &param, const TokenTree &body,
+  const Locals &locals) const {
+  const auto &pattern = Pattern::fromTree(param);
+  if (!pattern) {
+    return false;
+  }
+  if (pattern->getKind() != Pattern::Kind::Identifier) {
+    return true;
+  }
+  return needs(body, *pattern->getBoundNames().begin(), locals);
+}
+
+// mark(tree, strictArrow) - Returns a copy of tree in which the functions that
+//  are strict in their identifier parameter are created by strictArrow, and
+//  the Bindings that always need their value are strict. The copy shares the
+//  subtrees of tree that did not change. Like neededNames, this keeps the
+//  TokenTrees it has yet to finish on its own stack.
+TokenTree::TreePointer StrictnessAnalyzer::mark(
+  const TokenTree::TreePointer &tree, const Value::Pointer &strictArrow) const {
+  struct Step {
+    TokenTree::TreePointer tree;
+    Locals locals;
+    bool expanded;
+    bool strict;
+  };
+  std::vector<Step> steps {
+    { tree, Locals { new std::set<std::string> {} }, false, false }
+  };
+  std::vector<TokenTree::TreePointer> results;
+  while (!steps.empty()) {
+    Step step = steps.back();
+    steps.pop_back();
+    const auto binding = step.tree->getBindingPointer();
+    const auto lambda = asLambda(*step.tree);
+    const auto pair = lambda ? nullptr : asCall(*step.tree);
+    const auto lines = binding || step.tree->getConstantPointer() ? nullptr :
+      step.tree->getLineListPointer();
+    if (binding && !step.expanded) {
+      const bool strict = binding->strict ||
+        needs(*binding->body, binding->name, step.locals);
+      steps.push_back({ step.tree, step.locals, true, strict });
+      steps.push_back({ binding->body, with(step.locals, { binding->name }),
+        false, false });
+      steps.push_back({ binding->value, step.locals, false, false });
+    }
+    else if (binding) {
+      const TokenTree::TreePointer body = std::move(results.back());
+      results.pop_back();
+      const TokenTree::TreePointer value = std::move(results.back());
+      results.pop_back();
+      results.push_back(value == binding->value && body == binding->body &&
+        step.strict == binding->strict ? step.tree :
+        std::make_shared<TokenTree>(binding->name, value, body, step.strict));
+    }
+    else if (lambda && !step.expanded) {
+      const auto &param = lambda->first->getFunctionPairPointer()->second;
+      const auto &pattern = Pattern::fromTree(*param);
+      const bool strict = pattern &&
+        pattern->getKind() == Pattern::Kind::Identifier &&
+        !lambda->first->getFunctionPairPointer()->first->getConstantPointer() &&
+        isStrict(*param, *lambda->second, step.locals);
+      steps.push_back({ step.tree, step.locals, true, strict });
+      steps.push_back({ lambda->second, pattern ?
+        with(step.locals, pattern->getBoundNames()) : step.locals, false,
+        false });
+    }
+    else if (lambda) {
+      const TokenTree::TreePointer body = std::move(results.back());
+      results.pop_back();
+      const auto &inner = *lambda->first->getFunctionPairPointer();
+      if (!step.strict && body == lambda->second) {
+        results.push_back(step.tree);
+        continue;
+      }
+      const TokenTree::TreePointer arrow = step.strict ?
+        std::make_shared<TokenTree>(strictArrow, inner.first) : inner.first;
+      results.push_back(std::make_shared<TokenTree>(
+        std::make_shared<TokenTree>(arrow, inner.second), body
+      ));
+    }
+    else if (pair && !step.expanded) {
+      steps.push_back({ step.tree, step.locals, true, false });
+      steps.push_back({ pair->second, step.locals, false, false });
+      steps.push_back({ pair->first, step.locals, false, false });
+    }
+    else if (pair) {
+      const TokenTree::TreePointer x = std::move(results.back());
+      results.pop_back();
+      const TokenTree::TreePointer f = std::move(results.back());
+      results.pop_back();
+      results.push_back(f == pair->first && x == pair->second ? step.tree :
+        std::make_shared<TokenTree>(f, x));
+    }
+    else if (lines && !step.expanded) {
+      steps.push_back({ step.tree, step.locals, true, false });
+      for (std::size_t i = lines->size(); i-- > 0; ) {
+        steps.push_back({ (*lines)[i], step.locals, false, false });
+      }
+    }
+    else if (lines) {
+      const std::size_t first = results.size() - lines->size();
+      TokenTree::LineList marked { results.begin() + first, results.end() };
+      results.resize(first);
+      results.push_back(marked == *lines ? step.tree :
+        std::make_shared<TokenTree>(marked));
+    }
+    else {
+      results.push_back(step.tree);
+    }
+  }
+  return results.back();
+}
+
+// analyze(ast, context) - Marks a copy of ast. Functions that are strict are
+//  created by a Constant that stands for `->`, which creates them the same way
+//  but marks them as strict. The Constant is created here rather than taken
+//  from context, so it is never allocated in a Region.
+TokenTree StrictnessAnalyzer::analyze(const TokenTree &ast,
+  const Context::Pointer &context) {
+  const Region::Scope scope { Region::Pointer {} };
+  const StrictnessAnalyzer analyzer { context, ast };
+  const Value::Pointer strictArrow {
+    new BinaryFunctionValue<IdentifierValue, IdentifierValue, Value> {
+      [](const std::shared_ptr<IdentifierValue> &param,
+        const std::shared_ptr<IdentifierValue> &body,
+        [[maybe_unused]] const Context::Pointer &ignored) -> Value::OrError {
+        return DefaultContext::createFunction(param, body, true);
+      }, context, false, { false, false }
+    }
+  };
+  return *analyzer.mark(std::make_shared<TokenTree>(ast), strictArrow);
+}
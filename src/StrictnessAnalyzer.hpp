@@ -0,0 +1,67 @@
+// File: src/StrictnessAnalyzer.hpp
+// Purpose: Header file for StrictnessAnalyzers, which find the parameters of
+//  functions that are always used, so that their arguments can be evaluated
+//  before the call instead of being delayed. See src/StrictnessAnalyzer.cpp
+//  for implementations.
+
+#ifndef STRICTNESSANALYZER_HPP
+#define STRICTNESSANALYZER_HPP
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "Context.hpp"
+#include "TokenTree.hpp"
+#include "Value.hpp"
+
+// StrictnessAnalyzer - Arguments and definitions are lazy (see
+//  src/ThunkValue.hpp), but delaying an argument that the function always uses
+//  only costs a ThunkValue. A function is strict in its parameter if
+//  evaluating its body certainly evaluates the parameter, which is found by
+//  following the code that is always evaluated: the lines of a block, the
+//  function of a call, and the arguments that the function is strict in.
+//  Which arguments a function is strict in is its strictness signature (see
+//  Value::getStrictness). Builtins declare theirs, and the signatures of the
+//  functions defined at the top level are found together, starting from the
+//  assumption that they are strict in everything and weakening it until it
+//  holds, so that recursive functions can be strict. Functions that are found
+//  to be strict are created with a Constant in place of `->` (which looks like
+//  `->` to everything but the Evaluator), and Bindings (see src/Inliner.hpp)
+//  whose body always uses their name are marked as strict.
+class StrictnessAnalyzer {
+private:
+  // Names that are bound within the code being analyzed, which may not refer
+  //  to what they refer to at the top level.
+  typedef std::shared_ptr<const std::set<std::string>> Locals;
+
+  Context::Pointer context;
+  std::map<std::string, std::vector<bool>> signatures;
+
+  // Private methods are documented in src/StrictnessAnalyzer.cpp.
+  StrictnessAnalyzer(const Context::Pointer &context, const TokenTree &ast);
+  static const TokenTree::FunctionPair *asCall(const TokenTree &tree);
+  static const TokenTree::FunctionPair *asLambda(const TokenTree &tree);
+  static const Token *asDefinition(const TokenTree &tree);
+  static Locals with(const Locals &locals,
+    const std::set<std::string> &names);
+  std::vector<bool> signatureOf(const TokenTree &f, const Locals &locals) const;
+  std::set<std::string> neededNames(const TokenTree &tree,
+    const Locals &locals) const;
+  bool needs(const TokenTree &body, const std::string &name,
+    const Locals &locals) const;
+  bool isStrict(const TokenTree &param, const TokenTree &body,
+    const Locals &locals) const;
+  TokenTree::TreePointer mark(const TokenTree::TreePointer &tree,
+    const Value::Pointer &strictArrow) const;
+
+public:
+  // static analyze(ast, context) - Returns a TokenTree that gives the same
+  //  result as ast when it is evaluated in context, but whose strict functions
+  //  and Bindings take their arguments already evaluated.
+  static TokenTree analyze(const TokenTree &ast,
+    const Context::Pointer &context);
+};
+
+#endif
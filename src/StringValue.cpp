@@ -0,0 +1,208 @@
+// File: src/StringValue.cpp
+// Purpose: Source file for StringValues, which are the sequences of characters
+//  that string literals such as "Fizz" and `++` on them return. See
+//  src/StringValue.hpp for more documentation.
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "StringValue.hpp"
+#include "Error.hpp"
+#include "Evacuation.hpp"
+#include "NumberValue.hpp"
+#include "Region.hpp"
+#include "Rope.hpp"
+#include "SequenceValue.hpp"
+#include "Token.hpp"
+#include "Value.hpp"
+
+// Constructors
+StringValue::StringValue(const Rope &text): SequenceValue {
+  std::make_shared<const Source>(text), std::vector<Stage> {}
+} {}
+StringValue::StringValue(const Token &stringToken):
+  StringValue { decodeLiteral(stringToken) } {}
+
+// decodeLiteral(stringToken) - A literal without escapes is its own text, so
+//  the Rope views it between the quotes rather than copying it a second time.
+//  It is still copied once, out of the Token, which owns its text rather than
+//  viewing the source; the ConstantFolder, when it runs, makes that happen
+//  once per literal in a program rather than once per evaluation.
+Rope StringValue::decodeLiteral(const Token &stringToken) {
+  std::string literal = stringToken.getValue();
+  const std::size_t end = literal.size() - 1;
+  if (literal.find('\\') == std::string::npos) {
+    return Rope::fromUtf8(std::move(literal), 1, end);
+  }
+  std::string text;
+  for (std::size_t i = 1; i < end; i++) {
+    if (literal[i] != '\\') {
+      text.push_back(literal[i]);
+      continue;
+    }
+    switch (literal[++i]) {
+      case 'n':
+        text.push_back('\n');
+        break;
+      case 't':
+        text.push_back('\t');
+        break;
+      case 'r':
+        text.push_back('\r');
+        break;
+      case '0':
+        text.push_back('\0');
+        break;
+      case '\n':
+        break;
+      default:
+        text.push_back(literal[i]);
+    }
+  }
+  return Rope::fromUtf8(std::move(text));
+}
+
+// of(codePoint) - The Latin-1 Strings are created on first use and are never
+//  released.
+std::shared_ptr<StringValue> StringValue::of(char32_t codePoint) {
+  static const auto latin1 = [] {
+    std::array<std::shared_ptr<StringValue>, 256> strings;
+    for (char32_t c = 0; c < strings.size(); c++) {
+      strings[c] = std::make_shared<StringValue>(Rope::of(c));
+    }
+    return strings;
+  }();
+  if (codePoint < latin1.size()) {
+    return latin1[codePoint];
+  }
+  return Region::make<StringValue>(Rope::of(codePoint));
+}
+
+// getText() - A StringValue is always created with a Rope.
+const Rope &StringValue::getText() const {
+  return *std::get_if<Rope>(source.get());
+}
+
+// then(stage) - Slices the Rope for Take and Drop.
+std::shared_ptr<SequenceValue> StringValue::then(const Stage &stage) const {
+  const Rope &text = getText();
+  switch (stage.kind) {
+    case Stage::Kind::Take:
+      return Region::make<StringValue>(text.slice(0, stage.count));
+    case Stage::Kind::Drop:
+      return Region::make<StringValue>(text.slice(stage.count,
+        text.length()));
+    default:
+      return SequenceValue::then(stage);
+  }
+}
+
+// length() - The length of the Rope is known.
+Value::OrError StringValue::length() const {
+  return { Value::Pointer {
+    Region::make<NumberValue>(static_cast<std::int64_t>(getText().length()))
+  } };
+}
+
+// first() - Returns the character at 0.
+Value::OrError StringValue::first() const {
+  if (getText().length() == 0) {
+    return { Error { Error::Code::EmptySequence } };
+  }
+  return { Value::Pointer { of(getText().at(0)) } };
+}
+
+// last() - Returns the character at the end.
+Value::OrError StringValue::last() const {
+  const Rope &text = getText();
+  if (text.length() == 0) {
+    return { Error { Error::Code::EmptySequence } };
+  }
+  return { Value::Pointer { of(text.at(text.length() - 1)) } };
+}
+
+// at(index) - Looks the character up in the Rope.
+Value::OrError StringValue::at(const std::shared_ptr<NumberValue> &index)
+  const {
+  const double position = index->getRawNumber();
+  if (position < 0 || std::floor(position) != position ||
+    !(position < static_cast<double>(getText().length()))) {
+    return {
+      Error { Error::Code::IndexOutOfRange, { Error::Shown { index } } }
+    };
+  }
+  return { Value::Pointer {
+    of(getText().at(static_cast<std::size_t>(position)))
+  } };
+}
+
+std::optional<std::size_t> StringValue::hash() const {
+  if (!cachedHash) {
+    cachedHash = getText().hash();
+  }
+  return cachedHash;
+}
+
+std::optional<std::size_t> StringValue::knownHash() const {
+  return cachedHash;
+}
+
+bool StringValue::equals(const Value &other) const {
+  const auto otherString = dynamic_cast<const StringValue *>(&other);
+  return otherString && getText().equals(otherString->getText());
+}
+
+// evacuate([unused] evacuation) - The text of a String is never in a Region.
+Value::Pointer StringValue::evacuate([[maybe_unused]] Evacuation &evacuation)
+  const {
+  return Value::Pointer { std::make_shared<StringValue>(*this) };
+}
+
+// operator string() - Escapes the characters that a literal cannot contain
+//  as they are.
+StringValue::operator std::string() const {
+  std::string shown { "\"" };
+  for (const char c : getText().toUtf8()) {
+    switch (c) {
+      case '"':
+        shown += "\\\"";
+        break;
+      case '\\':
+        shown += "\\\\";
+        break;
+      case '\n':
+        shown += "\\n";
+        break;
+      case '\t':
+        shown += "\\t";
+        break;
+      case '\r':
+        shown += "\\r";
+        break;
+      case '\0':
+        shown += "\\0";
+        break;
+      default:
+        shown.push_back(c);
+    }
+  }
+  return shown + "\"";
+}
+
+const std::string StringValue::name { "String" };
+
+// getName() - Returns "String", the name of the String type.
+std::string StringValue::getName() const {
+  return StringValue::name;
+}
+
+std::string StringValue::getClassName() {
+  return StringValue::name;
+}
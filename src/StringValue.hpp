@@ -0,0 +1,87 @@
+// File: src/StringValue.hpp
+// Purpose: Header file for StringValues, which are the sequences of characters
+//  that string literals such as "Fizz" and `++` on them return. See
+//  src/StringValue.cpp for implementations.
+
+#ifndef STRINGVALUE_HPP
+#define STRINGVALUE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include "NumberValue.hpp"
+#include "Rope.hpp"
+#include "SequenceValue.hpp"
+#include "Token.hpp"
+#include "Value.hpp"
+
+// StringValue - A SequenceValue whose source is a Rope (see src/Rope.hpp) and
+//  which has no stages. Its elements are its characters, which are Unicode
+//  code points, each given as the String of that one character. A String
+//  takes one byte per character if all its characters are Latin-1 (as ASCII
+//  text is), and its UTF-8 bytes otherwise, rather than a Value for every
+//  character. Its length is known, the character at any position is found
+//  without decoding the characters before it, taking or dropping characters
+//  shares the text, and `++` on two Strings joins their Ropes in O(log n)
+//  time.
+class StringValue final: public SequenceValue {
+private:
+  // The hash of the text, once it has been computed.
+  mutable std::optional<std::size_t> cachedHash;
+
+  // Private methods are documented in src/StringValue.cpp.
+  static Rope decodeLiteral(const Token &stringToken);
+
+public:
+  // Constructor(text) - Creates the String of the code points of text.
+  explicit StringValue(const Rope &text);
+
+  // Constructor(stringToken) - Creates the String that a string literal
+  //  stands for, which is the text between its quotes with escapes such as
+  //  \n replaced. A backslash before a line break continues the literal on
+  //  the next line without a line break.
+  explicit StringValue(const Token &stringToken);
+
+  // static of(codePoint) - Returns the String of one character. The Strings
+  //  of Latin-1 characters are shared, so that going through the characters
+  //  of a String does not usually allocate.
+  static std::shared_ptr<StringValue> of(char32_t codePoint);
+
+  // getText() - Returns the code points of the String.
+  const Rope &getText() const;
+
+  // then(stage) - Returns a slice of the String for stages that take or drop
+  //  characters, and adds stage to the sequence like any other otherwise.
+  std::shared_ptr<SequenceValue> then(const Stage &stage) const;
+
+  // length(), first(), last(), at(index) - Look the result up directly.
+  Value::OrError length() const;
+  Value::OrError first() const;
+  Value::OrError last() const;
+  Value::OrError at(const std::shared_ptr<NumberValue> &index) const;
+
+  // hash(), knownHash() - Return the hash of the text (see Rope::hash), which
+  //  is computed once.
+  std::optional<std::size_t> hash() const;
+  std::optional<std::size_t> knownHash() const;
+
+  // equals(other) - Returns whether other is a String of the same text (see
+  //  Rope::equals).
+  bool equals(const Value &other) const;
+
+  // evacuate(evacuation) - Returns a copy of the String, which shares its
+  //  text.
+  Value::Pointer evacuate(Evacuation &evacuation) const;
+
+  // operator string() - Returns the String in double quotes, with quotes,
+  //  backslashes and control characters escaped as in a string literal.
+  operator std::string() const;
+
+  // name/getName() - Returns "String", the name of a StringValue-type value.
+  static const std::string name;
+  static std::string getClassName();
+  std::string getName() const;
+};
+
+#endif
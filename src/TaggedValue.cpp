@@ -0,0 +1,150 @@
+// File: src/TaggedValue.cpp
+// Purpose: A TaggedValue is a Value made by a constructor of an algebraic data
+//  type, such as `Nothing`, `Some 3` or `Left "error"`. For more
+//  documentation see src/TaggedValue.hpp.
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "TaggedValue.hpp"
+#include "Error.hpp"
+#include "Evacuation.hpp"
+#include "Value.hpp"
+
+// The names of the constructors that have Tags, in order of Tag, and the
+//  shared TaggedValues of those that have been used as nullary constructors.
+//  Constructors can be created while code runs on any thread, so the
+//  Registry is locked, but only while a Tag is looked up by name, which
+//  happens when a constructor or a Pattern is created rather than when a
+//  Value is made or matched.
+struct TaggedValue::Registry {
+  std::mutex lock;
+  std::vector<std::string> names { "Nothing", "Some", "Left", "Right" };
+  std::unordered_map<std::string, TaggedValue::Tag> tags {
+    { "Nothing", TaggedValue::nothing }, { "Some", TaggedValue::some },
+    { "Left", TaggedValue::left }, { "Right", TaggedValue::right }
+  };
+  std::vector<Value::Pointer> singletons;
+};
+
+// registry() - Returns the Registry, which is created when first used.
+TaggedValue::Registry &TaggedValue::registry() {
+  static Registry instance;
+  return instance;
+}
+
+// Constructors
+TaggedValue::TaggedValue(TaggedValue::Tag tag, const Value::Pointer &payload):
+  tag { tag }, payload { payload } {}
+
+TaggedValue::Tag TaggedValue::tagOf(const std::string &name) {
+  Registry &tags = registry();
+  const std::lock_guard<std::mutex> guard { tags.lock };
+  const auto [position, added] = tags.tags.emplace(
+    name, static_cast<TaggedValue::Tag>(tags.names.size())
+  );
+  if (added) {
+    tags.names.push_back(name);
+  }
+  return position->second;
+}
+
+std::string TaggedValue::nameOf(TaggedValue::Tag tag) {
+  Registry &tags = registry();
+  const std::lock_guard<std::mutex> guard { tags.lock };
+  return tags.names.at(tag);
+}
+
+// nullary(tag) - The TaggedValue is created the first time it is needed and
+//  kept on the heap rather than in a Region (see src/Region.hpp), since it
+//  outlives any evaluation.
+Value::Pointer TaggedValue::nullary(TaggedValue::Tag tag) {
+  Registry &tags = registry();
+  const std::lock_guard<std::mutex> guard { tags.lock };
+  if (tags.singletons.size() <= tag) {
+    tags.singletons.resize(tag + 1);
+  }
+  Value::Pointer &singleton = tags.singletons[tag];
+  if (!singleton) {
+    singleton = Value::Pointer { new TaggedValue { tag, nullptr } };
+  }
+  return singleton;
+}
+
+TaggedValue::Tag TaggedValue::getTag() const {
+  return tag;
+}
+
+const Value::Pointer &TaggedValue::getPayload() const {
+  return payload;
+}
+
+// hash() - Combines the Tag with the hash of the payload, so that Some 1 and
+//  Left 1 are unlikely to share a hash.
+std::optional<std::size_t> TaggedValue::hash() const {
+  const std::size_t hash = mixHash(tag);
+  if (!payload) {
+    return { hash };
+  }
+  const std::optional<std::size_t> payloadHash = payload->hash();
+  if (!payloadHash) {
+    return {};
+  }
+  return { combineHashes(hash, *payloadHash) };
+}
+
+bool TaggedValue::equals(const Value &other) const {
+  const auto otherTagged = dynamic_cast<const TaggedValue *>(&other);
+  if (!otherTagged || tag != otherTagged->tag) {
+    return false;
+  }
+  if (!payload || !otherTagged->payload) {
+    return !payload && !otherTagged->payload;
+  }
+  return Value::equal(*payload, *otherTagged->payload);
+}
+
+// call([unused] arg) - Returns an error, since TaggedValues cannot be called.
+Value::OrError TaggedValue::call([[maybe_unused]] Value::Pointer arg) const {
+  return {
+    Error { Error::Code::NotCallable, { &TaggedValue::getClassName } }
+  };
+}
+
+// evacuate(evacuation) - Nullary constructors are never in a Region, so there
+//  is always a payload.
+Value::Pointer TaggedValue::evacuate(Evacuation &evacuation) const {
+  return Value::Pointer {
+    std::make_shared<TaggedValue>(tag, evacuation.value(payload))
+  };
+}
+
+// operator string() - The payload is put in parentheses if it would otherwise
+//  read as more than one argument, as in Some (Some 3) or Some (-3).
+TaggedValue::operator std::string() const {
+  const std::string constructor = nameOf(tag);
+  if (!payload) {
+    return constructor;
+  }
+  const std::string shown = *payload;
+  const auto tagged = dynamic_cast<const TaggedValue *>(payload.get());
+  if ((tagged && tagged->payload) || shown.rfind('-', 0) == 0) {
+    return constructor + " (" + shown + ")";
+  }
+  return constructor + " " + shown;
+}
+
+const std::string TaggedValue::name { "Tagged" };
+
+// getName() - Returns "Tagged", the name of the Tagged type.
+std::string TaggedValue::getName() const {
+  return TaggedValue::name;
+}
+
+std::string TaggedValue::getClassName() {
+  return TaggedValue::name;
+}
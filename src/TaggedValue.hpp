@@ -0,0 +1,90 @@
+// File: src/TaggedValue.hpp
+// Purpose: A TaggedValue is a Value made by a constructor of an algebraic data
+//  type, such as `Nothing`, `Some 3` or `Left "error"`. For implementations
+//  see src/TaggedValue.cpp.
+
+#ifndef TAGGEDVALUE_HPP
+#define TAGGEDVALUE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include "Value.hpp"
+
+// TaggedValue - The Value of a constructor and, unless the constructor is
+//  nullary, of the one Value it was given (its payload; constructors of more
+//  than one Value take a tuple). A constructor is identified by a Tag, a small
+//  number given to each constructor name the first time it is seen, so
+//  telling constructors apart is a comparison of two numbers rather than of
+//  two names. A TaggedValue is a Tag and a pointer to the payload, which is
+//  shared rather than copied, and each nullary constructor has a single
+//  TaggedValue that is never allocated again (see nullary).
+class TaggedValue final: public Value {
+public:
+  typedef std::uint32_t Tag;
+
+  // The Tags of the constructors of `Maybe` and `Either`, which are given
+  //  their Tags before any other constructor.
+  static constexpr Tag nothing = 0;
+  static constexpr Tag some = 1;
+  static constexpr Tag left = 2;
+  static constexpr Tag right = 3;
+
+private:
+  Tag tag;
+  Value::Pointer payload;
+
+  // Private methods are documented in src/TaggedValue.cpp.
+  struct Registry;
+  static Registry &registry();
+
+public:
+  // Constructor(tag, payload) - Creates the Value of the constructor of tag
+  //  given payload. Use nullary(tag) instead for a nullary constructor.
+  TaggedValue(Tag tag, const Value::Pointer &payload);
+
+  // static tagOf(name) - Returns the Tag of the constructor called name,
+  //  giving it the next unused Tag if it has none yet.
+  static Tag tagOf(const std::string &name);
+
+  // static nameOf(tag) - Returns the name of the constructor of tag.
+  static std::string nameOf(Tag tag);
+
+  // static nullary(tag) - Returns the shared TaggedValue of the nullary
+  //  constructor of tag, such as `Nothing`.
+  static Value::Pointer nullary(Tag tag);
+
+  // getTag() - Returns the Tag of the constructor.
+  Tag getTag() const;
+
+  // getPayload() - Returns the payload, or nullptr if the constructor is
+  //  nullary.
+  const Value::Pointer &getPayload() const;
+
+  // hash() - Returns the hash of the Tag and the payload, or nothing if the
+  //  payload has none.
+  std::optional<std::size_t> hash() const;
+
+  // equals(other) - Returns whether other is a TaggedValue of the same
+  //  constructor with an equal payload.
+  bool equals(const Value &other) const;
+
+  // call(arg) - Returns an error, since TaggedValues cannot be called.
+  Value::OrError call([[maybe_unused]] Value::Pointer arg) const;
+
+  // evacuate(evacuation) - Returns the TaggedValue of the same constructor
+  //  with the evacuated payload.
+  Value::Pointer evacuate(Evacuation &evacuation) const;
+
+  // operator string() - Returns the constructor as it would be written, as in
+  //  Nothing or Some 3.
+  operator std::string() const;
+
+  // name/getName() - Returns "Tagged", the name of a TaggedValue-type value.
+  static const std::string name;
+  static std::string getClassName();
+  std::string getName() const;
+};
+
+#endif
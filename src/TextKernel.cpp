@@ -0,0 +1,223 @@
+// File: src/TextKernel.cpp
+// Purpose: Source file for TextKernel, which has the loops that scan the bytes
+//  of text for Ropes (see src/Rope.hpp). See src/TextKernel.hpp for more
+//  documentation.
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include "TextKernel.hpp"
+#include "NumericKernel.hpp"
+
+// The AVX2 copies of the loops are only compiled by GCC and Clang for x86, as
+//  for NumericKernel.
+#if (defined(__GNUC__) || defined(__clang__)) && \
+  (defined(__x86_64__) || defined(__i386__))
+#define TEXTKERNEL_AVX2
+#endif
+
+// passes<scan>(c, byte) - Returns 1 if c passes the test of scan and 0
+//  otherwise, without branching. byte is the byte that Byte looks for. The
+//  ASCII whitespace bytes are the space and the bytes from \t (9) to \r (13).
+template <TextKernel::Scan scan>
+__attribute__((always_inline)) inline unsigned char TextKernel::passes(
+  unsigned char c, unsigned char byte) {
+  const unsigned char space = (c == ' ') |
+    (static_cast<unsigned char>(c - '\t') <= '\r' - '\t');
+  switch (scan) {
+    case Scan::Byte:
+      return c == byte;
+    case Scan::NotAscii:
+      return c >> 7;
+    case Scan::Space:
+      return space | (c >> 7);
+    case Scan::NotSpace:
+      return space ^ 1;
+  }
+  return 0;
+}
+
+// scanBlocks<scan>(bytes, size, byte) - Finds the first block with a byte that
+//  passes, and then the byte itself. It is always inlined, so that it is
+//  compiled for the instructions of whichever copy calls it.
+template <TextKernel::Scan scan>
+__attribute__((always_inline)) inline std::size_t TextKernel::scanBlocks(
+  const char *bytes, std::size_t size, char byte) {
+  const auto data = reinterpret_cast<const unsigned char *>(bytes);
+  const auto target = static_cast<unsigned char>(byte);
+  std::size_t i = 0;
+  for (; i + blockBytes <= size; i += blockBytes) {
+    unsigned char any = 0;
+    for (std::size_t j = 0; j < blockBytes; j++) {
+      any |= passes<scan>(data[i + j], target);
+    }
+    if (any) {
+      break;
+    }
+  }
+  for (; i < size; i++) {
+    if (passes<scan>(data[i], target)) {
+      return i;
+    }
+  }
+  return size;
+}
+
+// scanAvx2<scan>(bytes, size, byte), scanDefault<scan>(bytes, size, byte) -
+//  The copies of scanBlocks compiled for AVX2 and for the baseline.
+#ifdef TEXTKERNEL_AVX2
+template <TextKernel::Scan scan>
+__attribute__((target("avx2"))) std::size_t TextKernel::scanAvx2(
+  const char *bytes, std::size_t size, char byte) {
+  return scanBlocks<scan>(bytes, size, byte);
+}
+#else
+template <TextKernel::Scan scan>
+std::size_t TextKernel::scanAvx2(const char *bytes, std::size_t size,
+  char byte) {
+  return scanBlocks<scan>(bytes, size, byte);
+}
+#endif
+
+template <TextKernel::Scan scan>
+std::size_t TextKernel::scanDefault(const char *bytes, std::size_t size,
+  char byte) {
+  return scanBlocks<scan>(bytes, size, byte);
+}
+
+// scanFor<scan>(bytes, size, byte) - Runs the copy for the processor.
+template <TextKernel::Scan scan>
+std::size_t TextKernel::scanFor(const char *bytes, std::size_t size,
+  char byte) {
+  return NumericKernel::hasAvx2() ? scanAvx2<scan>(bytes, size, byte) :
+    scanDefault<scan>(bytes, size, byte);
+}
+
+// countBlocks(bytes, size) - Counts the bytes that are not 10xxxxxx, one
+//  block at a time, in lanes that the compiler can vectorize.
+__attribute__((always_inline)) inline std::size_t TextKernel::countBlocks(
+  const char *bytes, std::size_t size) {
+  const auto data = reinterpret_cast<const unsigned char *>(bytes);
+  std::size_t count = 0;
+  std::size_t i = 0;
+  for (; i + blockBytes <= size; i += blockBytes) {
+    unsigned char leads = 0;
+    for (std::size_t j = 0; j < blockBytes; j++) {
+      leads += (data[i + j] & 0xC0) != 0x80;
+    }
+    count += leads;
+  }
+  for (; i < size; i++) {
+    count += (data[i] & 0xC0) != 0x80;
+  }
+  return count;
+}
+
+// countAvx2(bytes, size), countDefault(bytes, size) - The copies of
+//  countBlocks compiled for AVX2 and for the baseline.
+#ifdef TEXTKERNEL_AVX2
+__attribute__((target("avx2"))) std::size_t TextKernel::countAvx2(
+  const char *bytes, std::size_t size) {
+  return countBlocks(bytes, size);
+}
+#else
+std::size_t TextKernel::countAvx2(const char *bytes, std::size_t size) {
+  return countBlocks(bytes, size);
+}
+#endif
+
+std::size_t TextKernel::countDefault(const char *bytes, std::size_t size) {
+  return countBlocks(bytes, size);
+}
+
+// equalBlocks(x, y, size) - Combines the differences of the bytes of each
+//  block, and stops after the first block with any.
+__attribute__((always_inline)) inline bool TextKernel::equalBlocks(
+  const char *x, const char *y, std::size_t size) {
+  const auto xData = reinterpret_cast<const unsigned char *>(x);
+  const auto yData = reinterpret_cast<const unsigned char *>(y);
+  std::size_t i = 0;
+  for (; i + blockBytes <= size; i += blockBytes) {
+    unsigned char differ = 0;
+    for (std::size_t j = 0; j < blockBytes; j++) {
+      differ |= xData[i + j] ^ yData[i + j];
+    }
+    if (differ) {
+      return false;
+    }
+  }
+  for (; i < size; i++) {
+    if (xData[i] != yData[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// equalAvx2(x, y, size), equalDefault(x, y, size) - The copies of
+//  equalBlocks compiled for AVX2 and for the baseline.
+#ifdef TEXTKERNEL_AVX2
+__attribute__((target("avx2"))) bool TextKernel::equalAvx2(const char *x,
+  const char *y, std::size_t size) {
+  return equalBlocks(x, y, size);
+}
+#else
+bool TextKernel::equalAvx2(const char *x, const char *y, std::size_t size) {
+  return equalBlocks(x, y, size);
+}
+#endif
+
+bool TextKernel::equalDefault(const char *x, const char *y,
+  std::size_t size) {
+  return equalBlocks(x, y, size);
+}
+
+// find(bytes, size, needle) - Scans for the first byte of needle, and
+//  compares the rest wherever it is found.
+std::size_t TextKernel::find(const char *bytes, std::size_t size,
+  const std::string &needle) {
+  for (std::size_t i = 0; i + needle.size() <= size; i++) {
+    i += scanFor<Scan::Byte>(bytes + i, size - i, needle[0]);
+    if (i + needle.size() > size) {
+      break;
+    }
+    if (std::memcmp(bytes + i + 1, needle.data() + 1, needle.size() - 1) ==
+      0) {
+      return i;
+    }
+  }
+  return size;
+}
+
+std::size_t TextKernel::asciiLength(const char *bytes, std::size_t size) {
+  return scanFor<Scan::NotAscii>(bytes, size);
+}
+
+std::size_t TextKernel::findSpace(const char *bytes, std::size_t size) {
+  return scanFor<Scan::Space>(bytes, size);
+}
+
+std::size_t TextKernel::skipSpaces(const char *bytes, std::size_t size) {
+  return scanFor<Scan::NotSpace>(bytes, size);
+}
+
+std::size_t TextKernel::countCodePoints(const char *bytes, std::size_t size) {
+  return NumericKernel::hasAvx2() ? countAvx2(bytes, size) :
+    countDefault(bytes, size);
+}
+
+bool TextKernel::equal(const char *x, const char *y, std::size_t size) {
+  return NumericKernel::hasAvx2() ? equalAvx2(x, y, size) :
+    equalDefault(x, y, size);
+}
+
+// isWhitespace(codePoint) - The code points with the White_Space property.
+bool TextKernel::isWhitespace(char32_t codePoint) {
+  if (codePoint < 0x80) {
+    return codePoint == ' ' || (codePoint >= '\t' && codePoint <= '\r');
+  }
+  return codePoint == 0x85 || codePoint == 0xA0 || codePoint == 0x1680 ||
+    (codePoint >= 0x2000 && codePoint <= 0x200A) || codePoint == 0x2028 ||
+    codePoint == 0x2029 || codePoint == 0x202F || codePoint == 0x205F ||
+    codePoint == 0x3000;
+}
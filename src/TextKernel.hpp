@@ -0,0 +1,85 @@
+// File: src/TextKernel.hpp
+// Purpose: Header file for TextKernel, which has the loops that scan the bytes
+//  of text for Ropes (see src/Rope.hpp). See src/TextKernel.cpp for
+//  implementations.
+
+#ifndef TEXTKERNEL_HPP
+#define TEXTKERNEL_HPP
+
+#include <cstddef>
+#include <string>
+
+// TextKernel - The loops that search text, such as for the next line break of
+//  a String being split, go through its bytes in blocks of 32. Every byte of
+//  a block is checked with the same branch-free test and the results are
+//  combined, which the compiler vectorizes, and only a block where some byte
+//  matched is searched one byte at a time. Like the loops of NumericKernel
+//  (see src/NumericKernel.hpp), each has a copy compiled for AVX2, which
+//  tests 32 bytes per instruction, that runs on processors that have it.
+//  The scans for whitespace classify ASCII bytes exactly, and stop at every
+//  byte of 0x80 or more, which may belong to a character that is not ASCII,
+//  for the callers to decode and classify themselves.
+class TextKernel {
+public:
+  // static find(bytes, size, needle) - Returns the position of the first
+  //  occurrence of needle, which must not be empty, in the size bytes, or size
+  //  if there is none.
+  static std::size_t find(const char *bytes, std::size_t size,
+    const std::string &needle);
+
+  // static asciiLength(bytes, size) - Returns the number of bytes before the
+  //  first one that is not ASCII, or size if they all are.
+  static std::size_t asciiLength(const char *bytes, std::size_t size);
+
+  // static findSpace(bytes, size) - Returns the position of the first byte
+  //  that is ASCII whitespace or not ASCII, or size if there is none.
+  static std::size_t findSpace(const char *bytes, std::size_t size);
+
+  // static skipSpaces(bytes, size) - Returns the position of the first byte
+  //  that is not ASCII whitespace, or size if there is none.
+  static std::size_t skipSpaces(const char *bytes, std::size_t size);
+
+  // static countCodePoints(bytes, size) - Returns the number of code points
+  //  in the size bytes of valid UTF-8, which is the number of bytes that do
+  //  not continue a sequence.
+  static std::size_t countCodePoints(const char *bytes, std::size_t size);
+
+  // static equal(x, y, size) - Returns whether the size bytes at x and the
+  //  size bytes at y are the same.
+  static bool equal(const char *x, const char *y, std::size_t size);
+
+  // static isWhitespace(codePoint) - Returns whether codePoint is Unicode
+  //  whitespace, such as a space, a tab, a line break or U+00A0 (a
+  //  non-breaking space).
+  static bool isWhitespace(char32_t codePoint);
+
+private:
+  // The number of bytes tested at once.
+  static constexpr std::size_t blockBytes = 32;
+
+  // The tests that a scan can look for the first byte passing.
+  enum class Scan { Byte, NotAscii, Space, NotSpace };
+
+  // Private methods are documented in src/TextKernel.cpp.
+  template <Scan scan>
+  static unsigned char passes(unsigned char c, unsigned char byte);
+  template <Scan scan>
+  static std::size_t scanBlocks(const char *bytes, std::size_t size,
+    char byte);
+  template <Scan scan>
+  static std::size_t scanAvx2(const char *bytes, std::size_t size, char byte);
+  template <Scan scan>
+  static std::size_t scanDefault(const char *bytes, std::size_t size,
+    char byte);
+  template <Scan scan>
+  static std::size_t scanFor(const char *bytes, std::size_t size,
+    char byte = 0);
+  static std::size_t countBlocks(const char *bytes, std::size_t size);
+  static std::size_t countAvx2(const char *bytes, std::size_t size);
+  static std::size_t countDefault(const char *bytes, std::size_t size);
+  static bool equalBlocks(const char *x, const char *y, std::size_t size);
+  static bool equalAvx2(const char *x, const char *y, std::size_t size);
+  static bool equalDefault(const char *x, const char *y, std::size_t size);
+};
+
+#endif
@@ -0,0 +1,203 @@
+// File: src/ThunkValue.cpp
+// Purpose: Source file for ThunkValues, which stand for code whose Value is
+//  not needed yet. See src/ThunkValue.hpp for more documentation.
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "ThunkValue.hpp"
+#include "Context.hpp"
+#include "Error.hpp"
+#include "Evacuation.hpp"
+#include "Evaluator.hpp"
+#include "Region.hpp"
+#include "TokenTree.hpp"
+#include "Value.hpp"
+
+// Constructors
+ThunkValue::ThunkValue(const std::shared_ptr<const TokenTree> &tree,
+  const Context::Pointer &context): tree { tree }, context { context },
+  evaluating { false } {}
+ThunkValue::ThunkValue(const Value::Pointer &value): value { value },
+  evaluating { false } {}
+
+thread_local std::vector<Context::Pointer> ThunkValue::released {};
+thread_local std::vector<Value::Pointer> ThunkValue::releasedValues {};
+thread_local bool ThunkValue::releasing = false;
+
+// Destructor - Only the outermost destructor releases Contexts and Values.
+//  Releasing one may destroy other ThunkValues, whose Contexts and Values are
+//  added to the lists.
+ThunkValue::~ThunkValue() {
+  if (!context && !value) {
+    return;
+  }
+  if (context) {
+    released.push_back(std::move(context));
+  }
+  if (value) {
+    releasedValues.push_back(std::move(value));
+  }
+  if (releasing) {
+    return;
+  }
+  releasing = true;
+  while (!released.empty() || !releasedValues.empty()) {
+    if (!released.empty()) {
+      const Context::Pointer next { std::move(released.back()) };
+      released.pop_back();
+    }
+    else {
+      const Value::Pointer next { std::move(releasedValues.back()) };
+      releasedValues.pop_back();
+    }
+  }
+  releasing = false;
+}
+
+// delay(tree, context) - A tree that the pointer does not own (which has a use
+//  count of zero) belongs to code that may be gone by the time the ThunkValue
+//  is evaluated, so it is copied.
+std::shared_ptr<ThunkValue> ThunkValue::delay(
+  const std::shared_ptr<const TokenTree> &tree,
+  const Context::Pointer &context) {
+  return Region::make<ThunkValue>(tree.use_count() > 0 ? tree :
+    std::make_shared<const TokenTree>(*tree), context);
+}
+
+// getValue() - Returns the Value of the code, if known.
+const Value::Pointer &ThunkValue::getValue() const {
+  return value;
+}
+
+// begin() - Hands out the code unless it is already being evaluated.
+std::optional<ThunkValue::Code> ThunkValue::begin() const {
+  if (evaluating) {
+    return {};
+  }
+  evaluating = true;
+  return { Code { tree, context } };
+}
+
+// finish(result) - Keeps result and lets go of the code and its Context, which
+//  may be much larger than result. A ThunkValue outside the current Region
+//  may outlive it, so result may escape the Region.
+void ThunkValue::finish(const Value::Pointer &result) const {
+  value = result;
+  tree = nullptr;
+  context = Context::Pointer {};
+  evaluating = false;
+  const Region::Pointer region = Region::current();
+  if (region && !region->contains(this)) {
+    Evacuation::escape(weak_from_this());
+  }
+}
+
+// abandon() - Allows the code to be evaluated again.
+void ThunkValue::abandon() const {
+  evaluating = false;
+}
+
+// evacuate(evacuation) - The original is kept alive by the Evacuation until
+//  the copy has been filled in.
+Value::Pointer ThunkValue::evacuate(Evacuation &evacuation) const {
+  const auto copy = std::make_shared<ThunkValue>(Value::Pointer {});
+  evacuation.later([this, copy, &evacuation] {
+    copy->evacuateFrom(*this, evacuation);
+  });
+  return copy;
+}
+
+// evacuateHeld(evacuation) - Evacuates in place.
+void ThunkValue::evacuateHeld(Evacuation &evacuation) const {
+  evacuateFrom(*this, evacuation);
+}
+
+// evacuateFrom(thunk, evacuation) - Holds the evacuated copies of what thunk
+//  holds (which may be this ThunkValue itself).
+void ThunkValue::evacuateFrom(const ThunkValue &thunk,
+  Evacuation &evacuation) const {
+  value = evacuation.value(thunk.value);
+  tree = evacuation.tree(thunk.tree);
+  context = evacuation.context(thunk.context);
+}
+
+void ThunkValue::release() const {
+  value = nullptr;
+  tree = nullptr;
+  context = Context::Pointer {};
+}
+
+// force() - Evaluates the code with a separate Evaluator. The code was already
+//  optimized along with the code containing it.
+Value::OrError ThunkValue::force() const {
+  if (value) {
+    return { value };
+  }
+  const auto &code = begin();
+  if (!code) {
+    return { Error { Error::Code::Circular } };
+  }
+  const Value::OrError result =
+    Evaluator::evaluateIn(*code->tree, code->context);
+  if (std::holds_alternative<Error>(result)) {
+    abandon();
+    return result;
+  }
+  finish(*std::get_if<Value::Pointer>(&result));
+  return result;
+}
+
+// forced(value) - Forces value if it is a ThunkValue.
+Value::OrError ThunkValue::forced(const Value::Pointer &value) {
+  if (!value->isThunk()) {
+    return { value };
+  }
+  return static_cast<const ThunkValue &>(*value).force();
+}
+
+// wrapped(value) - Wraps value unless it already is a ThunkValue.
+Value::Pointer ThunkValue::wrapped(const Value::Pointer &value) {
+  if (value->isThunk()) {
+    return value;
+  }
+  return Value::Pointer { Region::make<ThunkValue>(value) };
+}
+
+// isThunk() - Every ThunkValue is a ThunkValue.
+bool ThunkValue::isThunk() const {
+  return true;
+}
+
+// getStrictness() - Nothing is known about code that has not been evaluated.
+std::vector<bool> ThunkValue::getStrictness() const {
+  return value ? value->getStrictness() : std::vector<bool> {};
+}
+
+// call(arg) - Calls the Value that the ThunkValue stands for.
+Value::OrError ThunkValue::call(Value::Pointer arg) const {
+  const Value::OrError &function = force();
+  if (std::holds_alternative<Error>(function)) {
+    return function;
+  }
+  return (*std::get_if<Value::Pointer>(&function))->call(std::move(arg));
+}
+
+// operator string() - Shows the Value if it is known.
+ThunkValue::operator std::string() const {
+  return value ? static_cast<std::string>(*value) : std::string { "<Thunk>" };
+}
+
+const std::string ThunkValue::name { "Thunk" };
+
+// getName() - Returns "Thunk", the name of the Thunk type.
+std::string ThunkValue::getName() const {
+  return ThunkValue::name;
+}
+
+std::string ThunkValue::getClassName() {
+  return ThunkValue::name;
+}
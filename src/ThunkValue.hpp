@@ -0,0 +1,143 @@
+// File: src/ThunkValue.hpp
+// Purpose: Header file for ThunkValues, which stand for code whose Value is
+//  not needed yet. See src/ThunkValue.cpp for implementations.
+
+#ifndef THUNKVALUE_HPP
+#define THUNKVALUE_HPP
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Context.hpp"
+#include "TokenTree.hpp"
+#include "Value.hpp"
+
+// ThunkValue - Holds code and the Context to evaluate it in until its Value is
+//  needed, which makes arguments and definitions lazy (call-by-need): code
+//  that is never used is never evaluated, and code that is used is evaluated
+//  at most once. Once evaluated, a ThunkValue holds only the Value of its code
+//  and lets go of the code and the Context.
+//  ThunkValues are only stored in Contexts. The Evaluator evaluates them on its
+//  own stacks when they are looked up (see Evaluator::run), so everything but
+//  the functions that take a ThunkValue parameter (such as `=`) sees only the
+//  Values they stand for. Native code that finds a ThunkValue elsewhere can
+//  use force().
+class ThunkValue final: public Value,
+  public std::enable_shared_from_this<ThunkValue> {
+public:
+  // The code and Context of a ThunkValue that is being evaluated.
+  struct Code {
+    std::shared_ptr<const TokenTree> tree;
+    Context::Pointer context;
+  };
+
+private:
+  // Evaluating the code does not change what the ThunkValue stands for, so
+  //  the state of the evaluation can change even if the ThunkValue is const.
+  mutable std::shared_ptr<const TokenTree> tree;
+  mutable Context::Pointer context;
+  mutable Value::Pointer value;
+  mutable bool evaluating;
+
+  // The Contexts and Values left to release by the destructor that is
+  //  releasing them.
+  static thread_local std::vector<Context::Pointer> released;
+  static thread_local std::vector<Value::Pointer> releasedValues;
+  static thread_local bool releasing;
+
+  // Private methods are documented in src/ThunkValue.cpp.
+  void evacuateFrom(const ThunkValue &thunk, Evacuation &evacuation) const;
+
+public:
+  // Constructor(tree, context) - Creates a ThunkValue standing for the Value of
+  //  tree in context. tree must be owned by the pointer (not merely referred
+  //  to), since the ThunkValue may outlive the code that created it.
+  ThunkValue(const std::shared_ptr<const TokenTree> &tree,
+    const Context::Pointer &context);
+
+  // Constructor(value) - Creates a ThunkValue that already holds value.
+  ThunkValue(const Value::Pointer &value);
+
+  // Destructor - Releases the Context of a ThunkValue that was never
+  //  evaluated, or the Value of one that was. Such a Context may hold another
+  //  such ThunkValue, and so on (as with an argument that is only ever added
+  //  to), and so may such a Value (as the tail of a long sequence built with
+  //  `:` does), so the chain is released in a loop rather than by nested
+  //  destructors.
+  ~ThunkValue();
+
+  // static delay(tree, context) - Returns a ThunkValue standing for the Value
+  //  of tree in context. If tree is only referred to by the pointer, the
+  //  ThunkValue keeps a copy of it (which shares its subtrees).
+  static std::shared_ptr<ThunkValue> delay(
+    const std::shared_ptr<const TokenTree> &tree,
+    const Context::Pointer &context);
+
+  // getValue() - Returns the Value of the code if it has been evaluated, or
+  //  nullptr otherwise.
+  const Value::Pointer &getValue() const;
+
+  // begin() - Returns the code to evaluate and marks the ThunkValue as being
+  //  evaluated, or returns an empty optional if it already is (which means
+  //  that its Value depends on itself). Must not be called once the Value is
+  //  known.
+  std::optional<Code> begin() const;
+
+  // finish(result) - Stores result as the Value of the code.
+  void finish(const Value::Pointer &result) const;
+
+  // abandon() - Marks the ThunkValue as no longer being evaluated, after its
+  //  code resulted in an error. The code is evaluated again if the Value is
+  //  needed again.
+  void abandon() const;
+
+  // evacuate(evacuation) - Returns a ThunkValue that holds the evacuated
+  //  Value, or the evacuated code and Context, of this one (see
+  //  src/Evacuation.hpp). Since those may hold the ThunkValue itself, the
+  //  copy is filled in later.
+  Value::Pointer evacuate(Evacuation &evacuation) const;
+
+  // evacuateHeld(evacuation) - Replaces the Value, or the code and Context,
+  //  of the ThunkValue by their evacuated copies. Used for a ThunkValue that
+  //  is not in the Region being evacuated but was finished while it was
+  //  current.
+  void evacuateHeld(Evacuation &evacuation) const;
+
+  // release() - Lets go of the Value, or the code and Context, of a
+  //  ThunkValue that has been evacuated (see Evacuation::release).
+  void release() const;
+
+  // force() - Returns the Value of the code, evaluating it if necessary (see
+  //  Evaluator::evaluateIn).
+  Value::OrError force() const;
+
+  // static forced(value) - Returns value, or the Value that it stands for if it
+  //  is a ThunkValue.
+  static Value::OrError forced(const Value::Pointer &value);
+
+  // static wrapped(value) - Returns value if it is a ThunkValue, or a
+  //  ThunkValue that already holds value otherwise.
+  static Value::Pointer wrapped(const Value::Pointer &value);
+
+  // isThunk() - Returns true.
+  bool isThunk() const;
+
+  // getStrictness() - Returns the strictness signature of the Value of the
+  //  code if it has been evaluated, or an empty signature otherwise.
+  std::vector<bool> getStrictness() const;
+
+  // call(arg) - Calls the Value of the code with arg.
+  Value::OrError call(Value::Pointer arg) const;
+
+  // operator string() - Returns the string representation of the Value of the
+  //  code, or "<Thunk>" if the code has not been evaluated.
+  operator std::string() const;
+
+  // name/getName() - Returns "Thunk", the name of a ThunkValue-type value.
+  static const std::string name;
+  static std::string getClassName();
+  std::string getName() const;
+};
+
+#endif
@@ -219,7 +219,8 @@ std::string TokenStream::takeString() {
   while (index < code.length()) {
     c = code.at(index);
     if (c == '\\') {
-      takeEscape();
+      takeEscape(); // Which moves past both characters of the escape
+      continue;
     }
     else if (c == quoteType) {
       lastWasQuote = true;
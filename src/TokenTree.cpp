@@ -6,6 +6,7 @@
 //  such as the first argument in `(+ 3)`. For more documentation, see
 //  src/TokenTree.hpp.
 
+#include <cstddef>
 #include <memory>
 #include <optional>
 #include <stack>
@@ -33,6 +34,58 @@ TokenTree::TokenTree(const TokenTree::LineList &lines):
 
 TokenTree::TokenTree(): data { std::monostate {} } {}
 
+TokenTree::TokenTree(const std::shared_ptr<Value> &value,
+  const TokenTree::TreePointer &original):
+  data { TokenTree::Constant { value, original } } {}
+
+// A Binding keeps the call it stands for, ((-> name) body) value, so that it
+//  can be looked through like a Constant.
+TokenTree::TokenTree(const std::string &name,
+  const TokenTree::TreePointer &value, const TokenTree::TreePointer &body,
+  bool strict): data { TokenTree::Binding { name, value, body,
+    std::make_shared<TokenTree>(std::make_shared<TokenTree>(
+      std::make_shared<TokenTree>(
+        std::make_shared<TokenTree>(Token { "->", Token::Type::Operator }),
+        std::make_shared<TokenTree>(Token { name, Token::Type::Identifier })
+      ), body
+    ), value), strict
+  } } {}
+
+// The destructor takes the subtrees that only this TokenTree refers to out of
+//  it and releases them one after another, taking their own subtrees out of
+//  them first, rather than letting each subtree destroy its own subtrees
+//  recursively. This way, very deep TokenTrees do not run out of stack.
+TokenTree::~TokenTree() {
+  std::vector<TreePointer> pending;
+  const auto takeSubtrees = [&pending](TokenTree &tree) {
+    if (auto pair = std::get_if<TokenTree::FunctionPair>(&tree.data)) {
+      pending.push_back(std::move(pair->first));
+      pending.push_back(std::move(pair->second));
+    }
+    else if (auto lines = std::get_if<TokenTree::LineList>(&tree.data)) {
+      for (auto &subtree : *lines) {
+        pending.push_back(std::move(subtree));
+      }
+    }
+    else if (auto constant = std::get_if<TokenTree::Constant>(&tree.data)) {
+      pending.push_back(std::move(constant->original));
+    }
+    else if (auto binding = std::get_if<TokenTree::Binding>(&tree.data)) {
+      pending.push_back(std::move(binding->value));
+      pending.push_back(std::move(binding->body));
+      pending.push_back(std::move(binding->original));
+    }
+  };
+  takeSubtrees(*this);
+  while (!pending.empty()) {
+    TreePointer tree = std::move(pending.back());
+    pending.pop_back();
+    if (tree.use_count() == 1) {
+      takeSubtrees(*tree);
+    }
+  }
+}
+
 // The table of precedences for each operator. Precedences cannot be changed
 //  during parsing.
 // *Nothing* should have a precedence less than 0, since that is reserved for
@@ -43,25 +96,41 @@ std::unordered_map<std::string, int> TokenTree::precedences = {
   { ".", 100},
   { ":", 90 },
   { "^", 80 },
+  { "**", 80 },
   { "*", 70 },
   { "/", 70 },
+  { "//", 70 },
   { "%", 70 },
   // Default precedence = 60
   { "+", 50 },
   { "++",50 },
   { "-", 50 },
+  { "..<", 45 },
+  { "..<=", 45 },
+  { "<", 42 },
+  { "<=", 42 },
+  { ">", 42 },
+  { ">=", 42 },
+  { "==", 42 },
+  { "!=", 42 },
   { "&", 40 },
   { "|", 40 },
+  { "|>", 35 },
   { "$", 30 },
   { ",", 20 },
   { ";", 10 },
+  { "->", 5 },
   { "=", 0  }
 };
 
 // The table of associativities for each operator. They default to being left-
-//  associative (a value of `true`). Only `^` is right-associative right now.
+//  associative (a value of `true`). Only `^`, `**`, `:` and `->` are
+//  right-associative right now.
 std::unordered_map<std::string, bool> TokenTree::associativities {
-  { "^", false }
+  { "^", false },
+  { "**", false },
+  { ":", false },
+  { "->", false }
 };
 bool TokenTree::defaultAssociativity = true; // Left-associative
 
@@ -86,6 +155,7 @@ bool TokenTree::getAssociativity(std::string op) {
 // This function returns an optional that contains a Token iff this TokenTree
 //  is a leaf (i.e. it contains only one Token).
 std::optional<Token> TokenTree::getToken() const {
+  const auto &data = unfolded().data;
   if (std::holds_alternative<Token>(data)) {
     return { *std::get_if<Token>(&data) };
   }
@@ -97,6 +167,7 @@ std::optional<Token> TokenTree::getToken() const {
 std::optional<
   std::pair<TokenTree, TokenTree>
 > TokenTree::getFunctionPair() const {
+  const auto &data = unfolded().data;
   if (std::holds_alternative<TokenTree::FunctionPair>(data)) {
     const auto &pair = *std::get_if<TokenTree::FunctionPair>(&data);
     if (pair.first && pair.second) {
@@ -110,6 +181,7 @@ std::optional<
 // This function returns an optional that contains a vector of TokenTrees iff
 //  this TokenTree is a list of lines of code.
 std::optional<std::vector<TokenTree>> TokenTree::getLineList() const {
+  const auto &data = unfolded().data;
   if (std::holds_alternative<TokenTree::LineList>(data)) {
     const auto &list = *std::get_if<TokenTree::LineList>(&data);
     std::vector<TokenTree> lines;
@@ -126,10 +198,46 @@ std::optional<std::vector<TokenTree>> TokenTree::getLineList() const {
   return {};
 }
 
+// These functions return a pointer to the contents of this TokenTree (or of
+//  the TokenTree a Constant or Binding stands for) if it holds the respective
+//  alternative, without copying anything.
+const Token *TokenTree::getTokenPointer() const {
+  return std::get_if<Token>(&unfolded().data);
+}
+
+const TokenTree::FunctionPair *TokenTree::getFunctionPairPointer() const {
+  return std::get_if<TokenTree::FunctionPair>(&unfolded().data);
+}
+
+const TokenTree::LineList *TokenTree::getLineListPointer() const {
+  return std::get_if<TokenTree::LineList>(&unfolded().data);
+}
+
+const TokenTree::Constant *TokenTree::getConstantPointer() const {
+  return std::get_if<TokenTree::Constant>(&data);
+}
+
+const TokenTree::Binding *TokenTree::getBindingPointer() const {
+  return std::get_if<TokenTree::Binding>(&data);
+}
+
+// This function returns the TokenTree that a Constant was created from or that
+//  a Binding stands for. Since neither is itself a Constant or a Binding, it
+//  never needs to look further than one level.
+const TokenTree &TokenTree::unfolded() const {
+  if (const auto constant = std::get_if<TokenTree::Constant>(&data)) {
+    return *constant->original;
+  }
+  if (const auto binding = std::get_if<TokenTree::Binding>(&data)) {
+    return *binding->original;
+  }
+  return *this;
+}
+
 // This function returns a boolean indicating whether this TokenTree represents
 //  an implied argument to a function.
 bool TokenTree::isImplied() const {
-  return std::holds_alternative<std::monostate>(data);
+  return std::holds_alternative<std::monostate>(unfolded().data);
 }
 
 // This operator returns a boolean indicating whether this TokenTree is
@@ -205,6 +313,70 @@ TokenTree::operator std::string() const {
   return "<implied>";
 }
 
+// This function returns the elements `e1, e2, ...` separated by commas in
+//  contents, in order, or only contents if it has no commas. Since `,` is
+//  left-associative, the contents are ((, ((, e1) e2)) e3), and the last
+//  element is found first.
+std::vector<TokenTree::TreePointer> TokenTree::commaSeparated(
+  const TreePointer &contents) {
+  std::vector<TreePointer> elements;
+  TreePointer rest = contents;
+  while (true) {
+    const auto pair = rest->getFunctionPairPointer();
+    const auto call = pair ? pair->first->getFunctionPairPointer() : nullptr;
+    const auto op = call ? call->first->getTokenPointer() : nullptr;
+    if (!op || op->getType() != Token::Type::Operator ||
+      op->getValue() != ",") {
+      break;
+    }
+    elements.push_back(pair->second);
+    rest = call->second;
+  }
+  elements.push_back(rest);
+  return { elements.rbegin(), elements.rend() };
+}
+
+// This function returns the tree of `e1 [:] e2 [:] ... [:] []` for the
+//  contents `e1, e2, ...` of a list literal, so that `[1, 2, 3]` is built by
+//  the builtins `[:]` and `[]`. Unlike `:`, which takes its second argument
+//  lazily, `[:]` cannot be written in Fleet code, and always gives a list.
+TokenTree::TreePointer TokenTree::listOf(const TreePointer &contents) {
+  const std::vector<TreePointer> &elements = commaSeparated(contents);
+  TreePointer list { new TokenTree { Token { "[]", Token::Type::Operator } } };
+  for (std::size_t i = elements.size(); i-- > 0; ) {
+    const TreePointer prepend { new TokenTree {
+      TreePointer { new TokenTree { Token { "[:]", Token::Type::Operator } } },
+      elements[i]
+    } };
+    list = TreePointer { new TokenTree { prepend, list } };
+  }
+  return list;
+}
+
+// This function returns the tree of a tuple literal `(e1, e2, ...)` with the
+//  given contents, or contents itself if it is a single expression in
+//  parentheses. The first two elements are paired by the builtin `(,)` and
+//  each element after them is added by the builtin `(,+)`, as in
+//  ((,+) ((,) e1 e2) e3). Unlike `,`, neither can be written in Fleet code, so
+//  a tuple nested in another, as in `((a, b), c)`, stays a separate element.
+TokenTree::TreePointer TokenTree::tupleOf(const TreePointer &contents) {
+  const std::vector<TreePointer> &elements = commaSeparated(contents);
+  if (elements.size() < 2) {
+    return contents;
+  }
+  TreePointer tuple = elements[0];
+  for (std::size_t i = 1; i < elements.size(); i++) {
+    const TreePointer add { new TokenTree {
+      TreePointer { new TokenTree {
+        Token { i == 1 ? "(,)" : "(,+)", Token::Type::Operator }
+      } },
+      tuple
+    } };
+    tuple = TreePointer { new TokenTree { add, elements[i] } };
+  }
+  return tuple;
+}
+
 // This function constructs a TokenTree from a given TokenStream. It uses a form
 //  of the shunting-yard algorithm for operator precedence parsing modified to
 //  parse Fleet-style function calls (i.e. function calls of the form `f x`).
@@ -212,6 +384,11 @@ TokenTree TokenTree::build(TokenStream stream) {
   std::stack<std::tuple<Token, int, bool>> operatorStack;
   std::stack<bool> lastWasNonOperatorStack;
   lastWasNonOperatorStack.push(false);
+  // The size of the output queue when each grouping was entered, so that an
+  //  operator can tell whether it is the first Token of its grouping, as in
+  //  the implied first argument of `map (* 2)`.
+  std::stack<std::size_t> groupStarts;
+  groupStarts.push(0);
 
   TokenTree::LineList lines {};
   TokenTree::LineList outputQueue {};
@@ -251,6 +428,7 @@ TokenTree TokenTree::build(TokenStream stream) {
           //  operator stack and enter a new layer of parsing.
           operatorStack.push({ next, 0, false });
           lastWasNonOperatorStack.push(false);
+          groupStarts.push(outputQueue.size());
         }
         else {
           // If the stream Token is ), ], or }, apply operators from the
@@ -280,15 +458,15 @@ TokenTree TokenTree::build(TokenStream stream) {
               //  queue.
               // Otherwise, push the operator with two arguments applied onto
               //  the output queue.
-              if (outputQueue.empty()) {
+              if (outputQueue.size() == groupStarts.top()) {
                 outputQueue.emplace_back(new TokenTree { t });
               }
-              else if (outputQueue.size() == 1 &&
+              else if (outputQueue.size() == groupStarts.top() + 1 &&
                        outputQueue.back()->isImplied()) {
                 outputQueue.pop_back();
                 outputQueue.emplace_back(new TokenTree { t });
               }
-              else if (outputQueue.size() == 1) {
+              else if (outputQueue.size() == groupStarts.top() + 1) {
                 const auto lastArg = outputQueue.back();
                 TokenTree::TreePointer firstArg { new TokenTree { t }};
                 outputQueue.pop_back();
@@ -316,7 +494,25 @@ TokenTree TokenTree::build(TokenStream stream) {
           if (!grouperWasClosed) {
             throw ParseError("Unmatched " + next.getValue());
           }
+          // The contents of brackets are a list literal (see listOf), and
+          //  empty brackets are the empty list. Parentheses around contents
+          //  separated by commas are a tuple literal (see tupleOf).
+          if (next.getValue() == "]") {
+            if (outputQueue.size() == groupStarts.top()) {
+              outputQueue.emplace_back(new TokenTree {
+                Token { "[]", Token::Type::Operator }
+              });
+            }
+            else {
+              outputQueue.back() = listOf(outputQueue.back());
+            }
+          }
+          else if (next.getValue() == ")" &&
+            outputQueue.size() != groupStarts.top()) {
+            outputQueue.back() = tupleOf(outputQueue.back());
+          }
           lastWasNonOperatorStack.pop();
+          groupStarts.pop();
           if (lastWasNonOperatorStack.top()) {
             if (outputQueue.empty()) {
               throw ParseError("Internal parsing error");
@@ -341,6 +537,9 @@ TokenTree TokenTree::build(TokenStream stream) {
           lastWasNonOperatorStack.pop();
         }
         lastWasNonOperatorStack.push(false);
+        while (groupStarts.size() > 1) {
+          groupStarts.pop();
+        }
         if (!outputQueue.empty() || !operatorStack.empty()) {
           Token t;
           while (!operatorStack.empty()) {
@@ -349,15 +548,15 @@ TokenTree TokenTree::build(TokenStream stream) {
             if (t.getType() == Token::Type::Grouper) {
               throw ParseError("Unmatched " + t.getValue());
             }
-            if (outputQueue.empty()) {
+            if (outputQueue.size() == groupStarts.top()) {
               outputQueue.emplace_back(new TokenTree { t });
             }
-            else if (outputQueue.size() == 1 &&
+            else if (outputQueue.size() == groupStarts.top() + 1 &&
                      outputQueue.back()->isImplied()) {
               outputQueue.pop_back();
               outputQueue.emplace_back(new TokenTree { t });
             }
-            else if (outputQueue.size() == 1) {
+            else if (outputQueue.size() == groupStarts.top() + 1) {
               const auto lastArg = outputQueue.back();
               TokenTree::TreePointer firstArg { new TokenTree { t }};
               outputQueue.pop_back();
@@ -389,13 +588,13 @@ TokenTree TokenTree::build(TokenStream stream) {
         }
         break;
       case Token::Type::Operator: {
-        // If an operator is encountered and the output queue is empty (i.e.
-        //  the operator is the first token encountered in this grouping), then
-        //  add an implied first argument.
+        // If an operator is encountered and the output queue has nothing from
+        //  this grouping (i.e. the operator is the first token encountered in
+        //  this grouping), then add an implied first argument.
         lastWasNonOperatorStack.top() = false;
         int precedence = getPrecedence(next.getValue());
         bool associativity = getAssociativity(next.getValue());
-        if (outputQueue.empty()) {
+        if (outputQueue.size() == groupStarts.top()) {
           outputQueue.emplace_back(new TokenTree {
             // An implied argument
           });
@@ -413,14 +612,15 @@ TokenTree TokenTree::build(TokenStream stream) {
         )) {
           Token poppedOperator = std::get<0>(operatorStack.top());
           operatorStack.pop();
-          if (outputQueue.empty()) {
+          if (outputQueue.size() == groupStarts.top()) {
             outputQueue.emplace_back(new TokenTree { poppedOperator });
           }
-          else if (outputQueue.size() == 1 && outputQueue.back()->isImplied()) {
+          else if (outputQueue.size() == groupStarts.top() + 1 &&
+            outputQueue.back()->isImplied()) {
             outputQueue.pop_back();
             outputQueue.emplace_back(new TokenTree { poppedOperator });
           }
-          else if (outputQueue.size() == 1) {
+          else if (outputQueue.size() == groupStarts.top() + 1) {
             const auto lastArg = outputQueue.back();
             TokenTree::TreePointer firstArg { new TokenTree {
               poppedOperator
@@ -465,14 +665,15 @@ TokenTree TokenTree::build(TokenStream stream) {
       if (t.getType() == Token::Type::Grouper) {
         throw ParseError("Unmatched " + t.getValue());
       }
-      if (outputQueue.size() == 0) {
+      if (outputQueue.size() == groupStarts.top()) {
         outputQueue.emplace_back(new TokenTree { t });
       }
-      else if (outputQueue.size() == 1 && outputQueue.back()->isImplied()) {
+      else if (outputQueue.size() == groupStarts.top() + 1 &&
+        outputQueue.back()->isImplied()) {
         outputQueue.pop_back();
         outputQueue.emplace_back(new TokenTree { t });
       }
-      else if (outputQueue.size() == 1) {
+      else if (outputQueue.size() == groupStarts.top() + 1) {
         const auto lastArg = outputQueue.back();
         TokenTree::TreePointer firstArg { new TokenTree { t }};
         outputQueue.pop_back();
@@ -9,6 +9,7 @@
 #ifndef TOKENTREE_HPP
 #define TOKENTREE_HPP
 
+#include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -20,6 +21,8 @@
 #include "TokenStream.hpp"
 #include "TokenTreeVisitor.hpp"
 
+class Value;
+
 class TokenTree {
 public:
 
@@ -29,6 +32,29 @@ public:
   typedef std::pair<TreePointer, TreePointer> FunctionPair;
   typedef std::vector<TreePointer> LineList;
 
+  // A Constant is a TokenTree that has already been evaluated (see
+  //  src/ConstantFolder.hpp). It keeps the TokenTree it was created from, and
+  //  it looks exactly like that TokenTree to everything but the Evaluator.
+  struct Constant {
+    std::shared_ptr<Value> value;
+    TreePointer original;
+  };
+
+  // A Binding is a TokenTree that evaluates body in a new Context layer in
+  //  which name is bound to the Value of value, just like the call
+  //  (name -> body) value but without creating the function (see
+  //  src/Inliner.hpp). It keeps that call as its original, and it looks
+  //  exactly like the call to everything but the Evaluator. value is only
+  //  evaluated once name is used, unless the Binding is strict, which means
+  //  that body always uses name (see src/StrictnessAnalyzer.hpp).
+  struct Binding {
+    std::string name;
+    TreePointer value;
+    TreePointer body;
+    TreePointer original;
+    bool strict;
+  };
+
 private:
   
   static std::unordered_map<std::string, int> precedences;
@@ -39,8 +65,14 @@ private:
 
   // The std::monostate alternative represents an implied argument - i.e.
   //  one in constructions like (+ 2), where the first argument to (+) is not
-  //  represented by a token.
-  const std::variant<Token, FunctionPair, LineList, std::monostate> data;
+  //  represented by a token. The data is only modified by the destructor.
+  std::variant<Token, FunctionPair, LineList, std::monostate, Constant,
+    Binding> data;
+
+  // Private methods are documented in src/TokenTree.cpp.
+  static std::vector<TreePointer> commaSeparated(const TreePointer &contents);
+  static TreePointer listOf(const TreePointer &contents);
+  static TreePointer tupleOf(const TreePointer &contents);
 
 public:
 
@@ -58,18 +90,39 @@ public:
   // Constructor() - Constructs an implied argument TokenTree.
   TokenTree();
 
+  // Constructor(value, original) - Constructs a Constant TokenTree that
+  //  evaluates to value, which must be what original evaluates to in any
+  //  Context it is used in.
+  TokenTree(const std::shared_ptr<Value> &value, const TreePointer &original);
+
+  // Constructor(name, value, body, strict) - Constructs a Binding TokenTree
+  //  that evaluates body with name bound to the Value of value, which is
+  //  evaluated first if strict is true.
+  TokenTree(const std::string &name, const TreePointer &value,
+    const TreePointer &body, bool strict = false);
+
+  // Copy constructor - Copies the TokenTree, sharing its subtrees.
+  TokenTree(const TokenTree &other) = default;
+
+  // Destructor - Destroys the TokenTree without recursing through deep
+  //  chains of subtrees.
+  ~TokenTree();
+
   // accept(v) - Following the visitor paradigm, calls the appropriate visit
   //  method on v based on the contents of this TokenTree. Returns the same
-  //  type as the visit method on v.
+  //  type as the visit method on v. Constants and Bindings are visited as the
+  //  TokenTrees they stand for.
   template <typename T>
   T accept(const TokenTreeVisitor<T> &v) const {
-    const auto &token = getToken();
-    if (token) {
+    if (&unfolded() != this) {
+      return unfolded().accept(v);
+    }
+    if (const auto token = getTokenPointer()) {
       return v.visit(*token);
     }
-    const auto &functionPair = getFunctionPair();
-    if (functionPair) {
-      return v.visit(functionPair->first, functionPair->second);
+    const auto functionPair = getFunctionPairPointer();
+    if (functionPair && functionPair->first && functionPair->second) {
+      return v.visit(*functionPair->first, *functionPair->second);
     }
     const auto &lineList = getLineList();
     if (lineList) {
@@ -92,6 +145,28 @@ public:
   //  number of lines.
   std::optional<std::vector<TokenTree>> getLineList() const;
 
+  // getTokenPointer(), getFunctionPairPointer(), getLineListPointer() - Return
+  //  a pointer to the contents of this TokenTree iff it contains a Token, a
+  //  function pair, or a number of lines respectively, or nullptr otherwise.
+  //  Unlike the methods above, these do not copy the contents. Like the
+  //  methods above, they look through Constants and Bindings.
+  const Token *getTokenPointer() const;
+  const FunctionPair *getFunctionPairPointer() const;
+  const LineList *getLineListPointer() const;
+
+  // getConstantPointer() - Returns a pointer to the contents of this TokenTree
+  //  iff it is a Constant, or nullptr otherwise. The methods above treat a
+  //  Constant as the TokenTree it was created from.
+  const Constant *getConstantPointer() const;
+
+  // getBindingPointer() - Returns a pointer to the contents of this TokenTree
+  //  iff it is a Binding, or nullptr otherwise.
+  const Binding *getBindingPointer() const;
+
+  // unfolded() - Returns the TokenTree that this TokenTree stands for if it is
+  //  a Constant or a Binding, or this TokenTree otherwise.
+  const TokenTree &unfolded() const;
+
   // isImplied() - Returns a boolean indicating whether this TokenTree is
   //  implied.
   bool isImplied() const;
@@ -0,0 +1,103 @@
+// File: src/TupleValue.cpp
+// Purpose: A TupleValue is a Value that holds a fixed number of Values, such
+//  as the result of `(x, y)` or of zip. For more documentation see
+//  src/TupleValue.hpp.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include "TupleValue.hpp"
+#include "Error.hpp"
+#include "Evacuation.hpp"
+#include "Value.hpp"
+
+// Constructors
+TupleValue::TupleValue(const Value::Pointer &first,
+  const Value::Pointer &second): count { 2 }, elements { first, second } {}
+
+// Constructor(tuple, last) - Copies the elements of tuple, which a tuple
+//  literal of more than two elements does once per element after the second.
+TupleValue::TupleValue(const TupleValue &tuple, const Value::Pointer &last):
+  count { tuple.count + 1 }, elements { tuple.elements }, rest { tuple.rest } {
+  if (tuple.count < inlineSize) {
+    elements[tuple.count] = last;
+  }
+  else {
+    rest.push_back(last);
+  }
+}
+
+std::size_t TupleValue::size() const {
+  return count;
+}
+
+const Value::Pointer &TupleValue::at(std::size_t index) const {
+  return index < inlineSize ? elements[index] : rest[index - inlineSize];
+}
+
+// hash() - Combines the hashes of the elements like ListValue::hash, but
+//  starting from a different seed, so that a tuple and the list of the same
+//  elements are unlikely to share a hash.
+std::optional<std::size_t> TupleValue::hash() const {
+  std::size_t hash = mixHash(~static_cast<std::uint64_t>(count));
+  for (std::size_t i = 0; i < count; i++) {
+    const std::optional<std::size_t> elementHash = at(i)->hash();
+    if (!elementHash) {
+      return {};
+    }
+    hash = combineHashes(hash, *elementHash);
+  }
+  return { hash };
+}
+
+bool TupleValue::equals(const Value &other) const {
+  const auto otherTuple = dynamic_cast<const TupleValue *>(&other);
+  if (!otherTuple || count != otherTuple->count) {
+    return false;
+  }
+  for (std::size_t i = 0; i < count; i++) {
+    if (!Value::equal(*at(i), *otherTuple->at(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// call([unused] arg) - Returns an error, since TupleValues cannot be called.
+Value::OrError TupleValue::call([[maybe_unused]] Value::Pointer arg) const {
+  return { Error { Error::Code::NotCallable, { &TupleValue::getClassName } } };
+}
+
+// evacuate(evacuation) - Evacuates the elements of a copy of the tuple in
+//  place. The inline slots past the last element are empty.
+Value::Pointer TupleValue::evacuate(Evacuation &evacuation) const {
+  const auto copy = std::make_shared<TupleValue>(*this);
+  for (Value::Pointer &element : copy->elements) {
+    element = evacuation.value(element);
+  }
+  for (Value::Pointer &element : copy->rest) {
+    element = evacuation.value(element);
+  }
+  return copy;
+}
+
+TupleValue::operator std::string() const {
+  std::string shown = "(";
+  for (std::size_t i = 0; i < count; i++) {
+    shown += (i == 0 ? "" : ", ") + static_cast<std::string>(*at(i));
+  }
+  return shown + ")";
+}
+
+const std::string TupleValue::name { "Tuple" };
+
+// getName() - Returns "Tuple", the name of the Tuple type.
+std::string TupleValue::getName() const {
+  return TupleValue::name;
+}
+
+std::string TupleValue::getClassName() {
+  return TupleValue::name;
+}
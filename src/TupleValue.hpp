@@ -0,0 +1,69 @@
+// File: src/TupleValue.hpp
+// Purpose: A TupleValue is a Value that holds a fixed number of Values, such
+//  as the result of `(x, y)` or of zip. For implementations see
+//  src/TupleValue.cpp.
+
+#ifndef TUPLEVALUE_HPP
+#define TUPLEVALUE_HPP
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Value.hpp"
+
+// TupleValue - An immutable tuple of two or more Values. The first inlineSize
+//  elements are held inside the TupleValue itself, so a pair (or any tuple of
+//  up to inlineSize elements) takes a single allocation, and reading an
+//  element is a load from the tuple rather than a walk down nested pairs.
+class TupleValue final: public Value {
+public:
+  // The number of elements held inline.
+  static constexpr std::size_t inlineSize = 4;
+
+private:
+  std::size_t count;
+  std::array<Value::Pointer, inlineSize> elements;
+
+  // The elements past the first inlineSize, of which there are usually none.
+  std::vector<Value::Pointer> rest;
+
+public:
+  // Constructor(first, second) - Creates the pair of first and second.
+  TupleValue(const Value::Pointer &first, const Value::Pointer &second);
+
+  // Constructor(tuple, last) - Creates the tuple of the elements of tuple
+  //  followed by last.
+  TupleValue(const TupleValue &tuple, const Value::Pointer &last);
+
+  // size() - Returns the number of elements.
+  std::size_t size() const;
+
+  // at(index) - Returns the element at index, which must be less than size().
+  const Value::Pointer &at(std::size_t index) const;
+
+  // hash() - Returns the hash of the elements in order, or nothing if an
+  //  element has none.
+  std::optional<std::size_t> hash() const;
+
+  // equals(other) - Returns whether other is a tuple of as many elements, each
+  //  equal to the element of this tuple at the same position.
+  bool equals(const Value &other) const;
+
+  // call(arg) - Returns an error, since TupleValues cannot be called.
+  Value::OrError call([[maybe_unused]] Value::Pointer arg) const;
+
+  // evacuate(evacuation) - Returns the tuple of the evacuated elements.
+  Value::Pointer evacuate(Evacuation &evacuation) const;
+
+  // operator string() - Returns the elements as in (x, y, ...).
+  operator std::string() const;
+
+  // name/getName() - Returns "Tuple", the name of a TupleValue-type value.
+  static const std::string name;
+  static std::string getClassName();
+  std::string getName() const;
+};
+
+#endif
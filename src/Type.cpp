@@ -5,6 +5,7 @@
 #include <optional>
 #include <variant>
 #include "Type.hpp"
+#include "Error.hpp"
 #include "Value.hpp"
 
 // Constructor(name, matches) - Creates a Type that simply uses a function to
@@ -19,9 +20,7 @@ Type::Type(std::string name, Type::UUIDMatcher matches, std::string uuid):
 
 // call(arg) - Returns an error, since Types cannot be called.
 Value::OrError Type::call([[maybe_unused]] Value::Pointer arg) const {
-  return { std::runtime_error {
-    std::string { "Value of Type " } + name + " cannot be called."
-  } };
+  return { Error { Error::Code::NotCallable, { &Type::getClassName } } };
 }
 
 // operator string() - Returns the name of the Type and its UUID if it exists.
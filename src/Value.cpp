@@ -2,19 +2,23 @@
 // Purpose: Source file for an abstract class from which all Fleet Values should
 //  inherit. Examples of Values include NumberValues, FunctionValues, etc.
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
-#include <stdexcept>
 #include <string>
 #include <variant>
+#include <vector>
 #include "Value.hpp"
+#include "Error.hpp"
 #include "Evaluator.hpp"
+#include "NumericKernel.hpp"
 #include "TokenTree.hpp"
 
 Value::OrError Value::call(const TokenTree &ast, const Evaluator *eval) const {
   // If the argument is not implied, evaluate the argument TokenTree.
   const Value::OrError &xValueOrErr = ast.accept(*eval);
-  if (std::holds_alternative<std::runtime_error>(xValueOrErr)) {
+  if (std::holds_alternative<Error>(xValueOrErr)) {
     return xValueOrErr;
   }
   const auto &xValue = *std::get_if<Value::Pointer>(&xValueOrErr);
@@ -22,6 +26,87 @@ Value::OrError Value::call(const TokenTree &ast, const Evaluator *eval) const {
   return call(xValue);
 }
 
+bool Value::quotesArgument() const {
+  return false;
+}
+
+bool Value::delaysArgument() const {
+  return false;
+}
+
+bool Value::isThunk() const {
+  return false;
+}
+
+std::vector<bool> Value::getStrictness() const {
+  return {};
+}
+
+bool Value::isPure() const {
+  return false;
+}
+
+const NumericKernel *Value::getNumericKernel() const {
+  return nullptr;
+}
+
+std::vector<NumericKernel> Value::getNumericKernels() const {
+  const NumericKernel *kernel = getNumericKernel();
+  if (!kernel) {
+    return {};
+  }
+  return { *kernel };
+}
+
+Value::Pointer Value::evacuate([[maybe_unused]] Evacuation &evacuation)
+  const {
+  return nullptr;
+}
+
+std::optional<std::size_t> Value::hash() const {
+  return {};
+}
+
+std::optional<std::size_t> Value::knownHash() const {
+  return {};
+}
+
+bool Value::equals([[maybe_unused]] const Value &other) const {
+  return false;
+}
+
+// equal(x, y) - Only compares hashes that are already known, since computing
+//  one takes as long as comparing the Values.
+bool Value::equal(const Value &x, const Value &y) {
+  if (&x == &y) {
+    return true;
+  }
+  const std::optional<std::size_t> xHash = x.knownHash();
+  if (xHash) {
+    const std::optional<std::size_t> yHash = y.knownHash();
+    if (yHash && *xHash != *yHash) {
+      return false;
+    }
+  }
+  return x.equals(y);
+}
+
+// mixHash(hash) - The finalizer of SplitMix64.
+std::size_t Value::mixHash(std::uint64_t hash) {
+  hash ^= hash >> 30;
+  hash *= 0xBF58476D1CE4E5B9;
+  hash ^= hash >> 27;
+  hash *= 0x94D049BB133111EB;
+  hash ^= hash >> 31;
+  return static_cast<std::size_t>(hash);
+}
+
+// combineHashes(seed, hash) - Mixes the hash before adding it, so that the
+//  order of the parts matters.
+std::size_t Value::combineHashes(std::size_t seed, std::size_t hash) {
+  return mixHash(seed * 0x9E3779B97F4A7C15 + hash);
+}
+
 const std::string Value::name { "Value" };
 
 std::string Value::getClassName() {
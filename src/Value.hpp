@@ -5,14 +5,19 @@
 #ifndef VALUE_HPP
 #define VALUE_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
-#include <stdexcept>
 #include <string>
 #include <variant>
+#include <vector>
+#include "Error.hpp"
 #include "TokenTree.hpp"
 
+class Evacuation;
 class Evaluator;
+class NumericKernel;
 
 class Value {
 public:
@@ -20,9 +25,9 @@ public:
   //  generic structures containing Values of unknown types.
   typedef std::shared_ptr<Value> Pointer;
 
-  // Value::OrError represents a runtime_error or a Value::Pointer. Useful for
+  // Value::OrError represents an Error or a Value::Pointer. Useful for
   //  return types of functions that may return Values or errors.
-  typedef std::variant<std::runtime_error, Pointer> OrError;
+  typedef std::variant<Error, Pointer> OrError;
   
   // castValue<T>() - Returns an optional, which contains a value of type T iff
   //  the Value is internally of that type.
@@ -50,6 +55,81 @@ public:
   virtual OrError call(Pointer arg) const = 0;
   virtual OrError call(const TokenTree &ast, const Evaluator *eval) const;
 
+  // virtual quotesArgument() - Returns a boolean indicating whether the Value
+  //  takes its argument unevaluated, as an IdentifierValue. This is false
+  //  unless overridden.
+  virtual bool quotesArgument() const;
+
+  // virtual delaysArgument() - Returns a boolean indicating whether the Value
+  //  takes its argument lazily, as a ThunkValue (see src/ThunkValue.hpp) that
+  //  is only evaluated if it is used. This is false unless overridden.
+  virtual bool delaysArgument() const;
+
+  // virtual isThunk() - Returns a boolean indicating whether the Value is a
+  //  ThunkValue, which stands for another Value. This is false unless
+  //  overridden.
+  virtual bool isThunk() const;
+
+  // virtual getStrictness() - Returns the strictness signature of the Value:
+  //  for each of the arguments that the Value can be called with in turn (as
+  //  in f x y), whether the call always needs the Value of that argument.
+  //  Arguments past the end of the signature may not be needed. This is empty
+  //  unless overridden.
+  virtual std::vector<bool> getStrictness() const;
+
+  // virtual isPure() - Returns a boolean indicating whether calling the Value
+  //  has no effects and gives a result that depends only on the argument, so
+  //  that calls of it with constant arguments can be evaluated ahead of time
+  //  (see src/ConstantFolder.hpp). This is false unless overridden.
+  virtual bool isPure() const;
+
+  // virtual getNumericKernel() - Returns the NumericKernel (see
+  //  src/NumericKernel.hpp) that calling the Value with a number is the same
+  //  as, or nullptr if there is none. This is nullptr unless overridden.
+  virtual const NumericKernel *getNumericKernel() const;
+
+  // virtual getNumericKernels() - Returns the NumericKernels that calling the
+  //  Value with a number is the same as applying in turn, or none if there
+  //  are no such NumericKernels. This is getNumericKernel, if any, unless
+  //  overridden.
+  virtual std::vector<NumericKernel> getNumericKernels() const;
+
+  // virtual evacuate(evacuation) - Returns a copy of the Value that is not in
+  //  the Region being evacuated, whose parts are evacuated as well (see
+  //  src/Evacuation.hpp), or nullptr if the Value cannot be copied. This is
+  //  nullptr unless overridden.
+  virtual Pointer evacuate(Evacuation &evacuation) const;
+
+  // virtual hash() - Returns the structural hash of the Value, which is the
+  //  same for any two Values that are equal (see equals), or nothing if the
+  //  Value is only ever equal to itself, as a function is. Compound Values
+  //  compute their hashes once and cache them. This is nothing unless
+  //  overridden.
+  virtual std::optional<std::size_t> hash() const;
+
+  // virtual knownHash() - Returns the hash of the Value if it is known without
+  //  computing it, such as a hash that has been cached, and nothing
+  //  otherwise. This is nothing unless overridden.
+  virtual std::optional<std::size_t> knownHash() const;
+
+  // virtual equals(other) - Returns whether the Value is structurally equal to
+  //  other, which is a different Value. Values of different types are never
+  //  equal, except for Ints and Floats. This is false unless overridden.
+  virtual bool equals(const Value &other) const;
+
+  // static equal(x, y) - Returns whether x and y are structurally equal. They
+  //  are if they are the same Value, and are not if both of their hashes are
+  //  known and differ; otherwise x.equals(y) decides.
+  static bool equal(const Value &x, const Value &y);
+
+  // static mixHash(hash) - Returns hash with its bits spread over all of it,
+  //  so that hashes that differ only in a few bits end up far apart.
+  static std::size_t mixHash(std::uint64_t hash);
+
+  // static combineHashes(seed, hash) - Returns the hash of a sequence whose
+  //  hash so far is seed followed by a part whose hash is hash.
+  static std::size_t combineHashes(std::size_t seed, std::size_t hash);
+
   // virtual getName() - Returns the name of the type (e.g. Number, String).
   virtual std::string getName() const = 0;
 
@@ -8,7 +8,11 @@
 #include <variant>
 #include <vector>
 #include "DefaultContext.hpp"
+#include "Directives.hpp"
+#include "Error.hpp"
 #include "Evaluator.hpp"
+#include "PassManager.hpp"
+#include "RuntimeStats.hpp"
 #include "TokenStream.hpp"
 #include "TokenTree.hpp"
 
@@ -24,13 +28,45 @@ std::vector<std::string> parseArguments(int argc, char **argv) {
 
 // main(argc, argv) - The entry point for the main Fleet executable.
 // Command line syntax:
-//  executable_name [--version | -c code | -t code ]
-//  --version - Prints the version of Fleet being used and the author's name.
-//  -c code   - Executes `code` and prints the result or an error.
-//  -t code   - Creates an AST of `code` and prints its string representation.
+//  executable_name [--version | [options] -c code | -t code ]
+//  --version     - Prints the version of Fleet being used and the author's
+//                  name.
+//  -c code       - Executes `code` and prints the result or an error.
+//  -t code       - Creates an AST of `code` and prints its string
+//                  representation.
+//  Options (for -c, in any order):
+//  --stats       - After executing code, prints runtime statistics (such as
+//                  the maximum stack depth reached and the functions inlined)
+//                  to standard error.
+//  --time-passes - After executing code, prints how long each optimization
+//                  pass took and how much it shrank the code to standard
+//                  error.
+//  -O0, -O1, -O2 - Selects the optimization level (see src/PassManager.hpp):
+//                  -O0 for code that runs only briefly, -O2 (the default) for
+//                  code that runs long enough to repay optimizing it. The
+//                  `no_optimize` directive always selects -O0.
 //  (With any other syntax, usage help is printed).
 int main(int argc, char **argv) {
   std::vector<std::string> arguments = parseArguments(argc, argv);
+  bool printStats = false;
+  bool timePasses = false;
+  int level = PassManager::defaultLevel;
+  while (arguments.size() >= 2) {
+    const std::string &option = arguments.at(1);
+    if (option == "--stats") {
+      printStats = true;
+    }
+    else if (option == "--time-passes") {
+      timePasses = true;
+    }
+    else if (option == "-O0" || option == "-O1" || option == "-O2") {
+      level = option.back() - '0';
+    }
+    else {
+      break;
+    }
+    arguments.erase(arguments.begin() + 1);
+  }
   if (arguments.size() == 2 && arguments.at(1) == "--version") {
     std::cout << "Fleet v0.0.1\nCreated by Thomas Smith\n";
     return 0;
@@ -38,8 +74,16 @@ int main(int argc, char **argv) {
   else if (arguments.size() == 3 && arguments.at(1) == "-c") {
     TokenStream tokens { arguments.at(2) };
     TokenTree tree = TokenTree::build(tokens);
+    const Directives directives { arguments.at(2) };
     Evaluator eval { Context::Pointer { new DefaultContext() } };
+    eval.setPasses(PassManager::forCode(level, directives));
     Value::OrError result = eval.evaluate(tree);
+    if (printStats) {
+      std::cerr << static_cast<std::string>(RuntimeStats::current());
+    }
+    if (timePasses) {
+      std::cerr << eval.getPasses().getTimingReport();
+    }
     if (std::holds_alternative<Value::Pointer>(result)) {
       std::cout << static_cast<std::string>(
         **std::get_if<Value::Pointer>(&result)
@@ -47,9 +91,12 @@ int main(int argc, char **argv) {
       return 0;
     }
     else {
-      std::cout << "Error: " << std::get_if<std::runtime_error>(
-        &result
-      )->what() << "\n";
+      const Error &error = *std::get_if<Error>(&result);
+      std::cout << "Error: " << error.getMessage() << "\n";
+      if (error.getSource()) {
+        std::cout << "  in " << static_cast<std::string>(*error.getSource())
+          << "\n";
+      }
       return 1;
     }
   }
@@ -63,7 +110,8 @@ int main(int argc, char **argv) {
       arguments.size() >= 1 ? arguments.at(0) : "<executable>"
     };
     std::cout << "Usage: " << executableName;
-    std::cout << " [--version] [-c code] [-t code]\n";
+    std::cout << " [--version] [[--stats] [--time-passes] [-O0|-O1|-O2] -c "
+      "code] [-t code]\n";
     return 1;
   }
 }
@@ -2,9 +2,11 @@
 #include <variant>
 #include "TestContext.hpp"
 #include "Context.hpp"
+#include "Error.hpp"
 #include "IdentifierValue.hpp"
 #include "NumberValue.hpp"
 #include "Tester.hpp"
+#include "ThunkValue.hpp"
 #include "Token.hpp"
 #include "Value.hpp"
 
@@ -18,6 +20,9 @@ void testNestedContext2();
 void testNestedContext3();
 void testIdentifierDefine();
 void testIdentifierDefineNested();
+void testCapture();
+void testCaptureUndefined();
+void testCaptureSealed();
 
 // This function calls all tests in this program and returns the number of
 //  failed tests.
@@ -31,6 +36,9 @@ int TestContext::main() {
   tester.test("Nested contexts 3", testNestedContext3);
   tester.test("Identifier define", testIdentifierDefine);
   tester.test("Identifier define nested", testIdentifierDefineNested);
+  tester.test("Capture", testCapture);
+  tester.test("Capture undefined", testCaptureUndefined);
+  tester.test("Capture sealed", testCaptureSealed);
   return tester.run();
 }
 
@@ -67,10 +75,10 @@ void testGetNonexistentValue() {
     }
   };
   Value::OrError result = context.getValue("nonexistent");
-  Tester::confirm(std::holds_alternative<std::runtime_error>(result));
+  Tester::confirm(std::holds_alternative<Error>(result));
 
   Value::OrError result2 = context.getValue("foo_");
-  Tester::confirm(std::holds_alternative<std::runtime_error>(result2));
+  Tester::confirm(std::holds_alternative<Error>(result2));
 }
 
 // This function tests that you can get two values from the same Context.
@@ -174,8 +182,61 @@ void testIdentifierDefineNested() {
   child.define(identifier2, value2);
   Tester::confirm(valuesEqual(root->getValue("blahblah___tau628"), value));
   Tester::confirm(valuesEqual(child.getValue("blahblah___tau628"), value));
-  Tester::confirm(std::holds_alternative<std::runtime_error>(root->getValue(
+  Tester::confirm(std::holds_alternative<Error>(root->getValue(
     "blahblah___notTau"
   )));
   Tester::confirm(valuesEqual(child.getValue("blahblah___notTau"), value2));
 }
+
+// This function tests that capturing identifiers copies only those identifiers
+//  into a Context without a parent.
+void testCapture() {
+  Value::Pointer value { new NumberValue { 1.0 } };
+  Value::Pointer value2 { new NumberValue { 2.0 } };
+  Context::Pointer root = new Context {
+    Context::ValueMap {
+      { "captured", value },
+      { "notCaptured", value2 }
+    }
+  };
+  Context::Pointer child = new Context { root };
+  Context::Pointer captured = Context::capture(child, { "captured" });
+  Tester::confirm(valuesEqual(captured->getValue("captured"), value));
+  Tester::confirm(std::holds_alternative<Error>(
+    captured->getValue("notCaptured")
+  ));
+  Tester::confirm(!captured->getParentContext());
+}
+
+// This function tests that identifiers that are not defined when they are
+//  captured can still be found once they are defined, without the captured
+//  Context keeping the Context they were captured from as its parent.
+void testCaptureUndefined() {
+  Value::Pointer value { new NumberValue { 3.0 } };
+  Context::Pointer root = new Context {};
+  Context::Pointer captured = Context::capture(root, { "definedLater" });
+  root->define("definedLater", value);
+  const auto &found = captured->getValue("definedLater");
+  Tester::confirm(std::holds_alternative<Value::Pointer>(found));
+  Tester::confirm(valuesEqual(
+    ThunkValue::forced(*std::get_if<Value::Pointer>(&found)), value
+  ));
+  Tester::confirm(!captured->getParentContext());
+}
+
+// This function tests that identifiers defined before a Context was sealed
+//  are found through that Context rather than copied.
+void testCaptureSealed() {
+  Value::Pointer value { new NumberValue { 4.0 } };
+  Value::Pointer value2 { new NumberValue { 5.0 } };
+  Context::Pointer root = new Context {};
+  root->define("sealed", value);
+  root->seal();
+  root->define("notSealed", value2);
+  Context::Pointer captured = Context::capture(root, { "sealed" });
+  Tester::confirm(&*captured->getParentContext() == &*root);
+  Tester::confirm(valuesEqual(captured->getValue("sealed"), value));
+  captured = Context::capture(root, { "notSealed" });
+  Tester::confirm(!captured->getParentContext());
+  Tester::confirm(valuesEqual(captured->getValue("notSealed"), value2));
+}
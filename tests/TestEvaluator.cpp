@@ -2,19 +2,40 @@
 // Purpose: Source file for the TestEvaluator test set.
 
 #include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
 #include <string>
+#include <utility>
 #include <variant>
+#include <vector>
 #include "TestEvaluator.hpp"
+#include "BooleanValue.hpp"
+#include "ConstantFolder.hpp"
 #include "Context.hpp"
+#include "Error.hpp"
 #include "DefaultContext.hpp"
+#include "Directives.hpp"
 #include "Evaluator.hpp"
+#include "FunctionValue.hpp"
+#include "Inliner.hpp"
+#include "MemoTable.hpp"
 #include "NumberValue.hpp"
+#include "ParseError.hpp"
+#include "PassManager.hpp"
+#include "Region.hpp"
+#include "RuntimeStats.hpp"
+#include "StrictnessAnalyzer.hpp"
 #include "Tester.hpp"
+#include "ThunkValue.hpp"
+#include "Token.hpp"
 #include "TokenTree.hpp"
 #include "Value.hpp"
 
 // Function prototypes
 bool evaluatesApproxTo(const Evaluator &eval, std::string code, double num);
+bool evaluatesShownAs(Evaluator &eval, std::string code, std::string shown);
 void testRawNumbers();
 void testWhitespace();
 void testAddition();
@@ -22,6 +43,33 @@ void testMultiplication();
 void testExponentiation();
 void testCombinedOperations();
 void testCombinedParens();
+void testRegionEvaluation();
+void testPartialApplication();
+void testFunctions();
+void testSubtraction();
+void testClauses();
+void testTailCalls();
+void testDeepEvaluation();
+void testErrors();
+void testConstantFolding();
+void testInlining();
+void testPassManager();
+void testMemoization();
+void testLaziness();
+void testStrictness();
+void testSequences();
+void testRanges();
+void testLists();
+void testNumericReductions();
+void testCompactLists();
+void testIntegers();
+void testStrings();
+void testStringKernels();
+void testBytes();
+void testMapsAndSets();
+void testEquality();
+void testTuples();
+void testTaggedValues();
 
 // main() - Runs all tests
 int TestEvaluator::main() {
@@ -33,6 +81,33 @@ int TestEvaluator::main() {
   tester.test("Test exponentiation", testExponentiation);
   tester.test("Test combined operations", testCombinedOperations);
   tester.test("Test operations and parentheses", testCombinedParens);
+  tester.test("Test region evaluation", testRegionEvaluation);
+  tester.test("Test partial application", testPartialApplication);
+  tester.test("Test functions", testFunctions);
+  tester.test("Test subtraction", testSubtraction);
+  tester.test("Test function clauses", testClauses);
+  tester.test("Test tail calls", testTailCalls);
+  tester.test("Test deep evaluation", testDeepEvaluation);
+  tester.test("Test errors", testErrors);
+  tester.test("Test constant folding", testConstantFolding);
+  tester.test("Test inlining", testInlining);
+  tester.test("Test pass manager", testPassManager);
+  tester.test("Test memoization", testMemoization);
+  tester.test("Test laziness", testLaziness);
+  tester.test("Test strictness", testStrictness);
+  tester.test("Test sequences", testSequences);
+  tester.test("Test ranges", testRanges);
+  tester.test("Test lists", testLists);
+  tester.test("Test numeric reductions", testNumericReductions);
+  tester.test("Test compact lists", testCompactLists);
+  tester.test("Test integers", testIntegers);
+  tester.test("Test strings", testStrings);
+  tester.test("Test string kernels", testStringKernels);
+  tester.test("Test bytes", testBytes);
+  tester.test("Test maps and sets", testMapsAndSets);
+  tester.test("Test equality", testEquality);
+  tester.test("Test tuples", testTuples);
+  tester.test("Test tagged values", testTaggedValues);
   return tester.run();
 }
 
@@ -53,6 +128,15 @@ bool evaluatesApproxTo(Evaluator &eval, std::string code, double num) {
   return std::abs(evaledNum->getRawNumber() - num) <= epsilon;
 }
 
+// evaluatesShownAs(eval, code, shown) - Returns a boolean indicating whether
+//  the string `code`, when evaluated in `eval`, evaluates to a Value shown as
+//  `shown`.
+bool evaluatesShownAs(Evaluator &eval, std::string code, std::string shown) {
+  const auto result = eval.evaluate(TokenTree::build({ code }));
+  return std::holds_alternative<Value::Pointer>(result) &&
+    static_cast<std::string>(**std::get_if<Value::Pointer>(&result)) == shown;
+}
+
 // testRawNumbers() - Tests that raw number strings evaluate to their respective
 //  doubles.
 void testRawNumbers() {
@@ -120,3 +204,1196 @@ void testCombinedParens() {
   Tester::confirm(evaluatesApproxTo(eval, "1^1^1^2^3*(5+1.1)^(2^0.01)",
     6.1772081531526535));
 }
+
+// testRegionEvaluation() - Tests that evaluating in region mode produces the
+//  same results, and that values defined during one evaluation remain valid in
+//  later evaluations.
+void testRegionEvaluation() {
+  Evaluator eval { new DefaultContext(), true };
+  Tester::confirm(evaluatesApproxTo(eval, "1 + 3 * 5", 16.0));
+  Tester::confirm(evaluatesApproxTo(eval, "3.1 ^ (1.1^(2*3)) + 4*(3+2)",
+    27.42125259322668));
+  Tester::confirm(evaluatesApproxTo(eval, "x = 2 * 21", 42.0));
+  Tester::confirm(evaluatesApproxTo(eval, "x + 0.5", 42.5));
+  Tester::confirm(!Region::current());
+
+  // Whatever outlives an evaluation is copied out of its Region, so the
+  //  Region is released once the evaluation is done. inRegion notes the
+  //  Region of the evaluation it is called in.
+  std::weak_ptr<Region> region;
+  const Value::Pointer inRegion { new FunctionValue<Value, Value> {
+    [&region](const std::shared_ptr<Value> &arg,
+      [[maybe_unused]] const Context::Pointer &ignored) ->
+      FunctionValue<Value, Value>::Return {
+      region = Region::current();
+      return { arg };
+    }, Context::Pointer { new Context() }
+  } };
+  const Context::Pointer context {
+    new Context { Context::Pointer { new DefaultContext() } }
+  };
+  context->define("inRegion", inRegion);
+  Evaluator released { context, true };
+  const std::vector<std::pair<std::string, double>> cases {
+    { "n = inRegion 2 * 21\nn", 42.0 },
+    { "n + 0.5", 42.5 },
+    { "xs = inRegion [1, 2, 3] |> map (* 2)\nxs |> sum", 12.0 },
+    { "ys = inRegion [[1], [2, 3]]\nys |> map sum |> sum", 6.0 },
+    { "xs |> sum", 12.0 },
+    { "k = inRegion 3\nf = x -> x * k\nf 5", 15.0 },
+    { "f 6", 18.0 },
+    { "factorial = 0 -> 1\n"
+      "factorial = n -> n * factorial (inRegion n - 1)\nfactorial 5", 120.0 },
+    { "factorial 6", 720.0 },
+    { "add2 = inRegion 2 |> (+)\nadd2 40", 42.0 },
+    { "add2 1", 3.0 },
+    { "ones = inRegion 1 : ones\nones |> take 3 |> sum", 3.0 },
+    { "ones |> take 5 |> sum", 5.0 },
+    { "lazy = 6 * 7\n0", 0.0 },
+    { "inRegion lazy", 42.0 },
+    { "lazy + 1", 43.0 },
+    { "t = (inRegion 1, [2])\nt == (1, [2])", 1.0 },
+    { "s = Some (inRegion [4])\ns == Some [4]", 1.0 }
+  };
+  for (const auto &[code, expected] : cases) {
+    const Value::OrError result =
+      released.evaluate(TokenTree::build({ code }));
+    const auto value = std::get_if<Value::Pointer>(&result);
+    const auto number = value ?
+      std::dynamic_pointer_cast<NumberValue>(*value) : nullptr;
+    const auto boolean = value ?
+      std::dynamic_pointer_cast<BooleanValue>(*value) : nullptr;
+    Tester::confirm(number ? number->getRawNumber() == expected :
+      boolean && boolean->getRawBoolean() == (expected != 0.0));
+    Tester::confirm(region.expired());
+  }
+}
+
+// testPartialApplication() - Tests that functions of two arguments give the
+//  same results whether they are called with both arguments at once or one
+//  argument at a time.
+void testPartialApplication() {
+  Evaluator eval { new DefaultContext() };
+  Tester::confirm(evaluatesApproxTo(eval, "((+) 2) 3", 5.0));
+  Tester::confirm(evaluatesApproxTo(eval, "(2 ^) 10", 1024.0));
+  Tester::confirm(evaluatesApproxTo(eval, "((=) y) (3 * 3)", 9.0));
+  Tester::confirm(evaluatesApproxTo(eval, "y + 1", 10.0));
+  const auto result = eval.evaluate(TokenTree::build({ "2 + undefinedName" }));
+  Tester::confirm(std::holds_alternative<Error>(result));
+}
+
+// testFunctions() - Tests that functions created with `->` can be called, and
+//  that they capture the variables they use when they are created.
+void testFunctions() {
+  Evaluator eval { new DefaultContext() };
+  Tester::confirm(evaluatesApproxTo(eval, "(x -> x * 2) 21", 42.0));
+  Tester::confirm(evaluatesApproxTo(eval, "f = x -> x + 1\nf 3", 4.0));
+  Tester::confirm(evaluatesApproxTo(eval, "add = x -> y -> x + y\nadd 2 5",
+    7.0));
+  Tester::confirm(evaluatesApproxTo(eval, "addTwo = add 2\naddTwo 10", 12.0));
+  Tester::confirm(evaluatesApproxTo(eval, "k = 10\ng = x -> x * k\ng 4",
+    40.0));
+  Tester::confirm(evaluatesApproxTo(eval, "h = x -> x + later\nlater = 1\nh 1",
+    2.0));
+  Tester::confirm(evaluatesShownAs(eval,
+    "isEven = 0 -> True\nisEven = n -> isOdd (n - 1)\n"
+    "isOdd = 0 -> False\nisOdd = n -> isEven (n - 1)\nisEven 10", "True"));
+  const auto missing = eval.evaluate(TokenTree::build({
+    "m = x -> x + neverDefined\nm 1"
+  }));
+  Tester::confirm(std::holds_alternative<Error>(missing) &&
+    std::get_if<Error>(&missing)->getCode() == Error::Code::Undefined);
+}
+
+// testSubtraction() - Tests that subtraction of numbers works as expected.
+void testSubtraction() {
+  Evaluator eval { new DefaultContext() };
+  Tester::confirm(evaluatesApproxTo(eval, "5 - 3", 2.0));
+  Tester::confirm(evaluatesApproxTo(eval, "10 - 2 - 3", 5.0));
+  Tester::confirm(evaluatesApproxTo(eval, "2 - 3 * 2", -4.0));
+}
+
+// testClauses() - Tests that setting a function that was set just before gives
+//  it another clause, that the first clause matching an argument is used, and
+//  that nothing else can be set again.
+void testClauses() {
+  Evaluator eval { new DefaultContext() };
+  Tester::confirm(evaluatesApproxTo(eval,
+    "factorial = 0 -> 1\nfactorial = n -> n * factorial (n - 1)\n"
+    "factorial 5", 120.0));
+  Tester::confirm(evaluatesApproxTo(eval, "factorial 0", 1.0));
+  Tester::confirm(evaluatesApproxTo(eval, "(1 -> 7) 1", 7.0));
+  Tester::confirm(std::holds_alternative<Error>(
+    eval.evaluate(TokenTree::build({ "(1 -> 7) 2" }))
+  ));
+
+  // The function that was set before keeps its clauses.
+  Tester::confirm(evaluatesApproxTo(eval, "fib = 0 -> 0\nfib 0", 0.0));
+  const Value::OrError defined = eval.getContext()->getValue("fib");
+  const Value::OrError alias = ThunkValue::forced(
+    *std::get_if<Value::Pointer>(&defined)
+  );
+  Tester::confirm(evaluatesApproxTo(eval, "fib = 1 -> 1\n"
+    "fib = n -> fib (n - 1) + fib (n - 2)\nfib 10", 55.0));
+  const auto &before = *std::get_if<Value::Pointer>(&alias);
+  const auto zero = before->call(Value::Pointer { new NumberValue { 0.0 } });
+  const auto ten = before->call(Value::Pointer { new NumberValue { 10.0 } });
+  Tester::confirm(std::holds_alternative<Value::Pointer>(zero));
+  Tester::confirm(std::holds_alternative<Error>(ten) &&
+    std::get_if<Error>(&ten)->getCode() == Error::Code::NoMatchingClause);
+
+  // Only a function set just before can be given another clause, and only
+  //  by a function.
+  const auto apart = eval.evaluate(TokenTree::build({
+    "twice = 0 -> 0\nother = 1\ntwice = n -> n * 2"
+  }));
+  Tester::confirm(std::holds_alternative<Error>(apart) &&
+    std::get_if<Error>(&apart)->getCode() == Error::Code::AlreadyDefined);
+  const auto number = eval.evaluate(TokenTree::build({ "x = 1\nx = 2" }));
+  Tester::confirm(std::holds_alternative<Error>(number) &&
+    std::get_if<Error>(&number)->getCode() == Error::Code::AlreadyDefined);
+  const auto notFunction = eval.evaluate(TokenTree::build({
+    "y = 0 -> 0\ny = 2"
+  }));
+  Tester::confirm(std::holds_alternative<Error>(notFunction) &&
+    std::get_if<Error>(&notFunction)->getCode() ==
+      Error::Code::AlreadyDefined);
+  Tester::confirm(evaluatesApproxTo(eval, "x", 1.0));
+}
+
+// testTailCalls() - Tests that calls in tail position do not use up the stack,
+//  both for self-recursion and for mutual recursion.
+void testTailCalls() {
+  Evaluator eval { new DefaultContext() };
+  Tester::confirm(evaluatesApproxTo(eval,
+    "count = 0 -> 0\ncount = n -> count (n - 1)\ncount 100000", 0.0));
+  Tester::confirm(evaluatesApproxTo(eval,
+    "total = 0 -> acc -> acc\ntotal = n -> acc -> total (n - 1) (acc + n)\n"
+    "total 100000 0", 5000050000.0));
+  Tester::confirm(evaluatesApproxTo(eval,
+    "isEven = 0 -> 1\nisEven = n -> isOdd (n - 1)\n"
+    "isOdd = 0 -> 0\nisOdd = n -> isEven (n - 1)\nisEven 100001", 0.0));
+}
+
+// testDeepEvaluation() - Tests that deeply nested code and deep recursion that
+//  is not in tail position are evaluated without running out of stack, and
+//  that the depth reached is reported in the RuntimeStats.
+void testDeepEvaluation() {
+  Evaluator eval { new DefaultContext() };
+
+  // Build the tree of 1 + 1 + ... + 1 directly, since the parser itself
+  //  recurses on the C++ stack.
+  const TokenTree::TreePointer one { new TokenTree {
+    Token { "1", Token::Type::Number }
+  } };
+  const TokenTree::TreePointer plus { new TokenTree {
+    Token { "+", Token::Type::Operator }
+  } };
+  TokenTree::TreePointer tree = one;
+  for (int i = 0; i < 10000; i++) {
+    tree = TokenTree::TreePointer { new TokenTree {
+      TokenTree::TreePointer { new TokenTree { plus, tree } }, one
+    } };
+  }
+  const auto result = eval.evaluate(*tree);
+  Tester::confirm(std::holds_alternative<Value::Pointer>(result));
+  Tester::confirm((*std::get_if<Value::Pointer>(&result))->
+    castValue<NumberValue>()->getRawNumber() == 10001.0);
+  RuntimeStats::current().reset();
+  Tester::confirm(evaluatesApproxTo(eval,
+    "sumTo = 0 -> 0\nsumTo = n -> n + sumTo (n - 1)\nsumTo 100000",
+    5000050000.0));
+  Tester::confirm(RuntimeStats::current().getMaxStackDepth() >= 100000);
+}
+
+// testErrors() - Tests that errors have the expected codes and messages, and
+//  that they record the code they occurred in.
+void testErrors() {
+  Evaluator eval { new DefaultContext() };
+  const auto undefined = eval.evaluate(TokenTree::build({ "1 + missing" }));
+  Tester::confirm(std::holds_alternative<Error>(undefined));
+  const Error &error = *std::get_if<Error>(&undefined);
+  Tester::confirm(error.getCode() == Error::Code::Undefined);
+  Tester::confirm(error.getMessage() == "TypeError: missing is undefined");
+  Tester::confirm(!!error.getSource());
+
+  const auto notCallable = eval.evaluate(TokenTree::build({ "1 2" }));
+  Tester::confirm(std::holds_alternative<Error>(notCallable));
+  Tester::confirm(std::get_if<Error>(&notCallable)->getMessage() ==
+    "TypeError: Value of type Number cannot be called");
+
+  const auto argument = eval.evaluate(TokenTree::build({ "(x -> x) + 1" }));
+  Tester::confirm(std::holds_alternative<Error>(argument));
+  Tester::confirm(std::get_if<Error>(&argument)->getMessage() ==
+    "TypeError: Expected argument of type Number but got argument of type "
+    "Value->Value");
+
+  // A moved-from Error keeps its code, and only loses its arguments.
+  Error moved { Error::Code::IndexOutOfRange, { "7" } };
+  const Error taken { std::move(moved) };
+  Tester::confirm(taken.getMessage() == "ValueError: Index 7 is out of range");
+  Tester::confirm(moved.getCode() == Error::Code::IndexOutOfRange);
+  Tester::confirm(moved.getMessage() == "ValueError: Index  is out of range");
+  Tester::confirm(!moved.getSource());
+}
+
+// testConstantFolding() - Tests that constant parts of code are evaluated
+//  ahead of time, including sections, and that code gives the same results
+//  whether or not it is folded.
+void testConstantFolding() {
+  const Context::Pointer context { new DefaultContext() };
+  const TokenTree folded = ConstantFolder::fold(
+    TokenTree::build({ "2 ^ 10" }), context
+  );
+  Tester::confirm(!!folded.getLineListPointer()->front()->getConstantPointer());
+  Tester::confirm(static_cast<std::string>(folded) ==
+    static_cast<std::string>(TokenTree::build({ "2 ^ 10" })));
+  const TokenTree parameter = ConstantFolder::fold(
+    TokenTree::build({ "0 -> 1" }), context
+  );
+  const auto &definition = *parameter.getLineListPointer()->front();
+  Tester::confirm(!definition.getFunctionPairPointer()->first->
+    getFunctionPairPointer()->second->getConstantPointer());
+
+  Evaluator optimized { new DefaultContext() };
+  Evaluator unoptimized { new DefaultContext(), false, false };
+  const char *codes[] = {
+    "2 ^ 10", "1000 - 1 - 2", "(* 2) 21", "(^ 2) 10", "(2 ^) 10",
+    "(- 1) 10", "((+) 2) 3", "f = x -> x * (2 ^ 10) - 1\nf 2",
+    "g = 0 -> 1\ng = n -> n * g (n - 1)\ng 6"
+  };
+  for (const char *code : codes) {
+    const auto &expected = unoptimized.evaluate(TokenTree::build({ code }));
+    Tester::confirm(std::holds_alternative<Value::Pointer>(expected));
+    Tester::confirm(evaluatesApproxTo(optimized, code,
+      (*std::get_if<Value::Pointer>(&expected))->castValue<NumberValue>()
+        ->getRawNumber()));
+  }
+  Tester::confirm(std::holds_alternative<Error>(
+    optimized.evaluate(TokenTree::build({ "1 2" }))
+  ));
+}
+
+// testInlining() - Tests that small functions are inlined only where that
+//  gives the same results, that functions called where they are written are
+//  reduced, and that repeated subexpressions are shared.
+void testInlining() {
+  const Context::Pointer context { new DefaultContext() };
+  const TokenTree reduced = Inliner::inlineCalls(
+    TokenTree::build({ "(x -> x * 2) 21" }), context, Inliner::Options {}
+  );
+  Tester::confirm(!!reduced.getLineListPointer()->front()->getBindingPointer());
+  Tester::confirm(static_cast<std::string>(reduced) ==
+    static_cast<std::string>(TokenTree::build({ "(x -> x * 2) 21" })));
+
+  Evaluator optimized { new DefaultContext() };
+  Evaluator unoptimized { new DefaultContext(), false, false };
+  RuntimeStats::current().reset();
+  Tester::confirm(evaluatesApproxTo(optimized,
+    "double = n -> n * 2\nmul = x -> y -> x * y\ndouble 4 + mul 2 3", 14.0));
+  Tester::confirm(RuntimeStats::current().getInlined().at("double") == 1);
+  Tester::confirm(RuntimeStats::current().getInlined().at("mul") == 1);
+  Tester::confirm(RuntimeStats::current().getBetaReductions() == 1);
+
+  RuntimeStats::current().reset();
+  const char *codes[] = {
+    "(x -> x * 2) 21",
+    "f = 0 -> 1\nf = n -> n * f (n - 1)\nf 5",
+    "k = 10\nscale = x -> x * k\nh = k -> scale k\nh 4",
+    "dec = n -> n - 1\ncount = 0 -> 0\ncount = n -> count (dec n)\ncount 9",
+    "add = x -> y -> x + y\nx = 5\nadd 1 x",
+    "sq = x -> (x + 1) * (x + 1) + (x + 1) * (x + 1)\nsq 3",
+    "g = y -> (y * y + 1) * (y * y + 1)\nj = n -> g (n - 1) + g n\nj 3",
+    "w = 5\npaired = y -> (y, w)\n((w, b) -> w * b) (paired 3)"
+  };
+  for (const char *code : codes) {
+    const auto &expected = unoptimized.evaluate(TokenTree::build({ code }));
+    Tester::confirm(std::holds_alternative<Value::Pointer>(expected));
+    Tester::confirm(evaluatesApproxTo(optimized, code,
+      (*std::get_if<Value::Pointer>(&expected))->castValue<NumberValue>()
+        ->getRawNumber()));
+  }
+  const auto &inlined = RuntimeStats::current().getInlined();
+  Tester::confirm(inlined.count("f") == 0 && inlined.count("scale") == 0);
+  Tester::confirm(inlined.count("dec") == 1 && inlined.count("g") == 1);
+  Tester::confirm(RuntimeStats::current().getCommonSubexpressions() >= 2);
+
+  RuntimeStats::current().reset();
+  Tester::confirm(evaluatesApproxTo(optimized,
+    "spread = x -> (x, x + 1)\n((a, b) -> a * b) (spread 3)", 12.0));
+  Tester::confirm(RuntimeStats::current().getInlined().at("spread") == 1);
+  Tester::confirm(RuntimeStats::current().getBetaReductions() == 1);
+
+  Evaluator limited { new DefaultContext() };
+  Inliner::Options options;
+  options.maxInlineSize = 0;
+  limited.setPasses(PassManager::forLevel(2, options));
+  RuntimeStats::current().reset();
+  Tester::confirm(evaluatesApproxTo(limited, "double = n -> n * 2\ndouble 4",
+    8.0));
+  Tester::confirm(RuntimeStats::current().getInlined().empty());
+}
+
+// testPassManager() - Tests that optimization levels select the right passes,
+//  that every level gives the same results, that passes are timed and
+//  measured, and that invalid code is caught between passes.
+void testPassManager() {
+  Tester::confirm(PassManager::forLevel(0).isEmpty());
+  Tester::confirm(PassManager::forLevel(1).getTimings().size() == 2);
+  Tester::confirm(PassManager::forLevel(2).getTimings().size() == 3);
+  Tester::confirm(PassManager::forLevel(2).getTimings().front().name ==
+    "inline");
+  Tester::confirm(PassManager::forCode(2,
+    Directives { "#[directive no_optimize]\n1" }).isEmpty());
+
+  const char *code =
+    "double = n -> n * 2\nf = 0 -> 1\nf = n -> n * f (n - 1)\nf 5 + double 2";
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    Tester::confirm(evaluatesApproxTo(eval, code, 124.0));
+  }
+
+  const Context::Pointer context { new DefaultContext() };
+  PassManager checked { true };
+  checked.add("fold", ConstantFolder::fold);
+  const TokenTree ast = TokenTree::build({ "x = 2 ^ 10 - 1\nx * 2" });
+  const TokenTree folded = checked.run(ast, context);
+  const auto &timing = checked.getTimings().front();
+  Tester::confirm(timing.sizeBefore == PassManager::sizeOf(ast));
+  Tester::confirm(timing.sizeAfter == PassManager::sizeOf(folded));
+  Tester::confirm(timing.sizeAfter < timing.sizeBefore);
+  Tester::confirm(timing.milliseconds >= 0);
+  Tester::confirm(checked.getTimingReport().find("fold") != std::string::npos);
+
+  Tester::confirm(!PassManager::verify(folded));
+  const TokenTree implied { TokenTree::LineList {
+    std::make_shared<TokenTree>()
+  } };
+  Tester::confirm(!!PassManager::verify(implied));
+  const auto &constant = folded.getLineListPointer()->front()->
+    getFunctionPairPointer()->second;
+  const TokenTree nested { TokenTree::LineList { std::make_shared<TokenTree>(
+    constant->getConstantPointer()->value, constant
+  ) } };
+  Tester::confirm(!!PassManager::verify(nested));
+
+  checked.add("break", [](const TokenTree &tree,
+    [[maybe_unused]] const Context::Pointer &ignored) {
+    return TokenTree { TokenTree::LineList {
+      std::make_shared<TokenTree>(tree), std::make_shared<TokenTree>()
+    } };
+  });
+  bool caught = false;
+  try {
+    checked.run(ast, context);
+  }
+  catch (const ParseError &error) {
+    const std::string message = error.std::runtime_error::what();
+    caught = message.find("after pass break") != std::string::npos;
+  }
+  Tester::confirm(caught);
+}
+
+// testMemoization() - Tests that functions remember their results when asked
+//  to or when it turns out to help, that tables stay within their capacity, and
+//  that memoized functions give the same results.
+void testMemoization() {
+  MemoTable table { "table", 2, MemoTable::Mode::Always };
+  const Value::Pointer one { new NumberValue { 1.0 } };
+  const Value::Pointer two { new NumberValue { 2.0 } };
+  Tester::confirm(!table.find(one));
+  table.remember(one, two);
+  table.remember(two, one);
+  Tester::confirm(table.find(Value::Pointer { new NumberValue { 1.0 } }) ==
+    two);
+  table.remember(Value::Pointer { new NumberValue { 3.0 } }, one);
+  Tester::confirm(table.size() == 2);
+  Tester::confirm(table.find(one) == two && !table.find(two));
+
+  RuntimeStats::current().reset();
+  const std::string fibonacci = "#[directive memoize]\nfib = 0 -> 0\n"
+    "fib = 1 -> 1\nfib = n -> fib (n - 1) + fib (n - 2)\n";
+  Evaluator memoized { new DefaultContext() };
+  memoized.setPasses(PassManager::forCode(2, Directives { fibonacci }));
+  Tester::confirm(evaluatesApproxTo(memoized, fibonacci + "fib 70",
+    190392490709135.0));
+  const auto &fib = RuntimeStats::current().getMemoized().at("fib");
+  Tester::confirm(fib->hits == 68 && fib->calls == 139 && !fib->rejected);
+
+  const std::string automatic = "#[directive memoize auto]\n"
+    "count = 0 -> 0\ncount = n -> count (n - 1)\n"
+    "f = 0 -> 0\nf = 1 -> 1\nf = n -> f (n - 1) + f (n - 2)\n"
+    "count 3000 + f 20";
+  for (int level = 0; level <= 2; level++) {
+    RuntimeStats::current().reset();
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forCode(level, Directives { automatic }));
+    Tester::confirm(evaluatesApproxTo(eval, automatic, 6765.0));
+    const auto &stats = RuntimeStats::current().getMemoized();
+    Tester::confirm(stats.at("count")->rejected);
+    Tester::confirm(!stats.at("f")->rejected && stats.at("f")->hits > 0);
+  }
+
+  RuntimeStats::current().reset();
+  Evaluator small { new DefaultContext() };
+  small.setPasses(PassManager::forCode(2,
+    Directives { fibonacci + "#[directive memo_size 4]" }));
+  Tester::confirm(evaluatesApproxTo(small, fibonacci + "fib 20", 6765.0));
+  Tester::confirm(RuntimeStats::current().getMemoized().at("fib")->evictions >
+    0);
+}
+
+// testLaziness() - Tests that arguments and definitions, including the tails
+//  of sequences made with `:`, are only evaluated if they are used, and at
+//  most once, at every optimization level.
+void testLaziness() {
+  int ticks = 0;
+  const Value::Pointer tick { new FunctionValue<Value, Value> {
+    [&ticks](const std::shared_ptr<Value> &arg,
+      [[maybe_unused]] const Context::Pointer &ignored) ->
+      FunctionValue<Value, Value>::Return {
+      ticks++;
+      return { arg };
+    }, Context::Pointer { new Context() }
+  } };
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    Tester::confirm(evaluatesApproxTo(eval, "(x -> 1) (1 2)", 1.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "constant = a -> b -> a\nconstant 3 (missing 2)", 3.0));
+    Tester::confirm(evaluatesApproxTo(eval, "x = 1 2\n5", 5.0));
+    Tester::confirm(evaluatesApproxTo(eval, "y = z * 2\nz = 4\ny", 8.0));
+
+    ticks = 0;
+    eval.tempDefine("tick", tick);
+    Tester::confirm(evaluatesApproxTo(eval, "(a -> a + a) (tick 2)", 4.0));
+    eval.tempDefine("tick", tick);
+    Tester::confirm(evaluatesApproxTo(eval, "t = tick 3\nt + t * t", 12.0));
+    eval.tempDefine("tick", tick);
+    Tester::confirm(evaluatesApproxTo(eval, "u = tick 3\n5", 5.0));
+    Tester::confirm(ticks == 2);
+
+    ticks = 0;
+    eval.tempDefine("tick", tick);
+    Tester::confirm(evaluatesApproxTo(eval, "1 : tick [2] |> first", 1.0));
+    eval.tempDefine("tick", tick);
+    Tester::confirm(evaluatesApproxTo(eval,
+      "xs = 1 : tick [2, 3]\n(xs |> sum) + (xs |> last)", 9.0));
+    Tester::confirm(ticks == 1);
+    Tester::confirm(evaluatesApproxTo(eval,
+      "naturals = 0 : (naturals |> map (+ 1))\n"
+      "naturals |> drop 10 |> take 3 |> sum", 33.0));
+
+    const auto circular = eval.evaluate(TokenTree::build({ "w = w + 1\nw" }));
+    Tester::confirm(std::holds_alternative<Error>(circular) &&
+      std::get_if<Error>(&circular)->getCode() == Error::Code::Circular);
+  }
+  Evaluator eval { new DefaultContext() };
+  Tester::confirm(evaluatesApproxTo(eval,
+    "g = 0 -> acc -> 5\ng = n -> acc -> g (n - 1) (acc + n)\ng 100000 0",
+    5.0));
+}
+
+// testStrictness() - Tests that functions and Bindings that always use their
+//  argument take it already evaluated, that others stay lazy, and that the
+//  analysis does not change results.
+void testStrictness() {
+  const char *code =
+    "double = n -> n * 2\nconstant = a -> b -> a\n"
+    "g = 0 -> acc -> acc\ng = n -> acc -> g (n - 1) (acc + n)\n";
+  const auto valueOf = [](Evaluator &eval, const std::string &line) {
+    const auto result = eval.evaluate(TokenTree::build({ line }));
+    return std::holds_alternative<Value::Pointer>(result) ?
+      *std::get_if<Value::Pointer>(&result) : Value::Pointer {};
+  };
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    Tester::confirm(evaluatesApproxTo(eval, std::string { code } +
+      "double (g 4 0) + constant 3 (missing 2)", 23.0));
+    const Value::Pointer doubled = valueOf(eval, "double");
+    const Value::Pointer accumulate = valueOf(eval, "g 4");
+    const Value::Pointer keep = valueOf(eval, "constant 3");
+    Tester::confirm(doubled && accumulate && keep);
+    Tester::confirm(doubled->delaysArgument() == (level == 0));
+    Tester::confirm(accumulate->delaysArgument() == (level == 0));
+    Tester::confirm(keep->delaysArgument());
+  }
+
+  const Context::Pointer context { new DefaultContext() };
+  const Value::OrError plus = context->getValue("+");
+  Tester::confirm(std::holds_alternative<Value::Pointer>(plus));
+  const std::vector<bool> bothStrict { true, true };
+  Tester::confirm((*std::get_if<Value::Pointer>(&plus))->getStrictness() ==
+    bothStrict);
+
+  const auto tree = [](const std::string &code) {
+    return std::make_shared<TokenTree>(TokenTree::build({ code }));
+  };
+  const TokenTree used = StrictnessAnalyzer::analyze(
+    TokenTree { "x", tree("3"), tree("x * x") }, context);
+  const TokenTree unused = StrictnessAnalyzer::analyze(
+    TokenTree { "x", tree("3"), tree("constant x 1") }, context);
+  Tester::confirm(used.getBindingPointer() &&
+    used.getBindingPointer()->strict);
+  Tester::confirm(unused.getBindingPointer() &&
+    !unused.getBindingPointer()->strict);
+}
+
+// testSequences() - Tests that sequence pipelines give the right results at
+//  every optimization level, that they only produce the elements they need,
+//  that stages written in Fleet run on plain numbers when they can (or fast
+//  enough on Values otherwise), and that unknown stages and errors are
+//  handled.
+void testSequences() {
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..< 10 |> filter (n -> n % 3 < 1) |> sum", 18.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..<= 100 |> map (* 2) |> take 3 |> sum", 12.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..< 100 |> while (<= 4) |> product", 24.0));
+    Tester::confirm(evaluatesApproxTo(eval, "1 ..< 11 |> drop 3 |> length",
+      7.0));
+    Tester::confirm(evaluatesApproxTo(eval, "5 ..< 9 |> last", 8.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..< 100 |> filter (> 40) |> first", 41.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..<= 3 |> concatMap (n -> 1 ..<= n) |> sum", 10.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..<= 3 |> zip (10 ..< 20) |> map ((x, y) -> x * y) |> sum",
+      68.0));
+    Tester::confirm(evaluatesApproxTo(eval, "1 ..<= 4 |> reduceLeft (-)",
+      -8.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "twice = s -> s |> map (* 2)\n1 ..<= 3 |> twice |> map (+ 1) |> sum",
+      15.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..< 1000000000 |> take 3 |> sum", 6.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..< 1000000000 |> while (< 4) |> sum", 6.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..< 3000000 |> filter (n -> n % 3 < 1) |> sum", 1499998500000.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "k = 3\n1 ..< 3000000 |> map (n -> 2 * (n + 1)) |> "
+      "while (n -> n % 1000 > k) |> length", 498.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..< 2001 |> map (n -> n * n) |> filter (n -> n % 2 < 1) |> length",
+      1000.0));
+
+    const auto empty = eval.evaluate(TokenTree::build({ "1 ..< 1 |> first" }));
+    Tester::confirm(std::holds_alternative<Error>(empty) &&
+      std::get_if<Error>(&empty)->getCode() == Error::Code::EmptySequence);
+    const auto notBoolean = eval.evaluate(
+      TokenTree::build({ "1 ..< 5 |> filter (* 2) |> sum" }));
+    Tester::confirm(std::holds_alternative<Error>(notBoolean) &&
+      std::get_if<Error>(&notBoolean)->getCode() == Error::Code::ReturnType);
+    const auto shown = eval.evaluate(
+      TokenTree::build({ "1 ..<= 2 |> map (< 2)" }));
+    Tester::confirm(std::holds_alternative<Value::Pointer>(shown) &&
+      static_cast<std::string>(**std::get_if<Value::Pointer>(&shown)) ==
+      "[True, False]");
+  }
+}
+
+// testRanges() - Tests that ranges answer length, first, last and indexing
+//  directly, that slicing and exact maps keep them ranges, and that sums and
+//  other reductions computed in closed form or on plain numbers agree with
+//  the same pipelines run element by element.
+void testRanges() {
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    Tester::confirm(evaluatesApproxTo(eval, "1 ..< 1000000000 |> length",
+      999999999.0));
+    Tester::confirm(evaluatesApproxTo(eval, "1 ..<= 1000000000 |> last",
+      1000000000.0));
+    Tester::confirm(evaluatesApproxTo(eval, "arithmetic 2 3 @ 1000000",
+      3000002.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "arithmetic 2 3 |> drop 5 |> take 3 |> first", 17.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..<= 10 |> map (* 2) |> (@ 3)", 8.0));
+    Tester::confirm(evaluatesApproxTo(eval, "2 ** 3 ** 2", 512.0));
+
+    Tester::confirm(evaluatesApproxTo(eval, "1 ..<= 1000000000 |> sum",
+      500000000500000000.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..<= 1000 |> map (** 2) |> sum", 333833500.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "0 ..< 100 |> map (10 -) |> map (** 3) |> sum", -16037000.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..< 1000 |> map (* 3) |> filter (> 10) |> map (- 1) |> sum",
+      1497486.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..< 1000 |> map (n -> n * 3) |> filter (> 10) |> map (- 1) |> sum",
+      1497486.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "0.5 ..< 3 |> map (* 3) |> sum", 13.5));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "arithmetic 1 1 |> while (< 5) |> product", 24.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..< 10000000 |> filter (> 10) |> length", 9999989.0));
+
+    const auto mapped = eval.evaluate(
+      TokenTree::build({ "0 ..< 10 |> drop 3 |> map (10 -)" }));
+    Tester::confirm(std::holds_alternative<Value::Pointer>(mapped) &&
+      (*std::get_if<Value::Pointer>(&mapped))->getName() == "Range");
+    const auto infinite = eval.evaluate(
+      TokenTree::build({ "arithmetic 1 1 |> length" }));
+    Tester::confirm(std::holds_alternative<Error>(infinite) &&
+      std::get_if<Error>(&infinite)->getCode() ==
+      Error::Code::InfiniteSequence);
+    const auto outside = eval.evaluate(TokenTree::build({ "(1 ..< 5) @ 4" }));
+    Tester::confirm(std::holds_alternative<Error>(outside) &&
+      std::get_if<Error>(&outside)->getCode() == Error::Code::IndexOutOfRange);
+  }
+
+  Evaluator eval { new DefaultContext() };
+  const auto section = eval.evaluate(TokenTree::build({ "(* 2)" }));
+  const auto lambda = eval.evaluate(TokenTree::build({ "x -> x * 2" }));
+  Tester::confirm(std::holds_alternative<Value::Pointer>(section) &&
+    (*std::get_if<Value::Pointer>(&section))->getNumericKernel());
+  Tester::confirm(std::holds_alternative<Value::Pointer>(lambda) &&
+    !(*std::get_if<Value::Pointer>(&lambda))->getNumericKernel());
+}
+
+// testLists() - Tests list literals, `:` (including sequences defined in terms
+//  of themselves with it), `++`, indexing, slicing, splice and update,
+//  including on lists big enough that their trees have several levels and
+//  concatenation has to rebalance them.
+void testLists() {
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    Tester::confirm(evaluatesApproxTo(eval, "[4, 5, 6] |> sum", 15.0));
+    Tester::confirm(evaluatesApproxTo(eval, "[] |> length", 0.0));
+    Tester::confirm(evaluatesApproxTo(eval, "1 : 2 : [3] |> product", 6.0));
+    Tester::confirm(evaluatesShownAs(eval,
+      "from = n -> n : from (n + 1)\nfrom 0 |> take 5 |> toList",
+      "[0, 1, 2, 3, 4]"));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "fibonacci = x -> y -> (x + y) : fibonacci y (x + y)\n"
+      "fibonacci 1 2 |> while (<= 4000000) |> filter (n -> n % 2 < 1) |> sum",
+      4613730.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "0 : arithmetic 1 1 |> take 3 |> sum", 3.0));
+    Tester::confirm(evaluatesApproxTo(eval, "[[1, 2], [3]] @ 0 @ 1", 2.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "[1, 2] ++ (3 ..< 6) ++ [6] |> map (* 2) |> last", 12.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "[10, 20, 30, 40] |> drop 1 |> take 2 |> sum", 50.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "[10, 20, 30] |> splice 1 |> ((x, rest) -> sum rest)", 40.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "[10, 20, 30] |> update 2 5 |> sum", 35.0));
+
+    Tester::confirm(evaluatesApproxTo(eval,
+      "xs = 0 ..< 100000 |> toList\n"
+      "ys = (xs |> drop 33 |> take 4000) ++ (xs |> drop 50001)\n"
+      "zs = ys ++ (ys |> update 3999 0) ++ [7]\n"
+      "(zs @ 3999) + (zs @ 4000) + (zs @ 57998) + (zs @ 61997) + "
+      "(zs |> last) + (zs |> length)",
+      4032.0 + 50001.0 + 0.0 + 53999.0 + 7.0 + 107999.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "big = 0 ..< 100000 |> toList\n"
+      "(big ++ big |> drop 99990 |> take 20 |> sum) + (big |> splice 500 |> "
+      "((x, rest) -> length rest))", 999945.0 + 45.0 + 99999.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "go = 0 -> xs -> xs\n"
+      "go = n -> xs -> go (n - 1) ([n] ++ xs ++ [n])\n"
+      "m = go 300 []\n"
+      "(m |> length) + (m @ 0) + (m @ 299) + (m @ 300) + (m |> sum)",
+      600.0 + 1.0 + 300.0 + 300.0 + 90300.0));
+
+    const auto list = eval.evaluate(TokenTree::build({ "1 ..< 5 |> toList" }));
+    Tester::confirm(std::holds_alternative<Value::Pointer>(list) &&
+      (*std::get_if<Value::Pointer>(&list))->getName() == "List");
+    const auto outside = eval.evaluate(TokenTree::build({ "[1, 2] @ 2" }));
+    Tester::confirm(std::holds_alternative<Error>(outside) &&
+      std::get_if<Error>(&outside)->getCode() == Error::Code::IndexOutOfRange);
+    const auto empty = eval.evaluate(TokenTree::build({ "[] |> first" }));
+    Tester::confirm(std::holds_alternative<Error>(empty) &&
+      std::get_if<Error>(&empty)->getCode() == Error::Code::EmptySequence);
+  }
+}
+
+// testNumericReductions() - Tests that min, max, dot and scanLeft work on
+//  numeric lists and ranges, that sums of many numbers are accurate, and that
+//  reductions of sequences of other Values still work or fail properly.
+void testNumericReductions() {
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "arithmetic 0.1 0 |> take 10000000 |> sum", 1000000.0));
+    Tester::confirm(evaluatesApproxTo(eval, "[3, 1, 4, 1, 5] |> min", 1.0));
+    Tester::confirm(evaluatesApproxTo(eval, "[3, 1, 4, 1, 5] |> max", 5.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..< 10001 |> toList |> map (* 2) |> filter (< 1000) |> max", 998.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..< 10001 |> map (1 -) |> drop 5 |> min", -9999.0));
+    Tester::confirm(evaluatesApproxTo(eval, "[[1], 2, 0] |> drop 1 |> min",
+      0.0));
+    Tester::confirm(evaluatesApproxTo(eval, "[1, 2, 3] |> dot [4, 5, 6]",
+      32.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..< 1001 |> dot (arithmetic 1 0)", 500500.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "[1, 2, 3] |> dot (arithmetic 1 1 |> map (a -> a))", 14.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "ns = 1 ..< 100001 |> toList\nns |> dot ns", 333338333350000.0));
+    Tester::confirm(evaluatesApproxTo(eval, "1 ..< 6 |> scanLeft (+) |> last",
+      15.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..< 6 |> toList |> scanLeft (*) |> sum", 153.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "1 ..< 600 |> scanLeft (+) |> toList |> drop 298 |> first", 44850.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "[1, 2, 3] |> scanLeft (a -> b -> a - b) |> last", -4.0));
+
+    const auto boxed = eval.evaluate(TokenTree::build({ "[[1]] |> min" }));
+    Tester::confirm(std::holds_alternative<Error>(boxed) &&
+      std::get_if<Error>(&boxed)->getCode() == Error::Code::ArgumentType);
+    const auto paired = eval.evaluate(TokenTree::build({ "[[1]] |> dot [1]" }));
+    Tester::confirm(std::holds_alternative<Error>(paired) &&
+      std::get_if<Error>(&paired)->getCode() == Error::Code::ArgumentType);
+    for (const char *code : { "[] |> max", "1 ..< 1 |> min" }) {
+      const auto empty = eval.evaluate(TokenTree::build({ code }));
+      Tester::confirm(std::holds_alternative<Error>(empty) &&
+        std::get_if<Error>(&empty)->getCode() == Error::Code::EmptySequence);
+    }
+  }
+}
+
+// testCompactLists() - Tests that toList stores long lists of whole numbers
+//  compactly, with the encoding that suits them, and that compact lists work
+//  like any other list.
+void testCompactLists() {
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    const RuntimeStats::Compaction &compaction =
+      RuntimeStats::current().getCompaction();
+
+    // Sorted numbers are delta encoded.
+    RuntimeStats::current().reset();
+    Tester::confirm(evaluatesApproxTo(eval,
+      "ids = 1000 ..< 101000 |> map (* 40) |> toList\n"
+      "(ids @ 54321) + (ids |> drop 500 |> take 1000 |> last) + "
+      "(ids |> length)", 2212840.0 + 99960.0 + 100000.0));
+    Tester::confirm(compaction.lists == 1 && compaction.numbers == 100000 &&
+      compaction.deltaBlocks > 0 && compaction.bytes * 4 < 100000 * 8);
+    Tester::confirm(evaluatesApproxTo(eval, "ids |> sum", 203998000000.0));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "(ids |> update 3 7 |> take 5 |> sum) + (0 : ids |> length) + "
+      "((ids ++ ids) @ 100000)", 40000.0 + 40040.0 + 40080.0 + 7.0 +
+      40160.0 + 100001.0 + 40000.0));
+
+    // Small numbers are bit packed, and repeated ones are run-length encoded.
+    RuntimeStats::current().reset();
+    Tester::confirm(evaluatesApproxTo(eval,
+      "counters = 0 ..< 10000 |> map (% 7) |> toList\n"
+      "counters |> filter (> 5) |> length", 1428.0));
+    Tester::confirm(compaction.packedBlocks == 79 &&
+      compaction.deltaBlocks + compaction.runBlocks == 0);
+    Tester::confirm(evaluatesApproxTo(eval,
+      "runs = 1 ..< 2000 |> concatMap (n -> arithmetic n 0 |> take 100) |> "
+      "toList\n(runs |> sum) + (runs @ 12345)", 199900000.0 + 124.0));
+    Tester::confirm(compaction.lists == 2 && compaction.runBlocks > 0);
+
+    // Lists that are short or not of whole numbers are left as they are.
+    RuntimeStats::current().reset();
+    Tester::confirm(evaluatesApproxTo(eval,
+      "(0 ..< 1000 |> map (* 0.5) |> toList |> sum) + "
+      "(0 ..< 100 |> toList |> sum)", 249750.0 + 4950.0));
+    Tester::confirm(compaction.lists == 0);
+  }
+}
+
+// testIntegers() - Tests that Ints stay exact past 64 bits, with large
+//  products, quotients and gcds computed as BigInts, and that Floats and
+//  ranges still give Floats.
+void testIntegers() {
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    Tester::confirm(evaluatesShownAs(eval, "2 ** 100",
+      "1267650600228229401496703205376"));
+    Tester::confirm(evaluatesShownAs(eval, "9223372036854775807 + 1",
+      "9223372036854775808"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "(9223372036854775807 + 1) - 1 < 9223372036854775807 + 1", "True"));
+    Tester::confirm(evaluatesShownAs(eval, "9223372036854775808 - 1",
+      "9223372036854775807"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "f = 18446744073709551616 -> 1\nf = n -> 0\nf (2 ** 64)", "1"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "123456789012345678901234567890 * 987654321098765432109876543210",
+      "121932631137021795226185032733622923332237463801111263526900"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "(3 ** 2000) * (7 ** 1500) // (7 ** 1500) - 3 ** 2000", "0"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "((3 ** 2000) * (7 ** 1500) + 12345) % (7 ** 1500)", "12345"));
+    Tester::confirm(evaluatesShownAs(eval, "gcd (2 ** 100 * 3 ** 5) (6 ** 40)",
+      "267181325549568"));
+    Tester::confirm(evaluatesShownAs(eval, "[4, 6, 10] |> reduceLeft lcm",
+      "60"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "[2 ** 70, 3, 2 ** 70 + 1] |> max", "1180591620717411303425"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "[2 ** 62, 2 ** 62, 2 ** 62] |> sum", "13835058055282163712"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "(7 // 2) + ((0 - 7) // 2) + ((0 - 7) % 2)", "-1"));
+
+    // Floats give Floats, and ranges hold Floats, but a sum of whole numbers
+    //  worked out by formula is an exact Int.
+    Tester::confirm(evaluatesShownAs(eval, "3 + 0.5", "3.500000"));
+    Tester::confirm(evaluatesApproxTo(eval, "7 / 2", 3.5));
+    Tester::confirm(evaluatesShownAs(eval, "1 ..< 4 |> first", "1.000000"));
+    Tester::confirm(evaluatesShownAs(eval, "1 ..< 4 |> sum", "6"));
+    Tester::confirm(evaluatesShownAs(eval, "1 ..< 4 |> length", "3"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "1 ..< 1000000 |> map (** 2) |> sum", "333332833333500000"));
+    Tester::confirm(evaluatesShownAs(eval, "0.5 ..< 4 |> sum", "8.000000"));
+
+    for (const char *code : { "5 % 0", "(2 ** 100) // 0" }) {
+      const auto result = eval.evaluate(TokenTree::build({ code }));
+      Tester::confirm(std::holds_alternative<Error>(result) &&
+        std::get_if<Error>(&result)->getCode() ==
+        Error::Code::DivisionByZero);
+    }
+
+    // A Number Token that is not a number is reported rather than read as 0.
+    const TokenTree invalid { Token { "12x", Token::Type::Number } };
+    const auto unparsed = eval.evaluate(invalid);
+    Tester::confirm(std::holds_alternative<Error>(unparsed) &&
+      std::get_if<Error>(&unparsed)->getCode() == Error::Code::CannotParse);
+  }
+}
+
+// testStrings() - Tests that Strings are sequences of code points, whether
+//  their characters fit in Latin-1 or not, and that `++` on long Strings keeps
+//  every character in its place.
+void testStrings() {
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    Tester::confirm(evaluatesShownAs(eval, "'Fizz' ++ \"Buzz\"",
+      "\"FizzBuzz\""));
+    Tester::confirm(evaluatesShownAs(eval, "\"h\u00e9llo\" @ 1",
+      "\"\u00e9\""));
+    Tester::confirm(evaluatesShownAs(eval,
+      "length \"h\u00e9llo w\u00f6rld \u2713\"", "13"));
+    Tester::confirm(evaluatesShownAs(eval, "last \"abc\u2713\"",
+      "\"\u2713\""));
+    Tester::confirm(evaluatesShownAs(eval, "\"a\" : \"bc\"", "\"abc\""));
+    Tester::confirm(evaluatesShownAs(eval, "\"a\\tb\\\"\" |> length", "4"));
+    Tester::confirm(evaluatesShownAs(eval, "\"hello\" |> drop 1 |> take 3",
+      "\"ell\""));
+    Tester::confirm(evaluatesShownAs(eval, "\"abc\" |> map (c -> c) |> toList",
+      "[\"a\", \"b\", \"c\"]"));
+
+    // 6000 characters joined three at a time, so the Rope has many leaves.
+    Tester::confirm(evaluatesShownAs(eval,
+      "1 ..<= 2000 |> map (n -> \"ab\u2713\") |> reduceLeft (++) |> "
+      "drop 2998 |> take 3", "\"b\u2713a\""));
+    Tester::confirm(evaluatesShownAs(eval,
+      "(1 ..<= 2000 |> map (n -> \"ab\u2713\") |> reduceLeft (++)) @ 5999",
+      "\"\u2713\""));
+
+    const auto outside = eval.evaluate(TokenTree::build({ "\"abc\" @ 3" }));
+    Tester::confirm(std::holds_alternative<Error>(outside) &&
+      std::get_if<Error>(&outside)->getCode() == Error::Code::IndexOutOfRange);
+  }
+}
+
+// testStringKernels() - Tests splitting, searching, trimming and parsing
+//  Strings, including ones longer than a block of bytes and ones in UTF-8.
+void testStringKernels() {
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    Tester::confirm(evaluatesShownAs(eval, "\"a,b,,c,\" |> split \",\"",
+      "[\"a\", \"b\", \"\", \"c\", \"\"]"));
+    Tester::confirm(evaluatesShownAs(eval, "\"1 2\\n3 4\" |> split \"\\n\"",
+      "[\"1 2\", \"3 4\"]"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "\" h\u00e9 w\u00f6\\t\u65e5\u3000x\" |> splitWith isWhitespace",
+      "[\"\", \"h\u00e9\", \"w\u00f6\", \"\u65e5\", \"x\"]"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "\"a-b c\" |> splitWith (c -> isWhitespace c)", "[\"a-b\", \"c\"]"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "[\"a\", \"\u2713\"] |> join \", \"", "\"a, \u2713\""));
+    Tester::confirm(evaluatesShownAs(eval,
+      "\"\u65e5\u672c\u8a9e abc\" |> find \"abc\"", "4"));
+    Tester::confirm(evaluatesShownAs(eval, "\"abc\" |> find \"\u2713\"",
+      "-1"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "\" \\t\u00a0h\u00e9llo\\n\" |> trim", "\"h\u00e9llo\""));
+
+    // Longer than a block of 32 bytes, with the match near the end.
+    Tester::confirm(evaluatesShownAs(eval,
+      "(1 ..<= 20 |> map (n -> \"abcd\") |> reduceLeft (++)) ++ \"x;y\" |> "
+      "split \";\" |> map length |> toList", "[81, 1]"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "(1 ..<= 20 |> map (n -> \"    \") |> reduceLeft (++)) ++ \"x \" |> "
+      "trim", "\"x\""));
+
+    Tester::confirm(evaluatesShownAs(eval, "tryParseAs Int \" 08 \"",
+      "Some 8"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "tryParseAs Int \"-123456789012345678901234567890\"",
+      "Some (-123456789012345678901234567890)"));
+    Tester::confirm(evaluatesShownAs(eval, "tryParseAs Float \"2.5e3\"",
+      "Some 2500.000000"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "orZero = Nothing -> 0\norZero = Some n -> n\n"
+      "\"1 2 x 3\" |> split \" \" |> map (tryParseAs Int) |> map orZero |> "
+      "sum", "6"));
+    Tester::confirm(evaluatesShownAs(eval, "toString 12", "\"12\""));
+    Tester::confirm(evaluatesShownAs(eval, "tryParseAs Int \"1.5\"",
+      "Nothing"));
+    Tester::confirm(evaluatesShownAs(eval, "tryParseAs Float \"\"",
+      "Nothing"));
+  }
+}
+
+// testBytes() - Tests reading a file as Bytes, slicing them and decoding them
+//  into numbers and Strings.
+void testBytes() {
+  const std::string path = (std::filesystem::temp_directory_path() /
+    "fleet-test-bytes.bin").string();
+  {
+    std::ofstream file { path, std::ios::binary };
+    // 1 and -2 as 4-byte Ints, then 1.5 as an 8-byte Float, then "h\u00e9".
+    const unsigned char bytes[] = {
+      1, 0, 0, 0, 0xFE, 0xFF, 0xFF, 0xFF,
+      0, 0, 0, 0, 0, 0, 0xF8, 0x3F,
+      'h', 0xC3, 0xA9
+    };
+    file.write(reinterpret_cast<const char *>(bytes), sizeof bytes);
+  }
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    eval.evaluate(TokenTree::build({ "bytes = readBytes \"" + path + "\"" }));
+    Tester::confirm(evaluatesShownAs(eval, "length bytes", "19"));
+    Tester::confirm(evaluatesShownAs(eval, "bytes @ 4", "254"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "bytes |> take 8 |> decodeInts 4", "[1, -2]"));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "bytes |> drop 8 |> decodeFloats 8 |> first", 1.5));
+    Tester::confirm(evaluatesShownAs(eval,
+      "bytes |> drop 16 |> decodeUtf8", "\"h\u00e9\""));
+    Tester::confirm(evaluatesShownAs(eval,
+      "bytes |> drop 16 |> filter (> 127) |> toList", "[195, 169]"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "bytesOf \"\u2713\" |> toList", "[226, 156, 147]"));
+
+    const auto missing = eval.evaluate(TokenTree::build({
+      "readBytes \"" + path + ".missing\""
+    }));
+    Tester::confirm(std::holds_alternative<Error>(missing) &&
+      std::get_if<Error>(&missing)->getCode() == Error::Code::CannotOpen);
+    const auto width = eval.evaluate(TokenTree::build({
+      "bytes |> decodeFloats 2"
+    }));
+    Tester::confirm(std::holds_alternative<Error>(width) &&
+      std::get_if<Error>(&width)->getCode() == Error::Code::InvalidWidth);
+  }
+  std::remove(path.c_str());
+}
+
+// testMapsAndSets() - Tests building maps and sets, changing them without
+//  changing the originals, and combining them.
+void testMapsAndSets() {
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    Tester::confirm(evaluatesShownAs(eval, "emptyMap", "{:}"));
+    Tester::confirm(evaluatesShownAs(eval, "emptySet |> include \"x\"",
+      "{\"x\"}"));
+    eval.evaluate(TokenTree::build({
+      "m = emptyMap |> insert \"a\" 1 |> insert \"b\" 2"
+    }));
+    Tester::confirm(evaluatesShownAs(eval, "m |> lookup \"b\"", "2"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "m |> insert \"a\" 3 |> lookup \"a\"", "3"));
+    Tester::confirm(evaluatesShownAs(eval, "m |> lookup \"a\"", "1"));
+    Tester::confirm(evaluatesShownAs(eval, "m |> remove \"a\"",
+      "{\"b\": 2}"));
+    Tester::confirm(evaluatesShownAs(eval, "size m", "2"));
+    Tester::confirm(evaluatesShownAs(eval, "m |> values |> sum", "3"));
+
+    eval.evaluate(TokenTree::build({
+      "squares = mapOf (0 ..< 1000 |> map (x -> [x, x * x]))"
+    }));
+    Tester::confirm(evaluatesShownAs(eval, "size squares", "1000"));
+    Tester::confirm(evaluatesApproxTo(eval, "squares |> lookup 999", 998001));
+    Tester::confirm(evaluatesShownAs(eval,
+      "squares |> remove 10 |> contains 10", "False"));
+    Tester::confirm(evaluatesShownAs(eval, "squares |> contains 10",
+      "True"));
+    Tester::confirm(evaluatesApproxTo(eval, "squares |> keys |> sum",
+      499500));
+
+    Tester::confirm(evaluatesShownAs(eval, "setOf [1, 2, 3] |> contains 2.0",
+      "True"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "setOf (0 ..< 100) |> union (setOf (50 ..< 150)) |> size", "150"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "setOf (0 ..< 100) |> intersection (setOf (50 ..< 150)) |> size",
+      "50"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "mapOf [[1, \"a\"]] |> union (mapOf [[1, \"b\"], [2, \"c\"]]) "
+      "|> lookup 1", "\"a\""));
+
+    const auto unhashable = eval.evaluate(TokenTree::build({
+      "emptySet |> include (x -> x)"
+    }));
+    Tester::confirm(std::holds_alternative<Error>(unhashable) &&
+      std::get_if<Error>(&unhashable)->getCode() == Error::Code::Unhashable);
+    const auto missing = eval.evaluate(TokenTree::build({
+      "m |> lookup \"c\""
+    }));
+    Tester::confirm(std::holds_alternative<Error>(missing) &&
+      std::get_if<Error>(&missing)->getCode() == Error::Code::KeyNotFound);
+  }
+}
+
+// testEquality() - Tests comparing Values structurally, however they were
+//  built, and using lists and maps as keys.
+void testEquality() {
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    Tester::confirm(evaluatesShownAs(eval, "1 == 1.0", "True"));
+    Tester::confirm(evaluatesShownAs(eval, "1 != 2", "True"));
+    Tester::confirm(evaluatesShownAs(eval, "True == 1", "False"));
+    Tester::confirm(evaluatesShownAs(eval, "\"ab\" ++ \"c\" == \"abc\"",
+      "True"));
+    Tester::confirm(evaluatesShownAs(eval, "\"\u00e9\" == take 1 "
+      "\"\u00e9\u2603\"", "True"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "[1, [2, \"x\"]] == [1, [2, \"y\"]]", "False"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "toList (1 ..<= 300) == (toList (1 ..< 300) ++ [300])", "True"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "toList (0 ..< 300 |> map (* 0.5)) == toList (0 ..< 300 |> map (/ 2))",
+      "True"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "(bytesOf \"abc\" |> drop 1) == bytesOf \"bc\"", "True"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "mapOf [[\"a\", 1], [\"b\", 2]] == "
+      "(emptyMap |> insert \"b\" 2 |> insert \"a\" 1.0)", "True"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "setOf [1, 2] == setOf [1, 3]", "False"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "setOf [[1, 2], toList (1 ..<= 2), setOf [1]] |> size", "2"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "mapOf [[[1, 2], \"x\"]] |> lookup [1.0, 2]", "\"x\""));
+    Tester::confirm(evaluatesShownAs(eval,
+      "1 ..< 20 |> filter (== 5) |> sum", "5.000000"));
+  }
+}
+
+// testTuples() - Tests tuple literals, tuple Patterns in functions and in
+//  `=`, and the tuples that zip and splice give.
+void testTuples() {
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    Tester::confirm(evaluatesShownAs(eval, "(1, \"a\", [2], (3, 4))",
+      "(1, \"a\", [2], (3, 4))"));
+    Tester::confirm(evaluatesShownAs(eval, "((1, 2), 3) == (1, 2, 3)",
+      "False"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "(1, 2, 3, 4, 5, 6) == (1, 2, 3, 4, 5, 6.0)", "True"));
+    Tester::confirm(evaluatesShownAs(eval, "(2 + 3)", "5"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "f = (a, b) -> a * b\nf (3, 4)", "12"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "g = (0, y) -> y\ng = ((x, y), z) -> x + y + z\ng = (x, y) -> x\n"
+      "g (0, 5) + g (7, 5) + g ((1, 2), 3)", "18"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "(x, rest) = splice 1 [10, 20, 30]\nx + sum rest", "60"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "(p, (q, r)) = pqr\npqr = (1, (2, 3))\np + q + r", "6"));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "[1, 2, 3] |> zip [10, 20, 30] |> map ((x, y) -> x * y) |> sum",
+      140.0));
+    Tester::confirm(evaluatesShownAs(eval,
+      "setOf [(1, 2), (1.0, 2), (2, 1)] |> size", "2"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "ks = [\"a\", \"b\"]\nvs = [1, 2]\n"
+      "mapOf (ks |> zip vs) |> lookup \"b\"", "2"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "mapOf [(1, \"a\"), (2, \"b\")] |> keys |> sum", "3"));
+
+    const auto unmatched = eval.evaluate(TokenTree::build({
+      "h = (a, b) -> a\nh (1, 2, 3)"
+    }));
+    Tester::confirm(std::holds_alternative<Error>(unmatched) &&
+      std::get_if<Error>(&unmatched)->getCode() ==
+        Error::Code::NoMatchingClause);
+    const auto repeated = eval.evaluate(TokenTree::build({
+      "(a, a) -> a"
+    }));
+    Tester::confirm(std::holds_alternative<Error>(repeated) &&
+      std::get_if<Error>(&repeated)->getCode() ==
+        Error::Code::InvalidParameter);
+  }
+}
+
+// testTaggedValues() - Tests Maybe and Either, constructors written in Fleet,
+//  constructor Patterns, and the functions that give Maybe.
+void testTaggedValues() {
+  for (int level = 0; level <= 2; level++) {
+    Evaluator eval { new DefaultContext() };
+    eval.setPasses(PassManager::forLevel(level));
+    Tester::confirm(evaluatesShownAs(eval,
+      "[Nothing, Some 3, Some (Some 4), Left \"a\", Right (1, 2)]",
+      "[Nothing, Some 3, Some (Some 4), Left \"a\", Right (1, 2)]"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "[Some 1 == Some 1.0, Some 1 == Left 1, Nothing == Nothing]",
+      "[True, False, True]"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "setOf [Some 1, Some 1, Nothing, Nothing, Left 1] |> size", "3"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "[tryAt 1 [5, 6], tryAt 2 [5, 6], tryFirst [], tryLast \"ab\"]",
+      "[Some 6, Nothing, Nothing, Some \"b\"]"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "orZero = Nothing -> 0\norZero = Some x -> x\n"
+      "orZero (tryAt 1 [5, 6]) + orZero (tryLast [])", "6"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "g = Some (a, b) -> a * b\ng = Some Nothing -> 1\n"
+      "g (Some (3, 4)) + g (Some Nothing)", "13"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "Circle = constructor \"Circle\"\nEmpty = singleton \"Empty\"\n"
+      "area = Circle r -> 3 * r * r\narea = Empty -> 0\n"
+      "area (Circle 2) + area Empty", "12"));
+    Tester::confirm(evaluatesShownAs(eval,
+      "Some x = tryFirst [7, 8]\nx + 1", "8"));
+    Tester::confirm(evaluatesApproxTo(eval,
+      "(1 ..<= 1000) |> map (x -> Some x) |> map (Some x -> x) |> sum",
+      500500.0));
+
+    const auto unmatched = eval.evaluate(TokenTree::build({
+      "h = Some x -> x\nh Nothing"
+    }));
+    Tester::confirm(std::holds_alternative<Error>(unmatched) &&
+      std::get_if<Error>(&unmatched)->getCode() ==
+        Error::Code::NoMatchingClause);
+    const auto lowercase = eval.evaluate(TokenTree::build({
+      "constructor \"circle\""
+    }));
+    Tester::confirm(std::holds_alternative<Error>(lowercase) &&
+      std::get_if<Error>(&lowercase)->getCode() ==
+        Error::Code::InvalidIdentifier);
+  }
+}
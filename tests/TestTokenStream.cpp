@@ -1,8 +1,10 @@
 // File: tests/TestTokenStream.cpp
 // Purpose: Source file for the TestTokenStream test set.
 
+#include <set>
 #include <string>
 #include "TestTokenStream.hpp"
+#include "Directives.hpp"
 #include "Tester.hpp"
 #include "Token.hpp"
 #include "TokenStream.hpp"
@@ -12,6 +14,7 @@ void emptyCode();
 void basicEndpointTokens();
 void grouperTokens();
 void allTokens();
+void directives();
 
 // main() - Runs all TokenStream tests and returns an integer indicating the
 //  number of failed tests.
@@ -21,6 +24,7 @@ int TestTokenStream::main() {
   tester.test("Basic tokens", basicEndpointTokens);
   tester.test("Groupers", grouperTokens);
   tester.test("All tokens", allTokens);
+  tester.test("Directives", directives);
   return tester.run();
 }
 
@@ -97,3 +101,32 @@ void allTokens() {
   Tester::confirm(all.next() == (Token { "\n", Token::Type::LineBreak }));
   Tester::confirm(!all.hasNext());
 }
+
+// directives() - Tests that directives are found in comments, with or without
+//  a value, that other comments are ignored, and that directives apply to the
+//  definitions right after them.
+void directives() {
+  const Directives found {
+    "#[directive no_optimize]\nx = 1 # [directive ignored]\n"
+    "#[directive require_version 0.0.1]\n#[directive no_prelude false]"
+  };
+  Tester::confirm(found.isSet("no_optimize"));
+  Tester::confirm(found.get("no_optimize") == std::string { "true" });
+  Tester::confirm(found.get("require_version") == std::string { "0.0.1" });
+  Tester::confirm(!found.isSet("no_prelude"));
+  Tester::confirm(!found.isSet("ignored"));
+  Tester::confirm(!Directives { "x = 1" }.isSet("no_optimize"));
+  Tester::confirm(found.getTargets("no_optimize") ==
+    std::set<std::string> { "x" });
+  Tester::confirm(found.getTargets("require_version").empty());
+
+  const Directives targeted {
+    "#[directive memoize]\n# fib\nfib = 0 -> 0\nfib = n -> n\n"
+    "#[directive memoize]\ng = 1\n#[directive memoize false]\nh = 2\n"
+    "#[directive memoize]\n(k) = 3"
+  };
+  Tester::confirm(targeted.getTargets("memoize") ==
+    (std::set<std::string> { "fib", "g" }));
+  Tester::confirm(targeted.getTargets("memoize", "false") ==
+    std::set<std::string> { "h" });
+}
@@ -13,6 +13,8 @@ void emptyTree();
 void oneExpression();
 void basicFunction();
 void operations();
+void sections();
+void tuples();
 
 // main() - Runs all TokenTree tests and returns a value indicating the number
 //  of tests failed.
@@ -24,6 +26,8 @@ int TestTokenTree::main() {
   tester.test("One expression", oneExpression);
   tester.test("A basic function", basicFunction);
   tester.test("Some operations", operations);
+  tester.test("Operator sections", sections);
+  tester.test("Tuple literals", tuples);
   return tester.run();
 }
 
@@ -153,3 +157,41 @@ void operations() {
   });
   Tester::confirm(opLines == comparisonTree);
 }
+
+// sections() - Tests that an operator without a first argument is given an
+//  implied one wherever its grouping is, as in `map (* 2)`.
+void sections() {
+  TokenStream section { "map (* 2)" };
+  const TokenTree tree = TokenTree::build(section);
+  const auto lines = tree.getLineListPointer();
+  Tester::confirm(lines && lines->size() == 1);
+  const auto call = lines->front()->getFunctionPairPointer();
+  Tester::confirm(call && call->first->getTokenPointer());
+  const auto partial = call->second->getFunctionPairPointer();
+  Tester::confirm(!!partial);
+  const auto op = partial->first->getFunctionPairPointer();
+  Tester::confirm(op && op->second->isImplied());
+  const auto &argument = partial->second->getTokenPointer();
+  Tester::confirm(argument &&
+    *argument == (Token {"2", Token::Type::Number}));
+}
+
+// tuples() - Tests that parentheses around elements separated by commas are a
+//  tuple literal built by `(,)` and `(,+)`, and that a tuple nested in another
+//  stays a single element.
+void tuples() {
+  TokenStream flat { "(a, b, c)" };
+  const TokenTree flatTree = TokenTree::build(flat);
+  Tester::confirm(static_cast<std::string>(*flatTree.getLineListPointer()->
+    front()) == "[[(Operator: (,+)), [[(Operator: (,)), (Identifier: a)], "
+    "(Identifier: b)]], (Identifier: c)]");
+  TokenStream nested { "((a, b), c)" };
+  const TokenTree nestedTree = TokenTree::build(nested);
+  Tester::confirm(static_cast<std::string>(*nestedTree.getLineListPointer()->
+    front()) == "[[(Operator: (,)), [[(Operator: (,)), (Identifier: a)], "
+    "(Identifier: b)]], (Identifier: c)]");
+  TokenStream grouped { "(a)" };
+  const TokenTree groupedTree = TokenTree::build(grouped);
+  Tester::confirm(static_cast<std::string>(*groupedTree.getLineListPointer()->
+    front()) == "(Identifier: a)");
+}